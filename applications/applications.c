@@ -13,6 +13,7 @@ extern int32_t loader_srv(void* p);
 extern int32_t notification_srv(void* p);
 extern int32_t power_observer_srv(void* p);
 extern int32_t power_srv(void* p);
+extern int32_t profiler_srv(void* p);
 extern int32_t storage_srv(void* p);
 extern int32_t desktop_srv(void* p);
 
@@ -117,6 +118,10 @@ const FlipperApplication FLIPPER_SERVICES[] = {
     {.app = power_observer_srv, .name = "PowerAuditSrv", .stack_size = 1024, .icon = NULL},
 #endif
 
+#ifdef SRV_PROFILER
+    {.app = profiler_srv, .name = "ProfilerSrv", .stack_size = 1024, .icon = NULL},
+#endif
+
 #ifdef SRV_STORAGE
     {.app = storage_srv, .name = "StorageSrv", .stack_size = 3072, .icon = NULL},
 #endif
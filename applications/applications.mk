@@ -19,6 +19,11 @@ SRV_LOADER	= 1
 SRV_NOTIFICATION = 1
 SRV_POWER	= 1
 SRV_POWER_OBSERVER = 1
+# Profiler in debug builds only, DEBUG defaults to 1 in make/toolchain.mk
+SRV_PROFILER = 0
+ifneq ($(DEBUG), 0)
+SRV_PROFILER = 1
+endif
 SRV_RPC = 1
 SRV_STORAGE	= 1
 
@@ -251,6 +256,13 @@ SRV_POWER	= 1
 endif
 
 
+SRV_PROFILER ?= 0
+ifeq ($(SRV_PROFILER), 1)
+CFLAGS		+= -DSRV_PROFILER
+SRV_CLI		= 1
+endif
+
+
 SRV_POWER ?= 0
 ifeq ($(SRV_POWER), 1)
 CFLAGS		+= -DSRV_POWER
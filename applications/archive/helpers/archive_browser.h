@@ -22,6 +22,11 @@ static const char* known_ext[] = {
     [ArchiveFileTypeIrda] = ".ir",
 };
 
+/* Files kept by app next to key file, NULL terminated, follow it on rename and delete */
+static const char* known_sidecar_ext[AppIdTotal][4] = {
+    [ArchiveFileTypeNFC] = {".shd", ".nfb", ".shb", NULL},
+};
+
 static inline const char* get_tab_ext(ArchiveTabEnum tab) {
     switch(tab) {
     case ArchiveTabIButton:
@@ -160,6 +160,63 @@ void archive_file_append(const char* path, const char* format, ...) {
     file_worker_free(file_worker);
 }
 
+static void archive_set_sidecar_path(
+    string_t sidecar,
+    ArchiveFileTypeEnum type,
+    const char* path,
+    const char* sidecar_ext) {
+    string_set_str(sidecar, path);
+    size_t ext_len = strlen(known_ext[type]);
+    if(string_size(sidecar) > ext_len &&
+       strcmp(string_get_cstr(sidecar) + string_size(sidecar) - ext_len, known_ext[type]) == 0) {
+        string_left(sidecar, string_size(sidecar) - ext_len);
+    }
+    string_cat_str(sidecar, sidecar_ext);
+}
+
+void archive_rename_sidecars(ArchiveFileTypeEnum type, const char* src, const char* dst) {
+    furi_assert(src);
+    furi_assert(dst);
+
+    if(type >= ArchiveFileTypeFolder) return;
+
+    Storage* fs_api = furi_record_open("storage");
+    string_t sidecar_src;
+    string_t sidecar_dst;
+    string_init(sidecar_src);
+    string_init(sidecar_dst);
+
+    for(const char** ext = known_sidecar_ext[type]; *ext; ext++) {
+        archive_set_sidecar_path(sidecar_src, type, src, *ext);
+        archive_set_sidecar_path(sidecar_dst, type, dst, *ext);
+        // Stale sidecar left under new name must not be picked up, missing ones are fine
+        storage_simply_remove(fs_api, string_get_cstr(sidecar_dst));
+        storage_common_rename(fs_api, string_get_cstr(sidecar_src), string_get_cstr(sidecar_dst));
+    }
+
+    string_clear(sidecar_src);
+    string_clear(sidecar_dst);
+    furi_record_close("storage");
+}
+
+void archive_delete_sidecars(ArchiveFileTypeEnum type, const char* path) {
+    furi_assert(path);
+
+    if(type >= ArchiveFileTypeFolder) return;
+
+    Storage* fs_api = furi_record_open("storage");
+    string_t sidecar;
+    string_init(sidecar);
+
+    for(const char** ext = known_sidecar_ext[type]; *ext; ext++) {
+        archive_set_sidecar_path(sidecar, type, path, *ext);
+        storage_simply_remove(fs_api, string_get_cstr(sidecar));
+    }
+
+    string_clear(sidecar);
+    furi_record_close("storage");
+}
+
 void archive_delete_file(void* context, const char* format, ...) {
     furi_assert(context);
 
@@ -180,6 +237,10 @@ void archive_delete_file(void* context, const char* format, ...) {
     }
 
     if(res) {
+        ArchiveFile_t* selected = archive_get_current_file(browser);
+        if(selected) {
+            archive_delete_sidecars(selected->type, string_get_cstr(filename));
+        }
         archive_file_array_rm_selected(browser);
     }
 
@@ -54,4 +54,6 @@ bool archive_get_filenames(void* context, const char* path);
 bool archive_dir_empty(void* context, const char* path);
 bool archive_read_dir(void* context, const char* path);
 void archive_file_append(const char* path, const char* format, ...);
-void archive_delete_file(void* context, const char* format, ...);
\ No newline at end of file
+void archive_delete_file(void* context, const char* format, ...);
+void archive_rename_sidecars(ArchiveFileTypeEnum type, const char* src, const char* dst);
+void archive_delete_sidecars(ArchiveFileTypeEnum type, const char* path);
\ No newline at end of file
@@ -54,10 +54,15 @@ bool archive_scene_rename_on_event(void* context, SceneManagerEvent event) {
             ArchiveFile_t* file = archive_get_current_file(archive->browser);
 
             string_cat(buffer_dst, known_ext[file->type]);
-            storage_common_rename(
+            FS_Error error = storage_common_rename(
                 fs_api, string_get_cstr(buffer_src), string_get_cstr(buffer_dst));
             furi_record_close("storage");
 
+            if(error == FSE_OK) {
+                archive_rename_sidecars(
+                    file->type, string_get_cstr(buffer_src), string_get_cstr(buffer_dst));
+            }
+
             if(file->fav) {
                 archive_favorites_rename(path, name, string_get_cstr(buffer_dst));
             }
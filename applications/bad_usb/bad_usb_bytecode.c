@@ -0,0 +1,409 @@
+#include "bad_usb_bytecode.h"
+
+#include <furi.h>
+#include <furi-hal-usb-hid.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define OUTPUT_BUFFER_LEN 256
+#define LINE_BUFFER_INITIAL 64
+#define STRING_OP_LEN_MAX UINT16_MAX
+#define BLOCK_NONE UINT32_MAX
+
+/* Keyword table is perfect hash for this seed, pick another one on collision */
+#define KEYWORD_SEED 0x811DE1F2UL
+#define KEYWORD_SLOTS 128
+#define KEYWORD_SLOT_EMPTY 0xFF
+
+typedef enum {
+    DuckyCommandKey,
+    DuckyCommandRem,
+    DuckyCommandDelay,
+    DuckyCommandString,
+    DuckyCommandDefaultDelay,
+    DuckyCommandRepeat,
+} DuckyCommand;
+
+typedef struct {
+    const char* name;
+    DuckyCommand command;
+    uint16_t keycode;
+} DuckyKeyword;
+
+static const DuckyKeyword ducky_keywords[] = {
+    {"REM", DuckyCommandRem, KEY_NONE},
+    {"DELAY", DuckyCommandDelay, KEY_NONE},
+    {"STRING", DuckyCommandString, KEY_NONE},
+    {"DEFAULT_DELAY", DuckyCommandDefaultDelay, KEY_NONE},
+    {"DEFAULTDELAY", DuckyCommandDefaultDelay, KEY_NONE},
+    {"REPEAT", DuckyCommandRepeat, KEY_NONE},
+
+    {"CTRL", DuckyCommandKey, KEY_MOD_LEFT_CTRL},
+    {"CONTROL", DuckyCommandKey, KEY_MOD_LEFT_CTRL},
+    {"SHIFT", DuckyCommandKey, KEY_MOD_LEFT_SHIFT},
+    {"ALT", DuckyCommandKey, KEY_MOD_LEFT_ALT},
+    {"GUI", DuckyCommandKey, KEY_MOD_LEFT_GUI},
+    {"WINDOWS", DuckyCommandKey, KEY_MOD_LEFT_GUI},
+
+    {"DOWNARROW", DuckyCommandKey, KEY_DOWN_ARROW},
+    {"DOWN", DuckyCommandKey, KEY_DOWN_ARROW},
+    {"LEFTARROW", DuckyCommandKey, KEY_LEFT_ARROW},
+    {"LEFT", DuckyCommandKey, KEY_LEFT_ARROW},
+    {"RIGHTARROW", DuckyCommandKey, KEY_RIGHT_ARROW},
+    {"RIGHT", DuckyCommandKey, KEY_RIGHT_ARROW},
+    {"UPARROW", DuckyCommandKey, KEY_UP_ARROW},
+    {"UP", DuckyCommandKey, KEY_UP_ARROW},
+
+    {"ENTER", DuckyCommandKey, KEY_ENTER},
+    {"BREAK", DuckyCommandKey, KEY_PAUSE},
+    {"PAUSE", DuckyCommandKey, KEY_PAUSE},
+    {"CAPSLOCK", DuckyCommandKey, KEY_CAPS_LOCK},
+    {"DELETE", DuckyCommandKey, KEY_DELETE},
+    {"BACKSPACE", DuckyCommandKey, KEY_BACKSPACE},
+    {"END", DuckyCommandKey, KEY_END},
+    {"ESC", DuckyCommandKey, KEY_ESC},
+    {"ESCAPE", DuckyCommandKey, KEY_ESC},
+    {"HOME", DuckyCommandKey, KEY_HOME},
+    {"INSERT", DuckyCommandKey, KEY_INSERT},
+    {"NUMLOCK", DuckyCommandKey, KEY_NUM_LOCK},
+    {"PAGEUP", DuckyCommandKey, KEY_PAGE_UP},
+    {"PAGEDOWN", DuckyCommandKey, KEY_PAGE_DOWN},
+    {"PRINTSCREEN", DuckyCommandKey, KEY_PRINT},
+    {"SCROLLOCK", DuckyCommandKey, KEY_SCROLL_LOCK},
+    {"SPACE", DuckyCommandKey, KEY_SPACE},
+    {"TAB", DuckyCommandKey, KEY_TAB},
+    {"MENU", DuckyCommandKey, KEY_APPLICATION},
+    {"APP", DuckyCommandKey, KEY_APPLICATION},
+
+    {"F1", DuckyCommandKey, KEY_F1},
+    {"F2", DuckyCommandKey, KEY_F2},
+    {"F3", DuckyCommandKey, KEY_F3},
+    {"F4", DuckyCommandKey, KEY_F4},
+    {"F5", DuckyCommandKey, KEY_F5},
+    {"F6", DuckyCommandKey, KEY_F6},
+    {"F7", DuckyCommandKey, KEY_F7},
+    {"F8", DuckyCommandKey, KEY_F8},
+    {"F9", DuckyCommandKey, KEY_F9},
+    {"F10", DuckyCommandKey, KEY_F10},
+    {"F11", DuckyCommandKey, KEY_F11},
+    {"F12", DuckyCommandKey, KEY_F12},
+};
+
+#define KEYWORDS_COUNT (sizeof(ducky_keywords) / sizeof(ducky_keywords[0]))
+
+struct BadUsbCompiler {
+    BadUsbBytecodeOutputCallback callback;
+    void* context;
+
+    uint8_t keyword_slots[KEYWORD_SLOTS];
+
+    uint8_t output[OUTPUT_BUFFER_LEN];
+    size_t output_len;
+    uint32_t code_size;
+    bool output_error;
+
+    /* Line that spans fed chunks */
+    char* line;
+    size_t line_len;
+    size_t line_size;
+
+    uint32_t source_size;
+    uint32_t source_hash;
+    uint16_t line_cur;
+    uint16_t error_line;
+
+    uint32_t defdelay;
+    uint32_t block_start; /**< Code of current line after its BadUsbOpLine */
+    uint32_t prev_block_start; /**< Code of previous line, REPEAT target */
+    bool prev_is_repeat;
+};
+
+uint32_t bad_usb_bytecode_hash(uint32_t hash, const uint8_t* data, size_t size) {
+    for(size_t i = 0; i < size; i++) {
+        hash ^= data[i];
+        hash *= 16777619UL;
+    }
+    return hash;
+}
+
+static uint8_t ducky_keyword_hash(const char* word, size_t len) {
+    uint32_t hash = bad_usb_bytecode_hash(KEYWORD_SEED, (const uint8_t*)word, len);
+    return (hash ^ (hash >> 16)) & (KEYWORD_SLOTS - 1);
+}
+
+static const DuckyKeyword*
+    ducky_keyword_find(BadUsbCompiler* compiler, const char* word, size_t len) {
+    uint8_t index = compiler->keyword_slots[ducky_keyword_hash(word, len)];
+    if(index == KEYWORD_SLOT_EMPTY) return NULL;
+    const DuckyKeyword* keyword = &ducky_keywords[index];
+    if(strlen(keyword->name) != len || memcmp(keyword->name, word, len) != 0) return NULL;
+    return keyword;
+}
+
+BadUsbCompiler* bad_usb_compiler_alloc(BadUsbBytecodeOutputCallback callback, void* context) {
+    furi_assert(callback);
+    BadUsbCompiler* compiler = furi_alloc(sizeof(BadUsbCompiler));
+    compiler->callback = callback;
+    compiler->context = context;
+
+    memset(compiler->keyword_slots, KEYWORD_SLOT_EMPTY, sizeof(compiler->keyword_slots));
+    for(size_t i = 0; i < KEYWORDS_COUNT; i++) {
+        const char* name = ducky_keywords[i].name;
+        uint8_t slot = ducky_keyword_hash(name, strlen(name));
+        furi_check(compiler->keyword_slots[slot] == KEYWORD_SLOT_EMPTY);
+        compiler->keyword_slots[slot] = i;
+    }
+
+    compiler->line_size = LINE_BUFFER_INITIAL;
+    compiler->line = furi_alloc(compiler->line_size);
+
+    compiler->source_hash = BAD_USB_BYTECODE_HASH_INIT;
+    compiler->block_start = BLOCK_NONE;
+    compiler->prev_block_start = BLOCK_NONE;
+
+    return compiler;
+}
+
+void bad_usb_compiler_free(BadUsbCompiler* compiler) {
+    furi_assert(compiler);
+    free(compiler->line);
+    free(compiler);
+}
+
+static void ducky_flush(BadUsbCompiler* compiler) {
+    if(compiler->output_len && !compiler->output_error) {
+        compiler->output_error =
+            !compiler->callback(compiler->output, compiler->output_len, compiler->context);
+    }
+    compiler->output_len = 0;
+}
+
+static void ducky_emit(BadUsbCompiler* compiler, const void* data, size_t size) {
+    const uint8_t* bytes = data;
+    compiler->code_size += size;
+    while(size) {
+        size_t chunk = MIN(size, OUTPUT_BUFFER_LEN - compiler->output_len);
+        memcpy(&compiler->output[compiler->output_len], bytes, chunk);
+        compiler->output_len += chunk;
+        bytes += chunk;
+        size -= chunk;
+        if(compiler->output_len == OUTPUT_BUFFER_LEN) ducky_flush(compiler);
+    }
+}
+
+/* Every op of a line goes after its line marker, emitted only if line has code */
+static void ducky_emit_op(BadUsbCompiler* compiler, BadUsbOp op) {
+    if(compiler->block_start == BLOCK_NONE) {
+        uint8_t line_op = BadUsbOpLine;
+        ducky_emit(compiler, &line_op, sizeof(line_op));
+        ducky_emit(compiler, &compiler->line_cur, sizeof(compiler->line_cur));
+        compiler->block_start = compiler->code_size;
+    }
+    uint8_t code = op;
+    ducky_emit(compiler, &code, sizeof(code));
+}
+
+static void ducky_emit_delay(BadUsbCompiler* compiler, uint32_t delay) {
+    if(delay == 0) return;
+    ducky_emit_op(compiler, BadUsbOpDelay);
+    ducky_emit(compiler, &delay, sizeof(delay));
+}
+
+static void ducky_emit_string(BadUsbCompiler* compiler, const char* text, size_t len) {
+    while(len) {
+        uint16_t chunk = MIN(len, STRING_OP_LEN_MAX);
+        ducky_emit_op(compiler, BadUsbOpString);
+        ducky_emit(compiler, &chunk, sizeof(chunk));
+        ducky_emit(compiler, text, chunk);
+        text += chunk;
+        len -= chunk;
+    }
+}
+
+static size_t ducky_skip_spaces(const char* line, size_t len, size_t pos) {
+    while(pos < len && (line[pos] == ' ' || line[pos] == '\t')) pos++;
+    return pos;
+}
+
+static size_t ducky_word_end(const char* line, size_t len, size_t pos) {
+    while(pos < len && line[pos] != ' ' && line[pos] != '\t') pos++;
+    return pos;
+}
+
+static bool ducky_get_number(const char* line, size_t len, size_t pos, uint32_t* value) {
+    pos = ducky_skip_spaces(line, len, pos);
+    if(pos == len || line[pos] < '0' || line[pos] > '9') return false;
+    uint32_t result = 0;
+    while(pos < len && line[pos] >= '0' && line[pos] <= '9') {
+        result = result * 10 + (line[pos] - '0');
+        pos++;
+    }
+    *value = result;
+    return true;
+}
+
+/* Single key or modifier word, or several of them joined with '-' */
+static bool ducky_get_keycode(
+    BadUsbCompiler* compiler,
+    const char* word,
+    size_t len,
+    bool accept_chars,
+    uint16_t* keycode) {
+    const DuckyKeyword* keyword = ducky_keyword_find(compiler, word, len);
+    if(keyword && keyword->command == DuckyCommandKey) {
+        *keycode = keyword->keycode;
+        return true;
+    } else if(accept_chars && len == 1) {
+        *keycode = HID_ASCII_TO_KEY(word[0]) & 0xFF;
+        return *keycode != KEY_NONE;
+    }
+
+    const char* dash = memchr(word, '-', len);
+    if(!dash || dash == word || dash == word + len - 1) return false;
+    uint16_t left, right;
+    if(!ducky_get_keycode(compiler, word, dash - word, false, &left)) return false;
+    if(!ducky_get_keycode(compiler, dash + 1, word + len - dash - 1, false, &right)) return false;
+    if((left & 0xFF) && (right & 0xFF)) return false;
+    *keycode = left | right;
+    return true;
+}
+
+static bool ducky_compile_keys(BadUsbCompiler* compiler, const char* line, size_t len) {
+    uint16_t keycode = KEY_NONE;
+    size_t pos = 0;
+    bool first = true;
+    while((pos = ducky_skip_spaces(line, len, pos)) < len) {
+        size_t end = ducky_word_end(line, len, pos);
+        uint16_t key;
+        if(!ducky_get_keycode(compiler, &line[pos], end - pos, !first, &key)) return false;
+        // Only one non-modifier key per combo
+        if((keycode & 0xFF) && (key & 0xFF)) return false;
+        keycode |= key;
+        first = false;
+        pos = end;
+    }
+
+    ducky_emit_op(compiler, BadUsbOpKey);
+    ducky_emit(compiler, &keycode, sizeof(keycode));
+    ducky_emit_delay(compiler, compiler->defdelay);
+    return true;
+}
+
+static bool ducky_compile_line(BadUsbCompiler* compiler, const char* line, size_t len) {
+    compiler->line_cur++;
+    compiler->block_start = BLOCK_NONE;
+
+    while(len && (line[len - 1] == '\r' || line[len - 1] == '\n')) len--;
+    size_t pos = ducky_skip_spaces(line, len, 0);
+    if(pos == len) return true;
+
+    size_t end = ducky_word_end(line, len, pos);
+    const DuckyKeyword* keyword = ducky_keyword_find(compiler, &line[pos], end - pos);
+    DuckyCommand command = keyword ? keyword->command : DuckyCommandKey;
+    uint32_t value = 0;
+    bool is_repeat = false;
+
+    if(command == DuckyCommandRem) {
+        // Comment, no code
+    } else if(command == DuckyCommandDelay) {
+        if(!ducky_get_number(line, len, end, &value) || value == 0) return false;
+        ducky_emit_delay(compiler, value + compiler->defdelay);
+    } else if(command == DuckyCommandDefaultDelay) {
+        if(!ducky_get_number(line, len, end, &compiler->defdelay)) return false;
+        ducky_emit_delay(compiler, compiler->defdelay);
+    } else if(command == DuckyCommandString) {
+        // Text starts after exactly one separator, the rest of spaces are typed
+        if(end < len) end++;
+        ducky_emit_string(compiler, &line[end], len - end);
+        ducky_emit_delay(compiler, compiler->defdelay);
+    } else if(command == DuckyCommandRepeat) {
+        if(!ducky_get_number(line, len, end, &value)) return false;
+        if(compiler->prev_is_repeat) return false;
+        // Jump goes before own delay, repeated block already ends with its delay
+        if(compiler->prev_block_start != BLOCK_NONE && value) {
+            ducky_emit_op(compiler, BadUsbOpRepeat);
+            ducky_emit(compiler, &value, sizeof(value));
+            ducky_emit(compiler, &compiler->prev_block_start, sizeof(uint32_t));
+        }
+        ducky_emit_delay(compiler, compiler->defdelay);
+        is_repeat = true;
+    } else {
+        if(!ducky_compile_keys(compiler, &line[pos], len - pos)) return false;
+    }
+
+    // Lines without code like comments still reset REPEAT target
+    compiler->prev_block_start = compiler->block_start;
+    compiler->prev_is_repeat = is_repeat;
+    return true;
+}
+
+static bool ducky_compile_line_checked(BadUsbCompiler* compiler, const char* line, size_t len) {
+    if(!ducky_compile_line(compiler, line, len)) {
+        compiler->error_line = compiler->line_cur;
+        return false;
+    }
+    return !compiler->output_error;
+}
+
+bool bad_usb_compiler_feed(BadUsbCompiler* compiler, const uint8_t* data, size_t size) {
+    furi_assert(compiler);
+    compiler->source_size += size;
+    compiler->source_hash = bad_usb_bytecode_hash(compiler->source_hash, data, size);
+
+    const char* chunk = (const char*)data;
+    while(size) {
+        const char* newline = memchr(chunk, '\n', size);
+        size_t len = newline ? (size_t)(newline - chunk) : size;
+
+        if(newline && compiler->line_len == 0) {
+            // Whole line is in chunk, no copy
+            if(!ducky_compile_line_checked(compiler, chunk, len)) return false;
+        } else {
+            if(compiler->line_len + len > compiler->line_size) {
+                while(compiler->line_len + len > compiler->line_size) compiler->line_size *= 2;
+                compiler->line = realloc(compiler->line, compiler->line_size);
+                furi_check(compiler->line);
+            }
+            memcpy(&compiler->line[compiler->line_len], chunk, len);
+            compiler->line_len += len;
+            if(newline) {
+                bool result =
+                    ducky_compile_line_checked(compiler, compiler->line, compiler->line_len);
+                compiler->line_len = 0;
+                if(!result) return false;
+            }
+        }
+
+        if(!newline) break;
+        chunk += len + 1;
+        size -= len + 1;
+    }
+
+    return true;
+}
+
+bool bad_usb_compiler_finish(BadUsbCompiler* compiler, BadUsbBytecodeHeader* header) {
+    furi_assert(compiler);
+    furi_assert(header);
+
+    if(compiler->line_len) {
+        bool result = ducky_compile_line_checked(compiler, compiler->line, compiler->line_len);
+        compiler->line_len = 0;
+        if(!result) return false;
+    }
+    ducky_flush(compiler);
+
+    memset(header, 0, sizeof(BadUsbBytecodeHeader));
+    header->magic = BAD_USB_BYTECODE_MAGIC;
+    header->version = BAD_USB_BYTECODE_VERSION;
+    header->line_nb = compiler->line_cur;
+    header->source_size = compiler->source_size;
+    header->source_hash = compiler->source_hash;
+
+    return !compiler->output_error;
+}
+
+uint16_t bad_usb_compiler_get_error_line(BadUsbCompiler* compiler) {
+    furi_assert(compiler);
+    return compiler->error_line;
+}
@@ -0,0 +1,113 @@
+/**
+ * @file bad_usb_bytecode.h
+ * BadUSB: ducky script compiler
+ *
+ * Script is compiled once into compact bytecode and cached next to it, worker
+ * then only streams opcodes. Cache is valid while source size and hash match,
+ * file timestamps are not available with FatFs built without RTC.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BAD_USB_BYTECODE_MAGIC 0x4B435544UL /* "DUCK" */
+#define BAD_USB_BYTECODE_VERSION 1
+/** Cache file is script path with this suffix */
+#define BAD_USB_BYTECODE_EXTENSION ".bc"
+/** Source hash initial value, FNV-1a */
+#define BAD_USB_BYTECODE_HASH_INIT 0x811C9DC5UL
+
+/** Opcodes, arguments follow in native byte order */
+typedef enum {
+    BadUsbOpLine = 1, /**< u16 source line, starts code of that line */
+    BadUsbOpString, /**< u16 length, ASCII characters to type */
+    BadUsbOpKey, /**< u16 keycode with modifiers to press and release */
+    BadUsbOpDelay, /**< u32 milliseconds */
+    BadUsbOpRepeat, /**< u32 count, u32 code offset of block to run count more times */
+} BadUsbOp;
+
+/** Cache file header, code follows */
+typedef struct {
+    uint32_t magic;
+    uint8_t version;
+    uint8_t reserved;
+    uint16_t line_nb; /**< Source lines */
+    uint32_t source_size;
+    uint32_t source_hash;
+} BadUsbBytecodeHeader;
+
+/** Compiled code output callback
+ *
+ * @param      data     code chunk
+ * @param      size     chunk size
+ * @param      context  callback context
+ *
+ * @return     true if chunk was stored
+ */
+typedef bool (*BadUsbBytecodeOutputCallback)(const uint8_t* data, size_t size, void* context);
+
+/** BadUsbCompiler anonymous structure */
+typedef struct BadUsbCompiler BadUsbCompiler;
+
+/** Hash source chunk
+ *
+ * @param      hash  hash of previous chunks or BAD_USB_BYTECODE_HASH_INIT
+ * @param      data  source chunk
+ * @param      size  chunk size
+ *
+ * @return     updated hash
+ */
+uint32_t bad_usb_bytecode_hash(uint32_t hash, const uint8_t* data, size_t size);
+
+/** Allocate compiler
+ *
+ * @param      callback  code output, called with chunks in order
+ * @param      context   callback context
+ *
+ * @return     BadUsbCompiler instance
+ */
+BadUsbCompiler* bad_usb_compiler_alloc(BadUsbBytecodeOutputCallback callback, void* context);
+
+/** Free compiler
+ *
+ * @param      compiler  BadUsbCompiler instance
+ */
+void bad_usb_compiler_free(BadUsbCompiler* compiler);
+
+/** Compile source chunk, lines may span chunks
+ *
+ * @param      compiler  BadUsbCompiler instance
+ * @param      data      source chunk
+ * @param      size      chunk size
+ *
+ * @return     false on script or output error, stop feeding then
+ */
+bool bad_usb_compiler_feed(BadUsbCompiler* compiler, const uint8_t* data, size_t size);
+
+/** Compile last line, flush code and fill header
+ *
+ * @param      compiler  BadUsbCompiler instance
+ * @param      header    header to fill
+ *
+ * @return     false on script or output error
+ */
+bool bad_usb_compiler_finish(BadUsbCompiler* compiler, BadUsbBytecodeHeader* header);
+
+/** Get line of script error
+ *
+ * @param      compiler  BadUsbCompiler instance
+ *
+ * @return     1-based line, 0 if there was no script error
+ */
+uint16_t bad_usb_compiler_get_error_line(BadUsbCompiler* compiler);
+
+#ifdef __cplusplus
+}
+#endif
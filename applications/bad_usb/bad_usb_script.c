@@ -6,10 +6,12 @@
 #include <furi-hal-usb-hid.h>
 #include <storage/storage.h>
 #include "bad_usb_script.h"
+#include "bad_usb_bytecode.h"
+#include "bad_usb_typer.h"
 
 #define TAG "BadUSB"
 #define WORKER_TAG TAG "Worker"
-#define FILE_BUFFER_LEN 16
+#define FILE_BUFFER_LEN 256
 
 typedef enum {
     WorkerEvtReserved = (1 << 0),
@@ -22,259 +24,234 @@ typedef enum {
 struct BadUsbScript {
     BadUsbState st;
     string_t file_path;
-    uint32_t defdelay;
     FuriThread* thread;
-    uint8_t file_buf[FILE_BUFFER_LEN + 1];
-    uint8_t buf_start;
-    uint8_t buf_len;
-    bool file_end;
-    string_t line;
+    uint8_t file_buf[FILE_BUFFER_LEN];
+    uint16_t buf_pos;
+    uint16_t buf_len;
+    uint32_t buf_offset; /**< Code offset of file_buf[0] */
+    BadUsbTyper* typer;
 
-    string_t line_prev;
     uint32_t repeat_cnt;
+    bool repeat_active;
 };
 
-typedef struct {
-    char* name;
-    uint16_t keycode;
-} DuckyKey;
-
-static const DuckyKey ducky_keys[] = {
-    {"CTRL", KEY_MOD_LEFT_CTRL},
-    {"CONTROL", KEY_MOD_LEFT_CTRL},
-    {"SHIFT", KEY_MOD_LEFT_SHIFT},
-    {"ALT", KEY_MOD_LEFT_ALT},
-    {"GUI", KEY_MOD_LEFT_GUI},
-    {"WINDOWS", KEY_MOD_LEFT_GUI},
-
-    {"DOWNARROW", KEY_DOWN_ARROW},
-    {"DOWN", KEY_DOWN_ARROW},
-    {"LEFTARROW", KEY_LEFT_ARROW},
-    {"LEFT", KEY_LEFT_ARROW},
-    {"RIGHTARROW", KEY_RIGHT_ARROW},
-    {"RIGHT", KEY_RIGHT_ARROW},
-    {"UPARROW", KEY_UP_ARROW},
-    {"UP", KEY_UP_ARROW},
-
-    {"ENTER", KEY_ENTER},
-    {"BREAK", KEY_PAUSE},
-    {"PAUSE", KEY_PAUSE},
-    {"CAPSLOCK", KEY_CAPS_LOCK},
-    {"DELETE", KEY_DELETE},
-    {"BACKSPACE", KEY_BACKSPACE},
-    {"END", KEY_END},
-    {"ESC", KEY_ESC},
-    {"ESCAPE", KEY_ESC},
-    {"HOME", KEY_HOME},
-    {"INSERT", KEY_INSERT},
-    {"NUMLOCK", KEY_NUM_LOCK},
-    {"PAGEUP", KEY_PAGE_UP},
-    {"PAGEDOWN", KEY_PAGE_DOWN},
-    {"PRINTSCREEN", KEY_PRINT},
-    {"SCROLLOCK", KEY_SCROLL_LOCK},
-    {"SPACE", KEY_SPACE},
-    {"TAB", KEY_TAB},
-    {"MENU", KEY_APPLICATION},
-    {"APP", KEY_APPLICATION},
-
-    {"F1", KEY_F1},
-    {"F2", KEY_F2},
-    {"F3", KEY_F3},
-    {"F4", KEY_F4},
-    {"F5", KEY_F5},
-    {"F6", KEY_F6},
-    {"F7", KEY_F7},
-    {"F8", KEY_F8},
-    {"F9", KEY_F9},
-    {"F10", KEY_F10},
-    {"F11", KEY_F11},
-    {"F12", KEY_F12},
-};
+static bool ducky_code_fill(BadUsbScript* bad_usb, File* code_file) {
+    if(bad_usb->buf_pos < bad_usb->buf_len) return true;
+    bad_usb->buf_offset += bad_usb->buf_len;
+    bad_usb->buf_len = storage_file_read(code_file, bad_usb->file_buf, FILE_BUFFER_LEN);
+    bad_usb->buf_pos = 0;
+    return bad_usb->buf_len > 0;
+}
 
-static const char ducky_cmd_comment[] = {"REM"};
-static const char ducky_cmd_delay[] = {"DELAY"};
-static const char ducky_cmd_string[] = {"STRING"};
-static const char ducky_cmd_defdelay_1[] = {"DEFAULT_DELAY"};
-static const char ducky_cmd_defdelay_2[] = {"DEFAULTDELAY"};
-static const char ducky_cmd_repeat[] = {"REPEAT"};
-
-static bool ducky_get_number(char* param, uint32_t* val) {
-    uint32_t value = 0;
-    if(sscanf(param, "%lu", &value) == 1) {
-        *val = value;
-        return true;
+static bool ducky_code_read(BadUsbScript* bad_usb, File* code_file, void* data, size_t size) {
+    uint8_t* bytes = data;
+    while(size) {
+        if(!ducky_code_fill(bad_usb, code_file)) return false;
+        size_t chunk = MIN(size, (size_t)(bad_usb->buf_len - bad_usb->buf_pos));
+        memcpy(bytes, &bad_usb->file_buf[bad_usb->buf_pos], chunk);
+        bad_usb->buf_pos += chunk;
+        bytes += chunk;
+        size -= chunk;
     }
-    return false;
+    return true;
 }
 
-static uint32_t ducky_get_command_len(char* line) {
-    uint32_t len = strlen(line);
-    for(uint32_t i = 0; i < len; i++) {
-        if(line[i] == ' ') return i;
+static bool ducky_code_jump(BadUsbScript* bad_usb, File* code_file, uint32_t offset) {
+    // Short REPEAT blocks are still in buffer
+    if(offset >= bad_usb->buf_offset && offset < bad_usb->buf_offset + bad_usb->buf_len) {
+        bad_usb->buf_pos = offset - bad_usb->buf_offset;
+        return true;
     }
-    return 0;
+    bad_usb->buf_offset = offset;
+    bad_usb->buf_len = 0;
+    bad_usb->buf_pos = 0;
+    return storage_file_seek(code_file, sizeof(BadUsbBytecodeHeader) + offset, true);
 }
 
-static bool ducky_string(char* param) {
-    uint32_t i = 0;
-    while(param[i] != '\0') {
-        furi_hal_hid_kb_press(HID_ASCII_TO_KEY(param[i]));
-        furi_hal_hid_kb_release(HID_ASCII_TO_KEY(param[i]));
-        i++;
+static void ducky_code_rewind(BadUsbScript* bad_usb, File* code_file) {
+    bad_usb->buf_offset = 0;
+    bad_usb->buf_len = 0;
+    bad_usb->buf_pos = 0;
+    storage_file_seek(code_file, sizeof(BadUsbBytecodeHeader), true);
+}
+
+static bool ducky_typer_callback(const BadUsbTyperReport* report, void* context) {
+    return furi_hal_hid_kb_set(report->mods, report->keys);
+}
+
+static bool ducky_string(BadUsbScript* bad_usb, File* code_file, uint16_t len) {
+    while(len) {
+        if(!ducky_code_fill(bad_usb, code_file)) return false;
+        uint16_t chunk = MIN(len, bad_usb->buf_len - bad_usb->buf_pos);
+        // Disconnect is handled by worker, text is consumed anyway
+        bad_usb_typer_type(
+            bad_usb->typer, (const char*)&bad_usb->file_buf[bad_usb->buf_pos], chunk);
+        bad_usb->buf_pos += chunk;
+        len -= chunk;
     }
+    bad_usb_typer_release(bad_usb->typer);
     return true;
 }
 
-static uint16_t ducky_get_keycode(char* param, bool accept_chars) {
-    for(uint8_t i = 0; i < (sizeof(ducky_keys) / sizeof(ducky_keys[0])); i++) {
-        if(strncmp(param, ducky_keys[i].name, strlen(ducky_keys[i].name)) == 0)
-            return ducky_keys[i].keycode;
+static bool ducky_script_cache_write(const uint8_t* data, size_t size, void* context) {
+    File* code_file = context;
+    return storage_file_write(code_file, data, size) == size;
+}
+
+/* Check cache header against source, hashing source only if size matches */
+static bool ducky_script_cache_is_valid(BadUsbScript* bad_usb, File* source, File* code_file) {
+    BadUsbBytecodeHeader header;
+    if(storage_file_read(code_file, &header, sizeof(header)) != sizeof(header)) return false;
+    if(header.magic != BAD_USB_BYTECODE_MAGIC || header.version != BAD_USB_BYTECODE_VERSION ||
+       header.source_size != storage_file_size(source)) {
+        return false;
     }
-    if((accept_chars) && (strlen(param) > 0)) {
-        return (HID_ASCII_TO_KEY(param[0]) & 0xFF);
+
+    uint32_t hash = BAD_USB_BYTECODE_HASH_INIT;
+    uint16_t ret = 0;
+    while((ret = storage_file_read(source, bad_usb->file_buf, FILE_BUFFER_LEN)) > 0) {
+        hash = bad_usb_bytecode_hash(hash, bad_usb->file_buf, ret);
     }
-    return 0;
-}
+    if(hash != header.source_hash) return false;
 
-static int32_t ducky_parse_line(BadUsbScript* bad_usb, string_t line) {
-    uint32_t line_len = string_size(line);
-    char* line_t = (char*)string_get_cstr(line);
-    bool state = false;
+    bad_usb->st.line_nb = header.line_nb;
+    return true;
+}
 
-    for(uint32_t i = 0; i < line_len; i++) {
-        if((line_t[i] != ' ') && (line_t[i] != '\t') && (line_t[i] != '\n')) {
-            line_t = &line_t[i];
-            break; // Skip spaces and tabs
-        }
-        if(i == line_len - 1) return 0; // Skip empty lines
+static bool ducky_script_compile(BadUsbScript* bad_usb, File* source, File* code_file) {
+    BadUsbBytecodeHeader header = {0};
+    if(storage_file_write(code_file, &header, sizeof(header)) != sizeof(header)) {
+        FURI_LOG_E(WORKER_TAG, "Cache write error");
+        return false;
     }
 
-    FURI_LOG_I(WORKER_TAG, "line:%s", line_t);
-
-    // General commands
-    if(strncmp(line_t, ducky_cmd_comment, strlen(ducky_cmd_comment)) == 0) {
-        // REM - comment line
-        return (0);
-    } else if(strncmp(line_t, ducky_cmd_delay, strlen(ducky_cmd_delay)) == 0) {
-        // DELAY
-        line_t = &line_t[ducky_get_command_len(line_t) + 1];
-        uint32_t delay_val = 0;
-        state = ducky_get_number(line_t, &delay_val);
-        if((state) && (delay_val > 0)) {
-            return (int32_t)delay_val;
-        }
-        return (-1);
-    } else if(
-        (strncmp(line_t, ducky_cmd_defdelay_1, strlen(ducky_cmd_defdelay_1)) == 0) ||
-        (strncmp(line_t, ducky_cmd_defdelay_2, strlen(ducky_cmd_defdelay_2)) == 0)) {
-        // DEFAULT_DELAY
-        line_t = &line_t[ducky_get_command_len(line_t) + 1];
-        state = ducky_get_number(line_t, &bad_usb->defdelay);
-        return (state) ? (0) : (-1);
-    } else if(strncmp(line_t, ducky_cmd_string, strlen(ducky_cmd_string)) == 0) {
-        // STRING
-        line_t = &line_t[ducky_get_command_len(line_t) + 1];
-        state = ducky_string(line_t);
-        return (state) ? (0) : (-1);
-    } else if(strncmp(line_t, ducky_cmd_repeat, strlen(ducky_cmd_repeat)) == 0) {
-        // REPEAT
-        line_t = &line_t[ducky_get_command_len(line_t) + 1];
-        state = ducky_get_number(line_t, &bad_usb->repeat_cnt);
-        return (state) ? (0) : (-1);
+    BadUsbCompiler* compiler = bad_usb_compiler_alloc(ducky_script_cache_write, code_file);
+    bool result = true;
+    uint16_t ret = 0;
+    while(result && (ret = storage_file_read(source, bad_usb->file_buf, FILE_BUFFER_LEN)) > 0) {
+        result = bad_usb_compiler_feed(compiler, bad_usb->file_buf, ret);
+    }
+    result = result && bad_usb_compiler_finish(compiler, &header);
+    bad_usb->st.error_line = bad_usb_compiler_get_error_line(compiler);
+    bad_usb_compiler_free(compiler);
+
+    if(result) {
+        // Header goes last, interrupted compilation leaves invalid cache
+        result = storage_file_seek(code_file, 0, true) &&
+                 storage_file_write(code_file, &header, sizeof(header)) == sizeof(header);
+    }
+    if(result) {
+        bad_usb->st.line_nb = header.line_nb;
+        FURI_LOG_I(WORKER_TAG, "Compiled %u lines", header.line_nb);
+    } else if(bad_usb->st.error_line) {
+        FURI_LOG_E(WORKER_TAG, "Unknown command at line %u", bad_usb->st.error_line);
     } else {
-        // Special keys + modifiers
-        uint16_t key = ducky_get_keycode(line_t, false);
-        if(key == KEY_NONE) return (-1);
-        if((key & 0xFF00) != 0) {
-            // It's a modifier key
-            line_t = &line_t[ducky_get_command_len(line_t) + 1];
-            key |= ducky_get_keycode(line_t, true);
-        }
-        furi_hal_hid_kb_press(key);
-        furi_hal_hid_kb_release(key);
-        return (0);
+        FURI_LOG_E(WORKER_TAG, "Cache write error");
     }
-    return (-1);
+    return result;
 }
 
-static bool ducky_script_preload(BadUsbScript* bad_usb, File* script_file) {
-    uint8_t ret = 0;
-    uint32_t line_len = 0;
+/* Open compiled script in code_file, compiling it if cache is stale */
+static BadUsbWorkerState ducky_script_load(BadUsbScript* bad_usb, File* code_file) {
+    Storage* storage = furi_record_open("storage");
+    File* source = storage_file_alloc(storage);
+    string_t code_path;
+    string_init_printf(
+        code_path, "%s%s", string_get_cstr(bad_usb->file_path), BAD_USB_BYTECODE_EXTENSION);
+    BadUsbWorkerState state = BadUsbStateFileError;
 
     do {
-        ret = storage_file_read(script_file, bad_usb->file_buf, FILE_BUFFER_LEN);
-        for(uint16_t i = 0; i < ret; i++) {
-            if(bad_usb->file_buf[i] == '\n' && line_len > 0) {
-                bad_usb->st.line_nb++;
-                line_len = 0;
-            } else {
-                line_len++;
-            }
+        if(!storage_file_open(
+               source, string_get_cstr(bad_usb->file_path), FSAM_READ, FSOM_OPEN_EXISTING)) {
+            FURI_LOG_E(WORKER_TAG, "File open error");
+            break;
         }
-        if(storage_file_eof(script_file)) {
-            if(line_len > 0) {
-                bad_usb->st.line_nb++;
+
+        if(storage_file_open(
+               code_file, string_get_cstr(code_path), FSAM_READ, FSOM_OPEN_EXISTING)) {
+            if(ducky_script_cache_is_valid(bad_usb, source, code_file)) {
+                state = BadUsbStateIdle;
                 break;
             }
+            storage_file_close(code_file);
+            storage_file_seek(source, 0, true);
         }
-    } while(ret > 0);
 
-    storage_file_seek(script_file, 0, true);
-
-    return true;
-}
-
-static int32_t ducky_script_execute_next(BadUsbScript* bad_usb, File* script_file) {
-    int32_t delay_val = 0;
-
-    if(bad_usb->repeat_cnt > 0) {
-        bad_usb->repeat_cnt--;
-        delay_val = ducky_parse_line(bad_usb, bad_usb->line_prev);
-        if(delay_val < 0) {
-            bad_usb->st.error_line = bad_usb->st.line_cur - 1;
-            FURI_LOG_E(WORKER_TAG, "Unknown command at line %lu", bad_usb->st.line_cur - 1);
-            return (-1);
+        if(!storage_file_open(
+               code_file,
+               string_get_cstr(code_path),
+               FSAM_READ | FSAM_WRITE,
+               FSOM_CREATE_ALWAYS)) {
+            FURI_LOG_E(WORKER_TAG, "Cache open error");
+            break;
+        }
+        if(ducky_script_compile(bad_usb, source, code_file)) {
+            state = BadUsbStateIdle;
         } else {
-            return (delay_val + bad_usb->defdelay);
+            storage_file_close(code_file);
+            storage_common_remove(storage, string_get_cstr(code_path));
+            if(bad_usb->st.error_line) state = BadUsbStateScriptError;
         }
+    } while(0);
+
+    if(state == BadUsbStateIdle && bad_usb->st.line_nb == 0) {
+        state = BadUsbStateScriptError;
     }
 
-    string_set(bad_usb->line_prev, bad_usb->line);
-    string_reset(bad_usb->line);
+    storage_file_close(source);
+    storage_file_free(source);
+    string_clear(code_path);
+    furi_record_close("storage");
+    return state;
+}
+
+static int32_t ducky_script_execute_next(BadUsbScript* bad_usb, File* code_file) {
+    bool line_started = false;
 
     while(1) {
-        if(bad_usb->buf_len == 0) {
-            bad_usb->buf_len = storage_file_read(script_file, bad_usb->file_buf, FILE_BUFFER_LEN);
-            if(storage_file_eof(script_file)) {
-                if((bad_usb->buf_len < FILE_BUFFER_LEN) && (bad_usb->file_end == false)) {
-                    bad_usb->file_buf[bad_usb->buf_len] = '\n';
-                    bad_usb->buf_len++;
-                    bad_usb->file_end = true;
-                }
+        if(!ducky_code_fill(bad_usb, code_file)) return (-2); // End of script
+
+        uint8_t op = bad_usb->file_buf[bad_usb->buf_pos];
+        if(op == BadUsbOpLine && line_started) return 0; // Next line goes on next call
+        bad_usb->buf_pos++;
+        line_started = true;
+
+        bool result = false;
+        if(op == BadUsbOpLine) {
+            result = ducky_code_read(bad_usb, code_file, &bad_usb->st.line_cur, sizeof(uint16_t));
+        } else if(op == BadUsbOpString) {
+            uint16_t len = 0;
+            result = ducky_code_read(bad_usb, code_file, &len, sizeof(len)) &&
+                     ducky_string(bad_usb, code_file, len);
+        } else if(op == BadUsbOpKey) {
+            uint16_t key = KEY_NONE;
+            result = ducky_code_read(bad_usb, code_file, &key, sizeof(key));
+            furi_hal_hid_kb_press(key);
+            furi_hal_hid_kb_release(key);
+        } else if(op == BadUsbOpDelay) {
+            uint32_t delay_val = 0;
+            if(ducky_code_read(bad_usb, code_file, &delay_val, sizeof(delay_val))) {
+                return MIN(delay_val, (uint32_t)INT32_MAX);
             }
-
-            bad_usb->buf_start = 0;
-            if(bad_usb->buf_len == 0) return (-2);
-        }
-        for(uint8_t i = bad_usb->buf_start; i < (bad_usb->buf_start + bad_usb->buf_len); i++) {
-            if(bad_usb->file_buf[i] == '\n' && string_size(bad_usb->line) > 0) {
-                bad_usb->st.line_cur++;
-                bad_usb->buf_len = bad_usb->buf_len + bad_usb->buf_start - (i + 1);
-                bad_usb->buf_start = i + 1;
-                delay_val = ducky_parse_line(bad_usb, bad_usb->line);
-                if(delay_val < 0) {
-                    bad_usb->st.error_line = bad_usb->st.line_cur;
-                    FURI_LOG_E(WORKER_TAG, "Unknown command at line %lu", bad_usb->st.line_cur);
-                    return (-1);
-                } else {
-                    return (delay_val + bad_usb->defdelay);
-                }
-            } else {
-                string_push_back(bad_usb->line, bad_usb->file_buf[i]);
+        } else if(op == BadUsbOpRepeat) {
+            uint32_t args[2];
+            result = ducky_code_read(bad_usb, code_file, args, sizeof(args));
+            if(result && !bad_usb->repeat_active) {
+                bad_usb->repeat_cnt = args[0];
+                bad_usb->repeat_active = true;
+            }
+            if(result && bad_usb->repeat_cnt > 0) {
+                bad_usb->repeat_cnt--;
+                return ducky_code_jump(bad_usb, code_file, args[1]) ? 0 : (-1);
             }
+            bad_usb->repeat_active = false;
+        }
+
+        if(!result) {
+            bad_usb->st.error_line = bad_usb->st.line_cur;
+            FURI_LOG_E(WORKER_TAG, "Corrupted code at line %u", bad_usb->st.line_cur);
+            return (-1);
         }
-        bad_usb->buf_len = 0;
-        if(bad_usb->file_end) return (-2);
     }
 
     return 0;
@@ -298,30 +275,15 @@ static int32_t bad_usb_worker(void* context) {
 
     FURI_LOG_I(WORKER_TAG, "Init");
     File* script_file = storage_file_alloc(furi_record_open("storage"));
-    string_init(bad_usb->line);
-    string_init(bad_usb->line_prev);
+    bad_usb->typer = bad_usb_typer_alloc(ducky_typer_callback, bad_usb);
 
     furi_hal_hid_set_state_callback(bad_usb_hid_state_callback, bad_usb);
 
     while(1) {
         if(worker_state == BadUsbStateInit) { // State: initialization
-            if(storage_file_open(
-                   script_file,
-                   string_get_cstr(bad_usb->file_path),
-                   FSAM_READ,
-                   FSOM_OPEN_EXISTING)) {
-                if((ducky_script_preload(bad_usb, script_file)) && (bad_usb->st.line_nb > 0)) {
-                    if(furi_hal_hid_is_connected()) {
-                        worker_state = BadUsbStateIdle; // Ready to run
-                    } else {
-                        worker_state = BadUsbStateNotConnected; // USB not connected
-                    }
-                } else {
-                    worker_state = BadUsbStateScriptError; // Script preload error
-                }
-            } else {
-                FURI_LOG_E(WORKER_TAG, "File open error");
-                worker_state = BadUsbStateFileError; // File open error
+            worker_state = ducky_script_load(bad_usb, script_file);
+            if((worker_state == BadUsbStateIdle) && !furi_hal_hid_is_connected()) {
+                worker_state = BadUsbStateNotConnected; // USB not connected
             }
             bad_usb->st.state = worker_state;
 
@@ -346,12 +308,10 @@ static int32_t bad_usb_worker(void* context) {
                 break;
             } else if(flags & WorkerEvtToggle) { // Start executing script
                 delay_val = 0;
-                bad_usb->buf_len = 0;
                 bad_usb->st.line_cur = 0;
-                bad_usb->defdelay = 0;
                 bad_usb->repeat_cnt = 0;
-                bad_usb->file_end = false;
-                storage_file_seek(script_file, 0, true);
+                bad_usb->repeat_active = false;
+                ducky_code_rewind(bad_usb, script_file);
                 worker_state = BadUsbStateRunning;
             } else if(flags & WorkerEvtDisconnect) {
                 worker_state = BadUsbStateNotConnected; // USB disconnected
@@ -392,9 +352,13 @@ static int32_t bad_usb_worker(void* context) {
                     bad_usb->st.state = BadUsbStateDone;
                     furi_hal_hid_kb_release_all();
                     continue;
-                } else if(delay_val > 1000) {
-                    bad_usb->st.state = BadUsbStateDelay; // Show long delays
-                    bad_usb->st.delay_remain = delay_val / 1000;
+                } else if(delay_val > 0) {
+                    // Reports are queued, count delay from the moment host got them
+                    furi_hal_hid_flush();
+                    if(delay_val > 1000) {
+                        bad_usb->st.state = BadUsbStateDelay; // Show long delays
+                        bad_usb->st.delay_remain = delay_val / 1000;
+                    }
                 }
             } else {
                 furi_check((flags & osFlagsError) == 0);
@@ -413,11 +377,11 @@ static int32_t bad_usb_worker(void* context) {
     }
 
     furi_hal_hid_set_state_callback(NULL, NULL);
+    bad_usb_typer_free(bad_usb->typer);
 
     storage_file_close(script_file);
     storage_file_free(script_file);
-    string_clear(bad_usb->line);
-    string_clear(bad_usb->line_prev);
+    furi_record_close("storage");
 
     FURI_LOG_I(WORKER_TAG, "End");
 
@@ -0,0 +1,76 @@
+#include "bad_usb_typer.h"
+
+#include <furi.h>
+#include <string.h>
+
+struct BadUsbTyper {
+    BadUsbTyperCallback callback;
+    void* context;
+    BadUsbTyperReport report;
+    uint8_t keys_nb; /**< Pressed keys, oldest first */
+};
+
+BadUsbTyper* bad_usb_typer_alloc(BadUsbTyperCallback callback, void* context) {
+    furi_assert(callback);
+    BadUsbTyper* typer = furi_alloc(sizeof(BadUsbTyper));
+    typer->callback = callback;
+    typer->context = context;
+    return typer;
+}
+
+void bad_usb_typer_free(BadUsbTyper* typer) {
+    furi_assert(typer);
+    free(typer);
+}
+
+static void bad_usb_typer_remove(BadUsbTyper* typer, uint8_t index) {
+    memmove(
+        &typer->report.keys[index],
+        &typer->report.keys[index + 1],
+        typer->keys_nb - index - 1);
+    typer->keys_nb--;
+    typer->report.keys[typer->keys_nb] = KEY_NONE;
+}
+
+static bool bad_usb_typer_key(BadUsbTyper* typer, uint16_t keycode) {
+    uint8_t key = keycode & 0xFF;
+    uint8_t mods = keycode >> 8;
+
+    if(typer->keys_nb && mods != typer->report.mods) {
+        // Held keys would be retyped by some hosts with new modifiers
+        if(!bad_usb_typer_release(typer)) return false;
+    } else {
+        // Held key must go up before it can go down again
+        for(uint8_t i = 0; i < typer->keys_nb; i++) {
+            if(typer->report.keys[i] == key) {
+                bad_usb_typer_remove(typer, i);
+                if(!typer->callback(&typer->report, typer->context)) return false;
+                break;
+            }
+        }
+    }
+
+    // Oldest key is released in the same report
+    if(typer->keys_nb == HID_KB_MAX_KEYS) bad_usb_typer_remove(typer, 0);
+    typer->report.keys[typer->keys_nb++] = key;
+    typer->report.mods = mods;
+    return typer->callback(&typer->report, typer->context);
+}
+
+bool bad_usb_typer_type(BadUsbTyper* typer, const char* text, size_t len) {
+    furi_assert(typer);
+    for(size_t i = 0; i < len; i++) {
+        uint16_t keycode = HID_ASCII_TO_KEY(text[i]);
+        if((keycode & 0xFF) == KEY_NONE) continue;
+        if(!bad_usb_typer_key(typer, keycode)) return false;
+    }
+    return true;
+}
+
+bool bad_usb_typer_release(BadUsbTyper* typer) {
+    furi_assert(typer);
+    if(typer->keys_nb == 0 && typer->report.mods == 0) return true;
+    memset(&typer->report, 0, sizeof(BadUsbTyperReport));
+    typer->keys_nb = 0;
+    return typer->callback(&typer->report, typer->context);
+}
@@ -0,0 +1,78 @@
+/**
+ * @file bad_usb_typer.h
+ * BadUSB: text to keyboard reports packer
+ *
+ * Typed keys are not released one by one: each report presses one more key
+ * while earlier ones stay held, up to HID_KB_MAX_KEYS, then the oldest key is
+ * released in the same report that presses the next one. Host sees exactly
+ * one key down per report, so typing order is kept. Separate release report
+ * goes only before a key that is still held and before modifiers change.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <furi-hal-usb-hid.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Keyboard report, same layout as in furi_hal_hid_kb_set */
+typedef struct {
+    uint8_t mods;
+    uint8_t keys[HID_KB_MAX_KEYS];
+} BadUsbTyperReport;
+
+/** Report output callback
+ *
+ * @param      report   report to send
+ * @param      context  callback context
+ *
+ * @return     false if report can't be sent, typing stops then
+ */
+typedef bool (*BadUsbTyperCallback)(const BadUsbTyperReport* report, void* context);
+
+/** BadUsbTyper anonymous structure */
+typedef struct BadUsbTyper BadUsbTyper;
+
+/** Allocate typer, all keys are released
+ *
+ * @param      callback  report output
+ * @param      context   callback context
+ *
+ * @return     BadUsbTyper instance
+ */
+BadUsbTyper* bad_usb_typer_alloc(BadUsbTyperCallback callback, void* context);
+
+/** Free typer
+ *
+ * @param      typer  BadUsbTyper instance
+ */
+void bad_usb_typer_free(BadUsbTyper* typer);
+
+/** Type text, last keys stay pressed until bad_usb_typer_release
+ *
+ * Characters without key code are skipped.
+ *
+ * @param      typer  BadUsbTyper instance
+ * @param      text   ASCII text
+ * @param      len    text length
+ *
+ * @return     false on callback failure
+ */
+bool bad_usb_typer_type(BadUsbTyper* typer, const char* text, size_t len);
+
+/** Release all keys, sends report only if something is pressed
+ *
+ * @param      typer  BadUsbTyper instance
+ *
+ * @return     false on callback failure
+ */
+bool bad_usb_typer_release(BadUsbTyper* typer);
+
+#ifdef __cplusplus
+}
+#endif
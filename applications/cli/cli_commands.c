@@ -5,6 +5,8 @@
 #include <task-control-block.h>
 #include <time.h>
 #include <notification/notification-messages.h>
+#include <storage/storage.h>
+#include <toolbox/args.h>
 
 void cli_command_device_info_callback(const char* key, const char* value, bool last, void* context) {
     printf("%-24s: %s\r\n", key, value);
@@ -113,6 +115,20 @@ void cli_command_date(Cli* cli, string_t args, void* context) {
 }
 
 void cli_command_log(Cli* cli, string_t args, void* context) {
+    // Log records go to console UART, argument only switches their encoding there
+    if(!string_cmp(args, "text")) {
+        furi_log_set_mode(FuriLogModeText);
+        printf("Console log is text");
+        return;
+    } else if(!string_cmp(args, "binary")) {
+        furi_log_set_mode(FuriLogModeBinary);
+        printf("Console log is binary, decode it with scripts/logdecode.py");
+        return;
+    } else if(string_size(args)) {
+        cli_print_usage("log", "<text|binary>", string_get_cstr(args));
+        return;
+    }
+
     furi_stdglue_set_global_stdout_callback(cli_stdout_callback);
     printf("Press any key to stop...\r\n");
     cli_getc(cli);
@@ -282,31 +298,359 @@ void cli_command_ps(Cli* cli, string_t args, void* context) {
     const uint8_t threads_num_max = 32;
     osThreadId_t threads_id[threads_num_max];
     uint8_t thread_num = osThreadEnumerate(threads_id, threads_num_max);
+    MemmgrHeapThreadStats* heap =
+        furi_alloc(sizeof(MemmgrHeapThreadStats) * MEMMGR_HEAP_THREAD_SLOTS);
+    size_t heap_num = memmgr_heap_get_threads_stats(heap, MEMMGR_HEAP_THREAD_SLOTS);
     printf(
-        "%-20s %-14s %-8s %-8s %s\r\n", "Name", "Stack start", "Heap", "Stack", "Stack min free");
+        "%-20s %-14s %-8s %-8s %-8s %s\r\n",
+        "Name",
+        "Stack start",
+        "Heap",
+        "Peak",
+        "Stack",
+        "Stack min free");
     for(uint8_t i = 0; i < thread_num; i++) {
         TaskControlBlock* tcb = (TaskControlBlock*)threads_id[i];
+        MemmgrHeapThreadStats thread_heap = {0};
+        for(size_t j = 0; j < heap_num; j++) {
+            if(heap[j].thread_id == threads_id[i]) {
+                thread_heap = heap[j];
+                break;
+            }
+        }
         printf(
-            "%-20s 0x%-12lx %-8d %-8ld %-8ld\r\n",
+            "%-20s 0x%-12lx %-8d %-8d %-8ld %-8ld\r\n",
             osThreadGetName(threads_id[i]),
             (uint32_t)tcb->pxStack,
-            memmgr_heap_get_thread_memory(threads_id[i]),
+            thread_heap.live,
+            thread_heap.peak,
             (uint32_t)(tcb->pxEndOfStack - tcb->pxStack + 1) * sizeof(StackType_t),
             osThreadGetStackSpace(threads_id[i]));
     }
     printf("\r\nTotal: %d", thread_num);
+    free(heap);
+}
+
+static void cli_command_free_latency(const char* name, const MemmgrHeapLatency* latency) {
+    uint64_t freq = osKernelGetSysTimerFreq();
+    uint32_t avg = latency->count ? latency->time_total / latency->count : 0;
+    printf(
+        "%-12s %-10lu %-10lu %lu\r\n",
+        name,
+        latency->count,
+        (uint32_t)(avg * 1000000000ULL / freq),
+        (uint32_t)(latency->time_max * 1000000000ULL / freq));
 }
 
 void cli_command_free(Cli* cli, string_t args, void* context) {
+    MemmgrHeapStats stats;
+    memmgr_heap_get_stats(&stats);
+
     printf("Free heap size: %d\r\n", memmgr_get_free_heap());
     printf("Minimum heap size: %d\r\n", memmgr_get_minimum_free_heap());
-    printf("Maximum heap block: %d\r\n", memmgr_heap_get_max_free_block());
+    size_t max_block = memmgr_heap_get_max_free_block();
+    printf("Maximum heap block: %d\r\n", max_block);
+    printf("Free slab size: %d\r\n", stats.slab_free_bytes);
+
+    // Share of free heap that is not available as one contiguous block
+    uint32_t fragmentation = stats.heap_free_bytes ?
+                                 100 - (uint64_t)max_block * 100 / stats.heap_free_bytes :
+                                 0;
+    printf("Heap fragmentation: %lu%%\r\n", fragmentation);
+
+    printf(
+        "\r\nSlab arena: %d/%d bytes used\r\n",
+        stats.slab_size - stats.slab_free_bytes,
+        stats.slab_size);
+    printf(
+        "%-6s %-6s %-6s %-6s %-9s %-10s %s\r\n",
+        "Class",
+        "Pages",
+        "Peak",
+        "Used",
+        "Capacity",
+        "Allocs",
+        "Fallbacks");
+    for(uint8_t class_id = 0; class_id < MEMMGR_SLAB_CLASS_COUNT; class_id++) {
+        MemmgrSlabClassStats slab;
+        memmgr_heap_get_slab_stats(class_id, &slab);
+        printf(
+            "%-6d %-6d %-6d %-6d %-9d %-10lu %lu\r\n",
+            slab.object_size,
+            slab.pages,
+            slab.pages_max,
+            slab.used,
+            slab.capacity,
+            slab.allocs,
+            slab.fallbacks);
+    }
+
+    if(memmgr_heap_get_sample_rate() == 0) {
+        printf("\r\nLatency is measured while heap_trace rate is set\r\n");
+    }
+    printf("\r\n%-12s %-10s %-10s %s\r\n", "Latency", "Calls", "Avg, ns", "Max, ns");
+    cli_command_free_latency("slab alloc", &stats.slab_alloc);
+    cli_command_free_latency("slab free", &stats.slab_free);
+    cli_command_free_latency("heap alloc", &stats.heap_alloc);
+    cli_command_free_latency("heap free", &stats.heap_free);
+
+    printf(
+        "\r\nRealloc in place: %lu, moved: %lu\r\n",
+        stats.realloc_in_place,
+        stats.realloc_moved);
 }
 
 void cli_command_free_blocks(Cli* cli, string_t args, void* context) {
     memmgr_heap_printf_free_blocks();
 }
 
+static void cli_command_heap_trace_dump(string_t output) {
+    MemmgrHeapThreadStats* threads =
+        furi_alloc(sizeof(MemmgrHeapThreadStats) * MEMMGR_HEAP_THREAD_SLOTS);
+    size_t threads_num = memmgr_heap_get_threads_stats(threads, MEMMGR_HEAP_THREAD_SLOTS);
+    string_cat_printf(output, "%-20s %-10s %s\r\n", "Thread", "Live", "Peak");
+    for(size_t i = 0; i < threads_num; i++) {
+        string_cat_printf(
+            output,
+            "%-20s %-10d %d\r\n",
+            threads[i].thread_id ? osThreadGetName(threads[i].thread_id) : "-",
+            threads[i].live,
+            threads[i].peak);
+    }
+
+    MemmgrHeapSample* samples = furi_alloc(sizeof(MemmgrHeapSample) * MEMMGR_HEAP_SAMPLES_COUNT);
+    size_t samples_num = memmgr_heap_get_samples(samples, MEMMGR_HEAP_SAMPLES_COUNT);
+    string_cat_printf(
+        output,
+        "\r\nSample rate: 1/%lu, samples: %d\r\n",
+        memmgr_heap_get_sample_rate(),
+        samples_num);
+    string_cat_printf(
+        output,
+        "%-10s %-10s %-10s %-20s %-8s %s\r\n",
+        "Tick",
+        "Pointer",
+        "Caller",
+        "Thread",
+        "Size",
+        "State");
+    for(size_t i = 0; i < samples_num; i++) {
+        string_cat_printf(
+            output,
+            "%-10lu 0x%-8lx 0x%-8lx %-20s %-8d %s\r\n",
+            samples[i].tick,
+            (uint32_t)samples[i].pointer,
+            (uint32_t)samples[i].caller,
+            samples[i].thread_id ? osThreadGetName(samples[i].thread_id) : "-",
+            samples[i].size,
+            samples[i].freed ? "freed" : "live");
+    }
+
+    free(samples);
+    free(threads);
+}
+
+static void cli_command_heap_trace_save(string_t path, string_t dump) {
+    Storage* storage = furi_record_open("storage");
+    File* file = storage_file_alloc(storage);
+
+    if(storage_file_open(file, string_get_cstr(path), FSAM_WRITE, FSOM_CREATE_ALWAYS)) {
+        size_t size = string_size(dump);
+        if(storage_file_write(file, string_get_cstr(dump), size) == size) {
+            printf("Saved %d bytes to %s\r\n", size, string_get_cstr(path));
+        } else {
+            printf("Write failed: %s\r\n", storage_file_get_error_desc(file));
+        }
+    } else {
+        printf("Open failed: %s\r\n", storage_file_get_error_desc(file));
+    }
+
+    storage_file_close(file);
+    storage_file_free(file);
+    furi_record_close("storage");
+}
+
+void cli_command_heap_trace(Cli* cli, string_t args, void* context) {
+    string_t cmd;
+    string_t path;
+    string_t dump;
+    string_init(cmd);
+    string_init(path);
+    string_init(dump);
+
+    do {
+        if(!args_read_string_and_trim(args, cmd)) {
+            cli_command_heap_trace_dump(dump);
+            printf("%s", string_get_cstr(dump));
+            break;
+        }
+
+        if(string_cmp_str(cmd, "rate") == 0) {
+            int rate = 0;
+            if(!args_read_int_and_trim(args, &rate) || rate < 0) {
+                printf("Usage: heap_trace rate <N>, 0 disables sampling\r\n");
+                break;
+            }
+            memmgr_heap_set_sample_rate(rate);
+            break;
+        }
+
+        if(string_cmp_str(cmd, "save") == 0 &&
+           args_read_probably_quoted_string_and_trim(args, path)) {
+            cli_command_heap_trace_dump(dump);
+            cli_command_heap_trace_save(path, dump);
+            break;
+        }
+
+        printf("Usage: heap_trace [rate <N> | save <path>]\r\n");
+    } while(false);
+
+    string_clear(dump);
+    string_clear(path);
+    string_clear(cmd);
+}
+
+static void cli_command_trace_format(
+    string_t line,
+    const FuriTraceEvent* event,
+    const osThreadId_t* threads_id,
+    uint8_t threads_num) {
+    const char* label = "-";
+    switch(event->type) {
+    case FuriTraceTypeThreadSwitch:
+        // Only live threads, handle of deleted one may point anywhere
+        for(uint8_t i = 0; i < threads_num; i++) {
+            if(threads_id[i] == event->data) {
+                label = osThreadGetName(threads_id[i]);
+                break;
+            }
+        }
+        break;
+    case FuriTraceTypeIsrEnter:
+    case FuriTraceTypeIsrExit:
+    case FuriTraceTypeSpanBegin:
+    case FuriTraceTypeSpanEnd:
+        label = event->data;
+        break;
+    default:
+        break;
+    }
+    string_printf(
+        line,
+        "%lu %s %u 0x%lx %s\r\n",
+        event->timestamp,
+        furi_trace_get_type_name(event->type),
+        event->id,
+        (uint32_t)event->data,
+        label ? label : "-");
+}
+
+static void cli_command_trace_dump(File* file) {
+    // Ring is read in chunks, keep it still meanwhile
+    bool running = furi_trace_is_running();
+    furi_trace_stop();
+
+    size_t events_num = furi_trace_get_count();
+    const size_t events_chunk = 32;
+    FuriTraceEvent* events = furi_alloc(sizeof(FuriTraceEvent) * events_chunk);
+    const uint8_t threads_num_max = 32;
+    osThreadId_t threads_id[threads_num_max];
+    uint8_t threads_num = osThreadEnumerate(threads_id, threads_num_max);
+
+    string_t line;
+    string_init_printf(
+        line, "# trace cycles/us %lu events %d\r\n", furi_trace_get_cycles_per_us(), events_num);
+    size_t chunk_first = 0;
+    size_t chunk_size = 0;
+    for(size_t i = 0; i <= events_num; i++) {
+        if(file) {
+            storage_file_write(file, string_get_cstr(line), string_size(line));
+        } else {
+            printf("%s", string_get_cstr(line));
+        }
+        if(i == events_num) break;
+        if(i == chunk_first + chunk_size) {
+            chunk_first = i;
+            chunk_size = furi_trace_get_events(events, chunk_first, events_chunk);
+            if(chunk_size == 0) break;
+        }
+        cli_command_trace_format(line, &events[i - chunk_first], threads_id, threads_num);
+    }
+    string_clear(line);
+    free(events);
+
+    if(running) furi_trace_start(0);
+}
+
+static void cli_command_trace_save(string_t path) {
+    Storage* storage = furi_record_open("storage");
+    File* file = storage_file_alloc(storage);
+
+    if(storage_file_open(file, string_get_cstr(path), FSAM_WRITE, FSOM_CREATE_ALWAYS)) {
+        cli_command_trace_dump(file);
+        if(storage_file_get_error(file) == FSE_OK) {
+            printf("Saved to %s\r\n", string_get_cstr(path));
+        } else {
+            printf("Write failed: %s\r\n", storage_file_get_error_desc(file));
+        }
+    } else {
+        printf("Open failed: %s\r\n", storage_file_get_error_desc(file));
+    }
+
+    storage_file_close(file);
+    storage_file_free(file);
+    furi_record_close("storage");
+}
+
+void cli_command_trace(Cli* cli, string_t args, void* context) {
+    string_t cmd;
+    string_t path;
+    string_init(cmd);
+    string_init(path);
+
+    do {
+        if(!args_read_string_and_trim(args, cmd)) {
+            printf("Trace %s\r\n", furi_trace_is_running() ? "is running" : "is stopped");
+            break;
+        }
+
+        if(string_cmp_str(cmd, "start") == 0) {
+            int events = 0;
+            args_read_int_and_trim(args, &events);
+            if(events < 0 || !furi_trace_start(events)) {
+                printf("Events count must be 0 to %d\r\n", FURI_TRACE_EVENTS_MAX);
+            }
+            break;
+        }
+
+        if(string_cmp_str(cmd, "stop") == 0) {
+            furi_trace_stop();
+            break;
+        }
+
+        if(string_cmp_str(cmd, "reset") == 0) {
+            furi_trace_reset();
+            break;
+        }
+
+        if(string_cmp_str(cmd, "dump") == 0) {
+            cli_command_trace_dump(NULL);
+            break;
+        }
+
+        if(string_cmp_str(cmd, "save") == 0 &&
+           args_read_probably_quoted_string_and_trim(args, path)) {
+            cli_command_trace_save(path);
+            break;
+        }
+
+        printf("Usage: trace [start [events] | stop | reset | dump | save <path>]\r\n");
+    } while(false);
+
+    string_clear(path);
+    string_clear(cmd);
+}
+
 void cli_command_i2c(Cli* cli, string_t args, void* context) {
     furi_hal_i2c_acquire(&furi_hal_i2c_handle_external);
     uint8_t test = 0;
@@ -339,6 +683,8 @@ void cli_commands_init(Cli* cli) {
     cli_add_command(cli, "ps", CliCommandFlagParallelSafe, cli_command_ps, NULL);
     cli_add_command(cli, "free", CliCommandFlagParallelSafe, cli_command_free, NULL);
     cli_add_command(cli, "free_blocks", CliCommandFlagParallelSafe, cli_command_free_blocks, NULL);
+    cli_add_command(cli, "heap_trace", CliCommandFlagParallelSafe, cli_command_heap_trace, NULL);
+    cli_add_command(cli, "trace", CliCommandFlagParallelSafe, cli_command_trace, NULL);
 
     cli_add_command(cli, "vibro", CliCommandFlagDefault, cli_command_vibro, NULL);
     cli_add_command(cli, "led", CliCommandFlagDefault, cli_command_led, NULL);
@@ -19,7 +19,7 @@ ViewPort* gui_view_port_find_enabled(ViewPortArray_t array) {
 
 void gui_update(Gui* gui) {
     furi_assert(gui);
-    osThreadFlagsSet(gui->thread, GUI_THREAD_FLAG_DRAW);
+    furi_event_loop_signal_set(gui->draw_signal);
 }
 
 void gui_input_events_callback(const void* value, void* ctx) {
@@ -28,8 +28,7 @@ void gui_input_events_callback(const void* value, void* ctx) {
 
     Gui* gui = ctx;
 
-    osMessageQueuePut(gui->input_queue, value, 0, osWaitForever);
-    osThreadFlagsSet(gui->thread, GUI_THREAD_FLAG_INPUT);
+    furi_event_loop_message_queue_put(gui->input_queue, value, osWaitForever);
 }
 
 // Only Fullscreen supports vertical display for now
@@ -167,6 +166,7 @@ bool gui_redraw_desktop(Gui* gui) {
 
 void gui_redraw(Gui* gui) {
     furi_assert(gui);
+    FURI_TRACE_BEGIN("gui_redraw");
     gui_lock(gui);
 
     canvas_reset(gui->canvas);
@@ -186,6 +186,7 @@ void gui_redraw(Gui* gui) {
             gui->canvas_callback_context);
     }
     gui_unlock(gui);
+    FURI_TRACE_END("gui_redraw");
 }
 
 void gui_input(Gui* gui, InputEvent* input_event) {
@@ -280,8 +281,7 @@ void gui_cli_screen_stream(Cli* cli, string_t args, void* context) {
                 InputEvent input_event;
                 input_event.key = cli_getc(gui->cli);
                 input_event.type = cli_getc(gui->cli);
-                osMessageQueuePut(gui->input_queue, &input_event, 0, osWaitForever);
-                osThreadFlagsSet(gui->thread, GUI_THREAD_FLAG_INPUT);
+                furi_event_loop_message_queue_put(gui->input_queue, &input_event, osWaitForever);
             }
         } else {
             break;
@@ -403,10 +403,28 @@ void gui_set_framebuffer_callback(Gui* gui, GuiCanvasCommitCallback callback, vo
     gui_unlock(gui);
 }
 
+static void gui_input_queue_callback(void* context) {
+    Gui* gui = context;
+    // Process till queue become empty, redraw once after the whole burst
+    InputEvent input_event;
+    while(furi_event_loop_message_queue_get(gui->input_queue, &input_event, 0) == osOK) {
+        gui_input(gui, &input_event);
+    }
+}
+
+static void gui_draw_signal_callback(void* context) {
+    Gui* gui = context;
+    gui_redraw(gui);
+}
+
 Gui* gui_alloc() {
     Gui* gui = furi_alloc(sizeof(Gui));
-    // Thread ID
-    gui->thread = osThreadGetId();
+    // Event loop, input goes first so redraw requested by it is done in the same pass
+    gui->event_loop = furi_event_loop_alloc();
+    gui->input_queue = furi_event_loop_message_queue_alloc(
+        gui->event_loop, 8, sizeof(InputEvent), gui_input_queue_callback, gui);
+    gui->draw_signal =
+        furi_event_loop_signal_alloc(gui->event_loop, gui_draw_signal_callback, gui);
     // Allocate mutex
     gui->mutex = osMutexNew(NULL);
     furi_check(gui->mutex);
@@ -417,7 +435,6 @@ Gui* gui_alloc() {
     // Drawing canvas
     gui->canvas = canvas_init();
     // Input
-    gui->input_queue = osMessageQueueNew(8, sizeof(InputEvent), NULL);
     gui->input_events = furi_record_open("input_events");
     furi_check(gui->input_events);
     furi_pubsub_subscribe(gui->input_events, gui_input_events_callback, gui);
@@ -434,23 +451,8 @@ int32_t gui_srv(void* p) {
 
     furi_record_create("gui", gui);
 
-    while(1) {
-        uint32_t flags = osThreadFlagsWait(GUI_THREAD_FLAG_ALL, osFlagsWaitAny, osWaitForever);
-        // Process and dispatch input
-        if(flags & GUI_THREAD_FLAG_INPUT) {
-            // Process till queue become empty
-            InputEvent input_event;
-            while(osMessageQueueGet(gui->input_queue, &input_event, NULL, 0) == osOK) {
-                gui_input(gui, &input_event);
-            }
-        }
-        // Process and dispatch draw call
-        if(flags & GUI_THREAD_FLAG_DRAW) {
-            // Clear flags that arrived on input step
-            osThreadFlagsClear(GUI_THREAD_FLAG_DRAW);
-            gui_redraw(gui);
-        }
-    }
+    // Input, redraw requests and animation timers, never stops
+    furi_event_loop_run(gui->event_loop);
 
     return 0;
 }
@@ -37,16 +37,13 @@
 #define GUI_WINDOW_WIDTH GUI_DISPLAY_WIDTH
 #define GUI_WINDOW_HEIGHT (GUI_DISPLAY_HEIGHT - GUI_WINDOW_Y)
 
-#define GUI_THREAD_FLAG_DRAW (1 << 0)
-#define GUI_THREAD_FLAG_INPUT (1 << 1)
-#define GUI_THREAD_FLAG_ALL (GUI_THREAD_FLAG_DRAW | GUI_THREAD_FLAG_INPUT)
-
 ARRAY_DEF(ViewPortArray, ViewPort*, M_PTR_OPLIST);
 
 /** Gui structure */
 struct Gui {
-    // Thread and lock
-    osThreadId_t thread;
+    // Event loop and lock
+    FuriEventLoop* event_loop;
+    FuriEventLoopSignal* draw_signal;
     osMutexId_t mutex;
 
     // Layers and Canvas
@@ -56,7 +53,7 @@ struct Gui {
     void* canvas_callback_context;
 
     // Input
-    osMessageQueueId_t input_queue;
+    FuriEventLoopMessageQueue* input_queue;
     FuriPubSub* input_events;
     uint8_t ongoing_input;
     ViewPort* ongoing_input_view_port;
@@ -7,15 +7,18 @@ IconAnimation* icon_animation_alloc(const Icon* icon) {
     furi_assert(icon);
     IconAnimation* instance = furi_alloc(sizeof(IconAnimation));
     instance->icon = icon;
-    instance->timer = osTimerNew(icon_animation_timer_callback, osTimerPeriodic, instance, NULL);
+    // Frames are advanced in Gui event loop, next to redraws they cause
+    instance->gui = furi_record_open("gui");
+    instance->timer = furi_event_loop_timer_alloc(
+        instance->gui->event_loop, icon_animation_timer_callback, instance);
     return instance;
 }
 
 void icon_animation_free(IconAnimation* instance) {
     furi_assert(instance);
     icon_animation_stop(instance);
-    while(xTimerIsTimerActive(instance->timer) == pdTRUE) osDelay(1);
-    furi_check(osTimerDelete(instance->timer) == osOK);
+    furi_event_loop_timer_free(instance->timer);
+    furi_record_close("gui");
     free(instance);
 }
 
@@ -65,11 +68,8 @@ void icon_animation_start(IconAnimation* instance) {
     if(!instance->animating) {
         instance->animating = true;
         furi_assert(instance->icon->frame_rate);
-        furi_check(
-            xTimerChangePeriod(
-                instance->timer,
-                (osKernelGetTickFreq() / instance->icon->frame_rate),
-                portMAX_DELAY) == pdPASS);
+        furi_event_loop_timer_start(
+            instance->timer, osKernelGetTickFreq() / instance->icon->frame_rate, true);
     }
 }
 
@@ -77,7 +77,7 @@ void icon_animation_stop(IconAnimation* instance) {
     furi_assert(instance);
     if(instance->animating) {
         instance->animating = false;
-        furi_check(xTimerStop(instance->timer, portMAX_DELAY) == pdPASS);
+        furi_event_loop_timer_stop(instance->timer);
         instance->frame = 0;
     }
 }
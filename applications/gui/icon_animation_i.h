@@ -6,6 +6,7 @@
 #pragma once
 
 #include "icon_animation.h"
+#include "gui_i.h"
 
 #include <furi.h>
 
@@ -13,7 +14,8 @@ struct IconAnimation {
     const Icon* icon;
     uint8_t frame;
     bool animating;
-    osTimerId_t timer;
+    Gui* gui;
+    FuriEventLoopTimer* timer;
     IconAnimationCallback callback;
     void* callback_context;
 };
@@ -32,7 +34,7 @@ const uint8_t* icon_animation_get_data(IconAnimation* instance);
  */
 void icon_animation_next_frame(IconAnimation* instance);
 
-/** IconAnimation timer callback
+/** IconAnimation timer callback, called in Gui thread
  *
  * @param      context  pointer to IconAnimation
  */
@@ -28,9 +28,11 @@ void view_dispatcher_free(ViewDispatcher* view_dispatcher) {
     ViewDict_clear(view_dispatcher->views);
     // Free ViewPort
     view_port_free(view_dispatcher->view_port);
-    // Free internal queue
+    // Free internal queue and event loop
     if(view_dispatcher->queue) {
-        osMessageQueueDelete(view_dispatcher->queue);
+        furi_event_loop_timer_free(view_dispatcher->tick_timer);
+        furi_event_loop_message_queue_free(view_dispatcher->queue);
+        furi_event_loop_free(view_dispatcher->event_loop);
     }
     // Free dispatcher
     free(view_dispatcher);
@@ -39,7 +41,15 @@ void view_dispatcher_free(ViewDispatcher* view_dispatcher) {
 void view_dispatcher_enable_queue(ViewDispatcher* view_dispatcher) {
     furi_assert(view_dispatcher);
     furi_assert(view_dispatcher->queue == NULL);
-    view_dispatcher->queue = osMessageQueueNew(16, sizeof(ViewDispatcherMessage), NULL);
+    view_dispatcher->event_loop = furi_event_loop_alloc();
+    view_dispatcher->queue = furi_event_loop_message_queue_alloc(
+        view_dispatcher->event_loop,
+        16,
+        sizeof(ViewDispatcherMessage),
+        view_dispatcher_queue_callback,
+        view_dispatcher);
+    view_dispatcher->tick_timer = furi_event_loop_timer_alloc(
+        view_dispatcher->event_loop, view_dispatcher_tick_callback, view_dispatcher);
 }
 
 void view_dispatcher_set_event_callback_context(ViewDispatcher* view_dispatcher, void* context) {
@@ -77,26 +87,19 @@ void view_dispatcher_run(ViewDispatcher* view_dispatcher) {
     furi_assert(view_dispatcher);
     furi_assert(view_dispatcher->queue);
 
-    uint32_t tick_period = view_dispatcher->tick_period == 0 ? osWaitForever :
-                                                               view_dispatcher->tick_period;
-    ViewDispatcherMessage message;
-    while(1) {
-        if(osMessageQueueGet(view_dispatcher->queue, &message, NULL, tick_period) != osOK) {
-            view_dispatcher_handle_tick_event(view_dispatcher);
-            continue;
-        }
-        if(message.type == ViewDispatcherMessageTypeStop) {
-            break;
-        } else if(message.type == ViewDispatcherMessageTypeInput) {
-            view_dispatcher_handle_input(view_dispatcher, &message.input);
-        } else if(message.type == ViewDispatcherMessageTypeCustomEvent) {
-            view_dispatcher_handle_custom_event(view_dispatcher, message.custom_event);
-        }
+    if(view_dispatcher->tick_period) {
+        furi_event_loop_timer_start(
+            view_dispatcher->tick_timer, view_dispatcher->tick_period, true);
     }
 
+    furi_event_loop_run(view_dispatcher->event_loop);
+
+    furi_event_loop_timer_stop(view_dispatcher->tick_timer);
+
     // Wait till all input events delivered
+    ViewDispatcherMessage message;
     while(view_dispatcher->ongoing_input) {
-        osMessageQueueGet(view_dispatcher->queue, &message, NULL, osWaitForever);
+        furi_event_loop_message_queue_get(view_dispatcher->queue, &message, osWaitForever);
         if(message.type == ViewDispatcherMessageTypeInput) {
             uint8_t key_bit = (1 << message.input.key);
             if(message.input.type == InputTypePress) {
@@ -113,7 +116,9 @@ void view_dispatcher_stop(ViewDispatcher* view_dispatcher) {
     furi_assert(view_dispatcher->queue);
     ViewDispatcherMessage message;
     message.type = ViewDispatcherMessageTypeStop;
-    furi_check(osMessageQueuePut(view_dispatcher->queue, &message, 0, osWaitForever) == osOK);
+    furi_check(
+        furi_event_loop_message_queue_put(view_dispatcher->queue, &message, osWaitForever) ==
+        osOK);
 }
 
 void view_dispatcher_add_view(ViewDispatcher* view_dispatcher, uint32_t view_id, View* view) {
@@ -218,13 +223,43 @@ void view_dispatcher_draw_callback(Canvas* canvas, void* context) {
     }
 }
 
+void view_dispatcher_queue_callback(void* context) {
+    ViewDispatcher* view_dispatcher = context;
+    ViewDispatcherMessage message;
+    if(furi_event_loop_message_queue_get(view_dispatcher->queue, &message, 0) != osOK) {
+        return;
+    }
+
+    if(message.type == ViewDispatcherMessageTypeStop) {
+        // Messages after stop are left for next run
+        furi_event_loop_stop(view_dispatcher->event_loop);
+    } else if(message.type == ViewDispatcherMessageTypeInput) {
+        FURI_TRACE_BEGIN("view_dispatcher_input");
+        view_dispatcher_handle_input(view_dispatcher, &message.input);
+        FURI_TRACE_END("view_dispatcher_input");
+    } else if(message.type == ViewDispatcherMessageTypeCustomEvent) {
+        FURI_TRACE_BEGIN("view_dispatcher_custom");
+        view_dispatcher_handle_custom_event(view_dispatcher, message.custom_event);
+        FURI_TRACE_END("view_dispatcher_custom");
+    }
+}
+
+void view_dispatcher_tick_callback(void* context) {
+    ViewDispatcher* view_dispatcher = context;
+    FURI_TRACE_BEGIN("view_dispatcher_tick");
+    view_dispatcher_handle_tick_event(view_dispatcher);
+    FURI_TRACE_END("view_dispatcher_tick");
+}
+
 void view_dispatcher_input_callback(InputEvent* event, void* context) {
     ViewDispatcher* view_dispatcher = context;
     if(view_dispatcher->queue) {
         ViewDispatcherMessage message;
         message.type = ViewDispatcherMessageTypeInput;
         message.input = *event;
-        furi_check(osMessageQueuePut(view_dispatcher->queue, &message, 0, osWaitForever) == osOK);
+        furi_check(
+            furi_event_loop_message_queue_put(view_dispatcher->queue, &message, osWaitForever) ==
+            osOK);
     } else {
         view_dispatcher_handle_input(view_dispatcher, event);
     }
@@ -315,7 +350,9 @@ void view_dispatcher_send_custom_event(ViewDispatcher* view_dispatcher, uint32_t
     message.type = ViewDispatcherMessageTypeCustomEvent;
     message.custom_event = event;
 
-    furi_check(osMessageQueuePut(view_dispatcher->queue, &message, 0, osWaitForever) == osOK);
+    furi_check(
+        furi_event_loop_message_queue_put(view_dispatcher->queue, &message, osWaitForever) ==
+        osOK);
 }
 
 void view_dispatcher_set_current_view(ViewDispatcher* view_dispatcher, View* view) {
@@ -82,10 +82,13 @@ void view_dispatcher_set_navigation_event_callback(
     ViewDispatcherNavigationEventCallback callback);
 
 /** Set tick event handler
+ *
+ * Tick is periodic while view_dispatcher_run is running, regardless of other
+ * events. Must be set before view_dispatcher_run.
  *
  * @param      view_dispatcher  ViewDispatcher instance
  * @param      callback         ViewDispatcherTickEventCallback
- * @param      tick_period      callback call period
+ * @param      tick_period      callback call period in ticks, 0 to disable
  */
 void view_dispatcher_set_tick_event_callback(
     ViewDispatcher* view_dispatcher,
@@ -15,7 +15,9 @@
 DICT_DEF2(ViewDict, uint32_t, M_DEFAULT_OPLIST, View*, M_PTR_OPLIST)
 
 struct ViewDispatcher {
-    osMessageQueueId_t queue;
+    FuriEventLoop* event_loop;
+    FuriEventLoopMessageQueue* queue;
+    FuriEventLoopTimer* tick_timer;
     Gui* gui;
     ViewPort* view_port;
     ViewDict_t views;
@@ -49,6 +51,12 @@ typedef struct {
 /** ViewPort Draw Callback */
 void view_dispatcher_draw_callback(Canvas* canvas, void* context);
 
+/** Event loop message queue callback */
+void view_dispatcher_queue_callback(void* context);
+
+/** Event loop tick timer callback */
+void view_dispatcher_tick_callback(void* context);
+
 /** ViewPort Input Callback */
 void view_dispatcher_input_callback(InputEvent* event, void* context);
 
@@ -51,8 +51,13 @@ void CyfralDecoder::process_front(bool polarity, uint32_t time) {
         if(process_bit(polarity, time, &readed, &value)) {
             if(readed) {
                 readed_nibble = ((readed_nibble << 1) | value) & 0x0F;
-                if(readed_nibble == 0b0001) {
+
+                // nibble is zeroed on reset, a single 1 after it is not a start word
+                if(bit_index < 4) bit_index++;
+
+                if(bit_index == 4 && readed_nibble == 0b0001) {
                     readed_nibble = 0;
+                    bit_index = 0;
                     state = State::READ_NIBBLE;
                 }
             }
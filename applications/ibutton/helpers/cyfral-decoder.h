@@ -6,6 +6,7 @@ class CyfralDecoder {
 public:
     bool read(uint8_t* data, uint8_t data_size);
     void process_front(bool polarity, uint32_t time);
+    void reset_state();
 
     CyfralDecoder();
 
@@ -25,7 +26,6 @@ private:
     BitState bit_state;
 
     bool process_bit(bool polarity, uint32_t time, bool* readed, bool* readed_value);
-    void reset_state();
     bool nibble_valid(uint8_t data);
 
     // high + low period time
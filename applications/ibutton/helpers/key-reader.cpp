@@ -5,6 +5,8 @@
 
 extern COMP_HandleTypeDef hcomp1;
 
+static const size_t decoder_batch = 64;
+
 KeyReader::Error KeyReader::read(iButtonKey* key) {
     uint8_t tmp_key_data[8] = {0, 0, 0, 0, 0, 0, 0, 0};
     iButtonKeyType key_type;
@@ -41,14 +43,16 @@ KeyReader::Error KeyReader::read(iButtonKey* key) {
         }
     }
 
-    switch_mode_if_needed();
+    // back to edge capture until next call
+    if(read_mode != ReadMode::CYFRAL_METAKOM) {
+        switch_to(ReadMode::CYFRAL_METAKOM);
+    }
 
     return result;
 }
 
 KeyReader::KeyReader(OneWireMaster* _onewire_master) {
     onewire_master = _onewire_master;
-    read_mode_switch_time = 0;
     read_mode = ReadMode::DALLAS;
 }
 
@@ -57,34 +61,63 @@ KeyReader::~KeyReader() {
 }
 
 bool KeyReader::read_key(iButtonKeyType* key_type, uint8_t* data, uint8_t data_size) {
+    // every call is a time slice: edges captured since previous call are decoded first,
+    // then comparator is paused for 1-Wire probe, which is only reset and presence
+    // wait (about 1ms) without a key, so comparator captures most of the time
+    bool readed = read_comparator_key(key_type, data);
+
+    if(!readed) {
+        switch_to(ReadMode::DALLAS);
+        readed = read_dallas_key(key_type, data);
+    }
+
+    return readed;
+}
+
+bool KeyReader::read_comparator_key(iButtonKeyType* key_type, uint8_t* data) {
     bool readed = false;
 
-    switch(read_mode) {
-    case ReadMode::DALLAS:
-        __disable_irq();
-        if(onewire_master->search(data)) {
-            onewire_master->reset_search();
-            readed = true;
-            *key_type = iButtonKeyType::KeyDallas;
-        } else {
-            onewire_master->reset_search();
-        }
-        __enable_irq();
-        break;
-    case ReadMode::CYFRAL_METAKOM:
-        if(cyfral_decoder.read(data, 2)) {
-            readed = true;
-            *key_type = iButtonKeyType::KeyCyfral;
-        } else if(metakom_decoder.read(data, 4)) {
-            readed = true;
-            *key_type = iButtonKeyType::KeyMetakom;
-        }
-        break;
+    decode_edges();
+
+    if(cyfral_decoder.read(data, 2)) {
+        readed = true;
+        *key_type = iButtonKeyType::KeyCyfral;
+    } else if(metakom_decoder.read(data, 4)) {
+        readed = true;
+        *key_type = iButtonKeyType::KeyMetakom;
     }
 
     return readed;
 }
 
+bool KeyReader::read_dallas_key(iButtonKeyType* key_type, uint8_t* data) {
+    bool readed = false;
+
+    __disable_irq();
+    if(onewire_master->search(data)) {
+        readed = true;
+        *key_type = iButtonKeyType::KeyDallas;
+    }
+    onewire_master->reset_search();
+    __enable_irq();
+
+    return readed;
+}
+
+void KeyReader::decode_edges() {
+    uint32_t edges[decoder_batch];
+    size_t count;
+
+    while((count = edge_ring.pop(edges, decoder_batch)) > 0) {
+        for(size_t i = 0; i < count; i++) {
+            bool polarity = KeyEdgeRing::get_polarity(edges[i]);
+            uint32_t period = KeyEdgeRing::get_period(edges[i]);
+            cyfral_decoder.process_front(polarity, period);
+            metakom_decoder.process_front(polarity, period);
+        }
+    }
+}
+
 bool KeyReader::verify_key(iButtonKeyType key_type, const uint8_t* const data, uint8_t data_size) {
     bool result = true;
 
@@ -101,7 +134,6 @@ bool KeyReader::verify_key(iButtonKeyType key_type, const uint8_t* const data, u
             }
         } else {
             result = false;
-            break;
         }
         __enable_irq();
         break;
@@ -143,10 +175,8 @@ void KeyReader::comparator_trigger_callback(void* hcomp, void* comp_ctx) {
     if(hcomp == &hcomp1) {
         uint32_t current_dwt_value = DWT->CYCCNT;
 
-        _this->cyfral_decoder.process_front(
-            hal_gpio_get_rfid_in_level(), current_dwt_value - last_dwt_value);
-        _this->metakom_decoder.process_front(
-            hal_gpio_get_rfid_in_level(), current_dwt_value - last_dwt_value);
+        // ring keeps the oldest edges when full, they are contiguous and enough for a frame
+        _this->edge_ring.push(hal_gpio_get_rfid_in_level(), current_dwt_value - last_dwt_value);
 
         last_dwt_value = current_dwt_value;
     }
@@ -157,6 +187,11 @@ void KeyReader::switch_to(ReadMode mode) {
     case ReadMode::DALLAS:
         onewire_master->start();
         stop_comaparator();
+
+        // 1-Wire slice breaks edge stream, frames can't continue over it
+        edge_ring.reset();
+        cyfral_decoder.reset_state();
+        metakom_decoder.reset_state();
         break;
     case ReadMode::CYFRAL_METAKOM:
         onewire_master->stop();
@@ -167,22 +202,11 @@ void KeyReader::switch_to(ReadMode mode) {
     read_mode = mode;
 }
 
-void KeyReader::switch_mode_if_needed() {
-    if(osKernelGetTickCount() - read_mode_switch_time > (osKernelGetTickFreq() / 5)) {
-        read_mode_switch_time = osKernelGetTickCount();
-        switch(read_mode) {
-        case ReadMode::DALLAS:
-            switch_to(ReadMode::CYFRAL_METAKOM);
-            break;
-        case ReadMode::CYFRAL_METAKOM:
-            switch_to(ReadMode::DALLAS);
-            break;
-        }
-    }
-}
-
 void KeyReader::start() {
     furi_hal_power_enable_otg();
+    edge_ring.reset();
+    cyfral_decoder.reset_state();
+    metakom_decoder.reset_state();
     switch_to(ReadMode::CYFRAL_METAKOM);
 }
 
@@ -7,6 +7,7 @@
 #include "../ibutton-key.h"
 #include <one_wire_master.h>
 #include <one_wire_slave.h>
+#include <lib/toolbox/edge-ring.h>
 
 class KeyReader {
 public:
@@ -25,6 +26,8 @@ public:
 
 private:
     bool read_key(iButtonKeyType* key_type, uint8_t* data, uint8_t data_size);
+    bool read_comparator_key(iButtonKeyType* key_type, uint8_t* data);
+    bool read_dallas_key(iButtonKeyType* key_type, uint8_t* data);
     bool verify_key(iButtonKeyType key_type, const uint8_t* const data, uint8_t data_size);
 
     // cyfral and metakom readers data
@@ -35,11 +38,15 @@ private:
     void stop_comaparator(void);
     uint32_t last_dwt_value;
 
+    // comparator ISR only stores edges, decoders run in read() while 1-Wire is idle
+    typedef EdgeRing<1024> KeyEdgeRing;
+    KeyEdgeRing edge_ring;
+    void decode_edges();
+
     CyfralDecoder cyfral_decoder;
     MetakomDecoder metakom_decoder;
 
     // mode
-    uint32_t read_mode_switch_time;
     enum class ReadMode : uint8_t {
         CYFRAL_METAKOM,
         DALLAS,
@@ -50,5 +57,4 @@ private:
     OneWireMaster* onewire_master;
 
     void switch_to(ReadMode mode);
-    void switch_mode_if_needed();
 };
\ No newline at end of file
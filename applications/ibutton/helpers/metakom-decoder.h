@@ -6,6 +6,7 @@ class MetakomDecoder {
 public:
     bool read(uint8_t* data, uint8_t data_size);
     void process_front(bool polarity, uint32_t time);
+    void reset_state();
 
     MetakomDecoder();
 
@@ -47,7 +48,6 @@ private:
     uint32_t key_data;
     uint8_t key_data_index;
 
-    void reset_state();
     bool parity_check(uint8_t data);
 
     bool process_bit(bool polarity, uint32_t time, uint32_t* high_time, uint32_t* low_time);
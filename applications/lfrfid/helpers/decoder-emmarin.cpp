@@ -1,7 +1,6 @@
 #include "emmarin.h"
 #include "decoder-emmarin.h"
 #include <furi.h>
-#include <furi-hal.h>
 
 constexpr uint32_t clocks_in_us = 64;
 constexpr uint32_t short_time = 255 * clocks_in_us;
@@ -13,6 +12,10 @@ constexpr uint32_t short_time_high = short_time + jitter_time;
 constexpr uint32_t long_time_low = long_time - jitter_time;
 constexpr uint32_t long_time_high = long_time + jitter_time;
 
+// Stop bit of previous frame and 9 header ones
+constexpr uint64_t header_mask = 0x3FF;
+constexpr uint64_t header = 0x1FF;
+
 void DecoderEMMarin::reset_state() {
     ready = false;
     readed_data = 0;
@@ -60,6 +63,7 @@ void DecoderEMMarin::process_front(bool polarity, uint32_t time) {
 
         if(data_ok) {
             readed_data = (readed_data << 1) | data;
+            if((readed_data & header_mask) == header) sync_count++;
 
             ready = em_marin.can_be_decoded(
                 reinterpret_cast<const uint8_t*>(&readed_data), sizeof(uint64_t));
@@ -67,6 +71,10 @@ void DecoderEMMarin::process_front(bool polarity, uint32_t time) {
     }
 }
 
+uint32_t DecoderEMMarin::get_sync_count() {
+    return sync_count;
+}
+
 DecoderEMMarin::DecoderEMMarin() {
     reset_state();
 }
@@ -8,12 +8,16 @@ public:
     bool read(uint8_t* data, uint8_t data_size);
     void process_front(bool polarity, uint32_t time);
 
+    /** Frame headers found so far, partial decode confidence for mode switching */
+    uint32_t get_sync_count();
+
     DecoderEMMarin();
 
 private:
     void reset_state();
 
     uint64_t readed_data = 0;
+    uint32_t sync_count = 0;
     std::atomic<bool> ready;
 
     ManchesterState manchester_saved_state;
@@ -1,5 +1,5 @@
 #include "decoder-hid26.h"
-#include <furi-hal.h>
+#include <furi.h>
 
 constexpr uint32_t clocks_in_us = 64;
 
@@ -10,6 +10,16 @@ constexpr uint32_t max_time_us = 80;
 constexpr uint32_t min_time = (min_time_us - jitter_time_us) * clocks_in_us;
 constexpr uint32_t mid_time = ((max_time_us - min_time_us) / 2 + min_time_us) * clocks_in_us;
 constexpr uint32_t max_time = (max_time_us + jitter_time_us) * clocks_in_us;
+// Means this close to mid_time continue current run
+constexpr uint32_t hysteresis_time = 2 * clocks_in_us;
+// Bit is 50 carrier periods
+constexpr uint32_t bit_time = 50 * 8 * clocks_in_us;
+// Manchester data has runs of 2 bits at most, preamble of 3
+constexpr uint32_t run_bits_max = 4;
+
+// Preamble can't be met in manchester coded data
+constexpr uint32_t preamble_mask = 0xFF;
+constexpr uint32_t preamble = 0x1D;
 
 bool DecoderHID26::read(uint8_t* data, uint8_t data_size) {
     bool result = false;
@@ -35,47 +45,35 @@ void DecoderHID26::process_front(bool polarity, uint32_t time) {
 
         if(last_pulse_time > min_time && last_pulse_time < max_time) {
             bool pulse;
+            // Edge shared by two periods cancels out in their mean
+            uint32_t mean_time = (last_pulse_time + prev_pulse_time) / 2;
+            prev_pulse_time = last_pulse_time;
 
-            if(last_pulse_time < mid_time) {
+            if(mean_time < mid_time - hysteresis_time) {
                 // 6 pulses
                 pulse = false;
-            } else {
+            } else if(mean_time > mid_time + hysteresis_time) {
                 // 5 pulses
                 pulse = true;
+            } else {
+                pulse = last_pulse;
             }
 
-            if(last_pulse == pulse) {
-                pulse_count++;
-
-                if(pulse) {
-                    if(pulse_count > 4) {
-                        pulse_count = 0;
-                        store_data(1);
-                    }
-                } else {
-                    if(pulse_count > 5) {
-                        pulse_count = 0;
-                        store_data(0);
-                    }
-                }
-            } else {
-                if(last_pulse) {
-                    if(pulse_count > 2) {
-                        store_data(1);
-                    }
-                } else {
-                    if(pulse_count > 3) {
-                        store_data(0);
-                    }
-                }
-
-                pulse_count = 0;
+            // Run length is measured in time, one misjudged period does not cost a bit
+            if(last_pulse != pulse) {
+                store_run(last_pulse, run_time);
+                run_time = 0;
                 last_pulse = pulse;
             }
+            run_time += last_pulse_time;
         }
     }
 }
 
+uint32_t DecoderHID26::get_sync_count() {
+    return sync_count;
+}
+
 DecoderHID26::DecoderHID26() {
     reset_state();
 }
@@ -85,14 +83,25 @@ void DecoderHID26::store_data(bool data) {
     stored_data[1] = (stored_data[1] << 1) | ((stored_data[2] >> 31) & 1);
     stored_data[2] = (stored_data[2] << 1) | data;
 
+    if((stored_data[2] & preamble_mask) == preamble) sync_count++;
+
     if(hid.can_be_decoded(reinterpret_cast<const uint8_t*>(&stored_data), sizeof(uint32_t) * 3)) {
         ready = true;
     }
 }
 
+void DecoderHID26::store_run(bool data, uint32_t time) {
+    uint32_t bits = (time + bit_time / 2) / bit_time;
+    if(bits > run_bits_max) bits = run_bits_max;
+    for(uint32_t i = 0; i < bits && !ready; i++) {
+        store_data(data);
+    }
+}
+
 void DecoderHID26::reset_state() {
     last_pulse = false;
-    pulse_count = 0;
+    prev_pulse_time = mid_time;
+    run_time = 0;
     ready = false;
     last_pulse_time = 0;
 }
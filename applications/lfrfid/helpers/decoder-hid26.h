@@ -7,15 +7,21 @@ class DecoderHID26 {
 public:
     bool read(uint8_t* data, uint8_t data_size);
     void process_front(bool polarity, uint32_t time);
+
+    /** Frame headers found so far, partial decode confidence for mode switching */
+    uint32_t get_sync_count();
     DecoderHID26();
 
 private:
     uint32_t last_pulse_time = 0;
+    uint32_t prev_pulse_time;
     bool last_pulse;
-    uint8_t pulse_count;
+    uint32_t run_time;
 
     uint32_t stored_data[3] = {0, 0, 0};
+    uint32_t sync_count = 0;
     void store_data(bool data);
+    void store_run(bool data, uint32_t time);
 
     std::atomic<bool> ready;
 
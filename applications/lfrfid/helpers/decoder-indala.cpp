@@ -1,5 +1,5 @@
 #include "decoder-indala.h"
-#include <furi-hal.h>
+#include <furi.h>
 
 constexpr uint32_t clocks_in_us = 64;
 constexpr uint32_t us_per_bit = 255;
@@ -28,7 +28,7 @@ bool DecoderIndala::read(uint8_t* data, uint8_t data_size) {
 void DecoderIndala::process_front(bool polarity, uint32_t time) {
     if(ready) return;
 
-    process_internal(polarity, time, &raw_data);
+    process_internal(polarity, time, &raw_data, &raw_candidate);
     if(ready) return;
 
     if(polarity) {
@@ -37,13 +37,17 @@ void DecoderIndala::process_front(bool polarity, uint32_t time) {
         time = time - 110;
     }
 
-    process_internal(!polarity, time, &cursed_raw_data);
+    process_internal(!polarity, time, &cursed_raw_data, &cursed_candidate);
     if(ready) {
         cursed_data_valid = true;
     }
 }
 
-void DecoderIndala::process_internal(bool polarity, uint32_t time, uint64_t* data) {
+void DecoderIndala::process_internal(
+    bool polarity,
+    uint32_t time,
+    uint64_t* data,
+    uint64_t* candidate) {
     time /= clocks_in_us;
     time += (us_per_bit / 2);
 
@@ -54,17 +58,28 @@ void DecoderIndala::process_internal(bool polarity, uint32_t time, uint64_t* dat
             *data = (*data << 1) | polarity;
 
             if((*data >> 32) == 0xa0000000ULL) {
+                sync_count++;
+                // Checksum is one parity bit, so frame must repeat before it is taken
                 if(indala.can_be_decoded(
                        reinterpret_cast<const uint8_t*>(data), sizeof(uint64_t))) {
-                    ready = true;
-                    break;
+                    if(*data == *candidate) {
+                        ready = true;
+                        break;
+                    }
+                    *candidate = *data;
                 }
             }
         }
     }
 }
 
+uint32_t DecoderIndala::get_sync_count() {
+    return sync_count;
+}
+
 DecoderIndala::DecoderIndala() {
+    raw_candidate = 0;
+    cursed_candidate = 0;
     reset_state();
 }
 
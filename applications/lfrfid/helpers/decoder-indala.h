@@ -9,7 +9,10 @@ public:
     bool read(uint8_t* data, uint8_t data_size);
     void process_front(bool polarity, uint32_t time);
 
-    void process_internal(bool polarity, uint32_t time, uint64_t* data);
+    /** Frame headers found so far, partial decode confidence for mode switching */
+    uint32_t get_sync_count();
+
+    void process_internal(bool polarity, uint32_t time, uint64_t* data, uint64_t* candidate);
 
     DecoderIndala();
 
@@ -18,6 +21,10 @@ private:
 
     uint64_t raw_data;
     uint64_t cursed_raw_data;
+    /** Last valid frame, next one must match it, kept between reads */
+    uint64_t raw_candidate;
+    uint64_t cursed_candidate;
+    uint32_t sync_count = 0;
 
     std::atomic<bool> ready;
     std::atomic<bool> cursed_data_valid;
@@ -0,0 +1,41 @@
+#include "rfid-mode-scheduler.h"
+
+void RfidModeScheduler::reset(uint32_t now, uint32_t tick_freq) {
+    quiet_ticks = quiet_ms * tick_freq / 1000;
+    search_ticks = search_ms * tick_freq / 1000;
+    lock_ticks = lock_ms * tick_freq / 1000;
+    start(now, false);
+}
+
+void RfidModeScheduler::hold(uint32_t now) {
+    start(now, true);
+}
+
+bool RfidModeScheduler::update(uint32_t now, uint32_t edges, uint32_t syncs) {
+    if(syncs) {
+        // Decoders follow the signal, give them time for next frame
+        start(now, true);
+        return false;
+    }
+
+    dwell_edges += edges;
+    uint32_t dwell = now - dwell_start;
+    bool result = false;
+
+    if(locked) {
+        result = dwell >= lock_ticks;
+    } else if(dwell >= quiet_ticks && dwell_edges < quiet_edges) {
+        result = true;
+    } else {
+        result = dwell >= search_ticks;
+    }
+
+    if(result) start(now, false);
+    return result;
+}
+
+void RfidModeScheduler::start(uint32_t now, bool _locked) {
+    dwell_start = now;
+    dwell_edges = 0;
+    locked = _locked;
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <stdint.h>
+
+/**
+ * @brief Decides when reader switches between carrier configs
+ *
+ * Mode is kept while decoders find frame syncs in edge stream. Without syncs
+ * it is left after short dwell if comparator is quiet, and after longer one
+ * if there is modulation that none of decoders can follow. Once sync is seen
+ * dwell is long enough for the frame to be read.
+ */
+class RfidModeScheduler {
+public:
+    /**
+     * @brief Start dwell in new mode
+     * @param now current time in kernel ticks
+     * @param tick_freq kernel tick frequency
+     */
+    void reset(uint32_t now, uint32_t tick_freq);
+
+    /** Key was read, dwell is started over as locked */
+    void hold(uint32_t now);
+
+    /**
+     * @brief Account decoded edges and check dwell
+     * @param now current time in kernel ticks
+     * @param edges edges decoded since previous update
+     * @param syncs frame syncs found by decoders since previous update
+     * @return true if mode should be switched now, dwell is started over
+     */
+    bool update(uint32_t now, uint32_t edges, uint32_t syncs);
+
+private:
+    /** No modulation: less edges than this in quiet dwell */
+    static const uint32_t quiet_edges = 16;
+    static const uint32_t quiet_ms = 20;
+    /** Longest frame, sync of any protocol must be met */
+    static const uint32_t search_ms = 50;
+    /** Longest frame, sync to ready, plus read poll interval */
+    static const uint32_t lock_ms = 160;
+
+    uint32_t quiet_ticks;
+    uint32_t search_ticks;
+    uint32_t lock_ticks;
+
+    uint32_t dwell_start;
+    uint32_t dwell_edges;
+    bool locked;
+
+    void start(uint32_t now, bool _locked);
+};
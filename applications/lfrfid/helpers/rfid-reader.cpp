@@ -6,20 +6,68 @@
 
 extern COMP_HandleTypeDef hcomp1;
 
+typedef enum {
+    RfidReaderEventEdges = (1 << 0),
+    RfidReaderEventStop = (1 << 1),
+} RfidReaderEvent;
+
+// Decoder thread wakes up this often or when ring is half full
+static const uint32_t decoder_interval = 5;
+static const size_t decoder_batch = 64;
+
 /**
  * @brief private violation assistant for RfidReader
  */
 struct RfidReaderAccessor {
-    static void decode(RfidReader& rfid_reader, bool polarity) {
-        rfid_reader.decode(polarity);
+    static void store_edge(RfidReader& rfid_reader, bool polarity) {
+        rfid_reader.store_edge(polarity);
+    }
+
+    static int32_t decoder_thread(void* context) {
+        static_cast<RfidReader*>(context)->decoder_loop();
+        return 0;
     }
 };
 
-void RfidReader::decode(bool polarity) {
+void RfidReader::store_edge(bool polarity) {
     uint32_t current_dwt_value = DWT->CYCCNT;
     uint32_t period = current_dwt_value - last_dwt_value;
     last_dwt_value = current_dwt_value;
 
+#ifdef RFID_GPIO_DEBUG
+    decoder_gpio_out.process_front(polarity, period);
+#endif
+
+    if(edge_ring.push(polarity, period) == RfidEdgeRing::capacity / 2) {
+        osThreadFlagsSet(decoder_thread_id, RfidReaderEventEdges);
+    }
+}
+
+void RfidReader::decoder_loop() {
+    uint32_t edges[decoder_batch];
+    bool running = true;
+
+    while(running) {
+        uint32_t flags = osThreadFlagsWait(
+            RfidReaderEventEdges | RfidReaderEventStop, osFlagsWaitAny, decoder_interval);
+        if(!(flags & osFlagsError) && (flags & RfidReaderEventStop)) {
+            running = false;
+        }
+
+        size_t count;
+        uint32_t decoded = 0;
+        while((count = edge_ring.pop(edges, decoder_batch)) > 0) {
+            for(size_t i = 0; i < count; i++) {
+                decode(RfidEdgeRing::get_polarity(edges[i]), RfidEdgeRing::get_period(edges[i]));
+            }
+            decoded += count;
+        }
+
+        if(running) schedule(decoded);
+    }
+}
+
+void RfidReader::decode(bool polarity, uint32_t period) {
 #ifdef RFID_GPIO_DEBUG
     decoder_gpio_out.process_front(polarity, period);
 #endif
@@ -39,28 +87,50 @@ void RfidReader::decode(bool polarity) {
     detect_ticks++;
 }
 
-bool RfidReader::switch_timer_elapsed() {
-    const uint32_t seconds_to_switch = osKernelGetTickFreq() * 2.0f;
-    return (osKernelGetTickCount() - switch_os_tick_last) > seconds_to_switch;
+uint32_t RfidReader::get_sync_count() {
+    return decoder_em.get_sync_count() + decoder_hid26.get_sync_count() +
+           decoder_indala.get_sync_count();
 }
 
-void RfidReader::switch_timer_reset() {
-    switch_os_tick_last = osKernelGetTickCount();
+void RfidReader::schedule(uint32_t edges) {
+    uint32_t now = osKernelGetTickCount();
+    uint32_t syncs = get_sync_count();
+
+    if(key_readed.exchange(false)) {
+        scheduler.hold(now);
+    }
+
+    if(scheduler.update(now, edges, syncs - scheduler_syncs) && switch_enabled) {
+        switch_mode();
+    }
+    scheduler_syncs = syncs;
 }
 
 void RfidReader::switch_mode() {
     switch(type) {
     case Type::Normal:
         type = Type::Indala;
-        furi_hal_rfid_change_read_config(62500.0f, 0.25f);
         break;
     case Type::Indala:
         type = Type::Normal;
-        furi_hal_rfid_change_read_config(125000.0f, 0.5f);
         break;
     }
 
-    switch_timer_reset();
+    apply_mode();
+    // edges still queued were sampled with old timer config
+    edge_ring.flush();
+    mode_switched = true;
+}
+
+void RfidReader::apply_mode() {
+    switch(type) {
+    case Type::Normal:
+        furi_hal_rfid_change_read_config(125000.0f, 0.5f);
+        break;
+    case Type::Indala:
+        furi_hal_rfid_change_read_config(62500.0f, 0.25f);
+        break;
+    }
 }
 
 static void comparator_trigger_callback(void* hcomp, void* comp_ctx) {
@@ -68,7 +138,7 @@ static void comparator_trigger_callback(void* hcomp, void* comp_ctx) {
     RfidReader* _this = static_cast<RfidReader*>(comp_ctx);
 
     if(hcomp == &hcomp1) {
-        RfidReaderAccessor::decode(
+        RfidReaderAccessor::store_edge(
             *_this, (HAL_COMP_GetOutputLevel(_hcomp) == COMP_OUTPUT_LEVEL_HIGH));
     }
 }
@@ -77,35 +147,63 @@ RfidReader::RfidReader() {
 }
 
 void RfidReader::start() {
-    type = Type::Normal;
+    start_forced(Type::Normal);
+}
+
+void RfidReader::start_forced(RfidReader::Type _type) {
+    type = _type;
+    scheduler.reset(osKernelGetTickCount(), osKernelGetTickFreq());
+    scheduler_syncs = get_sync_count();
+    switch_enabled = true;
+    key_readed = false;
+    mode_switched = false;
+    detect_ticks = 0;
+
+    furi_assert(decoder_thread == nullptr);
+    edge_ring.reset();
+    decoder_thread = furi_thread_alloc();
+    furi_thread_set_name(decoder_thread, "RfidDecoder");
+    furi_thread_set_stack_size(decoder_thread, 1024);
+    furi_thread_set_context(decoder_thread, this);
+    furi_thread_set_callback(decoder_thread, RfidReaderAccessor::decoder_thread);
+    furi_thread_start(decoder_thread);
+    decoder_thread_id = furi_thread_get_thread_id(decoder_thread);
 
     furi_hal_rfid_pins_read();
     furi_hal_rfid_tim_read(125000, 0.5);
+    if(type != Type::Normal) {
+        apply_mode();
+    }
     furi_hal_rfid_tim_read_start();
     start_comparator();
 
-    switch_timer_reset();
     last_readed_count = 0;
 }
 
-void RfidReader::start_forced(RfidReader::Type _type) {
-    start();
-    if(_type == Type::Indala) {
-        switch_mode();
-    }
-}
-
 void RfidReader::stop() {
     furi_hal_rfid_pins_reset();
     furi_hal_rfid_tim_read_stop();
     furi_hal_rfid_tim_reset();
     stop_comparator();
+
+    if(decoder_thread) {
+        osThreadFlagsSet(decoder_thread_id, RfidReaderEventStop);
+        furi_thread_join(decoder_thread);
+        furi_thread_free(decoder_thread);
+        decoder_thread = nullptr;
+        decoder_thread_id = nullptr;
+    }
 }
 
 bool RfidReader::read(LfrfidKeyType* _type, uint8_t* data, uint8_t data_size, bool switch_enable) {
     bool result = false;
     bool something_readed = false;
 
+    switch_enabled = switch_enable;
+    if(mode_switched.exchange(false)) {
+        last_readed_count = 0;
+    }
+
     // reading
     if(decoder_em.read(data, data_size)) {
         *_type = LfrfidKeyType::KeyEM4100;
@@ -124,7 +222,7 @@ bool RfidReader::read(LfrfidKeyType* _type, uint8_t* data, uint8_t data_size, bo
 
     // validation
     if(something_readed) {
-        switch_timer_reset();
+        key_readed = true;
 
         if(last_readed_type == *_type && memcmp(last_readed_data, data, data_size) == 0) {
             last_readed_count = last_readed_count + 1;
@@ -139,21 +237,14 @@ bool RfidReader::read(LfrfidKeyType* _type, uint8_t* data, uint8_t data_size, bo
         }
     }
 
-    // mode switching
-    if(switch_enable && switch_timer_elapsed()) {
-        switch_mode();
-        last_readed_count = 0;
-    }
-
     return result;
 }
 
 bool RfidReader::detect() {
     bool detected = false;
-    if(detect_ticks > 10) {
+    if(detect_ticks.exchange(0) > 10) {
         detected = true;
     }
-    detect_ticks = 0;
 
     return detected;
 }
@@ -162,6 +253,10 @@ bool RfidReader::any_read() {
     return last_readed_count > 0;
 }
 
+uint32_t RfidReader::get_edge_overruns() {
+    return edge_ring.get_overruns();
+}
+
 void RfidReader::start_comparator(void) {
     api_interrupt_add(comparator_trigger_callback, InterruptTypeComparatorTrigger, this);
     last_dwt_value = DWT->CYCCNT;
@@ -5,6 +5,10 @@
 #include "decoder-hid26.h"
 #include "decoder-indala.h"
 #include "key-info.h"
+#include "rfid-mode-scheduler.h"
+#include <furi.h>
+#include <atomic>
+#include <lib/toolbox/edge-ring.h>
 
 //#define RFID_GPIO_DEBUG 1
 
@@ -24,6 +28,11 @@ public:
     bool detect();
     bool any_read();
 
+    /**
+     * @brief Edges dropped since start because decoder thread was late
+     */
+    uint32_t get_edge_overruns();
+
 private:
     friend struct RfidReaderAccessor;
 
@@ -40,14 +49,29 @@ private:
     void start_comparator(void);
     void stop_comparator(void);
 
-    void decode(bool polarity);
+    // Comparator ISR only stores edges, decoders run in decoder thread
+    typedef EdgeRing<1024> RfidEdgeRing;
+    RfidEdgeRing edge_ring;
+    FuriThread* decoder_thread = nullptr;
+    osThreadId_t decoder_thread_id = nullptr;
+
+    void store_edge(bool polarity);
+    void decoder_loop();
+    void decode(bool polarity, uint32_t period);
 
-    uint32_t detect_ticks;
+    // Counted in decoder thread, taken by detect() in app thread
+    std::atomic<uint32_t> detect_ticks;
 
-    uint32_t switch_os_tick_last;
-    bool switch_timer_elapsed();
-    void switch_timer_reset();
+    // Mode is switched in decoder thread, read() only passes its arguments and results
+    RfidModeScheduler scheduler;
+    uint32_t scheduler_syncs;
+    std::atomic<bool> switch_enabled;
+    std::atomic<bool> key_readed;
+    std::atomic<bool> mode_switched;
+    uint32_t get_sync_count();
+    void schedule(uint32_t edges);
     void switch_mode();
+    void apply_mode();
 
     LfrfidKeyType last_readed_type;
     uint8_t last_readed_data[LFRFID_KEY_SIZE];
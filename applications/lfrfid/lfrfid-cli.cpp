@@ -92,6 +92,11 @@ void lfrfid_cli_read(Cli* cli, string_t args) {
     printf("Reading stopped\r\n");
     reader.stop();
 
+    uint32_t overruns = reader.get_edge_overruns();
+    if(overruns) {
+        printf("Edges dropped: %lu\r\n", overruns);
+    }
+
     string_clear(type_string);
 }
 
@@ -2,13 +2,19 @@
 
 #include <lib/toolbox/path.h>
 #include <lib/flipper_file/flipper_file.h>
+#include "mifare_ultralight_dump.h"
 
 static const char* nfc_app_folder = "/any/nfc";
 static const char* nfc_app_extension = ".nfc";
 static const char* nfc_app_shadow_extension = ".shd";
+static const char* nfc_app_dump_extension = ".nfb";
+static const char* nfc_app_shadow_dump_extension = ".shb";
 static const char* nfc_file_header = "Flipper NFC device";
 static const uint32_t nfc_file_version = 2;
 
+/* Text file is read through stack buffer of this size for dump CRC */
+#define NFC_DEVICE_SOURCE_CRC_CHUNK 512
+
 NfcDevice* nfc_device_alloc() {
     NfcDevice* nfc_dev = furi_alloc(sizeof(NfcDevice));
     nfc_dev->storage = furi_record_open("storage");
@@ -149,6 +155,88 @@ bool nfc_device_load_mifare_ul_data(FlipperFile* file, NfcDevice* dev) {
     return parsed;
 }
 
+/* CRC of whole text file in chunks, file position is kept for text loader */
+static bool nfc_device_get_source_crc(File* file, uint64_t size, uint32_t* crc) {
+    if(size == 0 || size > MF_UL_DUMP_SOURCE_SIZE_MAX) return false;
+
+    uint8_t chunk[NFC_DEVICE_SOURCE_CRC_CHUNK];
+    uint64_t left = size;
+    uint32_t source_crc = 0;
+    uint64_t position = storage_file_tell(file);
+    if(storage_file_seek(file, 0, true)) {
+        while(left) {
+            uint16_t chunk_size = MIN(left, sizeof(chunk));
+            if(storage_file_read(file, chunk, chunk_size) != chunk_size) break;
+            source_crc = mf_ul_dump_source_crc(source_crc, chunk, chunk_size);
+            left -= chunk_size;
+        }
+    }
+    if(!left) *crc = source_crc;
+
+    return storage_file_seek(file, position, true) && !left;
+}
+
+static bool nfc_device_save_mifare_ul_dump(
+    NfcDevice* dev,
+    const char* source_path,
+    const char* path) {
+    bool saved = false;
+    MifareUlData* data = &dev->dev_data.mf_ul_data;
+    MfUltralightDumpHeader header;
+    File* source = storage_file_alloc(dev->storage);
+    File* file = storage_file_alloc(dev->storage);
+
+    do {
+        // Dump is valid only for text file with the same contents
+        if(!storage_file_open(source, source_path, FSAM_READ, FSOM_OPEN_EXISTING)) break;
+        uint64_t source_size = storage_file_size(source);
+        uint32_t source_crc;
+        if(!nfc_device_get_source_crc(source, source_size, &source_crc)) break;
+        mf_ul_dump_prepare_header(&header, data, source_size, source_crc);
+        if(!storage_file_open(file, path, FSAM_WRITE, FSOM_CREATE_ALWAYS)) break;
+        if(storage_file_write(file, &header, sizeof(header)) != sizeof(header)) break;
+        if(storage_file_write(file, data->data, data->data_size) != data->data_size) break;
+        saved = true;
+    } while(false);
+
+    storage_file_close(source);
+    storage_file_free(source);
+    storage_file_close(file);
+    storage_file_free(file);
+    if(!saved) {
+        // Don't leave dump of older data
+        storage_simply_remove(dev->storage, path);
+    }
+    return saved;
+}
+
+static bool nfc_device_load_mifare_ul_dump(NfcDevice* dev, const char* path, File* source) {
+    bool loaded = false;
+    MifareUlData* data = &dev->dev_data.mf_ul_data;
+    MfUltralightDumpHeader header;
+    File* file = storage_file_alloc(dev->storage);
+
+    do {
+        if(!storage_file_open(file, path, FSAM_READ, FSOM_OPEN_EXISTING)) break;
+        if(storage_file_read(file, &header, sizeof(header)) != sizeof(header)) break;
+        // Text file was edited after dump was saved, size is checked first as it is free
+        uint64_t source_size = storage_file_size(source);
+        if(header.source_size != source_size) break;
+        uint32_t source_crc;
+        if(!nfc_device_get_source_crc(source, source_size, &source_crc)) break;
+        if(header.source_crc != source_crc) break;
+        if(!mf_ul_dump_parse_header(&header, data)) break;
+        // Whole page array in one read
+        if(storage_file_read(file, data->data, data->data_size) != data->data_size) break;
+        if(!mf_ul_dump_check(&header, data)) break;
+        loaded = true;
+    } while(false);
+
+    storage_file_close(file);
+    storage_file_free(file);
+    return loaded;
+}
+
 static bool nfc_device_save_bank_card_data(FlipperFile* file, NfcDevice* dev) {
     bool saved = false;
     NfcEmvData* data = &dev->dev_data.emv_data;
@@ -225,7 +313,8 @@ static bool nfc_device_save_file(
     NfcDevice* dev,
     const char* dev_name,
     const char* folder,
-    const char* extension) {
+    const char* extension,
+    const char* dump_extension) {
     furi_assert(dev);
 
     bool saved = false;
@@ -267,19 +356,30 @@ static bool nfc_device_save_file(
     if(!saved) {
         dialog_message_show_storage_error(dev->dialogs, "Can not save\nkey file");
     }
-    string_clear(temp_str);
     flipper_file_close(file);
     flipper_file_free(file);
+    if(saved && dev->format == NfcDeviceSaveFormatMifareUl) {
+        // Binary dump is loaded instead of pages from text file while they are in sync
+        string_t dump_path;
+        string_init_printf(dump_path, "%s/%s%s", folder, dev_name, dump_extension);
+        string_printf(temp_str, "%s/%s%s", folder, dev_name, extension);
+        nfc_device_save_mifare_ul_dump(
+            dev, string_get_cstr(temp_str), string_get_cstr(dump_path));
+        string_clear(dump_path);
+    }
+    string_clear(temp_str);
     return saved;
 }
 
 bool nfc_device_save(NfcDevice* dev, const char* dev_name) {
-    return nfc_device_save_file(dev, dev_name, nfc_app_folder, nfc_app_extension);
+    return nfc_device_save_file(
+        dev, dev_name, nfc_app_folder, nfc_app_extension, nfc_app_dump_extension);
 }
 
 bool nfc_device_save_shadow(NfcDevice* dev, const char* dev_name) {
     dev->shadow_file_exist = true;
-    return nfc_device_save_file(dev, dev_name, nfc_app_folder, nfc_app_shadow_extension);
+    return nfc_device_save_file(
+        dev, dev_name, nfc_app_folder, nfc_app_shadow_extension, nfc_app_shadow_dump_extension);
 }
 
 static bool nfc_device_load_data(NfcDevice* dev, string_t path) {
@@ -289,19 +389,24 @@ static bool nfc_device_load_data(NfcDevice* dev, string_t path) {
     uint32_t data_cnt = 0;
     string_t temp_str;
     string_init(temp_str);
+    string_t dump_path;
+    string_init(dump_path);
     bool depricated_version = false;
 
     do {
         // Check existance of shadow file
         size_t ext_start = string_search_str(path, nfc_app_extension);
         string_set_n(temp_str, path, 0, ext_start);
+        string_set(dump_path, temp_str);
         string_cat_printf(temp_str, "%s", nfc_app_shadow_extension);
         dev->shadow_file_exist =
             storage_common_stat(dev->storage, string_get_cstr(temp_str), NULL) == FSE_OK;
         // Open shadow file if it exists. If not - open original
         if(dev->shadow_file_exist) {
+            string_cat_printf(dump_path, "%s", nfc_app_shadow_dump_extension);
             if(!flipper_file_open_existing(file, string_get_cstr(temp_str))) break;
         } else {
+            string_cat_printf(dump_path, "%s", nfc_app_dump_extension);
             if(!flipper_file_open_existing(file, string_get_cstr(path))) break;
         }
         // Read and verify file header
@@ -322,7 +427,11 @@ static bool nfc_device_load_data(NfcDevice* dev, string_t path) {
         if(!flipper_file_read_hex(file, "SAK", &data->sak, 1)) break;
         // Parse other data
         if(dev->format == NfcDeviceSaveFormatMifareUl) {
-            if(!nfc_device_load_mifare_ul_data(file, dev)) break;
+            // Parse pages from text file only if binary dump is missing or out of sync
+            File* source = flipper_file_get_file(file);
+            if(!nfc_device_load_mifare_ul_dump(dev, string_get_cstr(dump_path), source) &&
+               !nfc_device_load_mifare_ul_data(file, dev))
+                break;
         } else if(dev->format == NfcDeviceSaveFormatBankCard) {
             if(!nfc_device_load_bank_card_data(file, dev)) break;
         }
@@ -338,6 +447,7 @@ static bool nfc_device_load_data(NfcDevice* dev, string_t path) {
     }
 
     string_clear(temp_str);
+    string_clear(dump_path);
     flipper_file_close(file);
     flipper_file_free(file);
     return parsed;
@@ -410,6 +520,12 @@ bool nfc_device_delete(NfcDevice* dev) {
                 file_path, "%s/%s%s", nfc_app_folder, dev->dev_name, nfc_app_shadow_extension);
             if(!storage_simply_remove(dev->storage, string_get_cstr(file_path))) break;
         }
+        // Remove binary dumps, missing ones are fine
+        string_printf(file_path, "%s/%s%s", nfc_app_folder, dev->dev_name, nfc_app_dump_extension);
+        if(!storage_simply_remove(dev->storage, string_get_cstr(file_path))) break;
+        string_printf(
+            file_path, "%s/%s%s", nfc_app_folder, dev->dev_name, nfc_app_shadow_dump_extension);
+        if(!storage_simply_remove(dev->storage, string_get_cstr(file_path))) break;
         deleted = true;
     } while(0);
 
@@ -432,6 +548,9 @@ bool nfc_device_restore(NfcDevice* dev) {
         string_init_printf(
             path, "%s/%s%s", nfc_app_folder, dev->dev_name, nfc_app_shadow_extension);
         if(!storage_simply_remove(dev->storage, string_get_cstr(path))) break;
+        string_printf(
+            path, "%s/%s%s", nfc_app_folder, dev->dev_name, nfc_app_shadow_dump_extension);
+        if(!storage_simply_remove(dev->storage, string_get_cstr(path))) break;
         dev->shadow_file_exist = false;
         string_printf(path, "%s/%s%s", nfc_app_folder, dev->dev_name, nfc_app_extension);
         if(!nfc_device_load_data(dev, path)) break;
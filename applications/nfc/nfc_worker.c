@@ -1,6 +1,7 @@
 #include "nfc_worker_i.h"
 #include <furi-hal.h>
 #include "nfc_protocols/emv_decoder.h"
+#include "nfc_protocols/emv_reader.h"
 #include "nfc_protocols/mifare_ultralight.h"
 
 #define TAG "NfcWorker"
@@ -211,19 +212,38 @@ void nfc_worker_read_emv_app(NfcWorker* nfc_worker) {
     }
 }
 
+static ReturnCode nfc_worker_emv_exchange(EmvReader* reader) {
+    ReturnCode err = ERR_NONE;
+    uint8_t tx_buff[2][255];
+    uint8_t tx_idx = 0;
+    uint8_t* rx_buff;
+    uint16_t* rx_len;
+
+    uint16_t tx_len = emv_reader_prepare(reader, tx_buff[tx_idx]);
+    while(tx_len) {
+        err = furi_hal_nfc_data_exchange_start(tx_buff[tx_idx], tx_len, &rx_buff, &rx_len);
+        if(err != ERR_NONE) break;
+        // Record commands are planned from AFL, next one is built while response is in flight
+        tx_idx ^= 1;
+        tx_len = emv_reader_prepare(reader, tx_buff[tx_idx]);
+        err = furi_hal_nfc_data_exchange_wait(false);
+        if(err != ERR_NONE) break;
+        if(!emv_reader_process(reader, rx_buff, *rx_len)) break;
+        if(!tx_len) {
+            tx_len = emv_reader_prepare(reader, tx_buff[tx_idx]);
+        }
+    }
+    return err;
+}
+
 void nfc_worker_read_emv(NfcWorker* nfc_worker) {
     ReturnCode err;
     rfalNfcDevice* dev_list;
-    EmvApplication emv_app = {};
+    EmvReader reader;
     uint8_t dev_cnt = 0;
-    uint8_t tx_buff[255] = {};
-    uint16_t tx_len = 0;
-    uint8_t* rx_buff;
-    uint16_t* rx_len;
     NfcDeviceData* result = nfc_worker->dev_data;
 
     while(nfc_worker->state == NfcWorkerStateReadEMV) {
-        memset(&emv_app, 0, sizeof(emv_app));
         if(furi_hal_nfc_detect(&dev_list, &dev_cnt, 1000, false)) {
             // Card was found. Check that it supports EMV
             if(dev_list[0].rfInterface == RFAL_NFC_INTERFACE_ISODEP) {
@@ -235,114 +255,42 @@ void nfc_worker_read_emv(NfcWorker* nfc_worker) {
                     result->nfc_data.uid, dev_list[0].dev.nfca.nfcId1, result->nfc_data.uid_len);
                 result->nfc_data.protocol = NfcDeviceProtocolEMV;
 
-                FURI_LOG_I(TAG, "Send select PPSE command");
-                tx_len = emv_prepare_select_ppse(tx_buff);
-                err = furi_hal_nfc_data_exchange(tx_buff, tx_len, &rx_buff, &rx_len, false);
-                if(err != ERR_NONE) {
-                    FURI_LOG_E(TAG, "Error during selection PPSE request: %d", err);
-                    furi_hal_nfc_deactivate();
-                    continue;
-                }
-                FURI_LOG_I(TAG, "Select PPSE response received. Start parsing response");
-                if(emv_decode_ppse_response(rx_buff, *rx_len, &emv_app)) {
-                    FURI_LOG_I(TAG, "Select PPSE responce parced");
-                    result->emv_data.aid_len = emv_app.aid_len;
-                    memcpy(result->emv_data.aid, emv_app.aid, emv_app.aid_len);
-                } else {
-                    FURI_LOG_E(TAG, "Can't find pay application");
-                    furi_hal_nfc_deactivate();
-                    continue;
-                }
-                FURI_LOG_I(TAG, "Starting application ...");
-                tx_len = emv_prepare_select_app(tx_buff, &emv_app);
-                err = furi_hal_nfc_data_exchange(tx_buff, tx_len, &rx_buff, &rx_len, false);
-                if(err != ERR_NONE) {
-                    FURI_LOG_E(TAG, "Error during application selection request: %d", err);
-                    furi_hal_nfc_deactivate();
-                    continue;
-                }
-                FURI_LOG_I(TAG, "Select application response received. Start parsing response");
-                if(emv_decode_select_app_response(rx_buff, *rx_len, &emv_app)) {
-                    FURI_LOG_I(TAG, "Card name: %s", emv_app.name);
-                    memcpy(result->emv_data.name, emv_app.name, sizeof(emv_app.name));
-                } else if(emv_app.pdol.size > 0) {
-                    FURI_LOG_W(TAG, "Can't find card name, but PDOL is present.");
-                } else {
-                    FURI_LOG_E(TAG, "Can't find card name or PDOL");
-                    furi_hal_nfc_deactivate();
-                    continue;
-                }
-                FURI_LOG_I(TAG, "Starting Get Processing Options command ...");
-                tx_len = emv_prepare_get_proc_opt(tx_buff, &emv_app);
-                err = furi_hal_nfc_data_exchange(tx_buff, tx_len, &rx_buff, &rx_len, false);
-                if(err != ERR_NONE) {
-                    FURI_LOG_E(TAG, "Error during Get Processing Options command: %d", err);
-                    furi_hal_nfc_deactivate();
-                    continue;
-                }
-                if(emv_decode_get_proc_opt(rx_buff, *rx_len, &emv_app)) {
-                    FURI_LOG_I(TAG, "Card number parsed");
-                    result->emv_data.number_len = emv_app.card_number_len;
-                    memcpy(result->emv_data.number, emv_app.card_number, emv_app.card_number_len);
+                emv_reader_init(&reader);
+                err = nfc_worker_emv_exchange(&reader);
+                EmvApplication* emv_app = &reader.app;
+                if(reader.state == EmvReaderStateDone) {
+                    FURI_LOG_I(TAG, "Card read, %d records", reader.records_read);
+                    result->emv_data.aid_len = emv_app->aid_len;
+                    memcpy(result->emv_data.aid, emv_app->aid, emv_app->aid_len);
+                    if(emv_app->name[0]) {
+                        memcpy(result->emv_data.name, emv_app->name, sizeof(emv_app->name));
+                    }
+                    result->emv_data.number_len = emv_app->card_number_len;
+                    memcpy(
+                        result->emv_data.number,
+                        emv_app->card_number,
+                        result->emv_data.number_len);
+                    if(emv_app->exp_month) {
+                        result->emv_data.exp_mon = emv_app->exp_month;
+                        result->emv_data.exp_year = emv_app->exp_year;
+                    }
+                    if(emv_app->country_code) {
+                        result->emv_data.country_code = emv_app->country_code;
+                    }
+                    if(emv_app->currency_code) {
+                        result->emv_data.currency_code = emv_app->currency_code;
+                    }
                     // Notify caller and exit
                     if(nfc_worker->callback) {
                         nfc_worker->callback(nfc_worker->context);
                     }
                     break;
+                } else if(err != ERR_NONE) {
+                    FURI_LOG_E(TAG, "Exchange error %d in state %d", err, reader.state);
                 } else {
-                    // Mastercard doesn't give PAN / card number as GPO response
-                    // Iterate over all files found in application
-                    bool pan_found = false;
-                    for(uint8_t i = 0; (i < emv_app.afl.size) && !pan_found; i += 4) {
-                        uint8_t sfi = emv_app.afl.data[i] >> 3;
-                        uint8_t record_start = emv_app.afl.data[i + 1];
-                        uint8_t record_end = emv_app.afl.data[i + 2];
-
-                        // Iterate over all records in file
-                        for(uint8_t record = record_start; record <= record_end; ++record) {
-                            tx_len = emv_prepare_read_sfi_record(tx_buff, sfi, record);
-                            err = furi_hal_nfc_data_exchange(
-                                tx_buff, tx_len, &rx_buff, &rx_len, false);
-                            if(err != ERR_NONE) {
-                                FURI_LOG_E(
-                                    TAG,
-                                    "Error reading application sfi %d, record %d",
-                                    sfi,
-                                    record);
-                            }
-                            if(emv_decode_read_sfi_record(rx_buff, *rx_len, &emv_app)) {
-                                pan_found = true;
-                                break;
-                            }
-                        }
-                    }
-                    if(pan_found) {
-                        FURI_LOG_I(TAG, "Card PAN found");
-                        result->emv_data.number_len = emv_app.card_number_len;
-                        memcpy(
-                            result->emv_data.number,
-                            emv_app.card_number,
-                            result->emv_data.number_len);
-                        if(emv_app.exp_month) {
-                            result->emv_data.exp_mon = emv_app.exp_month;
-                            result->emv_data.exp_year = emv_app.exp_year;
-                        }
-                        if(emv_app.country_code) {
-                            result->emv_data.country_code = emv_app.country_code;
-                        }
-                        if(emv_app.currency_code) {
-                            result->emv_data.currency_code = emv_app.currency_code;
-                        }
-                        // Notify caller and exit
-                        if(nfc_worker->callback) {
-                            nfc_worker->callback(nfc_worker->context);
-                        }
-                        break;
-                    } else {
-                        FURI_LOG_E(TAG, "Can't read card number");
-                    }
-                    furi_hal_nfc_deactivate();
+                    FURI_LOG_E(TAG, "Can't read card number");
                 }
+                furi_hal_nfc_deactivate();
             } else {
                 // Can't find EMV card
                 FURI_LOG_W(TAG, "Card doesn't support EMV");
@@ -604,7 +552,7 @@ void nfc_worker_read_mifare_ul(NfcWorker* nfc_worker) {
 
 void nfc_worker_emulate_mifare_ul(NfcWorker* nfc_worker) {
     ReturnCode err;
-    uint8_t tx_buff[255] = {};
+    uint8_t* tx_buff;
     uint16_t tx_len = 0;
     uint8_t* rx_buff;
     uint16_t* rx_len;
@@ -625,7 +573,7 @@ void nfc_worker_emulate_mifare_ul(NfcWorker* nfc_worker) {
                 // Data exchange loop
                 while(nfc_worker->state == NfcWorkerStateEmulateMifareUl) {
                     tx_len = mf_ul_prepare_emulation_response(
-                        rx_buff, *rx_len, tx_buff, &mf_ul_emulate);
+                        rx_buff, *rx_len, &tx_buff, &mf_ul_emulate);
                     if(tx_len > 0) {
                         err =
                             furi_hal_nfc_data_exchange(tx_buff, tx_len, &rx_buff, &rx_len, false);
@@ -0,0 +1,191 @@
+#include "profiler_i.h"
+
+#include <furi-hal.h>
+#include <task-control-block.h>
+
+#define TAG "Profiler"
+
+static void profiler_thread_account(
+    ProfilerThread* thread,
+    uint32_t run_time,
+    size_t second,
+    size_t decade,
+    bool new_decade) {
+    uint32_t delta = run_time - thread->run_time;
+    thread->run_time = run_time;
+    thread->seconds[second] = delta;
+    if(new_decade) {
+        thread->decades[decade] = delta;
+    } else {
+        thread->decades[decade] += delta;
+    }
+}
+
+static ProfilerThread* profiler_thread_get(Profiler* profiler, TaskStatus_t* status) {
+    ProfilerThread* free_slot = NULL;
+    // Slot 0 is ISR
+    for(size_t i = 1; i < PROFILER_THREADS_MAX; i++) {
+        ProfilerThread* thread = &profiler->threads[i];
+        if(thread->handle == status->xHandle &&
+           strncmp(thread->name, status->pcTaskName, PROFILER_NAME_SIZE - 1) == 0) {
+            return thread;
+        } else if(!thread->handle && !free_slot) {
+            free_slot = thread;
+        }
+    }
+
+    if(free_slot) {
+        memset(free_slot, 0, sizeof(ProfilerThread));
+        free_slot->handle = status->xHandle;
+        strlcpy(free_slot->name, status->pcTaskName, PROFILER_NAME_SIZE);
+    }
+    return free_slot;
+}
+
+/* Take counters, account them into current buckets if account is set */
+static void profiler_update(Profiler* profiler, bool account) {
+    // Buffer follows thread count, retry if a thread was created meanwhile
+    uint32_t total_run_time;
+    UBaseType_t count = 0;
+    while(true) {
+        UBaseType_t tasks = uxTaskGetNumberOfTasks();
+        if(tasks > profiler->status_size) {
+            free(profiler->status);
+            profiler->status_size = tasks + PROFILER_STATUS_RESERVE;
+            profiler->status = furi_alloc(sizeof(TaskStatus_t) * profiler->status_size);
+        }
+        count = uxTaskGetSystemState(profiler->status, profiler->status_size, &total_run_time);
+        if(count) break;
+    }
+    uint32_t isr_time = api_interrupt_get_cycles();
+    uint32_t tick = osKernelGetTickCount();
+
+    furi_check(osMutexAcquire(profiler->mutex, osWaitForever) == osOK);
+
+    size_t second = profiler->second % PROFILER_SECONDS;
+    size_t decade = (profiler->second / PROFILER_SECONDS) % PROFILER_DECADES;
+    bool new_decade = (second == 0);
+
+    for(size_t i = 1; i < PROFILER_THREADS_MAX; i++) {
+        profiler->threads[i].alive = false;
+    }
+
+    for(UBaseType_t i = 0; i < count; i++) {
+        TaskStatus_t* status = &profiler->status[i];
+        ProfilerThread* thread = profiler_thread_get(profiler, status);
+        if(!thread) continue;
+
+        // Accounted handlers are in ISR entry, not in thread they preempted
+        uint32_t run_time =
+            status->ulRunTimeCounter - api_interrupt_get_thread_cycles(status->xHandle);
+        // Threads started after first sample ran from zero
+        if(account) {
+            profiler_thread_account(thread, run_time, second, decade, new_decade);
+        } else {
+            thread->run_time = run_time;
+        }
+
+        TaskControlBlock* tcb = (TaskControlBlock*)status->xHandle;
+        thread->stack_size = (tcb->pxEndOfStack - tcb->pxStack + 1) * sizeof(StackType_t);
+        thread->stack_min_free = status->usStackHighWaterMark * sizeof(StackType_t);
+        thread->alive = true;
+    }
+
+    for(size_t i = 1; i < PROFILER_THREADS_MAX; i++) {
+        if(!profiler->threads[i].alive) {
+            profiler->threads[i].handle = NULL;
+        }
+    }
+
+    if(account) {
+        profiler_thread_account(&profiler->threads[0], isr_time, second, decade, new_decade);
+
+        uint32_t wall = (tick - profiler->last_tick) * profiler->cycles_per_tick;
+        profiler->wall_seconds[second] = wall;
+        if(new_decade) {
+            profiler->wall_decades[decade] = wall;
+        } else {
+            profiler->wall_decades[decade] += wall;
+        }
+        profiler->second++;
+    } else {
+        profiler->threads[0].run_time = isr_time;
+    }
+    profiler->last_tick = tick;
+
+    furi_check(osMutexRelease(profiler->mutex) == osOK);
+}
+
+static uint16_t profiler_load(uint64_t time, uint64_t wall) {
+    return wall ? MIN(time * 1000 / wall, 1000ULL) : 0;
+}
+
+size_t profiler_get_stats(Profiler* profiler, ProfilerThreadStats* stats, size_t count) {
+    furi_assert(profiler);
+    furi_assert(stats);
+
+    furi_check(osMutexAcquire(profiler->mutex, osWaitForever) == osOK);
+
+    size_t last = (profiler->second + PROFILER_SECONDS - 1) % PROFILER_SECONDS;
+    uint64_t wall_10s = 0;
+    uint64_t wall_60s = 0;
+    for(size_t i = 0; i < PROFILER_SECONDS; i++) wall_10s += profiler->wall_seconds[i];
+    for(size_t i = 0; i < PROFILER_DECADES; i++) wall_60s += profiler->wall_decades[i];
+
+    size_t filled = 0;
+    for(size_t i = 0; i < PROFILER_THREADS_MAX && filled < count; i++) {
+        ProfilerThread* thread = &profiler->threads[i];
+        if(!thread->handle) continue;
+
+        uint64_t time_10s = 0;
+        uint64_t time_60s = 0;
+        for(size_t j = 0; j < PROFILER_SECONDS; j++) time_10s += thread->seconds[j];
+        for(size_t j = 0; j < PROFILER_DECADES; j++) time_60s += thread->decades[j];
+
+        ProfilerThreadStats* thread_stats = &stats[filled++];
+        strlcpy(thread_stats->name, thread->name, PROFILER_NAME_SIZE);
+        thread_stats->load[ProfilerWindow1s] =
+            profiler_load(thread->seconds[last], profiler->wall_seconds[last]);
+        thread_stats->load[ProfilerWindow10s] = profiler_load(time_10s, wall_10s);
+        thread_stats->load[ProfilerWindow60s] = profiler_load(time_60s, wall_60s);
+        thread_stats->stack_size = thread->stack_size;
+        thread_stats->stack_min_free = thread->stack_min_free;
+    }
+
+    furi_check(osMutexRelease(profiler->mutex) == osOK);
+
+    return filled;
+}
+
+static Profiler* profiler_alloc() {
+    Profiler* profiler = furi_alloc(sizeof(Profiler));
+    profiler->mutex = osMutexNew(NULL);
+    furi_check(profiler->mutex);
+    profiler->cycles_per_tick =
+        furi_hal_delay_get_cycles_per_us() * 1000000UL / osKernelGetTickFreq();
+
+    ProfilerThread* isr = &profiler->threads[0];
+    isr->handle = profiler;
+    strlcpy(isr->name, "ISR, partial", PROFILER_NAME_SIZE);
+    isr->alive = true;
+
+    profiler_update(profiler, false);
+    return profiler;
+}
+
+int32_t profiler_srv(void* p) {
+    Profiler* profiler = profiler_alloc();
+    furi_record_create("profiler", profiler);
+
+    Cli* cli = furi_record_open("cli");
+    profiler_cli_init(profiler, cli);
+    furi_record_close("cli");
+
+    FURI_LOG_I(TAG, "Started");
+    while(1) {
+        osDelay(osKernelGetTickFreq());
+        profiler_update(profiler, true);
+    }
+
+    return 0;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Threads tracked at once, including ISR pseudo thread */
+#define PROFILER_THREADS_MAX 32
+#define PROFILER_NAME_SIZE 16
+
+typedef struct Profiler Profiler;
+
+typedef enum {
+    ProfilerWindow1s,
+    ProfilerWindow10s,
+    ProfilerWindow60s,
+    ProfilerWindowNum,
+} ProfilerWindow;
+
+typedef struct {
+    char name[PROFILER_NAME_SIZE];
+    uint16_t load[ProfilerWindowNum]; /**< Share of wall time, per mille */
+    uint32_t stack_size; /**< Bytes, 0 for ISR */
+    uint32_t stack_min_free; /**< Stack high-water mark, bytes never used */
+} ProfilerThreadStats;
+
+/** Get per thread CPU load and stack watermarks
+ *
+ * First entry is interrupt handlers time, partial: only handlers marked with
+ * api_interrupt_enter and api_interrupt_exit (TIM1, TIM2, DMA and
+ * api_interrupt_call ones) are in it, and their time is taken out of thread
+ * they preempted. Other handlers stay in preempted thread load. Time spent in
+ * stop mode belongs to nobody, so loads do not add up to 100% while device
+ * sleeps.
+ *
+ * @param      profiler  Profiler instance
+ * @param      stats     destination
+ * @param      count     destination size
+ *
+ * @return     entries filled
+ */
+size_t profiler_get_stats(Profiler* profiler, ProfilerThreadStats* stats, size_t count);
+
+#ifdef __cplusplus
+}
+#endif
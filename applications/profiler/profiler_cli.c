@@ -0,0 +1,63 @@
+#include "profiler_i.h"
+
+#include <stdlib.h>
+#include <toolbox/args.h>
+
+#define PROFILER_CLI_REFRESH_STEPS 4
+
+static int profiler_cli_compare(const void* a, const void* b) {
+    const ProfilerThreadStats* stats_a = a;
+    const ProfilerThreadStats* stats_b = b;
+    return (int)stats_b->load[ProfilerWindow1s] - (int)stats_a->load[ProfilerWindow1s];
+}
+
+static void profiler_cli_print(ProfilerThreadStats* stats, size_t count) {
+    // ISR stays on top, threads by last second load
+    if(count > 1) {
+        qsort(&stats[1], count - 1, sizeof(ProfilerThreadStats), profiler_cli_compare);
+    }
+    printf(
+        "%-16s %-7s %-7s %-7s %-8s %s\r\n", "Name", "1s,%", "10s,%", "60s,%", "Stack", "Min free");
+    for(size_t i = 0; i < count; i++) {
+        printf("%-16s", stats[i].name);
+        for(size_t window = 0; window < ProfilerWindowNum; window++) {
+            printf(" %3u.%u   ", stats[i].load[window] / 10, stats[i].load[window] % 10);
+        }
+        if(stats[i].stack_size) {
+            printf("%-8lu %lu\r\n", stats[i].stack_size, stats[i].stack_min_free);
+        } else {
+            printf("%-8s %s\r\n", "-", "-");
+        }
+    }
+}
+
+static void profiler_cli_top(Cli* cli, string_t args, void* context) {
+    Profiler* profiler = context;
+    int iterations = 0;
+    args_read_int_and_trim(args, &iterations);
+
+    ProfilerThreadStats* stats = furi_alloc(sizeof(ProfilerThreadStats) * PROFILER_THREADS_MAX);
+    while(true) {
+        size_t count = profiler_get_stats(profiler, stats, PROFILER_THREADS_MAX);
+        if(iterations != 1) {
+            // Clear screen and go home
+            printf("\033[2J\033[H");
+        }
+        profiler_cli_print(stats, count);
+
+        if(iterations > 0 && --iterations == 0) break;
+        if(iterations == 0) printf("Press CTRL+C to stop\r\n");
+
+        bool interrupted = false;
+        for(size_t i = 0; i < PROFILER_CLI_REFRESH_STEPS && !interrupted; i++) {
+            osDelay(osKernelGetTickFreq() / PROFILER_CLI_REFRESH_STEPS);
+            interrupted = cli_cmd_interrupt_received(cli);
+        }
+        if(interrupted) break;
+    }
+    free(stats);
+}
+
+void profiler_cli_init(Profiler* profiler, Cli* cli) {
+    cli_add_command(cli, "top", CliCommandFlagParallelSafe, profiler_cli_top, profiler);
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "profiler.h"
+
+#include <furi.h>
+#include <cli/cli.h>
+
+/* 1s buckets for 1s and 10s windows */
+#define PROFILER_SECONDS 10
+/* 10s buckets for 60s window, current one is filling up */
+#define PROFILER_DECADES 6
+/* Spare TaskStatus_t entries, buffer grows when threads outnumber it */
+#define PROFILER_STATUS_RESERVE 4
+
+typedef struct {
+    void* handle; /**< TaskHandle_t, NULL for free slot, ISR slot uses profiler */
+    char name[PROFILER_NAME_SIZE];
+    uint32_t run_time; /**< Counter value at last sample */
+    uint32_t seconds[PROFILER_SECONDS];
+    uint64_t decades[PROFILER_DECADES];
+    uint32_t stack_size;
+    uint32_t stack_min_free;
+    bool alive;
+} ProfilerThread;
+
+struct Profiler {
+    osMutexId_t mutex;
+    TaskStatus_t* status;
+    size_t status_size;
+    ProfilerThread threads[PROFILER_THREADS_MAX];
+    /* Wall time buckets, same layout as threads */
+    uint32_t wall_seconds[PROFILER_SECONDS];
+    uint64_t wall_decades[PROFILER_DECADES];
+    uint32_t cycles_per_tick;
+    uint32_t last_tick;
+    uint32_t second;
+};
+
+void profiler_cli_init(Profiler* profiler, Cli* cli);
@@ -595,7 +595,13 @@ int32_t rpc_srv(void* p) {
             .bytes_left = RPC_MAX_MESSAGE_SIZE, /* max incoming message size */
         };
 
-        if(pb_decode_ex(&istream, &PB_Main_msg, rpc->decoded_message, PB_DECODE_DELIMITED)) {
+        // Decode span includes waiting for the rest of the message from transport
+        FURI_TRACE_BEGIN("rpc_decode");
+        bool decoded =
+            pb_decode_ex(&istream, &PB_Main_msg, rpc->decoded_message, PB_DECODE_DELIMITED);
+        FURI_TRACE_END("rpc_decode");
+
+        if(decoded) {
 #if SRV_RPC_DEBUG
             FURI_LOG_I(TAG, "INPUT:");
             rpc_print_message(rpc->decoded_message);
@@ -604,7 +610,9 @@ int32_t rpc_srv(void* p) {
                 RpcHandlerDict_get(rpc->handlers, rpc->decoded_message->which_content);
 
             if(handler && handler->message_handler) {
+                FURI_TRACE_BEGIN("rpc_dispatch");
                 handler->message_handler(rpc->decoded_message, handler->context);
+                FURI_TRACE_END("rpc_dispatch");
             } else if(!handler && !rpc->session.terminate) {
                 FURI_LOG_E(TAG, "Unhandled message, tag: %d", rpc->decoded_message->which_content);
             }
@@ -1,6 +1,8 @@
 #pragma once
 #include <furi.h>
+#ifndef FURI_HOST
 #include <gui/gui.h>
+#endif
 #include "storage-glue.h"
 #include "storage-sd-api.h"
 #include "filesystem-api-internal.h"
@@ -11,16 +13,20 @@ extern "C" {
 
 #define STORAGE_COUNT (ST_INT + 1)
 
+#ifndef FURI_HOST
 typedef struct {
     ViewPort* view_port;
     bool enabled;
 } StorageSDGui;
+#endif
 
 struct Storage {
     osMessageQueueId_t message_queue;
     StorageData storage[STORAGE_COUNT];
     StorageStatus prev_ext_storage_status;
+#ifndef FURI_HOST
     StorageSDGui sd_gui;
+#endif
     FuriPubSub* pubsub;
 };
 
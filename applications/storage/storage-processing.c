@@ -474,6 +474,7 @@ static FS_Error storage_process_sd_status(Storage* app) {
 /****************** API calls processing ******************/
 
 void storage_process_message(Storage* app, StorageMessage* message) {
+    FURI_TRACE_BEGIN("storage_process");
     switch(message->command) {
     case StorageCommandFileOpen:
         message->return_data->bool_value = storage_process_file_open(
@@ -589,6 +590,7 @@ void storage_process_message(Storage* app, StorageMessage* message) {
         message->return_data->error_value = storage_process_sd_status(app);
         break;
     }
+    FURI_TRACE_END("storage_process");
 
     osSemaphoreRelease(message->semaphore);
 }
@@ -3,14 +3,19 @@
 #include "storage-message.h"
 #include "storage-processing.h"
 #include "storage/storage-glue.h"
+#ifdef FURI_HOST
+#include "storages/storage-host.h"
+#else
 #include "storages/storage-int.h"
 #include "storages/storage-ext.h"
+#endif
 
 #define STORAGE_TICK 1000
 
 #define ICON_SD_MOUNTED &I_SDcardMounted_11x8
 #define ICON_SD_ERROR &I_SDcardFail_11x8
 
+#ifndef FURI_HOST
 static void storage_app_sd_icon_draw_callback(Canvas* canvas, void* context) {
     furi_assert(canvas);
     furi_assert(context);
@@ -28,6 +33,7 @@ static void storage_app_sd_icon_draw_callback(Canvas* canvas, void* context) {
         break;
     }
 }
+#endif
 
 Storage* storage_app_alloc() {
     Storage* app = malloc(sizeof(Storage));
@@ -38,6 +44,10 @@ Storage* storage_app_alloc() {
         storage_data_init(&app->storage[i]);
     }
 
+#ifdef FURI_HOST
+    storage_host_init(&app->storage[ST_INT], "int");
+    storage_host_init(&app->storage[ST_EXT], "ext");
+#else
     storage_int_init(&app->storage[ST_INT]);
     storage_ext_init(&app->storage[ST_EXT]);
 
@@ -51,6 +61,7 @@ Storage* storage_app_alloc() {
     Gui* gui = furi_record_open("gui");
     gui_add_view_port(gui, app->sd_gui.view_port, GuiLayerStatusBarLeft);
     furi_record_close("gui");
+#endif
 
     return app;
 }
@@ -68,6 +79,7 @@ void storage_tick(Storage* app) {
         furi_pubsub_publish(app->pubsub, &app->storage[ST_EXT].status);
     }
 
+#ifndef FURI_HOST
     // storage not enabled but was enabled (sd card unmount)
     if(app->storage[ST_EXT].status == StorageStatusNotReady && app->sd_gui.enabled == true) {
         app->sd_gui.enabled = false;
@@ -84,6 +96,7 @@ void storage_tick(Storage* app) {
         app->sd_gui.enabled = true;
         view_port_enabled_set(app->sd_gui.view_port, true);
     }
+#endif
 }
 
 int32_t storage_srv(void* p) {
@@ -0,0 +1,415 @@
+#ifdef FURI_HOST
+
+#include "../filesystem-api-internal.h"
+#include "storage-host.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/statvfs.h>
+#include <unistd.h>
+
+#define TAG "StorageHost"
+
+typedef struct {
+    string_t root;
+} StorageHostData;
+
+typedef struct {
+    int fd;
+} StorageHostFile;
+
+typedef struct {
+    DIR* dir;
+    string_t path;
+} StorageHostDir;
+
+static FS_Error storage_host_parse_error(int error) {
+    switch(error) {
+    case 0:
+        return FSE_OK;
+    case ENOENT:
+    case ENOTDIR:
+        return FSE_NOT_EXIST;
+    case EEXIST:
+    case ENOTEMPTY:
+        return FSE_EXIST;
+    case EACCES:
+    case EPERM:
+    case EROFS:
+    case EBUSY:
+        return FSE_DENIED;
+    case ENAMETOOLONG:
+    case EINVAL:
+        return FSE_INVALID_NAME;
+    default:
+        return FSE_INTERNAL;
+    }
+}
+
+static void storage_host_path(StorageData* storage, string_t host_path, const char* path) {
+    StorageHostData* host_data = storage->data;
+    string_init_set(host_path, host_data->root);
+    if(path[0] != '/') string_push_back(host_path, '/');
+    string_cat_str(host_path, path);
+}
+
+static bool storage_host_file_result(File* file, bool success) {
+    file->internal_error_id = success ? 0 : errno;
+    file->error_id = storage_host_parse_error(file->internal_error_id);
+    return (file->error_id == FSE_OK);
+}
+
+/******************* File Functions *******************/
+
+static bool storage_host_file_open(
+    void* ctx,
+    File* file,
+    const char* path,
+    FS_AccessMode access_mode,
+    FS_OpenMode open_mode) {
+    StorageData* storage = ctx;
+
+    int flags = 0;
+    if((access_mode & FSAM_READ) && (access_mode & FSAM_WRITE)) {
+        flags = O_RDWR;
+    } else if(access_mode & FSAM_WRITE) {
+        flags = O_WRONLY;
+    } else {
+        flags = O_RDONLY;
+    }
+    if(open_mode & (FSOM_OPEN_ALWAYS | FSOM_OPEN_APPEND)) flags |= O_CREAT;
+    if(open_mode & FSOM_CREATE_NEW) flags |= O_CREAT | O_EXCL;
+    if(open_mode & FSOM_CREATE_ALWAYS) flags |= O_CREAT | O_TRUNC;
+
+    StorageHostFile* file_data = malloc(sizeof(StorageHostFile));
+    storage_set_storage_file_data(file, file_data, storage);
+
+    string_t host_path;
+    storage_host_path(storage, host_path, path);
+    file_data->fd = open(string_get_cstr(host_path), flags, 0644);
+    string_clear(host_path);
+
+    bool success = (file_data->fd >= 0);
+    // Same as FA_OPEN_APPEND: r/w pointer starts at the end, writes may seek back
+    if(success && (open_mode & FSOM_OPEN_APPEND)) {
+        success = (lseek(file_data->fd, 0, SEEK_END) >= 0);
+    }
+    return storage_host_file_result(file, success);
+}
+
+static bool storage_host_file_close(void* ctx, File* file) {
+    StorageData* storage = ctx;
+    StorageHostFile* file_data = storage_get_storage_file_data(file, storage);
+    bool success = (file_data->fd < 0) || (close(file_data->fd) == 0);
+    storage_host_file_result(file, success);
+    free(file_data);
+    return (file->error_id == FSE_OK);
+}
+
+static uint16_t
+    storage_host_file_read(void* ctx, File* file, void* buff, uint16_t const bytes_to_read) {
+    StorageData* storage = ctx;
+    StorageHostFile* file_data = storage_get_storage_file_data(file, storage);
+
+    ssize_t bytes_read = read(file_data->fd, buff, bytes_to_read);
+    storage_host_file_result(file, bytes_read >= 0);
+    return (bytes_read > 0) ? bytes_read : 0;
+}
+
+static uint16_t storage_host_file_write(
+    void* ctx,
+    File* file,
+    const void* buff,
+    uint16_t const bytes_to_write) {
+    StorageData* storage = ctx;
+    StorageHostFile* file_data = storage_get_storage_file_data(file, storage);
+
+    ssize_t bytes_written = write(file_data->fd, buff, bytes_to_write);
+    storage_host_file_result(file, bytes_written >= 0);
+    return (bytes_written > 0) ? bytes_written : 0;
+}
+
+static bool
+    storage_host_file_seek(void* ctx, File* file, const uint32_t offset, const bool from_start) {
+    StorageData* storage = ctx;
+    StorageHostFile* file_data = storage_get_storage_file_data(file, storage);
+
+    off_t position = lseek(file_data->fd, offset, from_start ? SEEK_SET : SEEK_CUR);
+    return storage_host_file_result(file, position >= 0);
+}
+
+static uint64_t storage_host_file_tell(void* ctx, File* file) {
+    StorageData* storage = ctx;
+    StorageHostFile* file_data = storage_get_storage_file_data(file, storage);
+
+    off_t position = lseek(file_data->fd, 0, SEEK_CUR);
+    storage_host_file_result(file, position >= 0);
+    return (position > 0) ? position : 0;
+}
+
+static bool storage_host_file_truncate(void* ctx, File* file) {
+    StorageData* storage = ctx;
+    StorageHostFile* file_data = storage_get_storage_file_data(file, storage);
+
+    off_t position = lseek(file_data->fd, 0, SEEK_CUR);
+    bool success = (position >= 0) && (ftruncate(file_data->fd, position) == 0);
+    return storage_host_file_result(file, success);
+}
+
+static bool storage_host_file_sync(void* ctx, File* file) {
+    StorageData* storage = ctx;
+    StorageHostFile* file_data = storage_get_storage_file_data(file, storage);
+
+    return storage_host_file_result(file, fsync(file_data->fd) == 0);
+}
+
+static uint64_t storage_host_file_size(void* ctx, File* file) {
+    StorageData* storage = ctx;
+    StorageHostFile* file_data = storage_get_storage_file_data(file, storage);
+
+    struct stat file_stat;
+    bool success = (fstat(file_data->fd, &file_stat) == 0);
+    storage_host_file_result(file, success);
+    return success ? file_stat.st_size : 0;
+}
+
+static bool storage_host_file_eof(void* ctx, File* file) {
+    StorageData* storage = ctx;
+    StorageHostFile* file_data = storage_get_storage_file_data(file, storage);
+
+    struct stat file_stat;
+    off_t position = lseek(file_data->fd, 0, SEEK_CUR);
+    bool success = (position >= 0) && (fstat(file_data->fd, &file_stat) == 0);
+    storage_host_file_result(file, success);
+    return success ? (position >= file_stat.st_size) : true;
+}
+
+/******************* Dir Functions *******************/
+
+static bool storage_host_dir_open(void* ctx, File* file, const char* path) {
+    StorageData* storage = ctx;
+
+    StorageHostDir* file_data = malloc(sizeof(StorageHostDir));
+    storage_set_storage_file_data(file, file_data, storage);
+    storage_host_path(storage, file_data->path, path);
+    file_data->dir = opendir(string_get_cstr(file_data->path));
+    return storage_host_file_result(file, file_data->dir != NULL);
+}
+
+static bool storage_host_dir_close(void* ctx, File* file) {
+    StorageData* storage = ctx;
+    StorageHostDir* file_data = storage_get_storage_file_data(file, storage);
+
+    bool success = (file_data->dir == NULL) || (closedir(file_data->dir) == 0);
+    storage_host_file_result(file, success);
+    string_clear(file_data->path);
+    free(file_data);
+    return (file->error_id == FSE_OK);
+}
+
+static bool storage_host_dir_read(
+    void* ctx,
+    File* file,
+    FileInfo* fileinfo,
+    char* name,
+    const uint16_t name_length) {
+    StorageData* storage = ctx;
+    StorageHostDir* file_data = storage_get_storage_file_data(file, storage);
+
+    struct dirent* entry;
+    errno = 0;
+    do {
+        entry = readdir(file_data->dir);
+    } while(entry && (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0));
+
+    if(entry == NULL) {
+        storage_host_file_result(file, errno == 0);
+        if(file->error_id == FSE_OK) file->error_id = FSE_NOT_EXIST;
+        return false;
+    }
+
+    if(fileinfo != NULL) {
+        string_t entry_path;
+        string_init_printf(
+            entry_path, "%s/%s", string_get_cstr(file_data->path), entry->d_name);
+        struct stat entry_stat;
+        if(stat(string_get_cstr(entry_path), &entry_stat) == 0) {
+            fileinfo->size = entry_stat.st_size;
+            fileinfo->flags = S_ISDIR(entry_stat.st_mode) ? FSF_DIRECTORY : 0;
+        } else {
+            fileinfo->size = 0;
+            fileinfo->flags = 0;
+        }
+        string_clear(entry_path);
+    }
+
+    if(name != NULL) {
+        snprintf(name, name_length, "%s", entry->d_name);
+    }
+
+    return storage_host_file_result(file, true);
+}
+
+static bool storage_host_dir_rewind(void* ctx, File* file) {
+    StorageData* storage = ctx;
+    StorageHostDir* file_data = storage_get_storage_file_data(file, storage);
+
+    rewinddir(file_data->dir);
+    return storage_host_file_result(file, true);
+}
+
+/******************* Common FS Functions *******************/
+
+static FS_Error storage_host_common_stat(void* ctx, const char* path, FileInfo* fileinfo) {
+    string_t host_path;
+    storage_host_path(ctx, host_path, path);
+    struct stat path_stat;
+    int result = stat(string_get_cstr(host_path), &path_stat);
+    string_clear(host_path);
+
+    if(result != 0) {
+        return storage_host_parse_error(errno);
+    }
+
+    if(fileinfo != NULL) {
+        fileinfo->size = path_stat.st_size;
+        fileinfo->flags = S_ISDIR(path_stat.st_mode) ? FSF_DIRECTORY : 0;
+    }
+    return FSE_OK;
+}
+
+static FS_Error storage_host_common_remove(void* ctx, const char* path) {
+    string_t host_path;
+    storage_host_path(ctx, host_path, path);
+    // f_unlink removes both files and empty directories
+    int result = remove(string_get_cstr(host_path));
+    string_clear(host_path);
+    return storage_host_parse_error(result == 0 ? 0 : errno);
+}
+
+static FS_Error storage_host_common_rename(void* ctx, const char* old_path, const char* new_path) {
+    string_t host_old_path;
+    string_t host_new_path;
+    storage_host_path(ctx, host_old_path, old_path);
+    storage_host_path(ctx, host_new_path, new_path);
+
+    int result = -1;
+    // FatFs refuses to overwrite, keep it that way
+    if(access(string_get_cstr(host_new_path), F_OK) == 0) {
+        errno = EEXIST;
+    } else {
+        result = rename(string_get_cstr(host_old_path), string_get_cstr(host_new_path));
+    }
+
+    string_clear(host_old_path);
+    string_clear(host_new_path);
+    return storage_host_parse_error(result == 0 ? 0 : errno);
+}
+
+static FS_Error storage_host_common_mkdir(void* ctx, const char* path) {
+    string_t host_path;
+    storage_host_path(ctx, host_path, path);
+    int result = mkdir(string_get_cstr(host_path), 0755);
+    string_clear(host_path);
+    return storage_host_parse_error(result == 0 ? 0 : errno);
+}
+
+static FS_Error storage_host_common_fs_info(
+    void* ctx,
+    const char* fs_path,
+    uint64_t* total_space,
+    uint64_t* free_space) {
+    StorageData* storage = ctx;
+    StorageHostData* host_data = storage->data;
+
+    struct statvfs fs_stat;
+    if(statvfs(string_get_cstr(host_data->root), &fs_stat) != 0) {
+        return storage_host_parse_error(errno);
+    }
+
+    if(total_space != NULL) {
+        *total_space = (uint64_t)fs_stat.f_blocks * fs_stat.f_frsize;
+    }
+    if(free_space != NULL) {
+        *free_space = (uint64_t)fs_stat.f_bavail * fs_stat.f_frsize;
+    }
+    return FSE_OK;
+}
+
+/******************* SD API *******************/
+
+FS_Error sd_unmount_card(StorageData* storage) {
+    storage->status = StorageStatusNotReady;
+    return FSE_OK;
+}
+
+FS_Error sd_format_card(StorageData* storage) {
+    return FSE_NOT_IMPLEMENTED;
+}
+
+FS_Error sd_card_info(StorageData* storage, SDInfo* sd_info) {
+    uint64_t total_space = 0;
+    uint64_t free_space = 0;
+    FS_Error error = storage_host_common_fs_info(storage, "/", &total_space, &free_space);
+
+    memset(sd_info, 0, sizeof(SDInfo));
+    sd_info->fs_type = FST_EXFAT;
+    sd_info->kb_total = total_space / 1024;
+    sd_info->kb_free = free_space / 1024;
+    sd_info->sector_size = 512;
+    snprintf(sd_info->label, SD_LABEL_LENGTH, "HOST");
+    sd_info->error = error;
+
+    return error;
+}
+
+/******************* Init Storage *******************/
+
+void storage_host_init(StorageData* storage, const char* name) {
+    StorageHostData* host_data = furi_alloc(sizeof(StorageHostData));
+
+    const char* root = getenv("FURI_HOST_STORAGE");
+    if(root == NULL) root = STORAGE_HOST_ROOT_DEFAULT;
+    mkdir(root, 0755);
+    string_init_printf(host_data->root, "%s/%s", root, name);
+
+    storage->data = host_data;
+    storage->api.tick = NULL;
+    storage->fs_api.file.open = storage_host_file_open;
+    storage->fs_api.file.close = storage_host_file_close;
+    storage->fs_api.file.read = storage_host_file_read;
+    storage->fs_api.file.write = storage_host_file_write;
+    storage->fs_api.file.seek = storage_host_file_seek;
+    storage->fs_api.file.tell = storage_host_file_tell;
+    storage->fs_api.file.truncate = storage_host_file_truncate;
+    storage->fs_api.file.size = storage_host_file_size;
+    storage->fs_api.file.sync = storage_host_file_sync;
+    storage->fs_api.file.eof = storage_host_file_eof;
+
+    storage->fs_api.dir.open = storage_host_dir_open;
+    storage->fs_api.dir.close = storage_host_dir_close;
+    storage->fs_api.dir.read = storage_host_dir_read;
+    storage->fs_api.dir.rewind = storage_host_dir_rewind;
+
+    storage->fs_api.common.stat = storage_host_common_stat;
+    storage->fs_api.common.mkdir = storage_host_common_mkdir;
+    storage->fs_api.common.rename = storage_host_common_rename;
+    storage->fs_api.common.remove = storage_host_common_remove;
+    storage->fs_api.common.fs_info = storage_host_common_fs_info;
+
+    int result = mkdir(string_get_cstr(host_data->root), 0755);
+    if(result == 0 || errno == EEXIST) {
+        storage->status = StorageStatusOK;
+        FURI_LOG_I(TAG, "%s mapped to %s", name, string_get_cstr(host_data->root));
+    } else {
+        storage->status = StorageStatusNotAccessible;
+        FURI_LOG_E(TAG, "%s: cannot create %s", name, string_get_cstr(host_data->root));
+    }
+}
+
+#endif
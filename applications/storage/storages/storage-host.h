@@ -0,0 +1,26 @@
+#pragma once
+#include <furi.h>
+#include "../storage-glue.h"
+#include "../storage-sd-api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Host storage root, overridden by FURI_HOST_STORAGE environment variable */
+#define STORAGE_HOST_ROOT_DEFAULT "storage"
+
+/** Init storage backed by host directory
+ *
+ * @param storage storage data to init
+ * @param name storage name, used as subdirectory of host storage root
+ */
+void storage_host_init(StorageData* storage, const char* name);
+
+FS_Error sd_unmount_card(StorageData* storage);
+FS_Error sd_format_card(StorageData* storage);
+FS_Error sd_card_info(StorageData* storage, SDInfo* sd_info);
+
+#ifdef __cplusplus
+}
+#endif
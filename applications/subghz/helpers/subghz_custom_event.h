@@ -20,6 +20,7 @@ typedef enum {
     SubghzCustomEventViewReceverOK,
     SubghzCustomEventViewReceverConfig,
     SubghzCustomEventViewReceverBack,
+    SubghzCustomEventViewReceverUpdate,
 
     SubghzCustomEventViewReadRAWBack,
     SubghzCustomEventViewReadRAWIDLE,
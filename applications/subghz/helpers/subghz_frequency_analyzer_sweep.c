@@ -0,0 +1,171 @@
+#include "subghz_frequency_analyzer_sweep.h"
+
+#include <furi.h>
+
+#define SUBGHZ_FREQUENCY_ANALYZER_SWEEP_DWELL_MIN 600
+#define SUBGHZ_FREQUENCY_ANALYZER_SWEEP_DWELL_MAX 3000
+/* Variance at which dwell saturates, dB^2 */
+#define SUBGHZ_FREQUENCY_ANALYZER_SWEEP_VARIANCE_MAX 16.0f
+/* EWMA coefficient for per-channel RSSI statistic */
+#define SUBGHZ_FREQUENCY_ANALYZER_SWEEP_ALPHA 0.25f
+
+typedef struct {
+    float mean;
+    float variance;
+    uint32_t dwell_us;
+} SubGhzFrequencyAnalyzerSweepChannel;
+
+struct SubGhzFrequencyAnalyzerSweep {
+    const uint32_t* frequencies;
+    size_t frequencies_count;
+    SubGhzFrequencyAnalyzerSweepChannel* channels;
+
+    uint32_t dwell_min_us;
+    uint32_t dwell_max_us;
+
+    size_t measure_count;
+    uint32_t dwell_total;
+
+    SubGhzFrequencyAnalyzerSweepMeasure measure;
+    void* context;
+};
+
+static float subghz_frequency_analyzer_sweep_measure(
+    SubGhzFrequencyAnalyzerSweep* instance,
+    uint32_t* frequency,
+    uint32_t dwell_us) {
+    instance->measure_count++;
+    instance->dwell_total += dwell_us;
+    return instance->measure(instance->context, frequency, dwell_us);
+}
+
+static void subghz_frequency_analyzer_sweep_channel_update(
+    SubGhzFrequencyAnalyzerSweep* instance,
+    SubGhzFrequencyAnalyzerSweepChannel* channel,
+    float rssi) {
+    const float alpha = SUBGHZ_FREQUENCY_ANALYZER_SWEEP_ALPHA;
+    float delta = rssi - channel->mean;
+    channel->mean += alpha * delta;
+    channel->variance = (1.0f - alpha) * (channel->variance + alpha * delta * delta);
+
+    // Quiet channels settle fast, busy ones need time for AGC to follow the burst
+    float k = channel->variance / SUBGHZ_FREQUENCY_ANALYZER_SWEEP_VARIANCE_MAX;
+    if(k > 1.0f) k = 1.0f;
+    channel->dwell_us =
+        instance->dwell_min_us + (uint32_t)(k * (instance->dwell_max_us - instance->dwell_min_us));
+}
+
+SubGhzFrequencyAnalyzerSweep* subghz_frequency_analyzer_sweep_alloc(
+    const uint32_t* frequencies,
+    size_t frequencies_count,
+    SubGhzFrequencyAnalyzerSweepMeasure measure,
+    void* context) {
+    furi_assert(frequencies);
+    furi_assert(measure);
+    SubGhzFrequencyAnalyzerSweep* instance = furi_alloc(sizeof(SubGhzFrequencyAnalyzerSweep));
+
+    instance->frequencies = frequencies;
+    instance->frequencies_count = frequencies_count;
+    instance->channels =
+        furi_alloc(sizeof(SubGhzFrequencyAnalyzerSweepChannel) * frequencies_count);
+    instance->measure = measure;
+    instance->context = context;
+
+    subghz_frequency_analyzer_sweep_set_dwell(
+        instance,
+        SUBGHZ_FREQUENCY_ANALYZER_SWEEP_DWELL_MIN,
+        SUBGHZ_FREQUENCY_ANALYZER_SWEEP_DWELL_MAX);
+
+    return instance;
+}
+
+void subghz_frequency_analyzer_sweep_free(SubGhzFrequencyAnalyzerSweep* instance) {
+    furi_assert(instance);
+    free(instance->channels);
+    free(instance);
+}
+
+void subghz_frequency_analyzer_sweep_set_dwell(
+    SubGhzFrequencyAnalyzerSweep* instance,
+    uint32_t dwell_min_us,
+    uint32_t dwell_max_us) {
+    furi_assert(instance);
+    furi_assert(dwell_min_us <= dwell_max_us);
+    instance->dwell_min_us = dwell_min_us;
+    instance->dwell_max_us = dwell_max_us;
+    for(size_t i = 0; i < instance->frequencies_count; i++) {
+        instance->channels[i].mean = SUBGHZ_FREQUENCY_ANALYZER_SWEEP_RSSI_MIN;
+        instance->channels[i].variance = 0.0f;
+        instance->channels[i].dwell_us = dwell_min_us;
+    }
+}
+
+FrequencyRSSI subghz_frequency_analyzer_sweep_coarse(SubGhzFrequencyAnalyzerSweep* instance) {
+    furi_assert(instance);
+    FrequencyRSSI frequency_rssi = {
+        .frequency = 0, .rssi = SUBGHZ_FREQUENCY_ANALYZER_SWEEP_RSSI_MIN};
+
+    instance->measure_count = 0;
+    instance->dwell_total = 0;
+
+    for(size_t i = 0; i < instance->frequencies_count; i++) {
+        SubGhzFrequencyAnalyzerSweepChannel* channel = &instance->channels[i];
+        uint32_t frequency = instance->frequencies[i];
+        float rssi =
+            subghz_frequency_analyzer_sweep_measure(instance, &frequency, channel->dwell_us);
+        subghz_frequency_analyzer_sweep_channel_update(instance, channel, rssi);
+        if(frequency_rssi.rssi < rssi) {
+            frequency_rssi.rssi = rssi;
+            frequency_rssi.frequency = frequency;
+        }
+    }
+
+    return frequency_rssi;
+}
+
+FrequencyRSSI subghz_frequency_analyzer_sweep_refine(
+    SubGhzFrequencyAnalyzerSweep* instance,
+    FrequencyRSSI frequency_rssi,
+    uint32_t span,
+    uint32_t step_min) {
+    furi_assert(instance);
+    furi_assert(step_min);
+
+    const uint32_t dwell = instance->dwell_max_us;
+    FrequencyRSSI center = frequency_rssi;
+    center.rssi = subghz_frequency_analyzer_sweep_measure(instance, &center.frequency, dwell);
+
+    for(uint32_t step = span / 2; step; step /= 2) {
+        FrequencyRSSI best = center;
+
+        uint32_t frequency = center.frequency - step;
+        float rssi = subghz_frequency_analyzer_sweep_measure(instance, &frequency, dwell);
+        if(best.rssi < rssi) {
+            best.rssi = rssi;
+            best.frequency = frequency;
+        }
+
+        frequency = center.frequency + step;
+        rssi = subghz_frequency_analyzer_sweep_measure(instance, &frequency, dwell);
+        if(best.rssi < rssi) {
+            best.rssi = rssi;
+            best.frequency = frequency;
+        }
+
+        center = best;
+        // Stop once resolution is reached, not before
+        if(step <= step_min) break;
+    }
+
+    return center;
+}
+
+size_t subghz_frequency_analyzer_sweep_get_measure_count(SubGhzFrequencyAnalyzerSweep* instance) {
+    furi_assert(instance);
+    return instance->measure_count;
+}
+
+uint32_t subghz_frequency_analyzer_sweep_get_dwell_total(SubGhzFrequencyAnalyzerSweep* instance) {
+    furi_assert(instance);
+    return instance->dwell_total;
+}
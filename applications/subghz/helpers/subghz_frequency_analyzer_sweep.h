@@ -0,0 +1,92 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "subghz_frequency_analyzer_worker.h"
+
+#define SUBGHZ_FREQUENCY_ANALYZER_SWEEP_RSSI_MIN (-127.0f)
+
+typedef struct SubGhzFrequencyAnalyzerSweep SubGhzFrequencyAnalyzerSweep;
+
+/** Measure RSSI callback
+ * Must tune radio to frequency, wait dwell_us and return RSSI.
+ * Return SUBGHZ_FREQUENCY_ANALYZER_SWEEP_RSSI_MIN for unusable frequency.
+ * 
+ * @param context 
+ * @param frequency frequency to measure, set to frequency radio was tuned to, Hz
+ * @param dwell_us time to settle before RSSI is read, us
+ * @return RSSI, dBm
+ */
+typedef float (*SubGhzFrequencyAnalyzerSweepMeasure)(
+    void* context,
+    uint32_t* frequency,
+    uint32_t dwell_us);
+
+/** Allocate SubGhzFrequencyAnalyzerSweep
+ * 
+ * @param frequencies coarse frequency table
+ * @param frequencies_count coarse frequency table size
+ * @param measure RSSI measure callback
+ * @param context measure callback context
+ * @return SubGhzFrequencyAnalyzerSweep* 
+ */
+SubGhzFrequencyAnalyzerSweep* subghz_frequency_analyzer_sweep_alloc(
+    const uint32_t* frequencies,
+    size_t frequencies_count,
+    SubGhzFrequencyAnalyzerSweepMeasure measure,
+    void* context);
+
+/** Free SubGhzFrequencyAnalyzerSweep
+ * 
+ * @param instance SubGhzFrequencyAnalyzerSweep instance
+ */
+void subghz_frequency_analyzer_sweep_free(SubGhzFrequencyAnalyzerSweep* instance);
+
+/** Set dwell limits
+ * Channels with stable RSSI are measured with dwell_min_us,
+ * dwell grows towards dwell_max_us with RSSI variance.
+ * 
+ * @param instance SubGhzFrequencyAnalyzerSweep instance
+ * @param dwell_min_us minimal dwell, us
+ * @param dwell_max_us maximal dwell, us
+ */
+void subghz_frequency_analyzer_sweep_set_dwell(
+    SubGhzFrequencyAnalyzerSweep* instance,
+    uint32_t dwell_min_us,
+    uint32_t dwell_max_us);
+
+/** Run coarse pass over frequency table
+ * 
+ * @param instance SubGhzFrequencyAnalyzerSweep instance
+ * @return FrequencyRSSI strongest channel
+ */
+FrequencyRSSI subghz_frequency_analyzer_sweep_coarse(SubGhzFrequencyAnalyzerSweep* instance);
+
+/** Binary coarse-to-fine refinement around frequency
+ * Step starts at span/2 and halves, last pass is done with step at or below step_min.
+ * 
+ * @param instance SubGhzFrequencyAnalyzerSweep instance
+ * @param frequency_rssi coarse result
+ * @param span initial search half-width, Hz
+ * @param step_min refinement resolution, Hz
+ * @return FrequencyRSSI refined result
+ */
+FrequencyRSSI subghz_frequency_analyzer_sweep_refine(
+    SubGhzFrequencyAnalyzerSweep* instance,
+    FrequencyRSSI frequency_rssi,
+    uint32_t span,
+    uint32_t step_min);
+
+/** Get number of measurements done in last coarse and refine passes
+ * 
+ * @param instance SubGhzFrequencyAnalyzerSweep instance
+ * @return measurements count
+ */
+size_t subghz_frequency_analyzer_sweep_get_measure_count(SubGhzFrequencyAnalyzerSweep* instance);
+
+/** Get accumulated dwell of last coarse and refine passes
+ * 
+ * @param instance SubGhzFrequencyAnalyzerSweep instance
+ * @return dwell time, us
+ */
+uint32_t subghz_frequency_analyzer_sweep_get_dwell_total(SubGhzFrequencyAnalyzerSweep* instance);
@@ -1,10 +1,15 @@
 #include "subghz_frequency_analyzer_worker.h"
+#include "subghz_frequency_analyzer_sweep.h"
 #include <lib/drivers/cc1101_regs.h>
 
 #include <furi.h>
 
 #include "../subghz_i.h"
 
+#define SUBGHZ_FREQUENCY_ANALYZER_THRESHOLD -90.0f
+#define SUBGHZ_FREQUENCY_ANALYZER_REFINE_SPAN 500000
+#define SUBGHZ_FREQUENCY_ANALYZER_REFINE_STEP 10000
+
 static const uint8_t subghz_preset_ook_58khz[][2] = {
     {CC1101_FIFOTHR, 0x47}, // The only important bit is ADC_RETENTION, FIFO Tx=33 Rx=32
     {CC1101_MDMCFG4, 0xF5}, // Rx BW filter is 58.035714kHz
@@ -28,6 +33,8 @@ struct SubGhzFrequencyAnalyzerWorker {
 
     volatile bool worker_running;
     uint8_t count_repet;
+    uint32_t dwell_min_us;
+    uint32_t dwell_max_us;
     FrequencyRSSI frequency_rssi_buf;
 
     float filVal;
@@ -52,6 +59,38 @@ static uint32_t subghz_frequency_analyzer_worker_expRunningAverageAdaptive(
     return (uint32_t)instance->filVal;
 }
 
+/** Sweep measure callback, tunes radio and reads RSSI after dwell
+ * 
+ * @param context 
+ * @param frequency frequency, Hz
+ * @param dwell_us settle time, us
+ * @return RSSI, dBm
+ */
+static float subghz_frequency_analyzer_worker_measure(
+    void* context,
+    uint32_t* frequency,
+    uint32_t dwell_us) {
+    if(!furi_hal_subghz_is_frequency_valid(*frequency)) {
+        return SUBGHZ_FREQUENCY_ANALYZER_SWEEP_RSSI_MIN;
+    }
+    furi_hal_subghz_idle();
+    *frequency = furi_hal_subghz_set_frequency(*frequency);
+    furi_hal_subghz_rx();
+
+    // Sleep while more than a tick is left, osDelay(1) can't overshoot then.
+    // Spin the sub-tick rest on cycle counter, so dwell is not rounded up to tick.
+    uint32_t cycles_per_us = furi_hal_delay_get_cycles_per_us();
+    uint32_t tick_cycles = cycles_per_us * (1000000 / osKernelGetTickFreq());
+    uint32_t dwell_cycles = dwell_us * cycles_per_us;
+    uint32_t start = furi_hal_delay_get_cycles();
+    while(true) {
+        uint32_t elapsed = furi_hal_delay_get_cycles() - start;
+        if(elapsed >= dwell_cycles) break;
+        if(dwell_cycles - elapsed > tick_cycles) osDelay(1);
+    }
+    return furi_hal_subghz_get_rssi();
+}
+
 /** Worker thread
  * 
  * @param context 
@@ -61,9 +100,22 @@ static int32_t subghz_frequency_analyzer_worker_thread(void* context) {
     SubGhzFrequencyAnalyzerWorker* instance = context;
 
     FrequencyRSSI frequency_rssi = {.frequency = 0, .rssi = 0};
-    float rssi;
-    uint32_t frequency;
-    uint32_t frequency_start;
+
+    // Drop frequencies unsupported by hardware once, not every pass
+    uint32_t* frequencies = furi_alloc(sizeof(uint32_t) * subghz_frequencies_count);
+    size_t frequencies_count = 0;
+    for(size_t i = 0; i < subghz_frequencies_count; i++) {
+        if(furi_hal_subghz_is_frequency_valid(subghz_frequencies[i])) {
+            frequencies[frequencies_count++] = subghz_frequencies[i];
+        }
+    }
+
+    SubGhzFrequencyAnalyzerSweep* sweep = subghz_frequency_analyzer_sweep_alloc(
+        frequencies, frequencies_count, subghz_frequency_analyzer_worker_measure, instance);
+    if(instance->dwell_max_us) {
+        subghz_frequency_analyzer_sweep_set_dwell(
+            sweep, instance->dwell_min_us, instance->dwell_max_us);
+    }
 
     //Start CC1101
     furi_hal_subghz_reset();
@@ -73,47 +125,23 @@ static int32_t subghz_frequency_analyzer_worker_thread(void* context) {
     furi_hal_subghz_rx();
 
     while(instance->worker_running) {
-        osDelay(10);
-        frequency_rssi.rssi = -127.0f;
+        // Yield even if there is no valid frequency to measure
+        osDelay(1);
         furi_hal_subghz_idle();
         furi_hal_subghz_load_registers(subghz_preset_ook_650khz);
-        for(size_t i = 0; i < subghz_frequencies_count; i++) {
-            if(furi_hal_subghz_is_frequency_valid(subghz_frequencies[i])) {
-                furi_hal_subghz_idle();
-                frequency = furi_hal_subghz_set_frequency(subghz_frequencies[i]);
-                furi_hal_subghz_rx();
-                osDelay(3);
-                rssi = furi_hal_subghz_get_rssi();
-                if(frequency_rssi.rssi < rssi) {
-                    frequency_rssi.rssi = rssi;
-                    frequency_rssi.frequency = frequency;
-                }
-            }
-        }
+        frequency_rssi = subghz_frequency_analyzer_sweep_coarse(sweep);
 
-        if(frequency_rssi.rssi > -90.0) {
-            //  -0.5 ... 433.92 ... +0.5
-            frequency_start = frequency_rssi.frequency - 250000;
-            //step 10KHz
-            frequency_rssi.rssi = -127.0;
+        if(frequency_rssi.rssi > SUBGHZ_FREQUENCY_ANALYZER_THRESHOLD) {
             furi_hal_subghz_idle();
             furi_hal_subghz_load_registers(subghz_preset_ook_58khz);
-            for(uint32_t i = frequency_start; i < frequency_start + 500000; i += 10000) {
-                if(furi_hal_subghz_is_frequency_valid(i)) {
-                    furi_hal_subghz_idle();
-                    frequency = furi_hal_subghz_set_frequency(i);
-                    furi_hal_subghz_rx();
-                    osDelay(3);
-                    rssi = furi_hal_subghz_get_rssi();
-                    if(frequency_rssi.rssi < rssi) {
-                        frequency_rssi.rssi = rssi;
-                        frequency_rssi.frequency = frequency;
-                    }
-                }
-            }
+            frequency_rssi = subghz_frequency_analyzer_sweep_refine(
+                sweep,
+                frequency_rssi,
+                SUBGHZ_FREQUENCY_ANALYZER_REFINE_SPAN,
+                SUBGHZ_FREQUENCY_ANALYZER_REFINE_STEP);
         }
 
-        if(frequency_rssi.rssi > -90.0) {
+        if(frequency_rssi.rssi > SUBGHZ_FREQUENCY_ANALYZER_THRESHOLD) {
             instance->count_repet = 20;
             if(instance->filVal) {
                 frequency_rssi.frequency =
@@ -138,6 +166,9 @@ static int32_t subghz_frequency_analyzer_worker_thread(void* context) {
     furi_hal_subghz_idle();
     furi_hal_subghz_sleep();
 
+    subghz_frequency_analyzer_sweep_free(sweep);
+    free(frequencies);
+
     return 0;
 }
 
@@ -171,6 +202,17 @@ void subghz_frequency_analyzer_worker_set_pair_callback(
     instance->context = context;
 }
 
+void subghz_frequency_analyzer_worker_set_dwell(
+    SubGhzFrequencyAnalyzerWorker* instance,
+    uint32_t dwell_min_us,
+    uint32_t dwell_max_us) {
+    furi_assert(instance);
+    furi_assert(!instance->worker_running);
+    furi_assert(dwell_min_us <= dwell_max_us);
+    instance->dwell_min_us = dwell_min_us;
+    instance->dwell_max_us = dwell_max_us;
+}
+
 void subghz_frequency_analyzer_worker_start(SubGhzFrequencyAnalyzerWorker* instance) {
     furi_assert(instance);
     furi_assert(!instance->worker_running);
@@ -35,6 +35,17 @@ void subghz_frequency_analyzer_worker_set_pair_callback(
     SubGhzFrequencyAnalyzerWorkerPairCallback callback,
     void* context);
 
+/** Set sweep dwell limits, must be called before start
+ * 
+ * @param instance SubGhzFrequencyAnalyzerWorker instance
+ * @param dwell_min_us dwell for channels with stable RSSI, us
+ * @param dwell_max_us dwell for busy channels and refinement, us
+ */
+void subghz_frequency_analyzer_worker_set_dwell(
+    SubGhzFrequencyAnalyzerWorker* instance,
+    uint32_t dwell_min_us,
+    uint32_t dwell_max_us);
+
 /** Start SubGhzFrequencyAnalyzerWorker
  * 
  * @param instance SubGhzFrequencyAnalyzerWorker instance
@@ -36,46 +36,55 @@ void subghz_scene_receiver_callback(SubghzCustomEvent event, void* context) {
     view_dispatcher_send_custom_event(subghz->view_dispatcher, event);
 }
 
+/* Menu item callback, called on GUI thread from scene events and menu input */
+static uint8_t subghz_scene_receiver_get_item(void* context, uint16_t idx, string_t item_str) {
+    SubGhz* subghz = context;
+    subghz_history_get_text_item_menu(subghz->txrx->history, item_str, idx);
+    return subghz_history_get_type_protocol(subghz->txrx->history, idx);
+}
+
+static void subghz_scene_receiver_update_history(SubGhz* subghz) {
+    // Spill file and menu are only touched here, on GUI thread
+    subghz_history_flush(subghz->txrx->history);
+
+    uint16_t shown = scene_manager_get_scene_state(subghz->scene_manager, SubGhzSceneReceiver);
+    uint16_t idx;
+    while(subghz_history_pop_changed(subghz->txrx->history, &idx)) {
+        if(idx >= shown) continue;
+        subghz_receiver_update_item_in_menu(subghz->subghz_receiver, idx);
+    }
+
+    uint16_t count = subghz_history_get_item(subghz->txrx->history);
+    if(count != shown) {
+        subghz_receiver_set_history_item(subghz->subghz_receiver, count);
+        scene_manager_set_scene_state(subghz->scene_manager, SubGhzSceneReceiver, count);
+    }
+
+    subghz_scene_receiver_update_statusbar(subghz);
+}
+
 void subghz_scene_add_to_history_callback(SubGhzProtocolCommon* parser, void* context) {
     furi_assert(context);
     SubGhz* subghz = context;
-    string_t str_buff;
-    string_init(str_buff);
 
+    // Worker thread: history only keeps record in RAM, menu is updated on GUI thread
     if(subghz_history_add_to_history(
            subghz->txrx->history, parser, subghz->txrx->frequency, subghz->txrx->preset)) {
         subghz_parser_reset(subghz->txrx->parser);
-        string_reset(str_buff);
-        subghz_history_get_text_item_menu(
-            subghz->txrx->history, str_buff, subghz_history_get_item(subghz->txrx->history) - 1);
-        subghz_receiver_add_item_to_menu(
-            subghz->subghz_receiver,
-            string_get_cstr(str_buff),
-            subghz_history_get_type_protocol(
-                subghz->txrx->history, subghz_history_get_item(subghz->txrx->history) - 1));
-        subghz_scene_receiver_update_statusbar(subghz);
+        view_dispatcher_send_custom_event(
+            subghz->view_dispatcher, SubghzCustomEventViewReceverUpdate);
     }
-    string_clear(str_buff);
 }
 
 void subghz_scene_receiver_on_enter(void* context) {
     SubGhz* subghz = context;
 
-    string_t str_buff;
-    string_init(str_buff);
-
     //Load history to receiver
     subghz_receiver_exit(subghz->subghz_receiver);
-    for(uint8_t i = 0; i < subghz_history_get_item(subghz->txrx->history); i++) {
-        string_reset(str_buff);
-        subghz_history_get_text_item_menu(subghz->txrx->history, str_buff, i);
-        subghz_receiver_add_item_to_menu(
-            subghz->subghz_receiver,
-            string_get_cstr(str_buff),
-            subghz_history_get_type_protocol(subghz->txrx->history, i));
-    }
-    string_clear(str_buff);
-    subghz_scene_receiver_update_statusbar(subghz);
+    subghz_receiver_set_item_callback(
+        subghz->subghz_receiver, subghz_scene_receiver_get_item, subghz);
+    scene_manager_set_scene_state(subghz->scene_manager, SubGhzSceneReceiver, 0);
+    subghz_scene_receiver_update_history(subghz);
     subghz_receiver_set_callback(subghz->subghz_receiver, subghz_scene_receiver_callback, subghz);
     subghz_parser_enable_dump(subghz->txrx->parser, subghz_scene_add_to_history_callback, subghz);
 
@@ -106,6 +115,7 @@ bool subghz_scene_receiver_on_event(void* context, SceneManagerEvent event) {
                 subghz_sleep(subghz);
             };
             subghz_history_clean(subghz->txrx->history);
+            scene_manager_set_scene_state(subghz->scene_manager, SubGhzSceneReceiver, 0);
             subghz->txrx->hopper_state = SubGhzHopperStateOFF;
             subghz->txrx->frequency = subghz_frequencies[subghz_frequencies_433_92];
             subghz->txrx->preset = FuriHalSubGhzPresetOok650Async;
@@ -115,6 +125,10 @@ bool subghz_scene_receiver_on_event(void* context, SceneManagerEvent event) {
                 subghz->scene_manager, SubGhzSceneStart);
             return true;
             break;
+        case SubghzCustomEventViewReceverUpdate:
+            subghz_scene_receiver_update_history(subghz);
+            return true;
+            break;
         case SubghzCustomEventViewReceverOK:
             subghz->txrx->idx_menu_chosen = subghz_receiver_get_idx_menu(subghz->subghz_receiver);
             scene_manager_next_scene(subghz->scene_manager, SubGhzSceneReceiverInfo);
@@ -132,8 +146,9 @@ bool subghz_scene_receiver_on_event(void* context, SceneManagerEvent event) {
     } else if(event.type == SceneManagerEventTypeTick) {
         if(subghz->txrx->hopper_state != SubGhzHopperStateOFF) {
             subghz_hopper_update(subghz);
-            subghz_scene_receiver_update_statusbar(subghz);
         }
+        // Picks up repeat counters and spills records
+        subghz_scene_receiver_update_history(subghz);
 
         switch(subghz->state_notifications) {
         case SubGhzNotificationStateRX:
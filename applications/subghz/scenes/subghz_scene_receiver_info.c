@@ -19,14 +19,16 @@ void subghz_scene_receiver_info_callback(GuiButtonType result, InputType type, v
 
 static bool subghz_scene_receiver_info_update_parser(void* context) {
     SubGhz* subghz = context;
-    subghz->txrx->protocol_result = subghz_parser_get_by_name(
-        subghz->txrx->parser,
-        subghz_history_get_name(subghz->txrx->history, subghz->txrx->idx_menu_chosen));
+    // Record is lost if spill file can not be read
+    const char* name =
+        subghz_history_get_name(subghz->txrx->history, subghz->txrx->idx_menu_chosen);
+    SubGhzProtocolCommonLoad* raw_data =
+        subghz_history_get_raw_data(subghz->txrx->history, subghz->txrx->idx_menu_chosen);
+    if(name == NULL || raw_data == NULL) return false;
+    subghz->txrx->protocol_result = subghz_parser_get_by_name(subghz->txrx->parser, name);
 
     if(subghz->txrx->protocol_result->to_load_protocol != NULL) {
-        subghz->txrx->protocol_result->to_load_protocol(
-            subghz->txrx->protocol_result,
-            subghz_history_get_raw_data(subghz->txrx->history, subghz->txrx->idx_menu_chosen));
+        subghz->txrx->protocol_result->to_load_protocol(subghz->txrx->protocol_result, raw_data);
         subghz->txrx->frequency =
             subghz_history_get_frequency(subghz->txrx->history, subghz->txrx->idx_menu_chosen);
         subghz->txrx->preset =
@@ -180,6 +180,7 @@ SubGhz* subghz_alloc() {
     subghz->txrx->hopper_state = SubGhzHopperStateOFF;
     subghz->txrx->rx_key_state = SubGhzRxKeyStateIDLE;
     subghz->txrx->history = subghz_history_alloc();
+    subghz_history_set_spill_path(subghz->txrx->history, SUBGHZ_HISTORY_SPILL_PATH);
     subghz->txrx->worker = subghz_worker_alloc();
     subghz->txrx->parser = subghz_parser_alloc();
     subghz_worker_set_overrun_callback(
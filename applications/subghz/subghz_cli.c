@@ -270,6 +270,8 @@ static void subghz_cli_command_print_usage() {
     printf("Cmd list:\r\n");
     printf(
         "\tencrypt_keeloq <path_decrypted_file> <path_encrypted_file> <IV:16 bytes in hex>\t - Encrypt keeloq manufacture keys\r\n");
+    printf(
+        "\tcompile_keeloq <path_keystore_file> <path_binary_file> <IV:16 bytes in hex>\t - Compile keeloq manufacture keys to binary keystore\r\n");
     printf(
         "\tencrypt_raw <path_decrypted_file> <path_encrypted_file> <IV:16 bytes in hex>\t - Encrypt RAW data\r\n");
     printf("\tchat <frequency:in Herz>\t - Chat with other Flippers\r\n");
@@ -317,6 +319,55 @@ static void subghz_cli_command_encrypt_keeloq(Cli* cli, string_t args) {
     string_clear(source);
 }
 
+static void subghz_cli_command_compile_keeloq(Cli* cli, string_t args) {
+    uint8_t iv[16];
+
+    string_t source;
+    string_t destination;
+    string_init(source);
+    string_init(destination);
+
+    SubGhzKeystore* keystore = subghz_keystore_alloc();
+
+    do {
+        if(!args_read_string_and_trim(args, source)) {
+            subghz_cli_command_print_usage();
+            break;
+        }
+
+        if(!args_read_string_and_trim(args, destination)) {
+            subghz_cli_command_print_usage();
+            break;
+        }
+
+        if(!args_read_hex_bytes(args, iv, 16)) {
+            subghz_cli_command_print_usage();
+            break;
+        }
+
+        uint32_t cycles = DWT->CYCCNT;
+        if(!subghz_keystore_load(keystore, string_get_cstr(source))) {
+            printf("Failed to load Keystore");
+            break;
+        }
+        cycles = DWT->CYCCNT - cycles;
+        printf(
+            "Loaded %u keys in %lums\r\n",
+            SubGhzKeyArray_size(*subghz_keystore_get_data(keystore)),
+            cycles / (SystemCoreClock / 1000));
+        subghz_keystore_release_data(keystore);
+
+        if(!subghz_keystore_save_binary(keystore, string_get_cstr(destination), iv)) {
+            printf("Failed to save Keystore");
+            break;
+        }
+    } while(false);
+
+    subghz_keystore_free(keystore);
+    string_clear(destination);
+    string_clear(source);
+}
+
 static void subghz_cli_command_encrypt_raw(Cli* cli, string_t args) {
     uint8_t iv[16];
 
@@ -545,6 +596,11 @@ static void subghz_cli_command(Cli* cli, string_t args, void* context) {
             break;
         }
 
+        if(string_cmp_str(cmd, "compile_keeloq") == 0) {
+            subghz_cli_command_compile_keeloq(cli, args);
+            break;
+        }
+
         if(string_cmp_str(cmd, "encrypt_raw") == 0) {
             subghz_cli_command_encrypt_raw(cli, args);
             break;
@@ -562,6 +618,8 @@ static void subghz_cli_command(Cli* cli, string_t args, void* context) {
 }
 
 void subghz_cli_init() {
+    subghz_keystore_shared_init();
+
     Cli* cli = furi_record_open("cli");
 
     cli_add_command(
@@ -5,127 +5,635 @@
 
 #include <furi.h>
 #include <m-string.h>
+#include <m-array.h>
+#include <storage/storage.h>
 
-#define SUBGHZ_HISTORY_MAX 50
+#define TAG "SubGhzHistory"
 
-typedef struct SubGhzHistoryStruct SubGhzHistoryStruct;
+/* Default RAM budget for records, spill file takes the rest */
+#define SUBGHZ_HISTORY_RAM_BUDGET (4 * 1024)
+/* Every record keeps 9 byte identity and up to 4 bytes of index in RAM, 26KB when full */
+#define SUBGHZ_HISTORY_MAX 2048
+#define SUBGHZ_HISTORY_NONE UINT16_MAX
+/* Dedup index slots, power of two, table is kept at most half full */
+#define SUBGHZ_HISTORY_INDEX_SIZE_MIN 64
+#define SUBGHZ_HISTORY_STRING_NONE UINT8_MAX
+/* Pool slots only protocol names can take, keystore has more manufacture names than pool */
+#define SUBGHZ_HISTORY_STRING_PROTOCOLS 32
+/* Records and repeats waiting for GUI thread to write them to spill file */
+#define SUBGHZ_HISTORY_PENDING_MAX 8
+#define SUBGHZ_HISTORY_UPDATES_MAX 8
+#define SUBGHZ_HISTORY_CHANGED_MAX 8
+/* Bits 44-47 are ignored on dedup as they were for repeats before, the rest is compared */
+#define SUBGHZ_HISTORY_CODE_MASK 0xFFFF0FFFFFFFFFFF
 
-struct SubGhzHistoryStruct {
-    const char* name;
-    const char* manufacture_name;
-    uint8_t type_protocol;
-    uint8_t code_count_bit;
+typedef struct {
     uint64_t code_found;
-    uint16_t te;
-    FuriHalSubGhzPreset preset;
     uint32_t real_frequency;
-};
+    uint32_t first_seen;
+    uint32_t last_seen;
+    uint16_t te;
+    uint16_t count;
+    uint8_t name_id;
+    uint8_t manufacture_id;
+    uint8_t type_protocol;
+    uint8_t code_count_bit;
+    uint8_t preset;
+} __attribute__((packed)) SubGhzHistoryRecord;
+
+/* Dedup payload of every record, kept in RAM so repeats never touch SD */
+typedef struct {
+    uint64_t code;
+    uint8_t name_id;
+} __attribute__((packed)) SubGhzHistoryIdentity;
+
+/* Repeats of spilled record not written yet */
+typedef struct {
+    uint16_t idx;
+    uint16_t count;
+    uint32_t last_seen;
+} SubGhzHistoryUpdate;
+
+ARRAY_DEF(SubGhzHistoryRecordArray, SubGhzHistoryRecord, M_POD_OPLIST)
+ARRAY_DEF(SubGhzHistoryIdentityArray, SubGhzHistoryIdentity, M_POD_OPLIST)
+ARRAY_DEF(SubGhzHistoryStringPool, char*, M_PTR_OPLIST)
 
 struct SubGhzHistory {
-    uint32_t last_update_timestamp;
-    uint16_t last_index_write;
-    uint64_t code_last_found;
-    SubGhzHistoryStruct history[SUBGHZ_HISTORY_MAX];
+    osMutexId_t mutex;
+
+    SubGhzHistoryRecordArray_t records;
+    SubGhzHistoryIdentityArray_t identities;
+    SubGhzHistoryStringPool_t strings;
+    uint16_t* index;
+    size_t index_size;
+
+    size_t ram_budget;
+    uint16_t count;
+
+    // Records past RAM part: spilled ones on SD, then pending ones
+    uint16_t spilled;
+    SubGhzHistoryRecord pending[SUBGHZ_HISTORY_PENDING_MAX];
+    uint8_t pending_count;
+    SubGhzHistoryUpdate updates[SUBGHZ_HISTORY_UPDATES_MAX];
+    uint8_t updates_count;
+
+    uint16_t changed[SUBGHZ_HISTORY_CHANGED_MAX];
+    uint8_t changed_count;
+    // Too many changes to track, every record is reported
+    uint16_t changed_all;
+
+    // Spill file and cache are used from GUI thread only
+    Storage* storage;
+    File* spill_file;
+    string_t spill_path;
+    bool spill_failed;
+    SubGhzHistoryRecord spill_cache;
+    uint16_t spill_cache_idx;
+
     SubGhzProtocolCommonLoad data;
 };
 
+static void subghz_history_lock(SubGhzHistory* instance) {
+    furi_check(osMutexAcquire(instance->mutex, osWaitForever) == osOK);
+}
+
+static void subghz_history_unlock(SubGhzHistory* instance) {
+    furi_check(osMutexRelease(instance->mutex) == osOK);
+}
+
+/** Get pool id of name, name is copied as keystore can be unloaded while history lives
+ * @param limit - pool size new name can't be added at
+ * @return id or SUBGHZ_HISTORY_STRING_NONE if pool is full
+ */
+static uint8_t subghz_history_intern(SubGhzHistory* instance, const char* str, size_t limit) {
+    if(str == NULL) return SUBGHZ_HISTORY_STRING_NONE;
+
+    // Pool holds protocol and manufacture names only, so it never grows with session length
+    size_t pool_size = SubGhzHistoryStringPool_size(instance->strings);
+    for(size_t i = 0; i < pool_size; i++) {
+        if(strcmp(*SubGhzHistoryStringPool_get(instance->strings, i), str) == 0) return i;
+    }
+
+    if(pool_size >= limit) return SUBGHZ_HISTORY_STRING_NONE;
+    SubGhzHistoryStringPool_push_back(instance->strings, strdup(str));
+    return pool_size;
+}
+
+static const char* subghz_history_string(SubGhzHistory* instance, uint8_t id) {
+    if(id == SUBGHZ_HISTORY_STRING_NONE) return NULL;
+    return *SubGhzHistoryStringPool_get(instance->strings, id);
+}
+
+static inline size_t
+    subghz_history_slot(const SubGhzHistoryIdentity* identity, size_t index_size) {
+    uint64_t key = (identity->code ^ ((uint64_t)identity->name_id << 56)) * 0x9E3779B97F4A7C15ULL;
+    return (key >> 32) & (index_size - 1);
+}
+
+static void subghz_history_index_alloc(SubGhzHistory* instance, size_t index_size) {
+    instance->index = furi_alloc(index_size * sizeof(uint16_t));
+    memset(instance->index, 0xFF, index_size * sizeof(uint16_t));
+    instance->index_size = index_size;
+}
+
+/** Rehash records into twice larger index, must be called with lock held */
+static void subghz_history_index_grow(SubGhzHistory* instance) {
+    free(instance->index);
+    subghz_history_index_alloc(instance, instance->index_size * 2);
+    for(uint16_t i = 0; i < instance->count; i++) {
+        size_t slot = subghz_history_slot(
+            SubGhzHistoryIdentityArray_cget(instance->identities, i), instance->index_size);
+        while(instance->index[slot] != SUBGHZ_HISTORY_NONE) {
+            slot = (slot + 1) & (instance->index_size - 1);
+        }
+        instance->index[slot] = i;
+    }
+}
+
+static inline size_t subghz_history_ram_count(SubGhzHistory* instance) {
+    return SubGhzHistoryRecordArray_size(instance->records);
+}
+
+/** Find record with identity, must be called with lock held
+ * @param slot - set to index slot of found record or to free slot for new one
+ * @return record index or SUBGHZ_HISTORY_NONE
+ */
+static uint16_t subghz_history_find(
+    SubGhzHistory* instance,
+    const SubGhzHistoryIdentity* identity,
+    size_t* slot) {
+    *slot = subghz_history_slot(identity, instance->index_size);
+    while(true) {
+        uint16_t idx = instance->index[*slot];
+        if(idx == SUBGHZ_HISTORY_NONE) return SUBGHZ_HISTORY_NONE;
+        const SubGhzHistoryIdentity* item =
+            SubGhzHistoryIdentityArray_cget(instance->identities, idx);
+        if(item->code == identity->code && item->name_id == identity->name_id) return idx;
+        // Records are never removed one by one, so probe chains stay intact
+        *slot = (*slot + 1) & (instance->index_size - 1);
+    }
+}
+
+static void subghz_history_set_changed(SubGhzHistory* instance, uint16_t idx) {
+    for(uint8_t i = 0; i < instance->changed_count; i++) {
+        if(instance->changed[i] == idx) return;
+    }
+    if(instance->changed_count < SUBGHZ_HISTORY_CHANGED_MAX) {
+        instance->changed[instance->changed_count++] = idx;
+    } else {
+        instance->changed_count = 0;
+        instance->changed_all = 0;
+    }
+}
+
+static bool subghz_history_spill_open(SubGhzHistory* instance) {
+    if(instance->spill_file) return true;
+    instance->spill_file = storage_file_alloc(instance->storage);
+    if(!storage_file_open(
+           instance->spill_file,
+           string_get_cstr(instance->spill_path),
+           FSAM_READ | FSAM_WRITE,
+           FSOM_CREATE_ALWAYS)) {
+        FURI_LOG_E(TAG, "Spill file open failed");
+        storage_file_free(instance->spill_file);
+        instance->spill_file = NULL;
+        return false;
+    }
+    return true;
+}
+
+static void subghz_history_spill_close(SubGhzHistory* instance) {
+    if(instance->spill_file) {
+        storage_file_close(instance->spill_file);
+        storage_file_free(instance->spill_file);
+        instance->spill_file = NULL;
+        storage_common_remove(instance->storage, string_get_cstr(instance->spill_path));
+    }
+    instance->spill_cache_idx = SUBGHZ_HISTORY_NONE;
+}
+
+static bool subghz_history_spill_io(
+    SubGhzHistory* instance,
+    uint16_t spill_idx,
+    SubGhzHistoryRecord* record,
+    bool write) {
+    if(!instance->spill_file) return false;
+    uint32_t offset = spill_idx * sizeof(SubGhzHistoryRecord);
+    bool done = false;
+    if(storage_file_seek(instance->spill_file, offset, true)) {
+        uint16_t size;
+        if(write) {
+            size = storage_file_write(instance->spill_file, record, sizeof(SubGhzHistoryRecord));
+        } else {
+            size = storage_file_read(instance->spill_file, record, sizeof(SubGhzHistoryRecord));
+        }
+        done = size == sizeof(SubGhzHistoryRecord);
+    }
+    if(!done) {
+        FURI_LOG_E(
+            TAG,
+            "Spill %s failed: %s",
+            write ? "write" : "read",
+            storage_file_get_error_desc(instance->spill_file));
+    }
+    return done;
+}
+
+/** Copy record, spilled records are read through one-entry cache
+ * @return false if record is lost to SD error
+ */
+static bool subghz_history_read(
+    SubGhzHistory* instance,
+    uint16_t idx,
+    SubGhzHistoryRecord* record) {
+    subghz_history_lock(instance);
+    if(idx >= instance->count) {
+        subghz_history_unlock(instance);
+        return false;
+    }
+    size_t ram_count = subghz_history_ram_count(instance);
+    if(idx < ram_count) {
+        *record = *SubGhzHistoryRecordArray_get(instance->records, idx);
+        subghz_history_unlock(instance);
+        return true;
+    }
+    if(idx >= ram_count + instance->spilled) {
+        *record = instance->pending[idx - ram_count - instance->spilled];
+        subghz_history_unlock(instance);
+        return true;
+    }
+    SubGhzHistoryUpdate update = {.idx = SUBGHZ_HISTORY_NONE};
+    for(uint8_t i = 0; i < instance->updates_count; i++) {
+        if(instance->updates[i].idx == idx) update = instance->updates[i];
+    }
+    subghz_history_unlock(instance);
+
+    if(instance->spill_cache_idx != idx) {
+        instance->spill_cache_idx = SUBGHZ_HISTORY_NONE;
+        if(!subghz_history_spill_io(instance, idx - ram_count, &instance->spill_cache, false)) {
+            return false;
+        }
+        instance->spill_cache_idx = idx;
+    }
+    *record = instance->spill_cache;
+    if(update.idx == idx) {
+        record->count = MIN(record->count + update.count, UINT16_MAX);
+        record->last_seen = update.last_seen;
+    }
+    return true;
+}
+
+/** Apply repeat of spilled record to SD copy */
+static void subghz_history_spill_update(SubGhzHistory* instance, SubGhzHistoryUpdate* update) {
+    uint16_t spill_idx = update->idx - subghz_history_ram_count(instance);
+    SubGhzHistoryRecord record;
+    instance->spill_cache_idx = SUBGHZ_HISTORY_NONE;
+    if(subghz_history_spill_io(instance, spill_idx, &record, false)) {
+        record.count = MIN(record.count + update->count, UINT16_MAX);
+        record.last_seen = update->last_seen;
+        subghz_history_spill_io(instance, spill_idx, &record, true);
+    }
+}
+
 SubGhzHistory* subghz_history_alloc(void) {
     SubGhzHistory* instance = furi_alloc(sizeof(SubGhzHistory));
+    instance->mutex = osMutexNew(NULL);
+    SubGhzHistoryRecordArray_init(instance->records);
+    SubGhzHistoryIdentityArray_init(instance->identities);
+    SubGhzHistoryStringPool_init(instance->strings);
+    subghz_history_index_alloc(instance, SUBGHZ_HISTORY_INDEX_SIZE_MIN);
+    string_init(instance->spill_path);
+    instance->ram_budget = SUBGHZ_HISTORY_RAM_BUDGET;
+    instance->spill_cache_idx = SUBGHZ_HISTORY_NONE;
+    instance->changed_all = SUBGHZ_HISTORY_NONE;
+    instance->storage = furi_record_open("storage");
     return instance;
 }
 
 void subghz_history_free(SubGhzHistory* instance) {
     furi_assert(instance);
+    subghz_history_spill_close(instance);
+    furi_record_close("storage");
+    string_clear(instance->spill_path);
+    free(instance->index);
+    for
+        M_EACH(item, instance->strings, SubGhzHistoryStringPool_t) {
+            free(*item);
+        }
+    SubGhzHistoryStringPool_clear(instance->strings);
+    SubGhzHistoryIdentityArray_clear(instance->identities);
+    SubGhzHistoryRecordArray_clear(instance->records);
+    osMutexDelete(instance->mutex);
     free(instance);
 }
 
+void subghz_history_set_ram_budget(SubGhzHistory* instance, size_t ram_budget) {
+    furi_assert(instance);
+    subghz_history_lock(instance);
+    instance->ram_budget = ram_budget;
+    subghz_history_unlock(instance);
+}
+
+bool subghz_history_set_spill_path(SubGhzHistory* instance, const char* path) {
+    furi_assert(instance);
+    furi_assert(instance->count == 0);
+    subghz_history_spill_close(instance);
+    instance->spill_failed = false;
+    if(path == NULL) {
+        string_reset(instance->spill_path);
+    } else {
+        string_set_str(instance->spill_path, path);
+    }
+    // Opened by first flush
+    return true;
+}
+
 void subghz_history_set_frequency_preset(
     SubGhzHistory* instance,
     uint16_t idx,
     uint32_t frequency,
     FuriHalSubGhzPreset preset) {
     furi_assert(instance);
-    if(instance->last_index_write >= SUBGHZ_HISTORY_MAX) return;
-    instance->history[idx].preset = preset;
-    instance->history[idx].real_frequency = frequency;
+    subghz_history_lock(instance);
+    if(idx >= instance->count) {
+        subghz_history_unlock(instance);
+        return;
+    }
+    size_t ram_count = subghz_history_ram_count(instance);
+    SubGhzHistoryRecord* record = NULL;
+    if(idx < ram_count) {
+        record = SubGhzHistoryRecordArray_get(instance->records, idx);
+    } else if(idx >= ram_count + instance->spilled) {
+        record = &instance->pending[idx - ram_count - instance->spilled];
+    }
+    if(record) {
+        record->preset = preset;
+        record->real_frequency = frequency;
+        subghz_history_unlock(instance);
+        return;
+    }
+    subghz_history_unlock(instance);
+
+    // Spilled record, read-modify-write on GUI thread
+    SubGhzHistoryRecord spilled;
+    instance->spill_cache_idx = SUBGHZ_HISTORY_NONE;
+    if(subghz_history_spill_io(instance, idx - ram_count, &spilled, false)) {
+        spilled.preset = preset;
+        spilled.real_frequency = frequency;
+        subghz_history_spill_io(instance, idx - ram_count, &spilled, true);
+    }
 }
 
 uint32_t subghz_history_get_frequency(SubGhzHistory* instance, uint16_t idx) {
     furi_assert(instance);
-    return instance->history[idx].real_frequency;
+    SubGhzHistoryRecord record;
+    if(!subghz_history_read(instance, idx, &record)) return 0;
+    return record.real_frequency;
 }
 
 FuriHalSubGhzPreset subghz_history_get_preset(SubGhzHistory* instance, uint16_t idx) {
     furi_assert(instance);
-    return instance->history[idx].preset;
+    SubGhzHistoryRecord record;
+    if(!subghz_history_read(instance, idx, &record)) return FuriHalSubGhzPresetIDLE;
+    return record.preset;
 }
 
 void subghz_history_clean(SubGhzHistory* instance) {
     furi_assert(instance);
-    instance->last_index_write = 0;
-    instance->code_last_found = 0;
+    subghz_history_lock(instance);
+    SubGhzHistoryRecordArray_reset(instance->records);
+    SubGhzHistoryIdentityArray_reset(instance->identities);
+    free(instance->index);
+    subghz_history_index_alloc(instance, SUBGHZ_HISTORY_INDEX_SIZE_MIN);
+    // Interned names are own copies and are kept for next session
+    instance->count = 0;
+    instance->spilled = 0;
+    instance->pending_count = 0;
+    instance->updates_count = 0;
+    instance->changed_count = 0;
+    instance->changed_all = SUBGHZ_HISTORY_NONE;
+    subghz_history_unlock(instance);
+
+    // Spill file is reopened on first spill of next session
+    subghz_history_spill_close(instance);
+    instance->spill_failed = false;
+}
+
+bool subghz_history_flush(SubGhzHistory* instance) {
+    furi_assert(instance);
+    SubGhzHistoryRecord records[SUBGHZ_HISTORY_PENDING_MAX];
+    SubGhzHistoryUpdate updates[SUBGHZ_HISTORY_UPDATES_MAX];
+
+    subghz_history_lock(instance);
+    if(instance->spill_failed) {
+        subghz_history_unlock(instance);
+        return false;
+    }
+    uint8_t records_count = instance->pending_count;
+    memcpy(records, instance->pending, records_count * sizeof(SubGhzHistoryRecord));
+    uint8_t updates_count = instance->updates_count;
+    memcpy(updates, instance->updates, updates_count * sizeof(SubGhzHistoryUpdate));
+    instance->updates_count = 0;
+    uint16_t spilled = instance->spilled;
+    subghz_history_unlock(instance);
+
+    if(!records_count && !updates_count) return true;
+
+    // Worker keeps adding to RAM while SD is written without lock
+    bool written = subghz_history_spill_open(instance);
+    for(uint8_t i = 0; written && i < updates_count; i++) {
+        subghz_history_spill_update(instance, &updates[i]);
+    }
+    uint8_t records_written = 0;
+    while(written && records_written < records_count) {
+        written = subghz_history_spill_io(
+            instance, spilled + records_written, &records[records_written], true);
+        if(written) records_written++;
+    }
+
+    subghz_history_lock(instance);
+    uint16_t base = subghz_history_ram_count(instance) + spilled;
+    for(uint8_t i = 0; i < records_written; i++) {
+        // Repeats that came while record was written
+        SubGhzHistoryRecord* record = &instance->pending[i];
+        if(record->count != records[i].count &&
+           instance->updates_count < SUBGHZ_HISTORY_UPDATES_MAX) {
+            instance->updates[instance->updates_count++] = (SubGhzHistoryUpdate){
+                .idx = base + i,
+                .count = record->count - records[i].count,
+                .last_seen = record->last_seen,
+            };
+        }
+    }
+    instance->pending_count -= records_written;
+    memmove(
+        instance->pending,
+        &instance->pending[records_written],
+        instance->pending_count * sizeof(SubGhzHistoryRecord));
+    instance->spilled += records_written;
+    if(!written) {
+        // Pending records stay in RAM, no new ones are taken
+        instance->spill_failed = true;
+    }
+    subghz_history_unlock(instance);
+
+    return written;
+}
+
+bool subghz_history_pop_changed(SubGhzHistory* instance, uint16_t* idx) {
+    furi_assert(instance);
+    bool changed = false;
+    subghz_history_lock(instance);
+    if(instance->changed_count) {
+        *idx = instance->changed[--instance->changed_count];
+        changed = true;
+    } else if(instance->changed_all != SUBGHZ_HISTORY_NONE) {
+        if(instance->changed_all < instance->count) {
+            *idx = instance->changed_all++;
+            changed = true;
+        } else {
+            instance->changed_all = SUBGHZ_HISTORY_NONE;
+        }
+    }
+    subghz_history_unlock(instance);
+    return changed;
 }
 
 uint16_t subghz_history_get_item(SubGhzHistory* instance) {
     furi_assert(instance);
-    return instance->last_index_write;
+    return instance->count;
 }
 
 uint8_t subghz_history_get_type_protocol(SubGhzHistory* instance, uint16_t idx) {
     furi_assert(instance);
-    return instance->history[idx].type_protocol;
+    SubGhzHistoryRecord record;
+    if(!subghz_history_read(instance, idx, &record)) return SubGhzProtocolCommonTypeUnknown;
+    return record.type_protocol;
 }
 
 const char* subghz_history_get_name(SubGhzHistory* instance, uint16_t idx) {
     furi_assert(instance);
-    return instance->history[idx].name;
+    SubGhzHistoryRecord record;
+    if(!subghz_history_read(instance, idx, &record)) return NULL;
+    return subghz_history_string(instance, record.name_id);
+}
+
+uint16_t subghz_history_get_count(SubGhzHistory* instance, uint16_t idx) {
+    furi_assert(instance);
+    SubGhzHistoryRecord record;
+    if(!subghz_history_read(instance, idx, &record)) return 0;
+    return record.count;
+}
+
+void subghz_history_get_seen(
+    SubGhzHistory* instance,
+    uint16_t idx,
+    uint32_t* first_seen,
+    uint32_t* last_seen) {
+    furi_assert(instance);
+    SubGhzHistoryRecord record = {0};
+    subghz_history_read(instance, idx, &record);
+    if(first_seen) *first_seen = record.first_seen;
+    if(last_seen) *last_seen = record.last_seen;
 }
 
 SubGhzProtocolCommonLoad* subghz_history_get_raw_data(SubGhzHistory* instance, uint16_t idx) {
     furi_assert(instance);
-    instance->data.code_found = instance->history[idx].code_found;
-    instance->data.code_count_bit = instance->history[idx].code_count_bit;
-    instance->data.param1 = instance->history[idx].te;
+    SubGhzHistoryRecord record;
+    if(!subghz_history_read(instance, idx, &record)) return NULL;
+    instance->data.code_found = record.code_found;
+    instance->data.code_count_bit = record.code_count_bit;
+    instance->data.param1 = record.te;
     return &instance->data;
 }
+
+static bool subghz_history_is_full(SubGhzHistory* instance) {
+    if(instance->count == SUBGHZ_HISTORY_MAX) return true;
+    size_t ram_used = subghz_history_ram_count(instance) * sizeof(SubGhzHistoryRecord);
+    return (ram_used + sizeof(SubGhzHistoryRecord) > instance->ram_budget) &&
+           (string_empty_p(instance->spill_path) || instance->spill_failed);
+}
+
 bool subghz_history_get_text_space_left(SubGhzHistory* instance, string_t output) {
     furi_assert(instance);
-    if(instance->last_index_write == SUBGHZ_HISTORY_MAX) {
+    subghz_history_lock(instance);
+    bool full = subghz_history_is_full(instance);
+    uint16_t count = instance->count;
+    subghz_history_unlock(instance);
+    if(full) {
         if(output != NULL) string_printf(output, "Memory is FULL");
         return true;
     }
-    if(output != NULL)
-        string_printf(output, "%02u/%02u", instance->last_index_write, SUBGHZ_HISTORY_MAX);
+    if(output != NULL) string_printf(output, "%02u", count);
     return false;
 }
+
 void subghz_history_get_text_item_menu(SubGhzHistory* instance, string_t output, uint16_t idx) {
-    if(instance->history[idx].code_count_bit < 33) {
-        string_printf(
-            output,
-            "%s %lX",
-            instance->history[idx].name,
-            (uint32_t)(instance->history[idx].code_found & 0xFFFFFFFF));
+    SubGhzHistoryRecord record;
+    if(!subghz_history_read(instance, idx, &record)) {
+        string_set_str(output, "Lost record");
+        return;
+    }
+    const char* name = subghz_history_string(instance, record.name_id);
+    if(name == NULL) name = "Unknown";
+    if(record.code_count_bit < 33) {
+        string_printf(output, "%s %lX", name, (uint32_t)(record.code_found & 0xFFFFFFFF));
     } else {
         string_t str_buff;
         string_init(str_buff);
-        if(strcmp(instance->history[idx].name, "KeeLoq") == 0) {
+        const char* manufacture_name = subghz_history_string(instance, record.manufacture_id);
+        if(strcmp(name, "KeeLoq") == 0) {
             string_set(str_buff, "KL ");
-            string_cat(str_buff, instance->history[idx].manufacture_name);
-        } else if(strcmp(instance->history[idx].name, "Star Line") == 0) {
+            if(manufacture_name) string_cat(str_buff, manufacture_name);
+        } else if(strcmp(name, "Star Line") == 0) {
             string_set(str_buff, "SL ");
-            string_cat(str_buff, instance->history[idx].manufacture_name);
+            if(manufacture_name) string_cat(str_buff, manufacture_name);
         } else {
-            string_set(str_buff, instance->history[idx].name);
+            string_set(str_buff, name);
         }
 
         string_printf(
             output,
             "%s %lX%08lX",
             string_get_cstr(str_buff),
-            (uint32_t)(instance->history[idx].code_found >> 32),
-            (uint32_t)(instance->history[idx].code_found & 0xFFFFFFFF));
+            (uint32_t)(record.code_found >> 32),
+            (uint32_t)(record.code_found & 0xFFFFFFFF));
         string_clear(str_buff);
     }
+    if(record.count > 1) {
+        string_cat_printf(output, " x%u", record.count);
+    }
+}
+
+/** Count repeat of record idx, must be called with lock held */
+static void subghz_history_repeat(SubGhzHistory* instance, uint16_t idx, uint32_t timestamp) {
+    size_t ram_count = subghz_history_ram_count(instance);
+    SubGhzHistoryRecord* record = NULL;
+    if(idx < ram_count) {
+        record = SubGhzHistoryRecordArray_get(instance->records, idx);
+    } else if(idx >= ram_count + instance->spilled) {
+        record = &instance->pending[idx - ram_count - instance->spilled];
+    }
+
+    if(record) {
+        if(record->count < UINT16_MAX) record->count++;
+        record->last_seen = timestamp;
+    } else {
+        // Spilled record, counted here and written by next flush
+        SubGhzHistoryUpdate* update = NULL;
+        for(uint8_t i = 0; i < instance->updates_count; i++) {
+            if(instance->updates[i].idx == idx) update = &instance->updates[i];
+        }
+        if(update == NULL) {
+            if(instance->updates_count == SUBGHZ_HISTORY_UPDATES_MAX) return;
+            update = &instance->updates[instance->updates_count++];
+            update->idx = idx;
+            update->count = 0;
+        }
+        if(update->count < UINT16_MAX) update->count++;
+        update->last_seen = timestamp;
+    }
+    subghz_history_set_changed(instance, idx);
 }
 
 bool subghz_history_add_to_history(
@@ -136,36 +644,77 @@ bool subghz_history_add_to_history(
     furi_assert(instance);
     furi_assert(context);
     SubGhzProtocolCommon* protocol = context;
+    bool added = false;
 
-    if(instance->last_index_write >= SUBGHZ_HISTORY_MAX) return false;
-    if((instance->code_last_found == (protocol->code_last_found & 0xFFFF0FFFFFFFFFFF)) &&
-       ((millis() - instance->last_update_timestamp) < 500)) {
-        instance->last_update_timestamp = millis();
-        return false;
-    }
+    uint32_t timestamp = millis();
+    subghz_history_lock(instance);
+    do {
+        SubGhzHistoryIdentity identity = {
+            .code = protocol->code_last_found & SUBGHZ_HISTORY_CODE_MASK,
+            .name_id =
+                subghz_history_intern(instance, protocol->name, SUBGHZ_HISTORY_STRING_NONE),
+        };
+        size_t slot;
+        uint16_t found_idx = subghz_history_find(instance, &identity, &slot);
+        if(found_idx != SUBGHZ_HISTORY_NONE) {
+            subghz_history_repeat(instance, found_idx, timestamp);
+            break;
+        }
 
-    instance->code_last_found = protocol->code_last_found & 0xFFFF0FFFFFFFFFFF;
-    instance->last_update_timestamp = millis();
-
-    instance->history[instance->last_index_write].real_frequency = frequency;
-    instance->history[instance->last_index_write].preset = preset;
-    instance->history[instance->last_index_write].te = 0;
-    instance->history[instance->last_index_write].manufacture_name = NULL;
-    instance->history[instance->last_index_write].name = protocol->name;
-    instance->history[instance->last_index_write].code_count_bit = protocol->code_last_count_bit;
-    instance->history[instance->last_index_write].code_found = protocol->code_last_found;
-    if(strcmp(protocol->name, "KeeLoq") == 0) {
-        instance->history[instance->last_index_write].manufacture_name =
-            subghz_protocol_keeloq_find_and_get_manufacture_name(protocol);
-    } else if(strcmp(protocol->name, "Star Line") == 0) {
-        instance->history[instance->last_index_write].manufacture_name =
-            subghz_protocol_star_line_find_and_get_manufacture_name(protocol);
-    } else if(strcmp(protocol->name, "Princeton") == 0) {
-        instance->history[instance->last_index_write].te =
-            subghz_protocol_princeton_get_te(protocol);
-    }
-    instance->history[instance->last_index_write].type_protocol = protocol->type_protocol;
-
-    instance->last_index_write++;
-    return true;
-}
\ No newline at end of file
+        if(subghz_history_is_full(instance)) break;
+
+        SubGhzHistoryRecord record = {
+            .code_found = protocol->code_last_found,
+            .real_frequency = frequency,
+            .first_seen = timestamp,
+            .last_seen = timestamp,
+            .te = 0,
+            .count = 1,
+            .name_id = identity.name_id,
+            .manufacture_id = SUBGHZ_HISTORY_STRING_NONE,
+            .type_protocol = protocol->type_protocol,
+            .code_count_bit = protocol->code_last_count_bit,
+            .preset = preset,
+        };
+        // Manufacture name is not shown if pool is full, protocol names keep their slots
+        const size_t manufacture_limit =
+            SUBGHZ_HISTORY_STRING_NONE - SUBGHZ_HISTORY_STRING_PROTOCOLS;
+        if(strcmp(protocol->name, "KeeLoq") == 0) {
+            record.manufacture_id = subghz_history_intern(
+                instance,
+                subghz_protocol_keeloq_find_and_get_manufacture_name(protocol),
+                manufacture_limit);
+        } else if(strcmp(protocol->name, "Star Line") == 0) {
+            record.manufacture_id = subghz_history_intern(
+                instance,
+                subghz_protocol_star_line_find_and_get_manufacture_name(protocol),
+                manufacture_limit);
+        } else if(strcmp(protocol->name, "Princeton") == 0) {
+            record.te = subghz_protocol_princeton_get_te(protocol);
+        }
+
+        size_t ram_count = subghz_history_ram_count(instance);
+        // Records stay in RAM until first spill, after that indexes above RAM part go to SD
+        if((ram_count + 1) * sizeof(SubGhzHistoryRecord) <= instance->ram_budget &&
+           ram_count == instance->count) {
+            SubGhzHistoryRecordArray_push_back(instance->records, record);
+        } else if(instance->pending_count < SUBGHZ_HISTORY_PENDING_MAX) {
+            // Written to SD by subghz_history_flush on GUI thread
+            instance->pending[instance->pending_count++] = record;
+        } else {
+            break;
+        }
+
+        SubGhzHistoryIdentityArray_push_back(instance->identities, identity);
+        if((instance->count + 1) * 2 > instance->index_size) {
+            subghz_history_index_grow(instance);
+            subghz_history_find(instance, &identity, &slot);
+        }
+        instance->index[slot] = instance->count;
+        instance->count++;
+        added = true;
+    } while(false);
+    subghz_history_unlock(instance);
+
+    return added;
+}
@@ -3,6 +3,8 @@
 
 #include <lib/subghz/protocols/subghz_protocol_common.h>
 
+#define SUBGHZ_HISTORY_SPILL_PATH "/ext/subghz/.history.tmp"
+
 typedef struct SubGhzHistory SubGhzHistory;
 
 /** Allocate SubGhzHistory
@@ -17,6 +19,23 @@ SubGhzHistory* subghz_history_alloc(void);
  */
 void subghz_history_free(SubGhzHistory* instance);
 
+/** Set RAM budget for history records
+ * Records above budget go to spill file, if any
+ * 
+ * @param instance   - SubGhzHistory instance
+ * @param ram_budget - budget in bytes
+ */
+void subghz_history_set_ram_budget(SubGhzHistory* instance, size_t ram_budget);
+
+/** Set spill file, must be called on empty history
+ * File is created by first flush and removed on clean and free
+ * 
+ * @param instance  - SubGhzHistory instance
+ * @param path      - spill file path, NULL to disable spilling
+ * @return bool - true on success
+ */
+bool subghz_history_set_spill_path(SubGhzHistory* instance, const char* path);
+
 /** Clear history
  * 
  * @param instance - SubGhzHistory instance
@@ -52,6 +71,24 @@ uint32_t subghz_history_get_frequency(SubGhzHistory* instance, uint16_t idx);
  */
 FuriHalSubGhzPreset subghz_history_get_preset(SubGhzHistory* instance, uint16_t idx);
 
+/** Write records waiting for spill file, call from GUI thread only
+ * Spill file is never touched from add_to_history, so worker thread does not block on SD
+ * On failure records stay in RAM and history reports full
+ * 
+ * @param instance  - SubGhzHistory instance
+ * @return bool - true if all records were written
+ */
+bool subghz_history_flush(SubGhzHistory* instance);
+
+/** Get index of record changed since last call
+ * Used to redraw repeat counter of existing records
+ * 
+ * @param instance  - SubGhzHistory instance
+ * @param idx       - changed record index
+ * @return bool - true if idx was set
+ */
+bool subghz_history_pop_changed(SubGhzHistory* instance, uint16_t* idx);
+
 /** Get history index write 
  * 
  * @param instance  - SubGhzHistory instance
@@ -71,10 +108,31 @@ uint8_t subghz_history_get_type_protocol(SubGhzHistory* instance, uint16_t idx);
  * 
  * @param instance  - SubGhzHistory instance
  * @param idx       - record index  
- * @return name      - const char* name protocol  
+ * @return name      - const char* name protocol, NULL if record is lost  
  */
 const char* subghz_history_get_name(SubGhzHistory* instance, uint16_t idx);
 
+/** Get number of times history[idx] was received
+ * 
+ * @param instance  - SubGhzHistory instance
+ * @param idx       - record index  
+ * @return count     - repeat counter
+ */
+uint16_t subghz_history_get_count(SubGhzHistory* instance, uint16_t idx);
+
+/** Get first and last reception time of history[idx]
+ * 
+ * @param instance   - SubGhzHistory instance
+ * @param idx        - record index  
+ * @param first_seen - first seen timestamp, ms, can be NULL
+ * @param last_seen  - last seen timestamp, ms, can be NULL
+ */
+void subghz_history_get_seen(
+    SubGhzHistory* instance,
+    uint16_t idx,
+    uint32_t* first_seen,
+    uint32_t* last_seen);
+
 /** Get string item menu to history[idx]
  * 
  * @param instance  - SubGhzHistory instance
@@ -91,13 +149,14 @@ void subghz_history_get_text_item_menu(SubGhzHistory* instance, string_t output,
  */
 bool subghz_history_get_text_space_left(SubGhzHistory* instance, string_t output);
 
-/** Add protocol to history
+/** Add protocol to history, safe to call from worker thread
+ * Repeats of known protocol and code only update counter and last seen time
  * 
  * @param instance  - SubGhzHistory instance
  * @param context    - SubGhzProtocolCommon context
  * @param frequency - frequency Hz
  * @param preset    - FuriHalSubGhzPreset preset
- * @return bool;
+ * @return bool - true if new record was added
  */
 bool subghz_history_add_to_history(
     SubGhzHistory* instance,
@@ -109,6 +168,6 @@ bool subghz_history_add_to_history(
  * 
  * @param instance  - SubGhzHistory instance
  * @param idx       - record index
- * @return SubGhzProtocolCommonLoad*
+ * @return SubGhzProtocolCommonLoad*, NULL if record is lost
  */
 SubGhzProtocolCommonLoad* subghz_history_get_raw_data(SubGhzHistory* instance, uint16_t idx);
@@ -6,7 +6,6 @@
 #include <gui/elements.h>
 #include <assets_icons.h>
 #include <m-string.h>
-#include <m-array.h>
 
 #define FRAME_HEIGHT 12
 #define MAX_LEN_PX 100
@@ -17,17 +16,6 @@ typedef struct {
     uint8_t type;
 } SubGhzReceiverMenuItem;
 
-ARRAY_DEF(SubGhzReceiverMenuItemArray, SubGhzReceiverMenuItem, M_POD_OPLIST)
-
-#define M_OPL_SubGhzReceiverMenuItemArray_t() \
-    ARRAY_OPLIST(SubGhzReceiverMenuItemArray, M_POD_OPLIST)
-
-struct SubGhzReceiverHistory {
-    SubGhzReceiverMenuItemArray_t data;
-};
-
-typedef struct SubGhzReceiverHistory SubGhzReceiverHistory;
-
 static const Icon* ReceiverItemIcons[] = {
     [SubGhzProtocolCommonTypeUnknown] = &I_Quest_7x8,
     [SubGhzProtocolCommonTypeStatic] = &I_Unlock_7x8,
@@ -38,13 +26,18 @@ struct SubghzReceiver {
     View* view;
     SubghzReceiverCallback callback;
     void* context;
+    SubghzReceiverItemCallback item_callback;
+    void* item_context;
 };
 
 typedef struct {
     string_t frequency_str;
     string_t preset_str;
     string_t history_stat_str;
-    SubGhzReceiverHistory* history;
+    // Only visible items are kept, others are loaded through item callback on scroll
+    SubGhzReceiverMenuItem items[MENU_ITEMS];
+    uint16_t items_offset;
+    uint16_t items_count;
     uint16_t idx;
     uint16_t list_offset;
     uint16_t history_item;
@@ -60,6 +53,68 @@ void subghz_receiver_set_callback(
     subghz_receiver->context = context;
 }
 
+void subghz_receiver_set_item_callback(
+    SubghzReceiver* subghz_receiver,
+    SubghzReceiverItemCallback callback,
+    void* context) {
+    furi_assert(subghz_receiver);
+    furi_assert(callback);
+    subghz_receiver->item_callback = callback;
+    subghz_receiver->item_context = context;
+}
+
+static void subghz_receiver_load_item(
+    SubghzReceiver* subghz_receiver,
+    SubghzReceiverModel* model,
+    uint16_t slot) {
+    SubGhzReceiverMenuItem* item_menu = &model->items[slot];
+    string_reset(item_menu->item_str);
+    item_menu->type = SubGhzProtocolCommonTypeUnknown;
+    if(subghz_receiver->item_callback) {
+        item_menu->type = subghz_receiver->item_callback(
+            subghz_receiver->item_context, model->items_offset + slot, item_menu->item_str);
+    }
+}
+
+static void subghz_receiver_swap_items(SubGhzReceiverMenuItem* a, SubGhzReceiverMenuItem* b) {
+    string_swap(a->item_str, b->item_str);
+    uint8_t type = a->type;
+    a->type = b->type;
+    b->type = type;
+}
+
+/* Load items that became visible, ones still visible after scroll are moved, not reloaded */
+static void
+    subghz_receiver_load_items(SubghzReceiver* subghz_receiver, SubghzReceiverModel* model) {
+    if(model->list_offset > model->items_offset) {
+        uint16_t shift = model->list_offset - model->items_offset;
+        uint16_t kept = shift < model->items_count ? model->items_count - shift : 0;
+        for(uint16_t i = 0; i < kept; i++) {
+            subghz_receiver_swap_items(&model->items[i], &model->items[i + shift]);
+        }
+        model->items_offset = model->list_offset;
+        model->items_count = kept;
+    } else if(model->list_offset < model->items_offset) {
+        uint16_t shift = model->items_offset - model->list_offset;
+        uint16_t kept = shift < MENU_ITEMS ? MIN(model->items_count + shift, MENU_ITEMS) : 0;
+        for(uint16_t i = kept; i > shift; i--) {
+            subghz_receiver_swap_items(&model->items[i - 1], &model->items[i - 1 - shift]);
+        }
+        model->items_offset = model->list_offset;
+        for(uint16_t i = 0; i < MIN(shift, kept); i++) {
+            subghz_receiver_load_item(subghz_receiver, model, i);
+        }
+        model->items_count = kept;
+    }
+    uint16_t visible = 0;
+    if(model->history_item > model->items_offset) {
+        visible = MIN(model->history_item - model->items_offset, MENU_ITEMS);
+    }
+    for(; model->items_count < visible; model->items_count++) {
+        subghz_receiver_load_item(subghz_receiver, model, model->items_count);
+    }
+}
+
 static void subghz_receiver_update_offset(SubghzReceiver* subghz_receiver) {
     furi_assert(subghz_receiver);
 
@@ -75,33 +130,38 @@ static void subghz_receiver_update_offset(SubghzReceiver* subghz_receiver) {
             } else if(model->list_offset > model->idx - bounds) {
                 model->list_offset = CLAMP(model->idx - 1, history_item - bounds, 0);
             }
+            subghz_receiver_load_items(subghz_receiver, model);
             return true;
         });
 }
 
-void subghz_receiver_add_item_to_menu(
-    SubghzReceiver* subghz_receiver,
-    const char* name,
-    uint8_t type) {
+void subghz_receiver_set_history_item(SubghzReceiver* subghz_receiver, uint16_t history_item) {
     furi_assert(subghz_receiver);
     with_view_model(
         subghz_receiver->view, (SubghzReceiverModel * model) {
-            SubGhzReceiverMenuItem* item_menu =
-                SubGhzReceiverMenuItemArray_push_raw(model->history->data);
-            string_init_set_str(item_menu->item_str, name);
-            item_menu->type = type;
-            if((model->idx == model->history_item - 1)) {
-                model->history_item++;
-                model->idx++;
-            } else {
-                model->history_item++;
+            // Selection on last item follows new ones
+            if(history_item > model->history_item &&
+               (model->history_item == 0 || model->idx == model->history_item - 1)) {
+                model->idx = history_item - 1;
             }
-
+            model->history_item = history_item;
             return true;
         });
     subghz_receiver_update_offset(subghz_receiver);
 }
 
+void subghz_receiver_update_item_in_menu(SubghzReceiver* subghz_receiver, uint16_t idx) {
+    furi_assert(subghz_receiver);
+    with_view_model(
+        subghz_receiver->view, (SubghzReceiverModel * model) {
+            if(idx < model->items_offset || idx >= model->items_offset + model->items_count) {
+                return false;
+            }
+            subghz_receiver_load_item(subghz_receiver, model, idx - model->items_offset);
+            return true;
+        });
+}
+
 void subghz_receiver_add_data_statusbar(
     SubghzReceiver* subghz_receiver,
     const char* frequency_str,
@@ -156,9 +216,9 @@ void subghz_receiver_draw(Canvas* canvas, SubghzReceiverModel* model) {
 
     SubGhzReceiverMenuItem* item_menu;
 
-    for(size_t i = 0; i < MIN(model->history_item, MENU_ITEMS); ++i) {
-        size_t idx = CLAMP(i + model->list_offset, model->history_item, 0);
-        item_menu = SubGhzReceiverMenuItemArray_get(model->history->data, idx);
+    for(size_t i = 0; i < MIN(model->items_count, MENU_ITEMS); ++i) {
+        size_t idx = i + model->items_offset;
+        item_menu = &model->items[i];
         string_set(str_buff, item_menu->item_str);
         elements_string_fit_width(canvas, str_buff, scrollbar ? MAX_LEN_PX - 6 : MAX_LEN_PX);
         if(model->idx == idx) {
@@ -229,16 +289,16 @@ void subghz_receiver_exit(void* context) {
             string_reset(model->frequency_str);
             string_reset(model->preset_str);
             string_reset(model->history_stat_str);
-                for
-                    M_EACH(item_menu, model->history->data, SubGhzReceiverMenuItemArray_t) {
-                        string_clear(item_menu->item_str);
-                        item_menu->type = 0;
-                    }
-                SubGhzReceiverMenuItemArray_reset(model->history->data);
-                model->idx = 0;
-                model->list_offset = 0;
-                model->history_item = 0;
-                return false;
+            for(size_t i = 0; i < MENU_ITEMS; i++) {
+                string_reset(model->items[i].item_str);
+                model->items[i].type = 0;
+            }
+            model->items_offset = 0;
+            model->items_count = 0;
+            model->idx = 0;
+            model->list_offset = 0;
+            model->history_item = 0;
+            return false;
         });
 }
 
@@ -259,8 +319,9 @@ SubghzReceiver* subghz_receiver_alloc() {
             string_init(model->frequency_str);
             string_init(model->preset_str);
             string_init(model->history_stat_str);
-            model->history = furi_alloc(sizeof(SubGhzReceiverHistory));
-            SubGhzReceiverMenuItemArray_init(model->history->data);
+            for(size_t i = 0; i < MENU_ITEMS; i++) {
+                string_init(model->items[i].item_str);
+            }
             return true;
         });
 
@@ -275,14 +336,10 @@ void subghz_receiver_free(SubghzReceiver* subghz_receiver) {
             string_clear(model->frequency_str);
             string_clear(model->preset_str);
             string_clear(model->history_stat_str);
-                for
-                    M_EACH(item_menu, model->history->data, SubGhzReceiverMenuItemArray_t) {
-                        string_clear(item_menu->item_str);
-                        item_menu->type = 0;
-                    }
-                SubGhzReceiverMenuItemArray_clear(model->history->data);
-                free(model->history);
-                return false;
+            for(size_t i = 0; i < MENU_ITEMS; i++) {
+                string_clear(model->items[i].item_str);
+            }
+            return false;
         });
     view_free(subghz_receiver->view);
     free(subghz_receiver);
@@ -1,12 +1,18 @@
 #pragma once
 
 #include <gui/view.h>
+#include <m-string.h>
 #include "../helpers/subghz_custom_event.h"
 
 typedef struct SubghzReceiver SubghzReceiver;
 
 typedef void (*SubghzReceiverCallback)(SubghzCustomEvent event, void* context);
 
+/** Item text callback, menu keeps only visible items and loads them on scroll
+ * @return item type, SubGhzProtocolCommonType
+ */
+typedef uint8_t (*SubghzReceiverItemCallback)(void* context, uint16_t idx, string_t item_str);
+
 void subghz_receiver_set_callback(
     SubghzReceiver* subghz_receiver,
     SubghzReceiverCallback callback,
@@ -24,10 +30,14 @@ void subghz_receiver_add_data_statusbar(
     const char* preset_str,
     const char* history_stat_str);
 
-void subghz_receiver_add_item_to_menu(
+void subghz_receiver_set_item_callback(
     SubghzReceiver* subghz_receiver,
-    const char* name,
-    uint8_t type);
+    SubghzReceiverItemCallback callback,
+    void* context);
+
+void subghz_receiver_set_history_item(SubghzReceiver* subghz_receiver, uint16_t history_item);
+
+void subghz_receiver_update_item_in_menu(SubghzReceiver* subghz_receiver, uint16_t idx);
 
 uint16_t subghz_receiver_get_idx_menu(SubghzReceiver* subghz_receiver);
 
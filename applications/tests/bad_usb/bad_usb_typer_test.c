@@ -0,0 +1,107 @@
+#include <furi.h>
+#include <string.h>
+#include <bad_usb/bad_usb_typer.h>
+#include "../minunit.h"
+
+#define TEST_TEXT_MAX 128
+
+/* Host side of keyboard: key down events are keys missing in previous report */
+typedef struct {
+    BadUsbTyperReport prev;
+    char text[TEST_TEXT_MAX];
+    size_t text_len;
+    uint32_t reports;
+    bool fail;
+} TestHidSink;
+
+static char test_hid_key_to_ascii(uint8_t mods, uint8_t key) {
+    for(uint8_t c = 0; c < 128; c++) {
+        if(HID_ASCII_TO_KEY(c) == ((mods << 8) | key)) return c;
+    }
+    return 0;
+}
+
+static bool test_hid_sink_callback(const BadUsbTyperReport* report, void* context) {
+    TestHidSink* sink = context;
+    sink->reports++;
+
+    uint8_t pressed = 0;
+    for(uint8_t i = 0; i < HID_KB_MAX_KEYS; i++) {
+        uint8_t key = report->keys[i];
+        if(key == KEY_NONE || memchr(sink->prev.keys, key, HID_KB_MAX_KEYS)) continue;
+        char c = test_hid_key_to_ascii(report->mods, key);
+        if(c == 0 || sink->text_len == TEST_TEXT_MAX) sink->fail = true;
+        if(!sink->fail) sink->text[sink->text_len++] = c;
+        pressed++;
+    }
+    // More than one key down per report has no defined order
+    if(pressed > 1) sink->fail = true;
+    // Modifiers must not change under held keys
+    for(uint8_t i = 0; i < HID_KB_MAX_KEYS; i++) {
+        if(report->mods != sink->prev.mods && report->keys[i] &&
+           memchr(sink->prev.keys, report->keys[i], HID_KB_MAX_KEYS)) {
+            sink->fail = true;
+        }
+    }
+
+    sink->prev = *report;
+    return true;
+}
+
+static void test_type(const char* text, uint32_t reports) {
+    TestHidSink sink = {0};
+    BadUsbTyper* typer = bad_usb_typer_alloc(test_hid_sink_callback, &sink);
+
+    // Split in two calls, held keys carry over
+    size_t half = strlen(text) / 2;
+    mu_check(bad_usb_typer_type(typer, text, half));
+    mu_check(bad_usb_typer_type(typer, &text[half], strlen(text) - half));
+    mu_check(bad_usb_typer_release(typer));
+    bad_usb_typer_free(typer);
+
+    mu_check(!sink.fail);
+    mu_assert_int_eq(strlen(text), sink.text_len);
+    mu_assert_string_eq(text, sink.text);
+    BadUsbTyperReport released = {0};
+    mu_check(memcmp(&released, &sink.prev, sizeof(released)) == 0);
+    mu_assert_int_eq(reports, sink.reports);
+}
+
+MU_TEST(bad_usb_typer_distinct_test) {
+    // Window slides, one report per key plus final release
+    test_type("abcdefghijklmnopqrstuvwxyz", 27);
+}
+
+MU_TEST(bad_usb_typer_repeat_test) {
+    // Keys still held are released first: second 'l', 'o' and last 'l'
+    test_type("hello, world", 16);
+    test_type("aaaa", 8);
+}
+
+MU_TEST(bad_usb_typer_mods_test) {
+    // Releases before each case change
+    test_type("AbCd", 8);
+    test_type("Hello World!", 18);
+}
+
+MU_TEST(bad_usb_typer_skip_test) {
+    TestHidSink sink = {0};
+    BadUsbTyper* typer = bad_usb_typer_alloc(test_hid_sink_callback, &sink);
+    mu_check(bad_usb_typer_release(typer));
+    mu_check(bad_usb_typer_type(typer, "\x01\x7f", 2));
+    mu_check(bad_usb_typer_release(typer));
+    bad_usb_typer_free(typer);
+    mu_assert_int_eq(0, sink.reports);
+}
+
+MU_TEST_SUITE(bad_usb_typer) {
+    MU_RUN_TEST(bad_usb_typer_distinct_test);
+    MU_RUN_TEST(bad_usb_typer_repeat_test);
+    MU_RUN_TEST(bad_usb_typer_mods_test);
+    MU_RUN_TEST(bad_usb_typer_skip_test);
+}
+
+int run_minunit_test_bad_usb() {
+    MU_RUN_SUITE(bad_usb_typer);
+    return MU_EXIT_CODE;
+}
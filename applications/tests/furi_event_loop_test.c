@@ -0,0 +1,170 @@
+#include <stdio.h>
+#include <string.h>
+#include <furi.h>
+#include "minunit.h"
+
+#define TEST_EVENT_LOOP_MESSAGE 0xdeadbeef
+/* Idle test: window length and timer period, ticks */
+#define TEST_EVENT_LOOP_WINDOW 100
+#define TEST_EVENT_LOOP_PERIOD 10
+#define TEST_EVENT_LOOP_SIGNALS 20
+
+typedef struct {
+    FuriEventLoop* loop;
+    FuriEventLoopMessageQueue* queue;
+    uint32_t signal_calls;
+    uint32_t periodic_calls;
+    uint32_t periodic_calls_on_oneshot;
+    uint32_t message;
+} TestEventLoop;
+
+static void test_event_loop_signal_callback(void* context) {
+    TestEventLoop* test = context;
+    test->signal_calls++;
+}
+
+static void test_event_loop_periodic_callback(void* context) {
+    TestEventLoop* test = context;
+    test->periodic_calls++;
+}
+
+static void test_event_loop_oneshot_callback(void* context) {
+    TestEventLoop* test = context;
+    test->periodic_calls_on_oneshot = test->periodic_calls;
+    uint32_t message = TEST_EVENT_LOOP_MESSAGE;
+    furi_check(furi_event_loop_message_queue_put(test->queue, &message, 0) == osOK);
+}
+
+static void test_event_loop_queue_callback(void* context) {
+    TestEventLoop* test = context;
+    if(furi_event_loop_message_queue_get(test->queue, &test->message, 0) == osOK) {
+        furi_event_loop_stop(test->loop);
+    }
+}
+
+void test_furi_event_loop() {
+    TestEventLoop test = {0};
+
+    test.loop = furi_event_loop_alloc();
+    mu_assert_pointers_not_eq(test.loop, NULL);
+
+    FuriEventLoopSignal* signal =
+        furi_event_loop_signal_alloc(test.loop, test_event_loop_signal_callback, &test);
+    test.queue = furi_event_loop_message_queue_alloc(
+        test.loop, 4, sizeof(uint32_t), test_event_loop_queue_callback, &test);
+    FuriEventLoopTimer* periodic =
+        furi_event_loop_timer_alloc(test.loop, test_event_loop_periodic_callback, &test);
+    FuriEventLoopTimer* oneshot =
+        furi_event_loop_timer_alloc(test.loop, test_event_loop_oneshot_callback, &test);
+
+    // signal set before run is delivered, repeated sets coalesce
+    furi_event_loop_signal_set(signal);
+    furi_event_loop_signal_set(signal);
+
+    // one-shot in the middle of third period, it stops loop through queue
+    furi_event_loop_timer_start(periodic, 10, true);
+    furi_event_loop_timer_start(oneshot, 25, false);
+    mu_assert(furi_event_loop_timer_is_running(oneshot), "timer is not running");
+
+    furi_event_loop_run(test.loop);
+
+    mu_assert_int_eq(1, test.signal_calls);
+    mu_assert_int_eq(2, test.periodic_calls_on_oneshot);
+    mu_assert_int_eq(TEST_EVENT_LOOP_MESSAGE, test.message);
+    mu_assert(!furi_event_loop_timer_is_running(oneshot), "one-shot timer rearmed");
+    mu_assert(furi_event_loop_timer_is_running(periodic), "periodic timer stopped");
+
+    // stop before run makes run return after one pass
+    furi_event_loop_timer_stop(periodic);
+    furi_event_loop_signal_set(signal);
+    furi_event_loop_stop(test.loop);
+    furi_event_loop_run(test.loop);
+    mu_assert_int_eq(2, test.signal_calls);
+
+    furi_event_loop_timer_free(oneshot);
+    furi_event_loop_timer_free(periodic);
+    furi_event_loop_message_queue_free(test.queue);
+    furi_event_loop_signal_free(signal);
+    furi_event_loop_free(test.loop);
+}
+
+static int32_t test_event_loop_idle_thread(void* context) {
+    FuriEventLoop* loop = context;
+    furi_event_loop_run(loop);
+    return 0;
+}
+
+static void test_event_loop_count_callback(void* context) {
+    uint32_t* calls = context;
+    (*calls)++;
+}
+
+/* Wakeups and idle wakeups over one window */
+static void test_event_loop_window(FuriEventLoop* loop, uint32_t* wakeups, uint32_t* idle) {
+    uint32_t wakeups_start = furi_event_loop_get_wakeups(loop);
+    uint32_t idle_start = furi_event_loop_get_idle_wakeups(loop);
+    osDelay(TEST_EVENT_LOOP_WINDOW);
+    *wakeups = furi_event_loop_get_wakeups(loop) - wakeups_start;
+    *idle = furi_event_loop_get_idle_wakeups(loop) - idle_start;
+}
+
+void test_furi_event_loop_idle() {
+    uint32_t timer_calls = 0;
+    uint32_t signal_calls = 0;
+    uint32_t wakeups, idle;
+
+    FuriEventLoop* loop = furi_event_loop_alloc();
+    FuriEventLoopTimer* timer =
+        furi_event_loop_timer_alloc(loop, test_event_loop_count_callback, &timer_calls);
+    FuriEventLoopSignal* signal =
+        furi_event_loop_signal_alloc(loop, test_event_loop_count_callback, &signal_calls);
+
+    FuriThread* thread = furi_thread_alloc();
+    furi_thread_set_name(thread, "EventLoopIdle");
+    furi_thread_set_stack_size(thread, 1024);
+    furi_thread_set_context(thread, loop);
+    furi_thread_set_callback(thread, test_event_loop_idle_thread);
+    furi_thread_start(thread);
+
+    // Nothing armed: loop must not wake at all
+    osDelay(TEST_EVENT_LOOP_PERIOD);
+    test_event_loop_window(loop, &wakeups, &idle);
+    mu_assert_int_eq(0, wakeups);
+
+    // Periodic timer: one wakeup per expiration, each one dispatches. Start
+    // wakes loop to take new deadline, let it pass before window.
+    furi_event_loop_timer_start(timer, TEST_EVENT_LOOP_PERIOD, true);
+    osDelay(1);
+    test_event_loop_window(loop, &wakeups, &idle);
+    mu_assert(wakeups >= TEST_EVENT_LOOP_WINDOW / TEST_EVENT_LOOP_PERIOD - 1, "timer missed");
+    mu_assert(wakeups <= TEST_EVENT_LOOP_WINDOW / TEST_EVENT_LOOP_PERIOD + 1, "extra wakeups");
+    mu_assert_int_eq(0, idle);
+
+    // Stopped timer deadline may wake loop once, then it sleeps again
+    furi_event_loop_timer_stop(timer);
+    osDelay(TEST_EVENT_LOOP_PERIOD * 2);
+    test_event_loop_window(loop, &wakeups, &idle);
+    mu_assert_int_eq(0, wakeups);
+
+    // Spaced signals: one wakeup per dispatch, sets may coalesce under load
+    uint32_t wakeups_start = furi_event_loop_get_wakeups(loop);
+    uint32_t idle_start = furi_event_loop_get_idle_wakeups(loop);
+    for(size_t i = 0; i < TEST_EVENT_LOOP_SIGNALS; i++) {
+        furi_event_loop_signal_set(signal);
+        osDelay(1);
+    }
+    osDelay(TEST_EVENT_LOOP_PERIOD);
+    wakeups = furi_event_loop_get_wakeups(loop) - wakeups_start;
+    idle = furi_event_loop_get_idle_wakeups(loop) - idle_start;
+    mu_assert(signal_calls > 0, "signal not dispatched");
+    mu_assert_int_eq(signal_calls, wakeups);
+    mu_assert_int_eq(0, idle);
+
+    furi_event_loop_stop(loop);
+    furi_thread_join(thread);
+    furi_thread_free(thread);
+
+    furi_event_loop_signal_free(signal);
+    furi_event_loop_timer_free(timer);
+    furi_event_loop_free(loop);
+}
@@ -2,6 +2,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
+#include <furi/memmgr_heap.h>
 // this test is not accurate, but gives a basic understanding
 // that memory management is working fine
 
@@ -9,12 +10,28 @@
 // we also test that we are linking against stdlib
 extern size_t memmgr_get_free_heap(void);
 extern size_t memmgr_get_minimum_free_heap(void);
+extern size_t memmgr_get_free_slab(void);
+
+// 128 byte objects are served from slab, count its free space too
+static size_t memmgr_get_free_total(void) {
+    return memmgr_get_free_heap() + memmgr_get_free_slab();
+}
 
 // current heap managment realization consume:
 // X bytes after allocate and 0 bytes after allocate and free,
 // where X = sizeof(void*) + sizeof(size_t), look to BlockLink_t
 const size_t heap_overhead_max_size = sizeof(void*) + sizeof(size_t);
 
+// bytes accounted to the calling thread
+static size_t memmgr_get_thread_live(void) {
+    MemmgrHeapThreadStats stats[MEMMGR_HEAP_THREAD_SLOTS];
+    size_t count = memmgr_heap_get_threads_stats(stats, MEMMGR_HEAP_THREAD_SLOTS);
+    for(size_t i = 0; i < count; i++) {
+        if(stats[i].thread_id == osThreadGetId()) return stats[i].live;
+    }
+    return 0;
+}
+
 bool heap_equal(size_t heap_size, size_t heap_size_old) {
     // heap borders with overhead
     const size_t heap_low = heap_size_old - heap_overhead_max_size;
@@ -45,17 +62,17 @@ void test_furi_memmgr() {
 #endif
 
     // allocate memory case
-    heap_size_old = memmgr_get_free_heap();
+    heap_size_old = memmgr_get_free_total();
     ptr = malloc(alloc_size);
-    heap_size = memmgr_get_free_heap();
+    heap_size = memmgr_get_free_total();
     mu_assert_pointers_not_eq(ptr, NULL);
     mu_assert(heap_equal(heap_size, heap_size_old - alloc_size), "allocate failed");
 
     // free memory case
-    heap_size_old = memmgr_get_free_heap();
+    heap_size_old = memmgr_get_free_total();
     free(ptr);
     ptr = NULL;
-    heap_size = memmgr_get_free_heap();
+    heap_size = memmgr_get_free_total();
     mu_assert(heap_equal(heap_size, heap_size_old + alloc_size), "free failed");
 
     // reallocate memory case
@@ -73,14 +90,24 @@ void test_furi_memmgr() {
     memcpy(ptr, original_ptr, alloc_size);
 
     // reallocate array
-    heap_size_old = memmgr_get_free_heap();
+    heap_size_old = memmgr_get_free_total();
     ptr = realloc(ptr, alloc_size * 2);
-    heap_size = memmgr_get_free_heap();
+    heap_size = memmgr_get_free_total();
     mu_assert(heap_equal(heap_size, heap_size_old - alloc_size), "reallocate failed");
     mu_assert_int_eq(memcmp(original_ptr, ptr, alloc_size), 0);
     free(original_ptr);
     free(ptr);
 
+    // shrink in place case, pointer is kept and tail goes back to heap
+    original_ptr = malloc(alloc_size * 8);
+    mu_assert_pointers_not_eq(original_ptr, NULL);
+    heap_size_old = memmgr_get_free_total();
+    ptr = realloc(original_ptr, alloc_size * 4);
+    heap_size = memmgr_get_free_total();
+    mu_assert_pointers_eq(ptr, original_ptr);
+    mu_assert(heap_equal(heap_size, heap_size_old + alloc_size * 4), "shrink failed");
+    free(ptr);
+
     // allocate and zero-initialize array (calloc)
     original_ptr = malloc(alloc_size);
     mu_assert_pointers_not_eq(original_ptr, NULL);
@@ -88,12 +115,22 @@ void test_furi_memmgr() {
     for(int i = 0; i < alloc_size; i++) {
         *(unsigned char*)(original_ptr + i) = 0;
     }
-    heap_size_old = memmgr_get_free_heap();
+    heap_size_old = memmgr_get_free_total();
     ptr = calloc(1, alloc_size);
-    heap_size = memmgr_get_free_heap();
+    heap_size = memmgr_get_free_total();
     mu_assert(heap_equal(heap_size, heap_size_old - alloc_size), "callocate failed");
     mu_assert_int_eq(memcmp(original_ptr, ptr, alloc_size), 0);
 
     free(original_ptr);
     free(ptr);
+
+    // thread accounting case, free gives back exactly what alloc charged,
+    // also for heap blocks that were too small to split
+    size_t live_old = memmgr_get_thread_live();
+    for(int size = 1; size < alloc_size * 8; size += 7) {
+        ptr = malloc(size);
+        mu_assert_pointers_not_eq(ptr, NULL);
+        free(ptr);
+        mu_assert_int_eq(memmgr_get_thread_live(), live_old);
+    }
 }
\ No newline at end of file
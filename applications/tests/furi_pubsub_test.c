@@ -15,6 +15,22 @@ void test_pubsub_handler(const void* arg, void* ctx) {
     pubsub_context_value = *(uint32_t*)ctx;
 }
 
+uint32_t test_pubsub_calls = 0;
+
+void test_pubsub_count_handler(const void* arg, void* ctx) {
+    test_pubsub_calls++;
+}
+
+FuriPubSub* test_pubsub_reentrant = NULL;
+FuriPubSubSubscription* test_pubsub_reentrant_subscription = NULL;
+
+void test_pubsub_self_unsubscribe_handler(const void* arg, void* ctx) {
+    test_pubsub_calls++;
+    furi_pubsub_unsubscribe(test_pubsub_reentrant, test_pubsub_reentrant_subscription);
+    test_pubsub_reentrant_subscription =
+        furi_pubsub_subscribe(test_pubsub_reentrant, test_pubsub_count_handler, ctx);
+}
+
 void test_furi_pubsub() {
     FuriPubSub* test_pubsub = NULL;
     FuriPubSubSubscription* test_pubsub_subscription = NULL;
@@ -40,6 +56,36 @@ void test_furi_pubsub() {
     furi_pubsub_publish(test_pubsub, (void*)&notify_value_1);
     mu_assert_int_not_eq(pubsub_value, notify_value_1);
 
+    // several subscribers case, unsubscribe keeps the rest in order
+    test_pubsub_calls = 0;
+    FuriPubSubSubscription* test_pubsub_subscriptions[3];
+    for(size_t i = 0; i < 3; i++) {
+        test_pubsub_subscriptions[i] =
+            furi_pubsub_subscribe(test_pubsub, test_pubsub_count_handler, (void*)&context_value);
+    }
+    furi_pubsub_publish(test_pubsub, (void*)&notify_value_0);
+    mu_assert_int_eq(3, test_pubsub_calls);
+
+    furi_pubsub_unsubscribe(test_pubsub, test_pubsub_subscriptions[1]);
+    furi_pubsub_publish(test_pubsub, (void*)&notify_value_0);
+    mu_assert_int_eq(5, test_pubsub_calls);
+
+    furi_pubsub_unsubscribe(test_pubsub, test_pubsub_subscriptions[0]);
+    furi_pubsub_unsubscribe(test_pubsub, test_pubsub_subscriptions[2]);
+    furi_pubsub_publish(test_pubsub, (void*)&notify_value_0);
+    mu_assert_int_eq(5, test_pubsub_calls);
+
+    // unsubscribe and subscribe from callback case
+    test_pubsub_calls = 0;
+    test_pubsub_reentrant = test_pubsub;
+    test_pubsub_reentrant_subscription = furi_pubsub_subscribe(
+        test_pubsub, test_pubsub_self_unsubscribe_handler, (void*)&context_value);
+    furi_pubsub_publish(test_pubsub, (void*)&notify_value_0);
+    mu_assert_int_eq(1, test_pubsub_calls);
+    furi_pubsub_publish(test_pubsub, (void*)&notify_value_0);
+    mu_assert_int_eq(2, test_pubsub_calls);
+    furi_pubsub_unsubscribe(test_pubsub, test_pubsub_reentrant_subscription);
+
     // delete pubsub case
     furi_pubsub_free(test_pubsub);
 }
\ No newline at end of file
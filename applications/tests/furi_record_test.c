@@ -16,5 +16,16 @@ void test_furi_create_open() {
     furi_record_close("test/holding");
 
     // 4. Clean up
-    furi_record_destroy("test/holding");
+    mu_assert(furi_record_exists("test/holding"), "record must exist before destroy");
+    mu_assert(furi_record_destroy("test/holding"), "record without holders must be destroyed");
+    mu_assert(!furi_record_exists("test/holding"), "record must not exist after destroy");
+
+    // 5. Create again in the same slot
+    uint8_t test_data_new = 0;
+    furi_record_create("test/holding", (void*)&test_data_new);
+    record = furi_record_open("test/holding");
+    mu_assert_pointers_eq(record, &test_data_new);
+    mu_assert(!furi_record_destroy("test/holding"), "record with holders must not be destroyed");
+    furi_record_close("test/holding");
+    mu_assert(furi_record_destroy("test/holding"), "record without holders must be destroyed");
 }
@@ -0,0 +1,156 @@
+#include <furi.h>
+#include <subghz/helpers/subghz_frequency_analyzer_sweep.h>
+#include "../minunit.h"
+
+#define TAG "SubGhzFrequencyAnalyzerTest"
+
+#define SWEEP_TEST_NOISE_FLOOR -100.0f
+#define SWEEP_TEST_CARRIER_RSSI -50.0f
+/* Carrier power drop per kHz of detuning with 58kHz filter */
+#define SWEEP_TEST_ROLLOFF_PER_KHZ 0.4f
+#define SWEEP_TEST_BURST_US 20000
+#define SWEEP_TEST_BURST_COUNT 200
+/* Per-step cost outside of dwell: SPI writes, calibration */
+#define SWEEP_TEST_RETUNE_US 300
+#define SWEEP_TEST_TICK_US 1000
+
+static const uint32_t sweep_test_frequencies[] = {
+    300000000, 303875000, 304250000, 310000000, 315000000, 318000000, 390000000,
+    418000000, 433075000, 433420000, 433920000, 434420000, 434775000, 438900000,
+    868350000, 915000000, 925000000,
+};
+
+typedef struct {
+    uint32_t time_us;
+    uint32_t spin_us;
+    uint32_t carrier_frequency;
+    uint32_t burst_start_us;
+    uint32_t burst_end_us;
+} SweepTestModel;
+
+/* Dwell wait of worker: osDelay(1) sleeps to next tick while more than a tick is left,
+ * the rest is spun on cycle counter */
+static void sweep_test_model_wait(SweepTestModel* model, uint32_t dwell_us) {
+    uint32_t end = model->time_us + dwell_us;
+    while(end - model->time_us > SWEEP_TEST_TICK_US) {
+        model->time_us += SWEEP_TEST_TICK_US - model->time_us % SWEEP_TEST_TICK_US;
+    }
+    model->spin_us += end - model->time_us;
+    model->time_us = end;
+}
+
+static float sweep_test_model_measure(void* context, uint32_t* tuned, uint32_t dwell_us) {
+    SweepTestModel* model = context;
+    // Synthesizer step is about 400Hz, report frequency it really tunes to
+    uint32_t frequency = *tuned / 400 * 400;
+    *tuned = frequency;
+    model->time_us += SWEEP_TEST_RETUNE_US;
+    sweep_test_model_wait(model, dwell_us);
+
+    // Noise floor with +-2dB deterministic jitter
+    float rssi = SWEEP_TEST_NOISE_FLOOR + (float)(rand() % 5) - 2.0f;
+
+    // RSSI is sampled at the end of dwell
+    if(model->time_us >= model->burst_start_us && model->time_us < model->burst_end_us) {
+        uint32_t offset = frequency > model->carrier_frequency ?
+                              frequency - model->carrier_frequency :
+                              model->carrier_frequency - frequency;
+        float carrier = SWEEP_TEST_CARRIER_RSSI - SWEEP_TEST_ROLLOFF_PER_KHZ * (offset / 1000);
+        if(carrier > rssi) rssi = carrier;
+    }
+    return rssi;
+}
+
+MU_TEST(subghz_frequency_analyzer_refine_test) {
+    SweepTestModel model = {
+        .carrier_frequency = 433920000 + 37000,
+        .burst_start_us = 0,
+        .burst_end_us = UINT32_MAX,
+    };
+    SubGhzFrequencyAnalyzerSweep* sweep = subghz_frequency_analyzer_sweep_alloc(
+        sweep_test_frequencies,
+        COUNT_OF(sweep_test_frequencies),
+        sweep_test_model_measure,
+        &model);
+
+    FrequencyRSSI coarse = subghz_frequency_analyzer_sweep_coarse(sweep);
+    mu_assert_int_eq(433920000, coarse.frequency);
+    size_t coarse_count = subghz_frequency_analyzer_sweep_get_measure_count(sweep);
+
+    FrequencyRSSI fine = subghz_frequency_analyzer_sweep_refine(sweep, coarse, 500000, 10000);
+    size_t refine_count = subghz_frequency_analyzer_sweep_get_measure_count(sweep) - coarse_count;
+    uint32_t error = fine.frequency > model.carrier_frequency ?
+                         fine.frequency - model.carrier_frequency :
+                         model.carrier_frequency - fine.frequency;
+    FURI_LOG_I(TAG, "Refine: %u measurements, error %luHz", refine_count, error);
+
+    // Old linear scan had 10kHz step, last refinement step must be finer
+    mu_assert(error <= 10000 / 2, "refinement error above resolution");
+    // Linear 10kHz scan over 500kHz takes 50 steps
+    mu_assert(refine_count < 16, "refinement is not logarithmic");
+
+    subghz_frequency_analyzer_sweep_free(sweep);
+}
+
+static uint32_t sweep_test_detection(uint32_t dwell_min_us, uint32_t dwell_max_us) {
+    SweepTestModel model = {0};
+    SubGhzFrequencyAnalyzerSweep* sweep = subghz_frequency_analyzer_sweep_alloc(
+        sweep_test_frequencies,
+        COUNT_OF(sweep_test_frequencies),
+        sweep_test_model_measure,
+        &model);
+    subghz_frequency_analyzer_sweep_set_dwell(sweep, dwell_min_us, dwell_max_us);
+
+    srand(0);
+    uint32_t detected = 0;
+    uint32_t cycle_us_max = 0;
+    for(size_t i = 0; i < SWEEP_TEST_BURST_COUNT; i++) {
+        // Burst starts at random phase of sweep cycle
+        model.carrier_frequency =
+            sweep_test_frequencies[rand() % COUNT_OF(sweep_test_frequencies)];
+        model.burst_start_us = model.time_us + rand() % 50000;
+        model.burst_end_us = model.burst_start_us + SWEEP_TEST_BURST_US;
+
+        while(model.time_us < model.burst_end_us) {
+            uint32_t cycle_start = model.time_us;
+            FrequencyRSSI result = subghz_frequency_analyzer_sweep_coarse(sweep);
+            uint32_t cycle_us = model.time_us - cycle_start;
+            if(cycle_us > cycle_us_max) cycle_us_max = cycle_us;
+            if(result.rssi > -90.0f && result.frequency / 400 == model.carrier_frequency / 400) {
+                detected++;
+                break;
+            }
+        }
+        model.time_us = model.burst_end_us;
+    }
+
+    FURI_LOG_I(
+        TAG,
+        "Dwell %lu..%luus: sweep %luus, spin %lu%%, detected %lu/%u",
+        dwell_min_us,
+        dwell_max_us,
+        cycle_us_max,
+        model.spin_us / (model.time_us / 100),
+        detected,
+        SWEEP_TEST_BURST_COUNT);
+
+    subghz_frequency_analyzer_sweep_free(sweep);
+    return detected;
+}
+
+MU_TEST(subghz_frequency_analyzer_detection_test) {
+    // Previous fixed 3 tick dwell
+    uint32_t detected_fixed = sweep_test_detection(3000, 3000);
+    uint32_t detected_adaptive = sweep_test_detection(600, 3000);
+    mu_assert(detected_adaptive >= detected_fixed, "adaptive dwell detects less bursts");
+}
+
+MU_TEST_SUITE(subghz_frequency_analyzer) {
+    MU_RUN_TEST(subghz_frequency_analyzer_refine_test);
+    MU_RUN_TEST(subghz_frequency_analyzer_detection_test);
+}
+
+int run_minunit_test_subghz_frequency_analyzer() {
+    MU_RUN_SUITE(subghz_frequency_analyzer);
+    return MU_EXIT_CODE;
+}
@@ -14,6 +14,9 @@ int run_minunit();
 int run_minunit_test_irda_decoder_encoder();
 int run_minunit_test_rpc();
 int run_minunit_test_flipper_file();
+int run_minunit_test_subghz_worker();
+int run_minunit_test_subghz_frequency_analyzer();
+int run_minunit_test_bad_usb();
 
 void minunit_print_progress(void) {
     static char progress[] = {'\\', '|', '/', '-'};
@@ -47,20 +50,23 @@ void unit_tests_cli(Cli* cli, string_t args, void* context) {
     } else {
         notification_message_block(notification, &sequence_set_only_blue_255);
 
-        uint32_t heap_before = memmgr_get_free_heap();
+        uint32_t heap_before = memmgr_get_free_heap() + memmgr_get_free_slab();
         uint32_t cycle_counter = DWT->CYCCNT;
 
         test_result |= run_minunit();
         test_result |= run_minunit_test_irda_decoder_encoder();
         test_result |= run_minunit_test_rpc();
         test_result |= run_minunit_test_flipper_file();
+        test_result |= run_minunit_test_subghz_worker();
+        test_result |= run_minunit_test_subghz_frequency_analyzer();
+        test_result |= run_minunit_test_bad_usb();
         cycle_counter = (DWT->CYCCNT - cycle_counter);
 
         FURI_LOG_I(TAG, "Consumed: %0.2fs", (float)cycle_counter / (SystemCoreClock));
 
         if(test_result == 0) {
             delay(200); /* wait for tested services and apps to deallocate */
-            uint32_t heap_after = memmgr_get_free_heap();
+            uint32_t heap_after = memmgr_get_free_heap() + memmgr_get_free_slab();
             notification_message(notification, &sequence_success);
             if(heap_after != heap_before) {
                 FURI_LOG_E(TAG, "Leaked: %d", heap_before - heap_after);
@@ -1,9 +1,25 @@
 #include "api-interrupt-mgr.h"
 #include <cmsis_os2.h>
 #include <furi.h>
+#include <furi-hal-delay.h>
+
+#if defined(SRV_PROFILER) && !defined(FURI_HOST)
+#include <FreeRTOS.h>
+#include <task.h>
+/* Thread local storage slot with handler cycles taken from preempted thread */
+#define API_INTERRUPT_TLS_INDEX 0
+#endif
 
 static volatile InterruptCallbackItem callback_list[InterruptTypeLast];
 
+#ifdef SRV_PROFILER
+/* Nested handler always exits before the one it preempted resumes, so plain
+read-modify-write is enough here */
+static volatile uint32_t api_interrupt_nesting = 0;
+static volatile uint32_t api_interrupt_start = 0;
+static volatile uint32_t api_interrupt_cycles = 0;
+#endif
+
 bool api_interrupt_init() {
     for(uint8_t i = 0; i < InterruptTypeLast; i++) {
         callback_list[i].callback = NULL;
@@ -59,7 +75,50 @@ void api_interrupt_call(InterruptType type, void* hw) {
 
     if(callback_list[type].callback != NULL) {
         if(callback_list[type].ready) {
+            api_interrupt_enter();
+            FURI_TRACE_ISR_ENTER("interrupt", type);
             callback_list[type].callback(hw, callback_list[type].context);
+            FURI_TRACE_ISR_EXIT("interrupt", type);
+            api_interrupt_exit();
         }
     }
 }
+
+#ifdef SRV_PROFILER
+void api_interrupt_enter() {
+    if(api_interrupt_nesting++ == 0) {
+        api_interrupt_start = furi_hal_delay_get_cycles();
+    }
+}
+
+void api_interrupt_exit() {
+    furi_assert(api_interrupt_nesting > 0);
+    if(--api_interrupt_nesting == 0) {
+        uint32_t cycles = furi_hal_delay_get_cycles() - api_interrupt_start;
+        api_interrupt_cycles += cycles;
+#ifndef FURI_HOST
+        // Run time counter charges handler to thread it preempted, keep the difference
+        TaskHandle_t task = xTaskGetCurrentTaskHandle();
+        if(task) {
+            uintptr_t task_cycles =
+                (uintptr_t)pvTaskGetThreadLocalStoragePointer(task, API_INTERRUPT_TLS_INDEX);
+            vTaskSetThreadLocalStoragePointer(
+                task, API_INTERRUPT_TLS_INDEX, (void*)(task_cycles + cycles));
+        }
+#endif
+    }
+}
+
+uint32_t api_interrupt_get_cycles() {
+    return api_interrupt_cycles;
+}
+
+uint32_t api_interrupt_get_thread_cycles(void* thread) {
+#ifdef FURI_HOST
+    (void)thread;
+    return 0;
+#else
+    return (uintptr_t)pvTaskGetThreadLocalStoragePointer(thread, API_INTERRUPT_TLS_INDEX);
+#endif
+}
+#endif
@@ -6,6 +6,7 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -70,6 +71,40 @@ void api_interrupt_disable(InterruptCallback callback, InterruptType type);
  */
 void api_interrupt_call(InterruptType type, void* hw);
 
+#ifdef SRV_PROFILER
+/** Mark interrupt handler entry for ISR load accounting
+ *
+ * Handlers may nest, time is counted from outermost entry to its exit.
+ */
+void api_interrupt_enter();
+
+/** Mark interrupt handler exit for ISR load accounting */
+void api_interrupt_exit();
+
+/** Get time spent in accounted interrupt handlers
+ *
+ * @return     CPU cycles, wraps around
+ */
+uint32_t api_interrupt_get_cycles();
+
+/** Get time accounted handlers took from thread they preempted
+ *
+ * Thread run time counter includes it, subtract to get thread own time.
+ *
+ * @param      thread  TaskHandle_t
+ *
+ * @return     CPU cycles, wraps around, 0 on host
+ */
+uint32_t api_interrupt_get_thread_cycles(void* thread);
+#else
+/* ISR load accounting is for profiler only, free in builds without it */
+static inline void api_interrupt_enter() {
+}
+
+static inline void api_interrupt_exit() {
+}
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -8,12 +8,14 @@
 
 #include <furi/common_defines.h>
 #include <furi/check.h>
+#include <furi/event_loop.h>
 #include <furi/memmgr.h>
 #include <furi/memmgr_heap.h>
 #include <furi/pubsub.h>
 #include <furi/record.h>
 #include <furi/stdglue.h>
 #include <furi/thread.h>
+#include <furi/trace.h>
 #include <furi/valuemutex.h>
 #include <furi/log.h>
 
@@ -1,7 +1,9 @@
 #include "check.h"
 #include "furi-hal-task.h"
+#include "log.h"
 #include <furi-hal-console.h>
 #include <stdio.h>
+#include <stdlib.h>
 
 void __furi_print_name(void) {
     if(task_is_isr_context()) {
@@ -18,14 +20,27 @@ void __furi_print_name(void) {
     }
 }
 
+/* Nothing runs after us: no interrupts, so no context switch either */
+static void __furi_stop(void) {
+#ifndef FURI_HOST
+    __disable_irq();
+#endif
+    furi_log_drain_sync();
+}
+
 void __furi_abort(void) {
+#ifdef FURI_HOST
+    abort();
+#else
     __disable_irq();
     asm("bkpt 1");
     while(1) {
     }
+#endif
 }
 
 void furi_crash(const char* message) {
+    __furi_stop();
     furi_hal_console_puts("\r\n\033[0;31m[CRASH]");
     __furi_print_name();
     furi_hal_console_puts(message ? message : "Programming Error");
@@ -33,3 +48,13 @@ void furi_crash(const char* message) {
     furi_hal_console_puts("\033[0m\r\n");
     __furi_abort();
 }
+
+void furi_halt(const char* message) {
+    __furi_stop();
+    furi_hal_console_puts("\r\n\033[0;31m[HALT]");
+    __furi_print_name();
+    furi_hal_console_puts(message ? message : "System halt requested.");
+    furi_hal_console_puts("\r\nSystem halted. Bye-bye!\r\n");
+    furi_hal_console_puts("\033[0m\r\n");
+    __furi_abort();
+}
@@ -14,9 +14,12 @@ extern "C" {
 #define furi_assert(__e) ((void)0)
 #endif
 
-/** Crash system */
+/** Crash system, pending log records are output first */
 void furi_crash(const char* message);
 
+/** Halt system without crash report, pending log records are output first */
+void furi_halt(const char* message);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,505 @@
+#include "event_loop.h"
+#include "check.h"
+#include "memmgr.h"
+
+#include <FreeRTOS.h>
+#include <stream_buffer.h>
+#include <furi-hal-task.h>
+#include <stdatomic.h>
+
+#define FURI_EVENT_LOOP_TIMER_IDLE SIZE_MAX
+#define FURI_EVENT_LOOP_TIMERS_INITIAL 4
+
+struct FuriEventLoopSignal {
+    FuriEventLoop* loop;
+    uint32_t bit;
+    FuriEventLoopCallback callback;
+    void* context;
+};
+
+struct FuriEventLoopTimer {
+    FuriEventLoop* loop;
+    FuriEventLoopCallback callback;
+    void* context;
+    uint32_t deadline;
+    uint32_t period;
+    bool periodic;
+    size_t index; /**< Position in heap, FURI_EVENT_LOOP_TIMER_IDLE if not armed */
+};
+
+struct FuriEventLoopMessageQueue {
+    FuriEventLoopSignal* signal;
+    osMessageQueueId_t queue;
+    FuriEventLoopCallback callback;
+    void* context;
+};
+
+struct FuriEventLoopStreamBuffer {
+    FuriEventLoopSignal* signal;
+    StreamBufferHandle_t stream_buffer;
+    FuriEventLoopCallback callback;
+    void* context;
+};
+
+struct FuriEventLoop {
+    osThreadId_t _Atomic thread; /**< Running thread, NULL if not running */
+    atomic_uint pending; /**< Set signals, by bit */
+    atomic_bool stop;
+    FuriEventLoopSignal* signals[FURI_EVENT_LOOP_SIGNALS_MAX];
+    /* Protects signal slots and timer heap */
+    osMutexId_t mutex;
+    /* Min-heap by deadline */
+    FuriEventLoopTimer** timers;
+    size_t timers_count;
+    size_t timers_size;
+    /* Timer whose callback is running, timer free waits for it */
+    FuriEventLoopTimer* _Atomic timer_current;
+    /* Returns from wait, and those after which nothing was dispatched */
+    atomic_uint wakeups;
+    atomic_uint idle_wakeups;
+};
+
+static inline bool furi_event_loop_is_before(uint32_t a, uint32_t b) {
+    return (int32_t)(a - b) < 0;
+}
+
+static void furi_event_loop_wake(FuriEventLoop* loop) {
+    osThreadId_t thread = atomic_load(&loop->thread);
+    if(thread) {
+        osThreadFlagsSet(thread, FURI_EVENT_LOOP_THREAD_FLAG);
+    }
+}
+
+FuriEventLoop* furi_event_loop_alloc() {
+    FuriEventLoop* loop = furi_alloc(sizeof(FuriEventLoop));
+
+    atomic_init(&loop->thread, NULL);
+    atomic_init(&loop->pending, 0);
+    atomic_init(&loop->stop, false);
+    atomic_init(&loop->timer_current, NULL);
+    atomic_init(&loop->wakeups, 0);
+    atomic_init(&loop->idle_wakeups, 0);
+
+    loop->mutex = osMutexNew(NULL);
+    furi_check(loop->mutex);
+
+    loop->timers_size = FURI_EVENT_LOOP_TIMERS_INITIAL;
+    loop->timers = furi_alloc(loop->timers_size * sizeof(FuriEventLoopTimer*));
+
+    return loop;
+}
+
+void furi_event_loop_free(FuriEventLoop* loop) {
+    furi_assert(loop);
+    furi_check(atomic_load(&loop->thread) == NULL);
+    for(size_t i = 0; i < FURI_EVENT_LOOP_SIGNALS_MAX; i++) {
+        furi_check(loop->signals[i] == NULL);
+    }
+    furi_check(loop->timers_count == 0);
+
+    free(loop->timers);
+    furi_check(osMutexDelete(loop->mutex) == osOK);
+    free(loop);
+}
+
+/* Timer heap, called with mutex taken */
+
+static void
+    furi_event_loop_timers_place(FuriEventLoop* loop, size_t index, FuriEventLoopTimer* timer) {
+    loop->timers[index] = timer;
+    timer->index = index;
+}
+
+static void furi_event_loop_timers_sift_up(FuriEventLoop* loop, size_t index) {
+    FuriEventLoopTimer* timer = loop->timers[index];
+    while(index > 0) {
+        size_t parent = (index - 1) / 2;
+        if(!furi_event_loop_is_before(timer->deadline, loop->timers[parent]->deadline)) break;
+        furi_event_loop_timers_place(loop, index, loop->timers[parent]);
+        index = parent;
+    }
+    furi_event_loop_timers_place(loop, index, timer);
+}
+
+static void furi_event_loop_timers_sift_down(FuriEventLoop* loop, size_t index) {
+    FuriEventLoopTimer* timer = loop->timers[index];
+    while(true) {
+        size_t child = index * 2 + 1;
+        if(child >= loop->timers_count) break;
+        if(child + 1 < loop->timers_count &&
+           furi_event_loop_is_before(
+               loop->timers[child + 1]->deadline, loop->timers[child]->deadline)) {
+            child++;
+        }
+        if(!furi_event_loop_is_before(loop->timers[child]->deadline, timer->deadline)) break;
+        furi_event_loop_timers_place(loop, index, loop->timers[child]);
+        index = child;
+    }
+    furi_event_loop_timers_place(loop, index, timer);
+}
+
+static void furi_event_loop_timers_insert(FuriEventLoop* loop, FuriEventLoopTimer* timer) {
+    if(loop->timers_count == loop->timers_size) {
+        loop->timers_size *= 2;
+        loop->timers = realloc(loop->timers, loop->timers_size * sizeof(FuriEventLoopTimer*));
+        furi_check(loop->timers);
+    }
+    furi_event_loop_timers_place(loop, loop->timers_count++, timer);
+    furi_event_loop_timers_sift_up(loop, timer->index);
+}
+
+static void furi_event_loop_timers_remove(FuriEventLoop* loop, FuriEventLoopTimer* timer) {
+    size_t index = timer->index;
+    timer->index = FURI_EVENT_LOOP_TIMER_IDLE;
+    loop->timers_count--;
+    if(index == loop->timers_count) return;
+
+    // Put last one in the hole and restore order in whatever direction it breaks
+    FuriEventLoopTimer* last = loop->timers[loop->timers_count];
+    furi_event_loop_timers_place(loop, index, last);
+    if(index > 0 &&
+       furi_event_loop_is_before(last->deadline, loop->timers[(index - 1) / 2]->deadline)) {
+        furi_event_loop_timers_sift_up(loop, index);
+    } else {
+        furi_event_loop_timers_sift_down(loop, index);
+    }
+}
+
+static bool furi_event_loop_process_timers(FuriEventLoop* loop) {
+    uint32_t now = osKernelGetTickCount();
+    bool dispatched = false;
+
+    furi_check(osMutexAcquire(loop->mutex, osWaitForever) == osOK);
+    while(loop->timers_count && !furi_event_loop_is_before(now, loop->timers[0]->deadline)) {
+        FuriEventLoopTimer* timer = loop->timers[0];
+        furi_event_loop_timers_remove(loop, timer);
+        if(timer->periodic) {
+            // Keep phase, but don't try to catch up missed periods
+            timer->deadline += timer->period;
+            if(furi_event_loop_is_before(timer->deadline, now)) {
+                timer->deadline = now + timer->period;
+            }
+            furi_event_loop_timers_insert(loop, timer);
+        }
+
+        // Callback runs unlocked: it may take locks that timer users hold
+        atomic_store(&loop->timer_current, timer);
+        furi_check(osMutexRelease(loop->mutex) == osOK);
+        timer->callback(timer->context);
+        dispatched = true;
+        furi_check(osMutexAcquire(loop->mutex, osWaitForever) == osOK);
+        atomic_store(&loop->timer_current, NULL);
+    }
+    furi_check(osMutexRelease(loop->mutex) == osOK);
+
+    return dispatched;
+}
+
+static uint32_t furi_event_loop_get_timeout(FuriEventLoop* loop) {
+    uint32_t timeout = osWaitForever;
+
+    furi_check(osMutexAcquire(loop->mutex, osWaitForever) == osOK);
+    if(loop->timers_count) {
+        uint32_t now = osKernelGetTickCount();
+        uint32_t deadline = loop->timers[0]->deadline;
+        timeout = furi_event_loop_is_before(now, deadline) ? deadline - now : 0;
+    }
+    furi_check(osMutexRelease(loop->mutex) == osOK);
+
+    return timeout;
+}
+
+static bool furi_event_loop_process_signals(FuriEventLoop* loop) {
+    bool dispatched = false;
+    // Bit by bit, so signal set by earlier callback is handled in this pass
+    for(size_t i = 0; i < FURI_EVENT_LOOP_SIGNALS_MAX; i++) {
+        uint32_t bit = 1U << i;
+        if(!(atomic_load(&loop->pending) & bit)) continue;
+        if(atomic_fetch_and(&loop->pending, ~bit) & bit) {
+            FuriEventLoopSignal* signal = loop->signals[i];
+            if(signal) {
+                signal->callback(signal->context);
+                dispatched = true;
+            }
+        }
+    }
+
+    return dispatched;
+}
+
+void furi_event_loop_run(FuriEventLoop* loop) {
+    furi_assert(loop);
+
+    osThreadId_t thread = osThreadGetId();
+    osThreadId_t expected = NULL;
+    furi_check(atomic_compare_exchange_strong(&loop->thread, &expected, thread));
+
+    bool woken = false;
+    while(true) {
+        bool dispatched = furi_event_loop_process_timers(loop);
+        dispatched |= furi_event_loop_process_signals(loop);
+        if(atomic_exchange(&loop->stop, false)) break;
+        if(woken && !dispatched) atomic_fetch_add(&loop->idle_wakeups, 1);
+
+        osThreadFlagsWait(
+            FURI_EVENT_LOOP_THREAD_FLAG, osFlagsWaitAny, furi_event_loop_get_timeout(loop));
+        atomic_fetch_add(&loop->wakeups, 1);
+        woken = true;
+    }
+
+    atomic_store(&loop->thread, NULL);
+    osThreadFlagsClear(FURI_EVENT_LOOP_THREAD_FLAG);
+}
+
+void furi_event_loop_stop(FuriEventLoop* loop) {
+    furi_assert(loop);
+    atomic_store(&loop->stop, true);
+    furi_event_loop_wake(loop);
+}
+
+uint32_t furi_event_loop_get_wakeups(FuriEventLoop* loop) {
+    furi_assert(loop);
+    return atomic_load(&loop->wakeups);
+}
+
+uint32_t furi_event_loop_get_idle_wakeups(FuriEventLoop* loop) {
+    furi_assert(loop);
+    return atomic_load(&loop->idle_wakeups);
+}
+
+FuriEventLoopSignal* furi_event_loop_signal_alloc(
+    FuriEventLoop* loop,
+    FuriEventLoopCallback callback,
+    void* context) {
+    furi_assert(loop);
+    furi_assert(callback);
+
+    FuriEventLoopSignal* signal = furi_alloc(sizeof(FuriEventLoopSignal));
+    signal->loop = loop;
+    signal->callback = callback;
+    signal->context = context;
+
+    furi_check(osMutexAcquire(loop->mutex, osWaitForever) == osOK);
+    size_t i = 0;
+    while(i < FURI_EVENT_LOOP_SIGNALS_MAX && loop->signals[i]) i++;
+    furi_check(i < FURI_EVENT_LOOP_SIGNALS_MAX);
+    signal->bit = 1U << i;
+    loop->signals[i] = signal;
+    furi_check(osMutexRelease(loop->mutex) == osOK);
+
+    return signal;
+}
+
+void furi_event_loop_signal_free(FuriEventLoopSignal* signal) {
+    furi_assert(signal);
+    FuriEventLoop* loop = signal->loop;
+
+    furi_check(osMutexAcquire(loop->mutex, osWaitForever) == osOK);
+    atomic_fetch_and(&loop->pending, ~signal->bit);
+    for(size_t i = 0; i < FURI_EVENT_LOOP_SIGNALS_MAX; i++) {
+        if(loop->signals[i] == signal) loop->signals[i] = NULL;
+    }
+    furi_check(osMutexRelease(loop->mutex) == osOK);
+
+    free(signal);
+}
+
+void furi_event_loop_signal_set(FuriEventLoopSignal* signal) {
+    furi_assert(signal);
+    atomic_fetch_or(&signal->loop->pending, signal->bit);
+    furi_event_loop_wake(signal->loop);
+}
+
+FuriEventLoopTimer* furi_event_loop_timer_alloc(
+    FuriEventLoop* loop,
+    FuriEventLoopCallback callback,
+    void* context) {
+    furi_assert(loop);
+    furi_assert(callback);
+
+    FuriEventLoopTimer* timer = furi_alloc(sizeof(FuriEventLoopTimer));
+    timer->loop = loop;
+    timer->callback = callback;
+    timer->context = context;
+    timer->index = FURI_EVENT_LOOP_TIMER_IDLE;
+
+    return timer;
+}
+
+void furi_event_loop_timer_free(FuriEventLoopTimer* timer) {
+    furi_assert(timer);
+    FuriEventLoop* loop = timer->loop;
+
+    furi_event_loop_timer_stop(timer);
+    // Loop thread is either in this very callback or not in any
+    if(osThreadGetId() != atomic_load(&loop->thread)) {
+        while(atomic_load(&loop->timer_current) == timer) osDelay(1);
+    }
+
+    free(timer);
+}
+
+void furi_event_loop_timer_start(FuriEventLoopTimer* timer, uint32_t period, bool periodic) {
+    furi_assert(timer);
+    furi_assert(period);
+    FuriEventLoop* loop = timer->loop;
+
+    furi_check(osMutexAcquire(loop->mutex, osWaitForever) == osOK);
+    if(timer->index != FURI_EVENT_LOOP_TIMER_IDLE) {
+        furi_event_loop_timers_remove(loop, timer);
+    }
+    timer->period = period;
+    timer->periodic = periodic;
+    timer->deadline = osKernelGetTickCount() + period;
+    furi_event_loop_timers_insert(loop, timer);
+    bool is_first = timer->index == 0;
+    furi_check(osMutexRelease(loop->mutex) == osOK);
+
+    // Loop sleeps till previous nearest deadline, make it recalculate
+    if(is_first && osThreadGetId() != atomic_load(&loop->thread)) {
+        furi_event_loop_wake(loop);
+    }
+}
+
+void furi_event_loop_timer_stop(FuriEventLoopTimer* timer) {
+    furi_assert(timer);
+    FuriEventLoop* loop = timer->loop;
+
+    furi_check(osMutexAcquire(loop->mutex, osWaitForever) == osOK);
+    if(timer->index != FURI_EVENT_LOOP_TIMER_IDLE) {
+        furi_event_loop_timers_remove(loop, timer);
+    }
+    furi_check(osMutexRelease(loop->mutex) == osOK);
+}
+
+bool furi_event_loop_timer_is_running(FuriEventLoopTimer* timer) {
+    furi_assert(timer);
+    FuriEventLoop* loop = timer->loop;
+
+    furi_check(osMutexAcquire(loop->mutex, osWaitForever) == osOK);
+    bool is_running = timer->index != FURI_EVENT_LOOP_TIMER_IDLE;
+    furi_check(osMutexRelease(loop->mutex) == osOK);
+
+    return is_running;
+}
+
+static void furi_event_loop_message_queue_callback(void* context) {
+    FuriEventLoopMessageQueue* queue = context;
+    queue->callback(queue->context);
+    if(osMessageQueueGetCount(queue->queue)) {
+        furi_event_loop_signal_set(queue->signal);
+    }
+}
+
+FuriEventLoopMessageQueue* furi_event_loop_message_queue_alloc(
+    FuriEventLoop* loop,
+    uint32_t count,
+    uint32_t message_size,
+    FuriEventLoopCallback callback,
+    void* context) {
+    furi_assert(loop);
+    furi_assert(callback);
+
+    FuriEventLoopMessageQueue* queue = furi_alloc(sizeof(FuriEventLoopMessageQueue));
+    queue->queue = osMessageQueueNew(count, message_size, NULL);
+    furi_check(queue->queue);
+    queue->callback = callback;
+    queue->context = context;
+    queue->signal =
+        furi_event_loop_signal_alloc(loop, furi_event_loop_message_queue_callback, queue);
+
+    return queue;
+}
+
+void furi_event_loop_message_queue_free(FuriEventLoopMessageQueue* queue) {
+    furi_assert(queue);
+    furi_event_loop_signal_free(queue->signal);
+    furi_check(osMessageQueueDelete(queue->queue) == osOK);
+    free(queue);
+}
+
+osStatus_t furi_event_loop_message_queue_put(
+    FuriEventLoopMessageQueue* queue,
+    const void* message,
+    uint32_t timeout) {
+    furi_assert(queue);
+    osStatus_t status = osMessageQueuePut(queue->queue, message, 0, timeout);
+    if(status == osOK) {
+        furi_event_loop_signal_set(queue->signal);
+    }
+    return status;
+}
+
+osStatus_t furi_event_loop_message_queue_get(
+    FuriEventLoopMessageQueue* queue,
+    void* message,
+    uint32_t timeout) {
+    furi_assert(queue);
+    return osMessageQueueGet(queue->queue, message, NULL, timeout);
+}
+
+static void furi_event_loop_stream_buffer_callback(void* context) {
+    FuriEventLoopStreamBuffer* stream_buffer = context;
+    stream_buffer->callback(stream_buffer->context);
+    if(xStreamBufferIsEmpty(stream_buffer->stream_buffer) != pdTRUE) {
+        furi_event_loop_signal_set(stream_buffer->signal);
+    }
+}
+
+FuriEventLoopStreamBuffer* furi_event_loop_stream_buffer_alloc(
+    FuriEventLoop* loop,
+    size_t size,
+    FuriEventLoopCallback callback,
+    void* context) {
+    furi_assert(loop);
+    furi_assert(callback);
+
+    FuriEventLoopStreamBuffer* stream_buffer = furi_alloc(sizeof(FuriEventLoopStreamBuffer));
+    stream_buffer->stream_buffer = xStreamBufferCreate(size, 1);
+    furi_check(stream_buffer->stream_buffer);
+    stream_buffer->callback = callback;
+    stream_buffer->context = context;
+    stream_buffer->signal = furi_event_loop_signal_alloc(
+        loop, furi_event_loop_stream_buffer_callback, stream_buffer);
+
+    return stream_buffer;
+}
+
+void furi_event_loop_stream_buffer_free(FuriEventLoopStreamBuffer* stream_buffer) {
+    furi_assert(stream_buffer);
+    furi_event_loop_signal_free(stream_buffer->signal);
+    vStreamBufferDelete(stream_buffer->stream_buffer);
+    free(stream_buffer);
+}
+
+size_t furi_event_loop_stream_buffer_send(
+    FuriEventLoopStreamBuffer* stream_buffer,
+    const void* data,
+    size_t size,
+    uint32_t timeout) {
+    furi_assert(stream_buffer);
+
+    size_t sent;
+    if(task_is_isr_context()) {
+        BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+        sent = xStreamBufferSendFromISR(
+            stream_buffer->stream_buffer, data, size, &xHigherPriorityTaskWoken);
+        portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+    } else {
+        sent = xStreamBufferSend(stream_buffer->stream_buffer, data, size, timeout);
+    }
+    if(sent) {
+        furi_event_loop_signal_set(stream_buffer->signal);
+    }
+
+    return sent;
+}
+
+size_t furi_event_loop_stream_buffer_receive(
+    FuriEventLoopStreamBuffer* stream_buffer,
+    void* data,
+    size_t size,
+    uint32_t timeout) {
+    furi_assert(stream_buffer);
+    return xStreamBufferReceive(stream_buffer->stream_buffer, data, size, timeout);
+}
@@ -0,0 +1,305 @@
+/**
+ * @file event_loop.h
+ * Furi: event loop
+ *
+ * Single thread waits for all its event sources at once: signals (coalescing
+ * flags), message queues, stream buffers and timers. Sources are registered
+ * with callbacks, loop thread sleeps in one blocking wait until something is
+ * signaled or the nearest timer expires. Timers of one loop live in a single
+ * heap, no timer service thread is involved.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <cmsis_os2.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Max signals per loop, message queues and stream buffers take one each */
+#define FURI_EVENT_LOOP_SIGNALS_MAX 32
+
+/** Loop owner thread flag, must not be used by loop thread for other needs */
+#define FURI_EVENT_LOOP_THREAD_FLAG (1U << 23)
+
+/** FuriEventLoop anonymous structure */
+typedef struct FuriEventLoop FuriEventLoop;
+
+/** FuriEventLoopSignal anonymous structure */
+typedef struct FuriEventLoopSignal FuriEventLoopSignal;
+
+/** FuriEventLoopTimer anonymous structure */
+typedef struct FuriEventLoopTimer FuriEventLoopTimer;
+
+/** FuriEventLoopMessageQueue anonymous structure */
+typedef struct FuriEventLoopMessageQueue FuriEventLoopMessageQueue;
+
+/** FuriEventLoopStreamBuffer anonymous structure */
+typedef struct FuriEventLoopStreamBuffer FuriEventLoopStreamBuffer;
+
+/** Event source callback, called in loop thread
+ *
+ * @param      context  callback context
+ */
+typedef void (*FuriEventLoopCallback)(void* context);
+
+/** Allocate FuriEventLoop
+ *
+ * @return     FuriEventLoop instance
+ */
+FuriEventLoop* furi_event_loop_alloc();
+
+/** Free FuriEventLoop
+ *
+ * Loop must not be running, all sources must be freed.
+ *
+ * @param      loop  FuriEventLoop instance
+ */
+void furi_event_loop_free(FuriEventLoop* loop);
+
+/** Run loop in current thread until furi_event_loop_stop
+ *
+ * Sources signaled before run are dispatched right away.
+ *
+ * @param      loop  FuriEventLoop instance
+ */
+void furi_event_loop_run(FuriEventLoop* loop);
+
+/** Stop loop
+ *
+ * Threadsafe. Loop finishes current iteration and furi_event_loop_run
+ * returns. Stop requested before run makes next run return after first
+ * iteration.
+ *
+ * @param      loop  FuriEventLoop instance
+ */
+void furi_event_loop_stop(FuriEventLoop* loop);
+
+/** Get number of times loop thread woke up from its wait
+ *
+ * Threadsafe. Counts since allocation, across runs.
+ *
+ * @param      loop  FuriEventLoop instance
+ *
+ * @return     wakeups count, wraps around
+ */
+uint32_t furi_event_loop_get_wakeups(FuriEventLoop* loop);
+
+/** Get number of wakeups that dispatched nothing
+ *
+ * Threadsafe. Such wakeups come from stopped timers deadlines and from flags
+ * left set by signals already handled in previous pass. Stop is not counted.
+ *
+ * @param      loop  FuriEventLoop instance
+ *
+ * @return     idle wakeups count, wraps around
+ */
+uint32_t furi_event_loop_get_idle_wakeups(FuriEventLoop* loop);
+
+/** Allocate signal
+ *
+ * Signals are dispatched in allocation order, signal set several times before
+ * dispatch calls callback once.
+ *
+ * @param      loop      FuriEventLoop instance
+ * @param      callback  called in loop thread when signal is set
+ * @param      context   callback context
+ *
+ * @return     FuriEventLoopSignal instance
+ */
+FuriEventLoopSignal* furi_event_loop_signal_alloc(
+    FuriEventLoop* loop,
+    FuriEventLoopCallback callback,
+    void* context);
+
+/** Free signal
+ *
+ * Must be called from loop thread or while loop is not running.
+ *
+ * @param      signal  FuriEventLoopSignal instance
+ */
+void furi_event_loop_signal_free(FuriEventLoopSignal* signal);
+
+/** Set signal, wakes loop
+ *
+ * Threadsafe, ISR safe.
+ *
+ * @param      signal  FuriEventLoopSignal instance
+ */
+void furi_event_loop_signal_set(FuriEventLoopSignal* signal);
+
+/** Allocate timer
+ *
+ * @param      loop      FuriEventLoop instance
+ * @param      callback  called in loop thread on expiration
+ * @param      context   callback context
+ *
+ * @return     FuriEventLoopTimer instance
+ */
+FuriEventLoopTimer* furi_event_loop_timer_alloc(
+    FuriEventLoop* loop,
+    FuriEventLoopCallback callback,
+    void* context);
+
+/** Free timer
+ *
+ * Threadsafe. Stops timer and waits for its callback in progress, so must not
+ * be called from other thread while holding lock that callback takes.
+ *
+ * @param      timer  FuriEventLoopTimer instance
+ */
+void furi_event_loop_timer_free(FuriEventLoopTimer* timer);
+
+/** Start or restart timer
+ *
+ * Threadsafe.
+ *
+ * @param      timer     FuriEventLoopTimer instance
+ * @param      period    period in ticks, must not be 0
+ * @param      periodic  true to rearm after expiration
+ */
+void furi_event_loop_timer_start(FuriEventLoopTimer* timer, uint32_t period, bool periodic);
+
+/** Stop timer
+ *
+ * Threadsafe. Callback in progress is not waited for.
+ *
+ * @param      timer  FuriEventLoopTimer instance
+ */
+void furi_event_loop_timer_stop(FuriEventLoopTimer* timer);
+
+/** Check if timer is armed
+ *
+ * @param      timer  FuriEventLoopTimer instance
+ *
+ * @return     true if timer will expire
+ */
+bool furi_event_loop_timer_is_running(FuriEventLoopTimer* timer);
+
+/** Allocate message queue bound to loop
+ *
+ * Callback is called again and again while queue is not empty, so it must get
+ * at least one message with furi_event_loop_message_queue_get. Queue may turn
+ * out empty in callback if messages were taken outside of the loop.
+ *
+ * @param      loop          FuriEventLoop instance
+ * @param      count         queue capacity in messages
+ * @param      message_size  message size in bytes
+ * @param      callback      called in loop thread when queue has messages
+ * @param      context       callback context
+ *
+ * @return     FuriEventLoopMessageQueue instance
+ */
+FuriEventLoopMessageQueue* furi_event_loop_message_queue_alloc(
+    FuriEventLoop* loop,
+    uint32_t count,
+    uint32_t message_size,
+    FuriEventLoopCallback callback,
+    void* context);
+
+/** Free message queue
+ *
+ * Must be called from loop thread or while loop is not running.
+ *
+ * @param      queue  FuriEventLoopMessageQueue instance
+ */
+void furi_event_loop_message_queue_free(FuriEventLoopMessageQueue* queue);
+
+/** Put message to queue and wake loop
+ *
+ * Threadsafe, ISR safe with zero timeout.
+ *
+ * @param      queue    FuriEventLoopMessageQueue instance
+ * @param      message  pointer to message, copied into queue
+ * @param      timeout  timeout in ticks if queue is full
+ *
+ * @return     osOK on success, osMessageQueuePut status otherwise
+ */
+osStatus_t furi_event_loop_message_queue_put(
+    FuriEventLoopMessageQueue* queue,
+    const void* message,
+    uint32_t timeout);
+
+/** Get message from queue
+ *
+ * Normally called from callback with zero timeout. Blocking get from loop
+ * thread outside of furi_event_loop_run is allowed too.
+ *
+ * @param      queue    FuriEventLoopMessageQueue instance
+ * @param      message  pointer to buffer of message size
+ * @param      timeout  timeout in ticks if queue is empty
+ *
+ * @return     osOK on success, osMessageQueueGet status otherwise
+ */
+osStatus_t furi_event_loop_message_queue_get(
+    FuriEventLoopMessageQueue* queue,
+    void* message,
+    uint32_t timeout);
+
+/** Allocate stream buffer bound to loop
+ *
+ * Callback is called again and again while buffer is not empty, so it must
+ * receive some data with furi_event_loop_stream_buffer_receive.
+ *
+ * @param      loop      FuriEventLoop instance
+ * @param      size      buffer size in bytes
+ * @param      callback  called in loop thread when buffer has data
+ * @param      context   callback context
+ *
+ * @return     FuriEventLoopStreamBuffer instance
+ */
+FuriEventLoopStreamBuffer* furi_event_loop_stream_buffer_alloc(
+    FuriEventLoop* loop,
+    size_t size,
+    FuriEventLoopCallback callback,
+    void* context);
+
+/** Free stream buffer
+ *
+ * Must be called from loop thread or while loop is not running.
+ *
+ * @param      stream_buffer  FuriEventLoopStreamBuffer instance
+ */
+void furi_event_loop_stream_buffer_free(FuriEventLoopStreamBuffer* stream_buffer);
+
+/** Send data to stream buffer and wake loop
+ *
+ * Single writer. ISR safe, timeout is ignored in ISR.
+ *
+ * @param      stream_buffer  FuriEventLoopStreamBuffer instance
+ * @param      data           data to send
+ * @param      size           data size in bytes
+ * @param      timeout        timeout in ticks if buffer is full
+ *
+ * @return     bytes sent
+ */
+size_t furi_event_loop_stream_buffer_send(
+    FuriEventLoopStreamBuffer* stream_buffer,
+    const void* data,
+    size_t size,
+    uint32_t timeout);
+
+/** Receive data from stream buffer
+ *
+ * Loop thread only.
+ *
+ * @param      stream_buffer  FuriEventLoopStreamBuffer instance
+ * @param      data           destination
+ * @param      size           destination size in bytes
+ * @param      timeout        timeout in ticks if buffer is empty
+ *
+ * @return     bytes received
+ */
+size_t furi_event_loop_stream_buffer_receive(
+    FuriEventLoopStreamBuffer* stream_buffer,
+    void* data,
+    size_t size,
+    uint32_t timeout);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,45 +1,539 @@
 #include "log.h"
 #include "check.h"
+#include "common_defines.h"
 #include <cmsis_os2.h>
 #include <furi-hal.h>
 
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <string.h>
+
 #define FURI_LOG_LEVEL_DEFAULT FuriLogLevelInfo
 
+/* Ring size, must be power of two */
+#ifndef FURI_LOG_BUFFER_SIZE
+#define FURI_LOG_BUFFER_SIZE 2048
+#endif
+/* Packed arguments per record, arguments that do not fit are printed as is */
+#define FURI_LOG_ARGS_SIZE 96
+/* Longest copied string argument */
+#define FURI_LOG_STRING_SIZE 48
+/* Drain output chunk */
+#define FURI_LOG_LINE_SIZE 128
+/* Drain thread flag, set by producer that publishes record drain waits for */
+#define FURI_LOG_DRAIN_FLAG_PUBLISHED (1UL << 0)
+#define FURI_LOG_DRAIN_STACK_SIZE 2048
+
+/* Record header word: size, level and valid flag. Written last by producer,
+ring space is zeroed by drain, so a record is complete once flag is seen. */
+#define FURI_LOG_RECORD_VALID (1UL << 31)
+#define FURI_LOG_RECORD_SIZE_MASK (0xFFFFUL)
+#define FURI_LOG_RECORD_LEVEL_SHIFT 16
+
+#define FURI_LOG_BINARY_VERSION 1
+
+_Static_assert(
+    (FURI_LOG_BUFFER_SIZE & (FURI_LOG_BUFFER_SIZE - 1)) == 0,
+    "log buffer size must be power of two");
+
+typedef struct {
+    uint32_t header;
+    uint32_t timestamp;
+    const char* format; /**< NULL for dropped records notice */
+} FuriLogRecord;
+
+#define FURI_LOG_RECORD_SIZE_MAX \
+    ((sizeof(FuriLogRecord) + FURI_LOG_ARGS_SIZE + 3) & ~(size_t)3)
+
+typedef enum {
+    FuriLogArgNone, /**< Unsupported conversion, stops argument handling */
+    FuriLogArgLiteral,
+    FuriLogArgInt,
+    FuriLogArgLong,
+    FuriLogArgLongLong,
+    FuriLogArgSize,
+    FuriLogArgPointer,
+    FuriLogArgDouble,
+    FuriLogArgString, /**< Length byte and characters, no terminator */
+} FuriLogArg;
+
+typedef struct {
+    FuriLogArg arg;
+    uint8_t stars; /**< Width and precision passed as int arguments */
+    bool star_precision;
+    int precision; /**< Literal precision or -1 */
+} FuriLogSpec;
+
+typedef struct {
+    char buffer[FURI_LOG_LINE_SIZE];
+    size_t size;
+} FuriLogLine;
+
 typedef struct {
     FuriLogLevel log_level;
+    FuriLogMode mode;
     FuriLogPuts puts;
+    FuriLogTx tx;
     FuriLogTimestamp timetamp;
-    osMutexId_t mutex;
+    osThreadId_t thread;
+    atomic_uint reserve; /**< Producers reserve space here */
+    atomic_uint tail; /**< Drain position */
+    atomic_uint dropped;
+    uint32_t dropped_reported;
+    bool binary_header_sent;
 } FuriLogParams;
 
 static FuriLogParams furi_log;
+static uint32_t furi_log_buffer[FURI_LOG_BUFFER_SIZE / sizeof(uint32_t)];
+
+static inline uint32_t* furi_log_header_at(uint32_t position) {
+    return &furi_log_buffer[(position & (FURI_LOG_BUFFER_SIZE - 1)) / sizeof(uint32_t)];
+}
+
+static void furi_log_ring_write(uint32_t position, const void* data, size_t size) {
+    uint8_t* ring = (uint8_t*)furi_log_buffer;
+    size_t offset = position & (FURI_LOG_BUFFER_SIZE - 1);
+    size_t chunk = MIN(size, FURI_LOG_BUFFER_SIZE - offset);
+    memcpy(&ring[offset], data, chunk);
+    memcpy(ring, (const uint8_t*)data + chunk, size - chunk);
+}
+
+static void furi_log_ring_read(uint32_t position, void* data, size_t size) {
+    uint8_t* ring = (uint8_t*)furi_log_buffer;
+    size_t offset = position & (FURI_LOG_BUFFER_SIZE - 1);
+    size_t chunk = MIN(size, FURI_LOG_BUFFER_SIZE - offset);
+    memcpy(data, &ring[offset], chunk);
+    memcpy((uint8_t*)data + chunk, ring, size - chunk);
+}
+
+static void furi_log_ring_clear(uint32_t position, size_t size) {
+    uint8_t* ring = (uint8_t*)furi_log_buffer;
+    size_t offset = position & (FURI_LOG_BUFFER_SIZE - 1);
+    size_t chunk = MIN(size, FURI_LOG_BUFFER_SIZE - offset);
+    memset(&ring[offset], 0, chunk);
+    memset(ring, 0, size - chunk);
+}
+
+/* Parse conversion after '%', returns pointer past it */
+static const char* furi_log_spec_parse(const char* format, FuriLogSpec* spec) {
+    spec->stars = 0;
+    spec->star_precision = false;
+    spec->precision = -1;
+
+    while(*format && strchr("-+ #0", *format)) format++;
+    if(*format == '*') {
+        spec->stars++;
+        format++;
+    }
+    while(*format >= '0' && *format <= '9') format++;
+    if(*format == '.') {
+        format++;
+        spec->precision = 0;
+        if(*format == '*') {
+            spec->stars++;
+            spec->star_precision = true;
+            format++;
+        }
+        while(*format >= '0' && *format <= '9') {
+            spec->precision = spec->precision * 10 + (*format++ - '0');
+        }
+    }
+
+    uint8_t longs = 0;
+    bool size = false;
+    while(*format && strchr("hlzjt", *format)) {
+        if(*format == 'l') longs++;
+        if(*format == 'j') longs = 2;
+        if(*format == 'z' || *format == 't') size = true;
+        format++;
+    }
+
+    switch(*format) {
+    case 'd':
+    case 'i':
+    case 'u':
+    case 'x':
+    case 'X':
+    case 'o':
+    case 'c':
+        spec->arg = size ? FuriLogArgSize :
+                    longs > 1 ? FuriLogArgLongLong :
+                    longs ? FuriLogArgLong :
+                            FuriLogArgInt;
+        break;
+    case 'p':
+        spec->arg = FuriLogArgPointer;
+        break;
+    case 's':
+        spec->arg = FuriLogArgString;
+        break;
+    case 'f':
+    case 'F':
+    case 'e':
+    case 'E':
+    case 'g':
+    case 'G':
+    case 'a':
+    case 'A':
+        spec->arg = FuriLogArgDouble;
+        break;
+    case '%':
+        spec->arg = FuriLogArgLiteral;
+        break;
+    default:
+        spec->arg = FuriLogArgNone;
+        return format;
+    }
+    return format + 1;
+}
+
+static size_t furi_log_arg_size(FuriLogArg arg) {
+    switch(arg) {
+    case FuriLogArgInt:
+        return sizeof(int);
+    case FuriLogArgLong:
+        return sizeof(long);
+    case FuriLogArgLongLong:
+        return sizeof(long long);
+    case FuriLogArgSize:
+        return sizeof(size_t);
+    case FuriLogArgPointer:
+        return sizeof(void*);
+    case FuriLogArgDouble:
+        return sizeof(double);
+    default:
+        return 0;
+    }
+}
+
+/* Pack arguments in format order, stops at first one that does not fit */
+static size_t furi_log_args_pack(uint8_t* args, const char* format, va_list va) {
+    size_t size = 0;
+    FuriLogSpec spec;
+    while((format = strchr(format, '%')) != NULL) {
+        format = furi_log_spec_parse(format + 1, &spec);
+        if(spec.arg == FuriLogArgLiteral) continue;
+        if(spec.arg == FuriLogArgNone) break;
+
+        int stars[2];
+        for(uint8_t i = 0; i < spec.stars; i++) {
+            stars[i] = va_arg(va, int);
+        }
+        if(spec.star_precision) {
+            spec.precision = stars[spec.stars - 1];
+        }
+
+        const char* string = NULL;
+        size_t arg_size = furi_log_arg_size(spec.arg);
+        if(spec.arg == FuriLogArgString) {
+            string = va_arg(va, const char*);
+            if(string == NULL) string = "(null)";
+            size_t limit = FURI_LOG_STRING_SIZE;
+            if(spec.precision >= 0 && (size_t)spec.precision < limit) limit = spec.precision;
+            arg_size = 1 + strnlen(string, limit);
+        }
+        if(size + spec.stars * sizeof(int) + arg_size > FURI_LOG_ARGS_SIZE) break;
+
+        memcpy(&args[size], stars, spec.stars * sizeof(int));
+        size += spec.stars * sizeof(int);
+
+        switch(spec.arg) {
+        case FuriLogArgInt: {
+            int value = va_arg(va, int);
+            memcpy(&args[size], &value, sizeof(value));
+        } break;
+        case FuriLogArgLong: {
+            long value = va_arg(va, long);
+            memcpy(&args[size], &value, sizeof(value));
+        } break;
+        case FuriLogArgLongLong: {
+            long long value = va_arg(va, long long);
+            memcpy(&args[size], &value, sizeof(value));
+        } break;
+        case FuriLogArgSize: {
+            size_t value = va_arg(va, size_t);
+            memcpy(&args[size], &value, sizeof(value));
+        } break;
+        case FuriLogArgPointer: {
+            void* value = va_arg(va, void*);
+            memcpy(&args[size], &value, sizeof(value));
+        } break;
+        case FuriLogArgDouble: {
+            double value = va_arg(va, double);
+            memcpy(&args[size], &value, sizeof(value));
+        } break;
+        case FuriLogArgString:
+            args[size] = arg_size - 1;
+            memcpy(&args[size + 1], string, arg_size - 1);
+            break;
+        default:
+            break;
+        }
+        size += arg_size;
+    }
+    return size;
+}
+
+static void furi_log_drain(void* context);
 
 void furi_log_init() {
     // Set default logging parameters
     furi_log.log_level = FURI_LOG_LEVEL_DEFAULT;
+    furi_log.mode = FuriLogModeText;
     furi_log.puts = furi_hal_console_puts;
+    furi_log.tx = furi_hal_console_tx;
     furi_log.timetamp = HAL_GetTick;
-    furi_log.mutex = osMutexNew(NULL);
+    atomic_init(&furi_log.reserve, 0);
+    atomic_init(&furi_log.tail, 0);
+    atomic_init(&furi_log.dropped, 0);
+
+    // Records made before kernel start are output once it runs
+    const osThreadAttr_t attr = {
+        .name = "LogDrain",
+        .stack_size = FURI_LOG_DRAIN_STACK_SIZE,
+        .priority = osPriorityLow,
+    };
+    furi_log.thread = osThreadNew(furi_log_drain, NULL, &attr);
+    furi_check(furi_log.thread);
 }
 
 void furi_log_print(FuriLogLevel level, const char* format, ...) {
-    if(level <= furi_log.log_level && osMutexAcquire(furi_log.mutex, osWaitForever) == osOK) {
-        string_t string;
+    if(level > furi_log.log_level) return;
+
+    uint8_t record[FURI_LOG_RECORD_SIZE_MAX];
+    FuriLogRecord* header = (FuriLogRecord*)record;
+    header->timestamp = furi_log.timetamp();
+    header->format = format;
+
+    va_list args;
+    va_start(args, format);
+    size_t args_size = furi_log_args_pack(&record[sizeof(FuriLogRecord)], format, args);
+    va_end(args);
+
+    uint32_t size = (sizeof(FuriLogRecord) + args_size + 3) & ~3UL;
+    header->header = FURI_LOG_RECORD_VALID | (level << FURI_LOG_RECORD_LEVEL_SHIFT) | size;
 
-        // Timestamp
-        string_init_printf(string, "%lu ", furi_log.timetamp());
-        furi_log.puts(string_get_cstr(string));
-        string_clear(string);
+    // Reserve space, fails only when drain is behind by whole ring
+    unsigned int position = atomic_load(&furi_log.reserve);
+    do {
+        if(position + size - atomic_load(&furi_log.tail) > FURI_LOG_BUFFER_SIZE) {
+            atomic_fetch_add(&furi_log.dropped, 1);
+            return;
+        }
+    } while(!atomic_compare_exchange_weak(&furi_log.reserve, &position, position + size));
 
-        va_list args;
-        va_start(args, format);
-        string_init_vprintf(string, format, args);
-        va_end(args);
+    furi_log_ring_write(
+        position + sizeof(uint32_t), &record[sizeof(uint32_t)], size - sizeof(uint32_t));
+    __atomic_store_n(furi_log_header_at(position), header->header, __ATOMIC_SEQ_CST);
 
-        furi_log.puts(string_get_cstr(string));
-        string_clear(string);
+    // Record at tail is the one drain sleeps on. Drain moves tail before it checks
+    // header, so either it sees this record or we see it waiting for it.
+    if(position == atomic_load(&furi_log.tail)) {
+        osThreadFlagsSet(furi_log.thread, FURI_LOG_DRAIN_FLAG_PUBLISHED);
+    }
+}
+
+static void furi_log_line_flush(FuriLogLine* line) {
+    if(line->size) {
+        line->buffer[line->size] = '\0';
+        furi_log.puts(line->buffer);
+        line->size = 0;
+    }
+}
+
+static void furi_log_line_write(FuriLogLine* line, const char* data, size_t size) {
+    while(size) {
+        size_t chunk = MIN(size, sizeof(line->buffer) - 1 - line->size);
+        memcpy(&line->buffer[line->size], data, chunk);
+        line->size += chunk;
+        data += chunk;
+        size -= chunk;
+        if(line->size == sizeof(line->buffer) - 1) {
+            furi_log_line_flush(line);
+        }
+    }
+}
+
+/* Format one conversion with stars replaced by stored values */
+static size_t furi_log_format_arg(
+    char* output,
+    size_t output_size,
+    const char* spec_start,
+    const char* spec_end,
+    const FuriLogSpec* spec,
+    const uint8_t* args) {
+    char spec_str[32];
+    size_t spec_size = 0;
+    uint8_t star = 0;
+    for(const char* c = spec_start; c < spec_end && spec_size < sizeof(spec_str) - 12; c++) {
+        if(*c == '*') {
+            int value;
+            memcpy(&value, &args[star++ * sizeof(int)], sizeof(int));
+            spec_size += snprintf(&spec_str[spec_size], 12, "%d", value);
+        } else {
+            spec_str[spec_size++] = *c;
+        }
+    }
+    spec_str[spec_size] = '\0';
+    args += spec->stars * sizeof(int);
 
-        osMutexRelease(furi_log.mutex);
+    int result = 0;
+    switch(spec->arg) {
+    case FuriLogArgInt: {
+        int value;
+        memcpy(&value, args, sizeof(value));
+        result = snprintf(output, output_size, spec_str, value);
+    } break;
+    case FuriLogArgLong: {
+        long value;
+        memcpy(&value, args, sizeof(value));
+        result = snprintf(output, output_size, spec_str, value);
+    } break;
+    case FuriLogArgLongLong: {
+        long long value;
+        memcpy(&value, args, sizeof(value));
+        result = snprintf(output, output_size, spec_str, value);
+    } break;
+    case FuriLogArgSize: {
+        size_t value;
+        memcpy(&value, args, sizeof(value));
+        result = snprintf(output, output_size, spec_str, value);
+    } break;
+    case FuriLogArgPointer: {
+        void* value;
+        memcpy(&value, args, sizeof(value));
+        result = snprintf(output, output_size, spec_str, value);
+    } break;
+    case FuriLogArgDouble: {
+        double value;
+        memcpy(&value, args, sizeof(value));
+        result = snprintf(output, output_size, spec_str, value);
+    } break;
+    case FuriLogArgString: {
+        char value[FURI_LOG_STRING_SIZE + 1];
+        memcpy(value, &args[1], args[0]);
+        value[args[0]] = '\0';
+        result = snprintf(output, output_size, spec_str, value);
+    } break;
+    default:
+        break;
+    }
+    return (result < 0) ? 0 : MIN((size_t)result, output_size - 1);
+}
+
+static void furi_log_output_text(const uint8_t* record, size_t size) {
+    FuriLogLine line = {.size = 0};
+    const FuriLogRecord* header = (const FuriLogRecord*)record;
+    char output[FURI_LOG_STRING_SIZE + 32];
+
+    size_t output_size =
+        snprintf(output, sizeof(output), "%lu ", (unsigned long)header->timestamp);
+    furi_log_line_write(&line, output, output_size);
+
+    const char* format = header->format;
+    const uint8_t* args = &record[sizeof(FuriLogRecord)];
+    const uint8_t* args_end = &record[size];
+    FuriLogSpec spec;
+    while(*format) {
+        const char* spec_start = strchr(format, '%');
+        if(spec_start == NULL) break;
+        furi_log_line_write(&line, format, spec_start - format);
+
+        const char* spec_end = furi_log_spec_parse(spec_start + 1, &spec);
+        if(spec.arg == FuriLogArgLiteral) {
+            furi_log_line_write(&line, "%", 1);
+            format = spec_end;
+            continue;
+        }
+
+        // Argument was not packed, print the rest of format as is
+        size_t arg_size = furi_log_arg_size(spec.arg);
+        if(spec.arg == FuriLogArgString && args + spec.stars * sizeof(int) < args_end) {
+            arg_size = 1 + args[spec.stars * sizeof(int)];
+        }
+        if(spec.arg == FuriLogArgNone || args + spec.stars * sizeof(int) + arg_size > args_end) {
+            format = spec_start;
+            break;
+        }
+
+        output_size =
+            furi_log_format_arg(output, sizeof(output), spec_start, spec_end, &spec, args);
+        furi_log_line_write(&line, output, output_size);
+        args += spec.stars * sizeof(int) + arg_size;
+        format = spec_end;
+    }
+    furi_log_line_write(&line, format, strlen(format));
+    furi_log_line_flush(&line);
+}
+
+static void furi_log_output(const uint8_t* record, size_t size) {
+    if(furi_log.mode == FuriLogModeBinary) {
+        if(!furi_log.binary_header_sent) {
+            const uint8_t binary_header[] = {
+                'F',
+                'L',
+                'O',
+                'G',
+                FURI_LOG_BINARY_VERSION,
+                sizeof(void*),
+                sizeof(long),
+                sizeof(size_t)};
+            furi_log.tx(binary_header, sizeof(binary_header));
+            furi_log.binary_header_sent = true;
+        }
+        furi_log.tx(record, size);
+    } else {
+        furi_log_output_text(record, size);
+    }
+}
+
+static void furi_log_report_dropped() {
+    uint32_t dropped = atomic_load(&furi_log.dropped);
+    if(dropped == furi_log.dropped_reported) return;
+
+    uint8_t record[sizeof(FuriLogRecord) + sizeof(uint32_t)];
+    FuriLogRecord* header = (FuriLogRecord*)record;
+    header->header = FURI_LOG_RECORD_VALID | (FuriLogLevelError << FURI_LOG_RECORD_LEVEL_SHIFT) |
+                     sizeof(record);
+    header->timestamp = furi_log.timetamp();
+    header->format = NULL;
+    uint32_t count = dropped - furi_log.dropped_reported;
+    memcpy(&record[sizeof(FuriLogRecord)], &count, sizeof(count));
+    furi_log.dropped_reported = dropped;
+
+    if(furi_log.mode == FuriLogModeBinary) {
+        furi_log_output(record, sizeof(record));
+    } else {
+        char line[48];
+        snprintf(
+            line,
+            sizeof(line),
+            "%lu [log] %lu records dropped\r\n",
+            (unsigned long)header->timestamp,
+            (unsigned long)count);
+        furi_log.puts(line);
+    }
+}
+
+static void furi_log_drain(void* context) {
+    uint8_t record[FURI_LOG_RECORD_SIZE_MAX];
+    while(true) {
+        unsigned int position = atomic_load(&furi_log.tail);
+        uint32_t header = __atomic_load_n(furi_log_header_at(position), __ATOMIC_SEQ_CST);
+        if(!(header & FURI_LOG_RECORD_VALID)) {
+            // Ring is empty, sleep until producer publishes record at tail
+            furi_log_report_dropped();
+            osThreadFlagsWait(FURI_LOG_DRAIN_FLAG_PUBLISHED, osFlagsWaitAny, osWaitForever);
+            continue;
+        }
+
+        size_t size = header & FURI_LOG_RECORD_SIZE_MASK;
+        furi_check(size >= sizeof(FuriLogRecord) && size <= sizeof(record));
+        furi_log_ring_read(position, record, size);
+        furi_log_ring_clear(position, size);
+        atomic_store(&furi_log.tail, position + size);
+
+        furi_log_output(record, size);
     }
 }
 
@@ -59,7 +553,56 @@ void furi_log_set_puts(FuriLogPuts puts) {
     furi_log.puts = puts;
 }
 
+void furi_log_set_tx(FuriLogTx tx) {
+    furi_assert(tx);
+    furi_log.tx = tx;
+}
+
 void furi_log_set_timestamp(FuriLogTimestamp timestamp) {
     furi_assert(timestamp);
     furi_log.timetamp = timestamp;
 }
+
+void furi_log_set_mode(FuriLogMode mode) {
+    furi_log.binary_header_sent = false;
+    furi_log.mode = mode;
+}
+
+FuriLogMode furi_log_get_mode() {
+    return furi_log.mode;
+}
+
+bool furi_log_flush(uint32_t timeout) {
+    uint32_t start = osKernelGetTickCount();
+    while(atomic_load(&furi_log.tail) != atomic_load(&furi_log.reserve)) {
+        if(osKernelGetTickCount() - start >= timeout) return false;
+        osDelay(1);
+    }
+    return true;
+}
+
+void furi_log_drain_sync() {
+    // Drain thread is frozen, record it was outputting is lost. Stop at first
+    // record that is reserved but not written: its producer never finishes.
+    if(!furi_log.puts || !furi_log.tx) return;
+    uint8_t record[FURI_LOG_RECORD_SIZE_MAX];
+    unsigned int position = atomic_load(&furi_log.tail);
+    while(position != atomic_load(&furi_log.reserve)) {
+        uint32_t header = __atomic_load_n(furi_log_header_at(position), __ATOMIC_ACQUIRE);
+        size_t size = header & FURI_LOG_RECORD_SIZE_MASK;
+        if(!(header & FURI_LOG_RECORD_VALID) || size < sizeof(FuriLogRecord) ||
+           size > sizeof(record)) {
+            break;
+        }
+        furi_log_ring_read(position, record, size);
+        furi_log_ring_clear(position, size);
+        position += size;
+        atomic_store(&furi_log.tail, position);
+        furi_log_output(record, size);
+    }
+    furi_log_report_dropped();
+}
+
+uint32_t furi_log_get_dropped() {
+    return atomic_load(&furi_log.dropped);
+}
@@ -1,5 +1,18 @@
+/**
+ * @file log.h
+ * Furi: logging API
+ *
+ * Log calls are deferred: caller stores timestamp, format pointer and packed
+ * arguments into a lock-free ring, low priority drain thread formats and
+ * outputs them. Records that do not fit into ring are dropped and counted.
+ * Format string must be a literal or otherwise outlive the record, string
+ * arguments are copied, up to 48 characters.
+ */
+
 #pragma once
 
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <stdint.h>
 #include <stdarg.h>
@@ -34,7 +47,13 @@ typedef enum {
 #define FURI_LOG_CLR_D FURI_LOG_CLR(FURI_LOG_CLR_BLUE)
 #define FURI_LOG_CLR_T FURI_LOG_CLR(FURI_LOG_CLR_PURPLE)
 
+typedef enum {
+    FuriLogModeText, /**< Formatted lines through FuriLogPuts */
+    FuriLogModeBinary, /**< Raw records through FuriLogTx, see scripts/logdecode.py */
+} FuriLogMode;
+
 typedef void (*FuriLogPuts)(const char* data);
+typedef void (*FuriLogTx)(const uint8_t* data, size_t size);
 typedef uint32_t (*FuriLogTimestamp)(void);
 
 void furi_log_init();
@@ -42,8 +61,42 @@ void furi_log_print(FuriLogLevel level, const char* format, ...);
 void furi_log_set_level(FuriLogLevel level);
 FuriLogLevel furi_log_get_level();
 void furi_log_set_puts(FuriLogPuts puts);
+void furi_log_set_tx(FuriLogTx tx);
 void furi_log_set_timestamp(FuriLogTimestamp timestamp);
 
+/** Set output mode, binary stream starts with header describing target ABI
+ *
+ * @param      mode  output mode
+ */
+void furi_log_set_mode(FuriLogMode mode);
+
+/** Get output mode
+ *
+ * @return     current mode
+ */
+FuriLogMode furi_log_get_mode();
+
+/** Wait until drain thread outputs everything logged so far
+ *
+ * @param      timeout  timeout in ticks
+ *
+ * @return     true if ring is empty
+ */
+bool furi_log_flush(uint32_t timeout);
+
+/** Output records left in ring from caller context, never waits
+ *
+ * For crash and halt handlers only: interrupts must be disabled, so drain
+ * thread and producers can not touch ring meanwhile.
+ */
+void furi_log_drain_sync();
+
+/** Get number of records dropped because ring was full
+ *
+ * @return     dropped records since boot
+ */
+uint32_t furi_log_get_dropped();
+
 #define FURI_LOG_FORMAT(log_letter, tag, format) \
     FURI_LOG_CLR_##log_letter "[" #log_letter "][" tag "]: " FURI_LOG_CLR_RESET format "\r\n"
 #define FURI_LOG_SHOW(tag, format, log_level, log_letter, ...) \
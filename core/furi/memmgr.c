@@ -1,4 +1,5 @@
 #include "memmgr.h"
+#include "memmgr_heap.h"
 #include <string.h>
 
 extern void* pvPortMalloc(size_t xSize);
@@ -6,8 +7,9 @@ extern void vPortFree(void* pv);
 extern size_t xPortGetFreeHeapSize(void);
 extern size_t xPortGetMinimumEverFreeHeapSize(void);
 
+#ifndef FURI_HOST_SYSTEM_HEAP
 void* malloc(size_t size) {
-    return pvPortMalloc(size);
+    return memmgr_heap_alloc(size, __builtin_return_address(0));
 }
 
 void free(void* ptr) {
@@ -15,26 +17,11 @@ void free(void* ptr) {
 }
 
 void* realloc(void* ptr, size_t size) {
-    if(size == 0) {
-        vPortFree(ptr);
-        return NULL;
-    }
-
-    void* p;
-    p = pvPortMalloc(size);
-    if(p) {
-        // TODO implement secure realloc
-        // insecure, but will do job in our case
-        if(ptr != NULL) {
-            memcpy(p, ptr, size);
-            vPortFree(ptr);
-        }
-    }
-    return p;
+    return memmgr_heap_realloc(ptr, size);
 }
 
 void* calloc(size_t count, size_t size) {
-    void* ptr = pvPortMalloc(count * size);
+    void* ptr = memmgr_heap_alloc(count * size, __builtin_return_address(0));
     if(ptr) {
         // zero the memory
         memset(ptr, 0, count * size);
@@ -49,7 +36,7 @@ char* strdup(const char* s) {
     }
 
     size_t siz = strlen(s) + 1;
-    char* y = malloc(siz);
+    char* y = memmgr_heap_alloc(siz, __builtin_return_address(0));
 
     if(y != NULL) {
         memcpy(y, s, siz);
@@ -59,6 +46,7 @@ char* strdup(const char* s) {
 
     return y;
 }
+#endif
 
 size_t memmgr_get_free_heap(void) {
     return xPortGetFreeHeapSize();
@@ -68,14 +56,26 @@ size_t memmgr_get_minimum_free_heap(void) {
     return xPortGetMinimumEverFreeHeapSize();
 }
 
+size_t memmgr_get_free_slab(void) {
+    MemmgrHeapStats stats;
+    memmgr_heap_get_stats(&stats);
+    return stats.slab_free_bytes;
+}
+
 void* furi_alloc(size_t size) {
+#ifdef FURI_HOST_SYSTEM_HEAP
     void* p = malloc(size);
+#else
+    // Allocation samples point to furi_alloc caller, not to furi_alloc itself
+    void* p = memmgr_heap_alloc(size, __builtin_return_address(0));
+#endif
     furi_check(p);
     return memset(p, 0, size);
 }
 
+#ifndef FURI_HOST
 void* __wrap__malloc_r(struct _reent* r, size_t size) {
-    void* pointer = malloc(size);
+    void* pointer = memmgr_heap_alloc(size, __builtin_return_address(0));
     return pointer;
 }
 
@@ -91,4 +91,5 @@ void* __wrap__calloc_r(struct _reent* r, size_t count, size_t size) {
 void* __wrap__realloc_r(struct _reent* r, void* ptr, size_t size) {
     void* pointer = realloc(ptr, size);
     return pointer;
-}
\ No newline at end of file
+}
+#endif
@@ -18,6 +18,8 @@ extern "C" {
 #define FURI_MEMMGR_GUARD 1
 
 /** Get free heap size
+ *
+ * @note       slab arena free space is not included, see memmgr_heap_get_stats
  *
  * @return     free heap size in bytes
  */
@@ -29,6 +31,14 @@ size_t memmgr_get_free_heap(void);
  */
 size_t memmgr_get_minimum_free_heap(void);
 
+/** Get free space in slab arena
+ *
+ * @note       small allocations are served from slab, add it to free heap to see all of them
+ *
+ * @return     free slab size in bytes
+ */
+size_t memmgr_get_free_slab(void);
+
 /** Allocate memory from heap
  *
  * @note       performs memset with 0, will crash system if not enough memory
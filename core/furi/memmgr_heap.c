@@ -35,6 +35,7 @@
  */
 
 #include "memmgr_heap.h"
+#include "memmgr_slab.h"
 #include "check.h"
 #include <stdlib.h>
 #include <cmsis_os2.h>
@@ -124,6 +125,193 @@ DICT_DEF2(
 static MemmgrHeapThreadDict_t memmgr_heap_thread_dict = {0};
 static volatile uint32_t memmgr_heap_thread_trace_depth = 0;
 
+/* Allocator latency, updated with scheduler suspended */
+static MemmgrHeapStats memmgr_heap_stats = {0};
+
+/* Minimum tracks contiguous heap_4 space only, slab free space is reported separately */
+static inline void memmgr_heap_update_minimum_free() {
+    if(xFreeBytesRemaining < xMinimumEverFreeBytesRemaining) {
+        xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
+    }
+}
+
+/* Allocated heap blocks keep owner slot and sampled flag in the high bits of
+xBlockSize, slab objects keep them in a side table. Heap is far below 16MB. */
+#define heapOWNER_SHIFT 24
+#define heapOWNER_MASK (((size_t)0x3F) << heapOWNER_SHIFT)
+#define heapSAMPLED_BIT (((size_t)1) << 30)
+#define heapBLOCK_SIZE(xBlockSize) \
+    ((xBlockSize) & ~(heapOWNER_MASK | heapSAMPLED_BIT | xBlockAllocatedBit))
+
+#define MEMMGR_HEAP_SLAB_OWNER_MASK 0x3F
+#define MEMMGR_HEAP_SLAB_SAMPLED 0x80
+
+_Static_assert(MEMMGR_HEAP_THREAD_SLOTS <= 0x3F, "owner slot must fit into 6 bits");
+
+typedef struct {
+    TaskHandle_t owner; /**< NULL once thread is deleted */
+    size_t live;
+    size_t peak;
+    bool used;
+} MemmgrHeapOwner;
+
+/* Slot 0 collects allocations made outside of threads or when slots ran out.
+Thread keeps its slot + 1 in uxTaskNumber, 0 means not assigned yet. */
+static MemmgrHeapOwner memmgr_heap_owners[MEMMGR_HEAP_THREAD_SLOTS] = {0};
+static uint8_t memmgr_heap_slab_owners[MEMMGR_SLAB_ARENA_SIZE / MEMMGR_SLAB_MIN_SIZE] = {0};
+static uint8_t* memmgr_heap_slab_arena = NULL;
+
+/* Sampled allocation ring */
+static MemmgrHeapSample memmgr_heap_samples[MEMMGR_HEAP_SAMPLES_COUNT] = {0};
+static size_t memmgr_heap_samples_head = 0;
+static uint32_t memmgr_heap_sample_rate = 0;
+static uint32_t memmgr_heap_sample_countdown = 0;
+
+/* Latency is measured only while heap tracing is on, timer is not read otherwise.
+Rate changes with scheduler suspended, so start and add always agree. */
+static inline uint32_t memmgr_heap_latency_start() {
+    return memmgr_heap_sample_rate ? osKernelGetSysTimerCount() : 0;
+}
+
+static inline void memmgr_heap_latency_add(MemmgrHeapLatency* latency, uint32_t start) {
+    if(memmgr_heap_sample_rate == 0) return;
+    uint32_t time = osKernelGetSysTimerCount() - start;
+    latency->count++;
+    latency->time_total += time;
+    if(time > latency->time_max) latency->time_max = time;
+}
+
+static uint8_t memmgr_heap_owner_current() {
+    if(xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED) {
+        return 0;
+    }
+
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+    UBaseType_t task_number = uxTaskGetTaskNumber(task);
+    if(task_number == 0) {
+        task_number = 1;
+        for(uint8_t slot = 1; slot < MEMMGR_HEAP_THREAD_SLOTS; slot++) {
+            if(!memmgr_heap_owners[slot].used) {
+                memmgr_heap_owners[slot] = (MemmgrHeapOwner){task, 0, 0, true};
+                task_number = slot + 1;
+                break;
+            }
+        }
+        vTaskSetTaskNumber(task, task_number);
+    }
+
+    return task_number - 1;
+}
+
+static inline void memmgr_heap_owner_add(uint8_t slot, size_t size) {
+    MemmgrHeapOwner* owner = &memmgr_heap_owners[slot];
+    owner->live += size;
+    if(owner->live > owner->peak) owner->peak = owner->live;
+}
+
+static inline void memmgr_heap_owner_sub(uint8_t slot, size_t size) {
+    MemmgrHeapOwner* owner = &memmgr_heap_owners[slot];
+    owner->live -= size;
+    // Slot of deleted thread is kept while its allocations are alive
+    if(slot != 0 && owner->owner == NULL && owner->live == 0) {
+        owner->used = false;
+    }
+}
+
+static inline bool
+    memmgr_heap_sample_alloc(void* pointer, size_t size, void* caller, uint8_t slot) {
+    if(memmgr_heap_sample_rate == 0 || --memmgr_heap_sample_countdown != 0) {
+        return false;
+    }
+    memmgr_heap_sample_countdown = memmgr_heap_sample_rate;
+
+    memmgr_heap_samples[memmgr_heap_samples_head] = (MemmgrHeapSample){
+        .pointer = pointer,
+        .caller = caller,
+        .thread_id = memmgr_heap_owners[slot].owner,
+        .size = size,
+        .tick = xTaskGetTickCount(),
+        .freed = false,
+    };
+    memmgr_heap_samples_head = (memmgr_heap_samples_head + 1) % MEMMGR_HEAP_SAMPLES_COUNT;
+    return true;
+}
+
+/* Only sampled allocations get here, so the ring scan stays off the hot path */
+static void memmgr_heap_sample_free(void* pointer) {
+    for(size_t i = 0; i < MEMMGR_HEAP_SAMPLES_COUNT; i++) {
+        if(memmgr_heap_samples[i].pointer == pointer && !memmgr_heap_samples[i].freed) {
+            memmgr_heap_samples[i].freed = true;
+            break;
+        }
+    }
+}
+
+static inline uint8_t* memmgr_heap_slab_owner(void* pointer) {
+    size_t offset = (uint8_t*)pointer - memmgr_heap_slab_arena;
+    return &memmgr_heap_slab_owners[offset / MEMMGR_SLAB_MIN_SIZE];
+}
+
+void memmgr_heap_on_task_delete(void* task) {
+    UBaseType_t task_number = uxTaskGetTaskNumber(task);
+    if(task_number > 1) {
+        MemmgrHeapOwner* owner = &memmgr_heap_owners[task_number - 1];
+        owner->owner = NULL;
+        owner->used = (owner->live != 0);
+    }
+    // Samples outlive threads, do not let them point to freed task
+    for(size_t i = 0; i < MEMMGR_HEAP_SAMPLES_COUNT; i++) {
+        if(memmgr_heap_samples[i].thread_id == task) {
+            memmgr_heap_samples[i].thread_id = NULL;
+        }
+    }
+}
+
+size_t memmgr_heap_get_threads_stats(MemmgrHeapThreadStats* stats, size_t count) {
+    size_t filled = 0;
+    vTaskSuspendAll();
+    {
+        for(uint8_t slot = 0; slot < MEMMGR_HEAP_THREAD_SLOTS && filled < count; slot++) {
+            MemmgrHeapOwner* owner = &memmgr_heap_owners[slot];
+            if(slot != 0 && !owner->used) continue;
+            stats[filled].thread_id = owner->owner;
+            stats[filled].live = owner->live;
+            stats[filled].peak = owner->peak;
+            filled++;
+        }
+    }
+    (void)xTaskResumeAll();
+    return filled;
+}
+
+void memmgr_heap_set_sample_rate(uint32_t rate) {
+    vTaskSuspendAll();
+    {
+        memmgr_heap_sample_rate = rate;
+        memmgr_heap_sample_countdown = rate;
+    }
+    (void)xTaskResumeAll();
+}
+
+uint32_t memmgr_heap_get_sample_rate() {
+    return memmgr_heap_sample_rate;
+}
+
+size_t memmgr_heap_get_samples(MemmgrHeapSample* samples, size_t count) {
+    size_t filled = 0;
+    vTaskSuspendAll();
+    {
+        // Oldest first, empty entries have no pointer
+        for(size_t i = 0; i < MEMMGR_HEAP_SAMPLES_COUNT && filled < count; i++) {
+            size_t index = (memmgr_heap_samples_head + i) % MEMMGR_HEAP_SAMPLES_COUNT;
+            if(memmgr_heap_samples[index].pointer == NULL) continue;
+            samples[filled++] = memmgr_heap_samples[index];
+        }
+    }
+    (void)xTaskResumeAll();
+    return filled;
+}
+
 /* Initialize tracing storage on start */
 void memmgr_heap_init() {
     MemmgrHeapThreadDict_init(memmgr_heap_thread_dict);
@@ -222,6 +410,25 @@ size_t memmgr_heap_get_max_free_block() {
     return max_free_size;
 }
 
+void memmgr_heap_get_stats(MemmgrHeapStats* stats) {
+    vTaskSuspendAll();
+    {
+        *stats = memmgr_heap_stats;
+        stats->heap_free_bytes = xFreeBytesRemaining;
+        stats->slab_free_bytes = memmgr_slab_get_free();
+        stats->slab_size = memmgr_slab_get_arena_size();
+    }
+    (void)xTaskResumeAll();
+}
+
+void memmgr_heap_get_slab_stats(uint8_t class_id, MemmgrSlabClassStats* stats) {
+    vTaskSuspendAll();
+    {
+        memmgr_slab_get_class_stats(class_id, stats);
+    }
+    (void)xTaskResumeAll();
+}
+
 void memmgr_heap_printf_free_blocks() {
     BlockLink_t* pxBlock;
     //TODO enable when we can do printf with a locked scheduler
@@ -238,11 +445,19 @@ void memmgr_heap_printf_free_blocks() {
 /*-----------------------------------------------------------*/
 
 void* pvPortMalloc(size_t xWantedSize) {
+    return memmgr_heap_alloc(xWantedSize, __builtin_return_address(0));
+}
+/*-----------------------------------------------------------*/
+
+void* memmgr_heap_alloc(size_t xWantedSize, void* pvCaller) {
     BlockLink_t *pxBlock, *pxPreviousBlock, *pxNewBlockLink;
     void* pvReturn = NULL;
+    size_t xRequestedSize = xWantedSize;
 
     vTaskSuspendAll();
     {
+        uint32_t start = memmgr_heap_latency_start();
+
         /* If this is the first call to malloc then the heap will require
         initialisation to setup the list of free blocks. */
         if(pxEnd == NULL) {
@@ -252,11 +467,21 @@ void* pvPortMalloc(size_t xWantedSize) {
             mtCOVERAGE_TEST_MARKER();
         }
 
+        /* Small objects go to size-class slab first, heap is a fallback when
+        the class has no free slot left. */
+        if((xWantedSize > 0) && (xWantedSize <= MEMMGR_SLAB_MAX_SIZE)) {
+            pvReturn = memmgr_slab_alloc(xWantedSize);
+            if(pvReturn != NULL) {
+                xWantedSize = memmgr_slab_get_size(pvReturn);
+                memmgr_heap_latency_add(&memmgr_heap_stats.slab_alloc, start);
+            }
+        }
+
         /* Check the requested block size is not so large that the top bit is
         set.  The top bit of the block size member of the BlockLink_t structure
         is used to determine who owns the block - the application or the
         kernel, so it must be free. */
-        if((xWantedSize & xBlockAllocatedBit) == 0) {
+        if((pvReturn == NULL) && ((xWantedSize & xBlockAllocatedBit) == 0)) {
             /* The wanted size is increased so it can contain a BlockLink_t
             structure in addition to the requested amount of bytes. */
             if(xWantedSize > 0) {
@@ -319,17 +544,14 @@ void* pvPortMalloc(size_t xWantedSize) {
                     }
 
                     xFreeBytesRemaining -= pxBlock->xBlockSize;
-
-                    if(xFreeBytesRemaining < xMinimumEverFreeBytesRemaining) {
-                        xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
-                    } else {
-                        mtCOVERAGE_TEST_MARKER();
-                    }
+                    memmgr_heap_update_minimum_free();
 
                     /* The block is being returned - it is allocated and owned
                     by the application and has no "next" block. */
                     pxBlock->xBlockSize |= xBlockAllocatedBit;
                     pxBlock->pxNextFreeBlock = NULL;
+
+                    memmgr_heap_latency_add(&memmgr_heap_stats.heap_alloc, start);
                 } else {
                     mtCOVERAGE_TEST_MARKER();
                 }
@@ -340,6 +562,25 @@ void* pvPortMalloc(size_t xWantedSize) {
             mtCOVERAGE_TEST_MARKER();
         }
 
+        /* Account block to the calling thread, owner goes with the block so
+        free from any other thread is O(1) as well. Charged size is the one
+        free gives back: slab class size, or whole block as it was taken,
+        unsplit block can be larger than wanted. */
+        if(pvReturn != NULL) {
+            uint8_t owner = memmgr_heap_owner_current();
+            bool sampled = memmgr_heap_sample_alloc(pvReturn, xRequestedSize, pvCaller, owner);
+            if(memmgr_slab_owns(pvReturn)) {
+                memmgr_heap_owner_add(owner, xWantedSize);
+                *memmgr_heap_slab_owner(pvReturn) = owner |
+                                                    (sampled ? MEMMGR_HEAP_SLAB_SAMPLED : 0);
+            } else {
+                pxBlock = (void*)(((uint8_t*)pvReturn) - xHeapStructSize);
+                memmgr_heap_owner_add(owner, heapBLOCK_SIZE(pxBlock->xBlockSize));
+                pxBlock->xBlockSize |= ((size_t)owner << heapOWNER_SHIFT) |
+                                       (sampled ? heapSAMPLED_BIT : 0);
+            }
+        }
+
         traceMALLOC(pvReturn, xWantedSize);
     }
     (void)xTaskResumeAll();
@@ -364,7 +605,23 @@ void vPortFree(void* pv) {
     uint8_t* puc = (uint8_t*)pv;
     BlockLink_t* pxLink;
 
-    if(pv != NULL) {
+    if(memmgr_slab_owns(pv)) {
+        vTaskSuspendAll();
+        {
+            uint32_t start = memmgr_heap_latency_start();
+            size_t xSize = memmgr_slab_get_size(pv);
+            uint8_t* owner = memmgr_heap_slab_owner(pv);
+            memmgr_heap_owner_sub(*owner & MEMMGR_HEAP_SLAB_OWNER_MASK, xSize);
+            if(*owner & MEMMGR_HEAP_SLAB_SAMPLED) {
+                memmgr_heap_sample_free(pv);
+            }
+            *owner = 0;
+            traceFREE(pv, xSize);
+            memmgr_slab_free(pv);
+            memmgr_heap_latency_add(&memmgr_heap_stats.slab_free, start);
+        }
+        (void)xTaskResumeAll();
+    } else if(pv != NULL) {
         /* The memory being freed will have an BlockLink_t structure immediately
         before it. */
         puc -= xHeapStructSize;
@@ -378,17 +635,25 @@ void vPortFree(void* pv) {
 
         if((pxLink->xBlockSize & xBlockAllocatedBit) != 0) {
             if(pxLink->pxNextFreeBlock == NULL) {
-                /* The block is being returned to the heap - it is no longer
-                allocated. */
-                pxLink->xBlockSize &= ~xBlockAllocatedBit;
-
                 vTaskSuspendAll();
                 {
+                    uint32_t start = memmgr_heap_latency_start();
+                    /* The block is being returned to the heap - it is no longer
+                    allocated. Bit is cleared only with scheduler suspended:
+                    prvReallocInPlace takes a clear bit as "on the free list". */
+                    size_t xFlags = pxLink->xBlockSize;
+                    pxLink->xBlockSize = heapBLOCK_SIZE(pxLink->xBlockSize);
+                    memmgr_heap_owner_sub(
+                        (xFlags & heapOWNER_MASK) >> heapOWNER_SHIFT, pxLink->xBlockSize);
+                    if(xFlags & heapSAMPLED_BIT) {
+                        memmgr_heap_sample_free(pv);
+                    }
                     /* Add this block to the list of free blocks. */
                     xFreeBytesRemaining += pxLink->xBlockSize;
                     traceFREE(pv, pxLink->xBlockSize);
                     memset(pv, 0, pxLink->xBlockSize - xHeapStructSize);
                     prvInsertBlockIntoFreeList(((BlockLink_t*)pxLink));
+                    memmgr_heap_latency_add(&memmgr_heap_stats.heap_free, start);
                 }
                 (void)xTaskResumeAll();
             } else {
@@ -401,6 +666,123 @@ void vPortFree(void* pv) {
 }
 /*-----------------------------------------------------------*/
 
+/* Must be called with scheduler suspended. Resizes heap block without moving
+it: shrinks by splitting the tail off, grows by merging the next physical
+block when it is free and big enough. */
+static void* prvReallocInPlace(void* pv, size_t xWantedSize, size_t* pxOldSize) {
+    BlockLink_t* pxLink = (void*)(((uint8_t*)pv) - xHeapStructSize);
+    configASSERT((pxLink->xBlockSize & xBlockAllocatedBit) != 0);
+    configASSERT(pxLink->pxNextFreeBlock == NULL);
+
+    size_t xOldBlockSize = heapBLOCK_SIZE(pxLink->xBlockSize);
+    size_t xFlags = pxLink->xBlockSize & (heapOWNER_MASK | heapSAMPLED_BIT);
+    size_t xBlockSize = xOldBlockSize;
+    *pxOldSize = xOldBlockSize - xHeapStructSize;
+
+    if((xWantedSize & xBlockAllocatedBit) != 0) {
+        return NULL;
+    }
+    /* Same size calculation as in pvPortMalloc. */
+    xWantedSize += xHeapStructSize;
+    if((xWantedSize & portBYTE_ALIGNMENT_MASK) != 0x00) {
+        xWantedSize += (portBYTE_ALIGNMENT - (xWantedSize & portBYTE_ALIGNMENT_MASK));
+    }
+
+    if(xWantedSize > xBlockSize) {
+        /* Blocks tile the heap, so the next physical block starts right after
+        this one. The allocated bit tells if it is on the free list: it is
+        cleared and the block inserted within one suspended section. */
+        BlockLink_t* pxNext = (void*)(((uint8_t*)pxLink) + xBlockSize);
+        if((pxNext == pxEnd) || ((pxNext->xBlockSize & xBlockAllocatedBit) != 0) ||
+           ((xBlockSize + pxNext->xBlockSize) < xWantedSize)) {
+            return NULL;
+        }
+
+        /* Free list is sorted by address, find the block in front of next.
+        Next not being on the list means heap corruption, fall back to copy. */
+        BlockLink_t* pxIterator;
+        for(pxIterator = &xStart; pxIterator->pxNextFreeBlock != pxNext;
+            pxIterator = pxIterator->pxNextFreeBlock) {
+            if(pxIterator->pxNextFreeBlock == pxEnd ||
+               pxIterator->pxNextFreeBlock > pxNext) {
+                configASSERT(0);
+                return NULL;
+            }
+        }
+        pxIterator->pxNextFreeBlock = pxNext->pxNextFreeBlock;
+        xFreeBytesRemaining -= pxNext->xBlockSize;
+        xBlockSize += pxNext->xBlockSize;
+    } else if(xWantedSize < xOldBlockSize) {
+        /* Released tail held user data, clear it the same way vPortFree does. */
+        memset(((uint8_t*)pxLink) + xWantedSize, 0, xOldBlockSize - xWantedSize);
+    }
+
+    /* Give the tail back to the free list if it is big enough for a block. */
+    if((xBlockSize - xWantedSize) > heapMINIMUM_BLOCK_SIZE) {
+        BlockLink_t* pxNewBlockLink = (void*)(((uint8_t*)pxLink) + xWantedSize);
+        configASSERT((((size_t)pxNewBlockLink) & portBYTE_ALIGNMENT_MASK) == 0);
+        pxNewBlockLink->xBlockSize = xBlockSize - xWantedSize;
+        xBlockSize = xWantedSize;
+        xFreeBytesRemaining += pxNewBlockLink->xBlockSize;
+        prvInsertBlockIntoFreeList(pxNewBlockLink);
+    }
+
+    pxLink->xBlockSize = xBlockSize | xFlags | xBlockAllocatedBit;
+    memmgr_heap_owner_sub((xFlags & heapOWNER_MASK) >> heapOWNER_SHIFT, xOldBlockSize);
+    memmgr_heap_owner_add((xFlags & heapOWNER_MASK) >> heapOWNER_SHIFT, xBlockSize);
+    memmgr_heap_update_minimum_free();
+    traceMALLOC(pv, xBlockSize);
+
+    return pv;
+}
+
+void* memmgr_heap_realloc(void* pv, size_t xWantedSize) {
+    void* pvCaller = __builtin_return_address(0);
+    if(pv == NULL) {
+        return memmgr_heap_alloc(xWantedSize, pvCaller);
+    }
+    if(xWantedSize == 0) {
+        vPortFree(pv);
+        return NULL;
+    }
+
+    void* pvReturn = NULL;
+    size_t xOldSize = 0;
+
+    vTaskSuspendAll();
+    {
+        if(memmgr_slab_owns(pv)) {
+            xOldSize = memmgr_slab_get_size(pv);
+            /* Stay in the slot while the request maps to the same size class. */
+            if((xWantedSize <= xOldSize) &&
+               ((xWantedSize > xOldSize / 2) || (xOldSize == MEMMGR_SLAB_MIN_SIZE))) {
+                pvReturn = pv;
+            }
+        } else {
+            pvReturn = prvReallocInPlace(pv, xWantedSize, &xOldSize);
+        }
+
+        if(pvReturn != NULL) {
+            memmgr_heap_stats.realloc_in_place++;
+        } else {
+            memmgr_heap_stats.realloc_moved++;
+        }
+    }
+    (void)xTaskResumeAll();
+
+    if(pvReturn == NULL) {
+        /* Could not resize in place: move, copying only what the old block had. */
+        pvReturn = memmgr_heap_alloc(xWantedSize, pvCaller);
+        if(pvReturn != NULL) {
+            memcpy(pvReturn, pv, (xOldSize < xWantedSize) ? xOldSize : xWantedSize);
+            vPortFree(pv);
+        }
+    }
+
+    return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
 size_t xPortGetFreeHeapSize(void) {
     return xFreeBytesRemaining;
 }
@@ -433,6 +815,12 @@ static void prvHeapInit(void) {
 
     pucAlignedHeap = (uint8_t*)uxAddress;
 
+    /* Slab arena sits at the start of the heap, it is aligned the same way. */
+    memmgr_slab_init(pucAlignedHeap, MEMMGR_SLAB_ARENA_SIZE);
+    memmgr_heap_slab_arena = pucAlignedHeap;
+    pucAlignedHeap += MEMMGR_SLAB_ARENA_SIZE;
+    xTotalHeapSize -= MEMMGR_SLAB_ARENA_SIZE;
+
     /* xStart is used to hold a pointer to the first item in the list of free
     blocks.  The void cast is used to prevent compiler warnings. */
     xStart.pxNextFreeBlock = (void*)pucAlignedHeap;
@@ -454,8 +842,8 @@ static void prvHeapInit(void) {
     pxFirstFreeBlock->pxNextFreeBlock = pxEnd;
 
     /* Only one block exists - and it covers the entire usable heap space. */
-    xMinimumEverFreeBytesRemaining = pxFirstFreeBlock->xBlockSize;
     xFreeBytesRemaining = pxFirstFreeBlock->xBlockSize;
+    xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
 
     /* Work out the position of the top bit in a size_t variable. */
     xBlockAllocatedBit = ((size_t)1) << ((sizeof(size_t) * heapBITS_PER_BYTE) - 1);
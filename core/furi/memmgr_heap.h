@@ -5,8 +5,10 @@
 
 #pragma once
 
+#include <stdbool.h>
 #include <stdint.h>
 #include <cmsis_os2.h>
+#include "memmgr_slab.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -14,6 +16,47 @@ extern "C" {
 
 #define MEMMGR_HEAP_UNKNOWN 0xFFFFFFFF
 
+/** Threads with own allocation counters, slot 0 collects the rest */
+#define MEMMGR_HEAP_THREAD_SLOTS 48
+/** Allocation samples kept in ring */
+#define MEMMGR_HEAP_SAMPLES_COUNT 32
+
+/** Allocator call latency, in osKernelGetSysTimerCount ticks
+ * Collected only while allocation sampling is enabled
+ */
+typedef struct {
+    uint32_t count;
+    uint32_t time_max;
+    uint64_t time_total;
+} MemmgrHeapLatency;
+
+typedef struct {
+    MemmgrHeapLatency slab_alloc;
+    MemmgrHeapLatency slab_free;
+    MemmgrHeapLatency heap_alloc;
+    MemmgrHeapLatency heap_free;
+    uint32_t realloc_in_place; /**< Reallocations that kept the pointer */
+    uint32_t realloc_moved; /**< Reallocations that needed alloc, copy and free */
+    size_t heap_free_bytes; /**< Free bytes in heap, without slab arena */
+    size_t slab_free_bytes; /**< Free bytes in slab arena */
+    size_t slab_size; /**< Slab arena size */
+} MemmgrHeapStats;
+
+typedef struct {
+    osThreadId_t thread_id; /**< NULL for allocations outside of threads */
+    size_t live; /**< Bytes allocated right now */
+    size_t peak; /**< Maximum of live bytes */
+} MemmgrHeapThreadStats;
+
+typedef struct {
+    void* pointer;
+    void* caller; /**< Return address of allocation call */
+    osThreadId_t thread_id;
+    size_t size; /**< Requested size */
+    uint32_t tick; /**< Allocation time */
+    bool freed;
+} MemmgrHeapSample;
+
 /** Memmgr heap enable thread allocation tracking
  *
  * @param      thread_id  - thread id to track
@@ -34,12 +77,87 @@ void memmgr_heap_disable_thread_trace(osThreadId_t thread_id);
  */
 size_t memmgr_heap_get_thread_memory(osThreadId_t thread_id);
 
+/** Memmgr heap allocate memory on behalf of caller
+ *
+ * Same as pvPortMalloc, caller address is recorded in allocation samples.
+ *
+ * @param      size    - bytes to allocate
+ * @param      caller  - return address of allocating function
+ *
+ * @return     allocation or NULL
+ */
+void* memmgr_heap_alloc(size_t size, void* caller);
+
 /** Memmgr heap get the max contiguous block size on the heap
  *
  * @return     size_t max contiguous block size
  */
 size_t memmgr_heap_get_max_free_block();
 
+/** Memmgr heap resize allocation
+ *
+ * Resizes in place when possible: slab objects stay in their size class,
+ * heap blocks shrink by splitting and grow into the next free block.
+ * Otherwise moves data to a new allocation, copying only old block size.
+ *
+ * @param      ptr   - allocation to resize or NULL
+ * @param      size  - new size, 0 frees allocation
+ *
+ * @return     resized allocation or NULL, old allocation is intact then
+ */
+void* memmgr_heap_realloc(void* ptr, size_t size);
+
+/** Memmgr heap get allocator statistics
+ *
+ * @param      stats  - statistics to fill
+ */
+void memmgr_heap_get_stats(MemmgrHeapStats* stats);
+
+/** Memmgr heap get slab size class statistics
+ *
+ * @param      class_id  - class index, 0..MEMMGR_SLAB_CLASS_COUNT-1
+ * @param      stats     - statistics to fill
+ */
+void memmgr_heap_get_slab_stats(uint8_t class_id, MemmgrSlabClassStats* stats);
+
+/** Memmgr heap get per thread allocation counters
+ *
+ * Counters are updated on every alloc and free, no thread trace is needed.
+ *
+ * @param      stats  - array to fill
+ * @param      count  - array size
+ *
+ * @return     number of filled entries
+ */
+size_t memmgr_heap_get_threads_stats(MemmgrHeapThreadStats* stats, size_t count);
+
+/** Memmgr heap release counters of deleted thread, called by kernel
+ *
+ * @param      task  - task handle
+ */
+void memmgr_heap_on_task_delete(void* task);
+
+/** Memmgr heap set allocation sampling rate
+ *
+ * @param      rate  - sample one of rate allocations, 0 disables sampling
+ */
+void memmgr_heap_set_sample_rate(uint32_t rate);
+
+/** Memmgr heap get allocation sampling rate
+ *
+ * @return     current rate, 0 if disabled
+ */
+uint32_t memmgr_heap_get_sample_rate();
+
+/** Memmgr heap get allocation samples, oldest first
+ *
+ * @param      samples  - array to fill
+ * @param      count    - array size
+ *
+ * @return     number of filled entries
+ */
+size_t memmgr_heap_get_samples(MemmgrHeapSample* samples, size_t count);
+
 /** Print the address and size of all free blocks to stdout
  */
 void memmgr_heap_printf_free_blocks();
@@ -0,0 +1,211 @@
+#include "memmgr_slab.h"
+#include "check.h"
+
+#include <string.h>
+
+#define MEMMGR_SLAB_NONE 0xFF
+#define MEMMGR_SLAB_PAGE_FREE 0xFF
+
+_Static_assert(MEMMGR_SLAB_PAGE_COUNT < MEMMGR_SLAB_NONE, "page index must fit into uint8_t");
+_Static_assert(MEMMGR_SLAB_PAGE_SIZE >= MEMMGR_SLAB_MAX_SIZE, "page must fit biggest class");
+
+typedef struct {
+    void* free_list; /**< Freed objects, link is stored in object itself */
+    uint16_t used; /**< Objects allocated from page */
+    uint16_t carved; /**< Objects ever carved from page, rest is untouched */
+    uint8_t class_id; /**< Owner class or MEMMGR_SLAB_PAGE_FREE */
+    uint8_t prev; /**< Partial list of class or pool list */
+    uint8_t next;
+} MemmgrSlabPage;
+
+typedef struct {
+    uint8_t partial; /**< Pages with at least one free slot */
+    uint16_t per_page;
+    MemmgrSlabClassStats stats;
+} MemmgrSlabClass;
+
+static uint8_t* memmgr_slab_arena = NULL;
+static size_t memmgr_slab_arena_size = 0;
+static size_t memmgr_slab_used_bytes = 0;
+static uint8_t memmgr_slab_pool = MEMMGR_SLAB_NONE;
+static MemmgrSlabPage memmgr_slab_pages[MEMMGR_SLAB_PAGE_COUNT];
+static MemmgrSlabClass memmgr_slab_classes[MEMMGR_SLAB_CLASS_COUNT];
+
+static inline uint8_t memmgr_slab_class_of(size_t size) {
+    if(size <= MEMMGR_SLAB_MIN_SIZE) return 0;
+    // ceil(log2(size)) - log2(MEMMGR_SLAB_MIN_SIZE)
+    return (32 - __builtin_clz((uint32_t)size - 1)) - 4;
+}
+
+static inline uint8_t* memmgr_slab_page_base(uint8_t page_id) {
+    return memmgr_slab_arena + (size_t)page_id * MEMMGR_SLAB_PAGE_SIZE;
+}
+
+static void memmgr_slab_list_remove(uint8_t* head, uint8_t page_id) {
+    MemmgrSlabPage* page = &memmgr_slab_pages[page_id];
+    if(page->prev != MEMMGR_SLAB_NONE) {
+        memmgr_slab_pages[page->prev].next = page->next;
+    } else {
+        *head = page->next;
+    }
+    if(page->next != MEMMGR_SLAB_NONE) {
+        memmgr_slab_pages[page->next].prev = page->prev;
+    }
+    page->prev = MEMMGR_SLAB_NONE;
+    page->next = MEMMGR_SLAB_NONE;
+}
+
+static void memmgr_slab_list_push(uint8_t* head, uint8_t page_id) {
+    MemmgrSlabPage* page = &memmgr_slab_pages[page_id];
+    page->prev = MEMMGR_SLAB_NONE;
+    page->next = *head;
+    if(*head != MEMMGR_SLAB_NONE) {
+        memmgr_slab_pages[*head].prev = page_id;
+    }
+    *head = page_id;
+}
+
+void memmgr_slab_init(void* arena, size_t arena_size) {
+    furi_check(((size_t)arena & 0x7) == 0);
+    furi_check(arena_size <= MEMMGR_SLAB_ARENA_SIZE);
+
+    memmgr_slab_arena = arena;
+    memmgr_slab_arena_size = arena_size;
+    memset(memmgr_slab_arena, 0, memmgr_slab_arena_size);
+    memmgr_slab_used_bytes = 0;
+    memmgr_slab_pool = MEMMGR_SLAB_NONE;
+
+    uint8_t page_count = arena_size / MEMMGR_SLAB_PAGE_SIZE;
+    for(uint8_t page_id = page_count; page_id > 0; page_id--) {
+        memmgr_slab_pages[page_id - 1].class_id = MEMMGR_SLAB_PAGE_FREE;
+        memmgr_slab_list_push(&memmgr_slab_pool, page_id - 1);
+    }
+
+    for(uint8_t class_id = 0; class_id < MEMMGR_SLAB_CLASS_COUNT; class_id++) {
+        MemmgrSlabClass* slab_class = &memmgr_slab_classes[class_id];
+        memset(slab_class, 0, sizeof(MemmgrSlabClass));
+        slab_class->partial = MEMMGR_SLAB_NONE;
+        slab_class->stats.object_size = MEMMGR_SLAB_MIN_SIZE << class_id;
+        slab_class->per_page = MEMMGR_SLAB_PAGE_SIZE / slab_class->stats.object_size;
+    }
+}
+
+void* memmgr_slab_alloc(size_t size) {
+    if(memmgr_slab_arena == NULL || size == 0 || size > MEMMGR_SLAB_MAX_SIZE) return NULL;
+
+    uint8_t class_id = memmgr_slab_class_of(size);
+    MemmgrSlabClass* slab_class = &memmgr_slab_classes[class_id];
+
+    uint8_t page_id = slab_class->partial;
+    if(page_id == MEMMGR_SLAB_NONE) {
+        page_id = memmgr_slab_pool;
+        if(page_id == MEMMGR_SLAB_NONE) {
+            slab_class->stats.fallbacks++;
+            return NULL;
+        }
+        memmgr_slab_list_remove(&memmgr_slab_pool, page_id);
+
+        MemmgrSlabPage* page = &memmgr_slab_pages[page_id];
+        page->free_list = NULL;
+        page->used = 0;
+        page->carved = 0;
+        page->class_id = class_id;
+        memmgr_slab_list_push(&slab_class->partial, page_id);
+
+        slab_class->stats.pages++;
+        if(slab_class->stats.pages > slab_class->stats.pages_max) {
+            slab_class->stats.pages_max = slab_class->stats.pages;
+        }
+        slab_class->stats.capacity += slab_class->per_page;
+    }
+
+    MemmgrSlabPage* page = &memmgr_slab_pages[page_id];
+    void* object;
+    if(page->free_list) {
+        object = page->free_list;
+        page->free_list = *(void**)object;
+        *(void**)object = NULL;
+    } else {
+        // Freed memory is zeroed, so carving lazily keeps never used tail zeroed too
+        object = memmgr_slab_page_base(page_id) + page->carved * slab_class->stats.object_size;
+        page->carved++;
+    }
+
+    page->used++;
+    if(page->used == slab_class->per_page) {
+        memmgr_slab_list_remove(&slab_class->partial, page_id);
+    }
+
+    slab_class->stats.used++;
+    slab_class->stats.allocs++;
+    memmgr_slab_used_bytes += slab_class->stats.object_size;
+
+    return object;
+}
+
+void memmgr_slab_free(void* pointer) {
+    size_t offset = (uint8_t*)pointer - memmgr_slab_arena;
+    uint8_t page_id = offset / MEMMGR_SLAB_PAGE_SIZE;
+    MemmgrSlabPage* page = &memmgr_slab_pages[page_id];
+
+    furi_check(page->class_id < MEMMGR_SLAB_CLASS_COUNT);
+    MemmgrSlabClass* slab_class = &memmgr_slab_classes[page->class_id];
+    furi_check((offset % MEMMGR_SLAB_PAGE_SIZE) % slab_class->stats.object_size == 0);
+    furi_check(page->used > 0);
+#ifdef FURI_DEBUG
+    // Double free: object is already on page free list
+    for(void* item = page->free_list; item; item = *(void**)item) {
+        furi_check(item != pointer);
+    }
+#endif
+
+    memset(pointer, 0, slab_class->stats.object_size);
+    *(void**)pointer = page->free_list;
+    page->free_list = pointer;
+
+    if(page->used == slab_class->per_page) {
+        memmgr_slab_list_push(&slab_class->partial, page_id);
+    }
+    page->used--;
+
+    slab_class->stats.used--;
+    memmgr_slab_used_bytes -= slab_class->stats.object_size;
+
+    // Keep the last partial page to avoid bouncing a page on alloc/free pairs
+    if(page->used == 0 && (slab_class->partial != page_id || page->next != MEMMGR_SLAB_NONE)) {
+        memmgr_slab_list_remove(&slab_class->partial, page_id);
+        // Objects were zeroed on free except for free list links, wipe them too
+        page->free_list = NULL;
+        memset(memmgr_slab_page_base(page_id), 0, MEMMGR_SLAB_PAGE_SIZE);
+        page->class_id = MEMMGR_SLAB_PAGE_FREE;
+        memmgr_slab_list_push(&memmgr_slab_pool, page_id);
+
+        slab_class->stats.pages--;
+        slab_class->stats.capacity -= slab_class->per_page;
+    }
+}
+
+bool memmgr_slab_owns(const void* pointer) {
+    const uint8_t* p = pointer;
+    return (p >= memmgr_slab_arena) && (p < memmgr_slab_arena + memmgr_slab_arena_size);
+}
+
+size_t memmgr_slab_get_size(const void* pointer) {
+    size_t offset = (const uint8_t*)pointer - memmgr_slab_arena;
+    MemmgrSlabPage* page = &memmgr_slab_pages[offset / MEMMGR_SLAB_PAGE_SIZE];
+    furi_check(page->class_id < MEMMGR_SLAB_CLASS_COUNT);
+    return memmgr_slab_classes[page->class_id].stats.object_size;
+}
+
+size_t memmgr_slab_get_free(void) {
+    return memmgr_slab_arena_size - memmgr_slab_used_bytes;
+}
+
+size_t memmgr_slab_get_arena_size(void) {
+    return memmgr_slab_arena_size;
+}
+
+void memmgr_slab_get_class_stats(uint8_t class_id, MemmgrSlabClassStats* stats) {
+    furi_check(class_id < MEMMGR_SLAB_CLASS_COUNT);
+    *stats = memmgr_slab_classes[class_id].stats;
+}
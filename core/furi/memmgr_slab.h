@@ -0,0 +1,108 @@
+/**
+ * @file memmgr_slab.h
+ * Furi: size-class slab allocator for small heap objects
+ *
+ * Small requests are served from segregated per-size-class pages carved out
+ * of a fixed arena in front of the heap. Alloc and free are O(1), pages are
+ * handed back to a shared pool once empty. Callers are responsible for
+ * locking, memmgr heap calls it with scheduler suspended.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Number of size classes: 16, 32, 64, 128 and 256 bytes */
+#define MEMMGR_SLAB_CLASS_COUNT 5
+/** Smallest size class, must be enough for a free list link */
+#define MEMMGR_SLAB_MIN_SIZE 16
+/** Biggest request served by slab, anything above goes to heap */
+#define MEMMGR_SLAB_MAX_SIZE (MEMMGR_SLAB_MIN_SIZE << (MEMMGR_SLAB_CLASS_COUNT - 1))
+
+/** Page size, every page holds objects of one size class */
+#ifndef MEMMGR_SLAB_PAGE_SIZE
+#define MEMMGR_SLAB_PAGE_SIZE 512
+#endif
+
+/** Arena size reserved from heap region on start */
+#ifndef MEMMGR_SLAB_ARENA_SIZE
+#define MEMMGR_SLAB_ARENA_SIZE (12 * 1024)
+#endif
+
+#define MEMMGR_SLAB_PAGE_COUNT (MEMMGR_SLAB_ARENA_SIZE / MEMMGR_SLAB_PAGE_SIZE)
+
+typedef struct {
+    size_t object_size; /**< Size class, bytes */
+    size_t pages; /**< Pages currently owned by class */
+    size_t pages_max; /**< Peak of pages owned by class */
+    size_t used; /**< Objects allocated right now */
+    size_t capacity; /**< Objects that fit into owned pages */
+    uint32_t allocs; /**< Served allocations since boot */
+    uint32_t fallbacks; /**< Requests passed to heap because arena was full */
+} MemmgrSlabClassStats;
+
+/** Initialize slab allocator
+ *
+ * @param      arena       arena start, aligned to 8 bytes
+ * @param      arena_size  arena size, at most MEMMGR_SLAB_ARENA_SIZE
+ */
+void memmgr_slab_init(void* arena, size_t arena_size);
+
+/** Allocate object from slab
+ *
+ * @param      size  requested size, 1..MEMMGR_SLAB_MAX_SIZE
+ *
+ * @return     pointer to object or NULL if class has no room, use heap then
+ */
+void* memmgr_slab_alloc(size_t size);
+
+/** Free object allocated by memmgr_slab_alloc, memory is zeroed
+ *
+ * @param      pointer  object pointer
+ */
+void memmgr_slab_free(void* pointer);
+
+/** Check if pointer belongs to slab arena
+ *
+ * @param      pointer  pointer to check
+ *
+ * @return     true if pointer is inside arena
+ */
+bool memmgr_slab_owns(const void* pointer);
+
+/** Get object size of slab allocation
+ *
+ * @param      pointer  object pointer, must be owned by slab
+ *
+ * @return     size class of object
+ */
+size_t memmgr_slab_get_size(const void* pointer);
+
+/** Get bytes not taken by objects, both in free pages and in partial pages
+ *
+ * @return     free bytes in arena
+ */
+size_t memmgr_slab_get_free(void);
+
+/** Get arena size
+ *
+ * @return     arena size in bytes, 0 if slab is not initialized
+ */
+size_t memmgr_slab_get_arena_size(void);
+
+/** Get size class statistics
+ *
+ * @param      class_id  class index, 0..MEMMGR_SLAB_CLASS_COUNT-1
+ * @param      stats     statistics to fill
+ */
+void memmgr_slab_get_class_stats(uint8_t class_id, MemmgrSlabClassStats* stats);
+
+#ifdef __cplusplus
+}
+#endif
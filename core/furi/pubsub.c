@@ -2,28 +2,151 @@
 #include "memmgr.h"
 #include "check.h"
 
-#include <m-list.h>
 #include <cmsis_os2.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <string.h>
+
+/* Publishers that can be in flight at once, more of them wait for a free slot */
+#define FURI_PUBSUB_PUBLISHERS_MAX 8
+/* Wakeups that can be pending, more than there can be waiting threads */
+#define FURI_PUBSUB_WAKEUPS_MAX 0xFFFF
+
+/* Header of everything freed only after publishers that could see it are gone */
+typedef struct FuriPubSubRetired {
+    struct FuriPubSubRetired* next;
+    unsigned int epoch;
+} FuriPubSubRetired;
 
 struct FuriPubSubSubscription {
+    FuriPubSubRetired retired;
     FuriPubSubCallback callback;
     void* callback_context;
+    atomic_bool active;
 };
 
-LIST_DEF(FuriPubSubSubscriptionList, FuriPubSubSubscription, M_POD_OPLIST);
+/* Immutable snapshot of subscribers, replaced as a whole on every change */
+typedef struct {
+    FuriPubSubRetired retired;
+    size_t count;
+    FuriPubSubSubscription* items[];
+} FuriPubSubSubscriptions;
 
 struct FuriPubSub {
-    FuriPubSubSubscriptionList_t items;
+    FuriPubSubSubscriptions* _Atomic subscriptions;
+    /* Publishers in flight, by epoch parity */
+    atomic_uint readers[2];
+    atomic_uint epoch;
+    /* Threads in publish, lets unsubscribe from callback skip waiting for itself */
+    osThreadId_t _Atomic publishers[FURI_PUBSUB_PUBLISHERS_MAX];
+    /* Threads blocked on grace period and on publisher slot, woken by leaving publishers */
+    atomic_uint waiters;
+    atomic_uint slot_waiters;
+    osSemaphoreId_t wakeup;
+    /* Serializes subscribe and unsubscribe, publish never takes it */
     osMutexId_t mutex;
+    /* Retired snapshots and subscriptions, newest first, guarded by mutex */
+    FuriPubSubRetired* retired;
 };
 
+static FuriPubSubSubscriptions* furi_pubsub_subscriptions_alloc(size_t count) {
+    FuriPubSubSubscriptions* subscriptions =
+        furi_alloc(sizeof(FuriPubSubSubscriptions) + count * sizeof(FuriPubSubSubscription*));
+    subscriptions->count = count;
+    return subscriptions;
+}
+
+/* Advance epoch as far as publishers allow, returns new epoch.
+ * Epoch goes from E to E + 1 once publishers of E - 1 are gone, so anything
+ * retired in epoch E is unreachable when epoch reaches E + 2. Never waits,
+ * may run concurrently: epoch only moves by compare and swap. */
+static unsigned int furi_pubsub_advance(FuriPubSub* pubsub) {
+    unsigned int epoch = atomic_load(&pubsub->epoch);
+    for(size_t i = 0; i < 2; i++) {
+        if(atomic_load(&pubsub->readers[(epoch + 1) & 1]) != 0) break;
+        if(atomic_compare_exchange_strong(&pubsub->epoch, &epoch, epoch + 1)) epoch++;
+    }
+    return epoch;
+}
+
+/* Free what nobody can see anymore, called with mutex taken */
+static void furi_pubsub_reclaim(FuriPubSub* pubsub) {
+    unsigned int epoch = furi_pubsub_advance(pubsub);
+    FuriPubSubRetired** link = &pubsub->retired;
+    while(*link && epoch - (*link)->epoch < 2) {
+        link = &(*link)->next;
+    }
+    // list is newest first, everything from here on is old enough
+    FuriPubSubRetired* retired = *link;
+    *link = NULL;
+    while(retired) {
+        FuriPubSubRetired* next = retired->next;
+        free(retired);
+        retired = next;
+    }
+}
+
+static void furi_pubsub_retire(FuriPubSub* pubsub, FuriPubSubRetired* retired) {
+    retired->epoch = atomic_load(&pubsub->epoch);
+    retired->next = pubsub->retired;
+    pubsub->retired = retired;
+}
+
+/* Block until woken by a leaving publisher, caller rechecks its condition.
+ * Waiter is counted before the check, so publisher leaving after the check
+ * always sees it and the wakeup is not lost. */
+static void furi_pubsub_wait(FuriPubSub* pubsub) {
+    furi_check(osSemaphoreAcquire(pubsub->wakeup, osWaitForever) == osOK);
+}
+
+static void furi_pubsub_wake(FuriPubSub* pubsub) {
+    unsigned int waiters = atomic_load(&pubsub->waiters) + atomic_load(&pubsub->slot_waiters);
+    for(unsigned int i = waiters; i > 0; i--) {
+        // full semaphore means enough wakeups are pending already
+        if(osSemaphoreRelease(pubsub->wakeup) != osOK) break;
+    }
+}
+
+/* Leave epoch, last publisher of it may complete grace period someone waits for */
+static void furi_pubsub_leave(FuriPubSub* pubsub, unsigned int epoch) {
+    if(atomic_fetch_sub(&pubsub->readers[epoch & 1], 1) == 1 &&
+       atomic_load(&pubsub->waiters) != 0) {
+        furi_pubsub_wake(pubsub);
+    }
+}
+
+static bool furi_pubsub_is_publishing(FuriPubSub* pubsub, osThreadId_t thread) {
+    if(!thread) return false;
+    for(size_t i = 0; i < FURI_PUBSUB_PUBLISHERS_MAX; i++) {
+        if(atomic_load(&pubsub->publishers[i]) == thread) return true;
+    }
+    return false;
+}
+
+static bool furi_pubsub_slot_free(FuriPubSub* pubsub) {
+    for(size_t i = 0; i < FURI_PUBSUB_PUBLISHERS_MAX; i++) {
+        if(atomic_load(&pubsub->publishers[i]) == NULL) return true;
+    }
+    return false;
+}
+
 FuriPubSub* furi_pubsub_alloc() {
     FuriPubSub* pubsub = furi_alloc(sizeof(FuriPubSub));
 
     pubsub->mutex = osMutexNew(NULL);
     furi_assert(pubsub->mutex);
+    pubsub->wakeup = osSemaphoreNew(FURI_PUBSUB_WAKEUPS_MAX, 0, NULL);
+    furi_assert(pubsub->wakeup);
 
-    FuriPubSubSubscriptionList_init(pubsub->items);
+    atomic_init(&pubsub->subscriptions, furi_pubsub_subscriptions_alloc(0));
+    atomic_init(&pubsub->readers[0], 0);
+    atomic_init(&pubsub->readers[1], 0);
+    atomic_init(&pubsub->epoch, 0);
+    for(size_t i = 0; i < FURI_PUBSUB_PUBLISHERS_MAX; i++) {
+        atomic_init(&pubsub->publishers[i], NULL);
+    }
+    atomic_init(&pubsub->waiters, 0);
+    atomic_init(&pubsub->slot_waiters, 0);
 
     return pubsub;
 }
@@ -31,10 +154,18 @@ FuriPubSub* furi_pubsub_alloc() {
 void furi_pubsub_free(FuriPubSub* pubsub) {
     furi_assert(pubsub);
 
-    furi_check(FuriPubSubSubscriptionList_size(pubsub->items) == 0);
+    FuriPubSubSubscriptions* subscriptions = atomic_load(&pubsub->subscriptions);
+    furi_check(subscriptions->count == 0);
+    free(subscriptions);
 
-    FuriPubSubSubscriptionList_clear(pubsub->items);
+    // no publishers left, everything retired can go
+    while(pubsub->retired) {
+        FuriPubSubRetired* next = pubsub->retired->next;
+        free(pubsub->retired);
+        pubsub->retired = next;
+    }
 
+    furi_check(osSemaphoreDelete(pubsub->wakeup) == osOK);
     furi_check(osMutexDelete(pubsub->mutex) == osOK);
 
     free(pubsub);
@@ -42,13 +173,25 @@ void furi_pubsub_free(FuriPubSub* pubsub) {
 
 FuriPubSubSubscription*
     furi_pubsub_subscribe(FuriPubSub* pubsub, FuriPubSubCallback callback, void* callback_context) {
-    furi_check(osMutexAcquire(pubsub->mutex, osWaitForever) == osOK);
-    // put uninitialized item to the list
-    FuriPubSubSubscription* item = FuriPubSubSubscriptionList_push_raw(pubsub->items);
+    furi_assert(pubsub);
+    furi_assert(callback);
 
-    // initialize item
+    FuriPubSubSubscription* item = furi_alloc(sizeof(FuriPubSubSubscription));
     item->callback = callback;
     item->callback_context = callback_context;
+    atomic_init(&item->active, true);
+
+    furi_check(osMutexAcquire(pubsub->mutex, osWaitForever) == osOK);
+
+    // copy current snapshot with new item appended
+    FuriPubSubSubscriptions* old = atomic_load(&pubsub->subscriptions);
+    FuriPubSubSubscriptions* new = furi_pubsub_subscriptions_alloc(old->count + 1);
+    memcpy(new->items, old->items, old->count * sizeof(FuriPubSubSubscription*));
+    new->items[old->count] = item;
+
+    atomic_store(&pubsub->subscriptions, new);
+    furi_pubsub_retire(pubsub, &old->retired);
+    furi_pubsub_reclaim(pubsub);
 
     furi_check(osMutexRelease(pubsub->mutex) == osOK);
 
@@ -60,36 +203,88 @@ void furi_pubsub_unsubscribe(FuriPubSub* pubsub, FuriPubSubSubscription* pubsub_
     furi_assert(pubsub_subscription);
 
     furi_check(osMutexAcquire(pubsub->mutex, osWaitForever) == osOK);
+
+    // copy current snapshot without our item
+    FuriPubSubSubscriptions* old = atomic_load(&pubsub->subscriptions);
+    furi_check(old->count > 0);
+    FuriPubSubSubscriptions* new = furi_pubsub_subscriptions_alloc(old->count - 1);
+    size_t count = 0;
     bool result = false;
+    for(size_t i = 0; i < old->count; i++) {
+        if(old->items[i] == pubsub_subscription) {
+            result = true;
+        } else if(count < new->count) {
+            new->items[count++] = old->items[i];
+        }
+    }
+    furi_check(result);
 
-    // iterate over items
-    FuriPubSubSubscriptionList_it_t it;
-    for(FuriPubSubSubscriptionList_it(it, pubsub->items); !FuriPubSubSubscriptionList_end_p(it);
-        FuriPubSubSubscriptionList_next(it)) {
-        const FuriPubSubSubscription* item = FuriPubSubSubscriptionList_cref(it);
+    // publishers holding older snapshots skip inactive item
+    atomic_store(&pubsub->subscriptions, new);
+    atomic_store(&pubsub_subscription->active, false);
+    furi_pubsub_retire(pubsub, &old->retired);
+    unsigned int epoch = old->retired.epoch;
 
-        // if the iterator is equal to our element
-        if(item == pubsub_subscription) {
-            FuriPubSubSubscriptionList_remove(pubsub->items, it);
-            result = true;
-            break;
+    furi_check(osMutexRelease(pubsub->mutex) == osOK);
+
+    // wait for grace period: publishers that could see our item are gone once epoch
+    // moves by two, caller may free context then. From callback own publish never
+    // ends while we wait, so don't.
+    if(!furi_pubsub_is_publishing(pubsub, osThreadGetId())) {
+        atomic_fetch_add(&pubsub->waiters, 1);
+        while(furi_pubsub_advance(pubsub) - epoch < 2) {
+            furi_pubsub_wait(pubsub);
         }
+        atomic_fetch_sub(&pubsub->waiters, 1);
     }
 
+    furi_check(osMutexAcquire(pubsub->mutex, osWaitForever) == osOK);
+    furi_pubsub_retire(pubsub, &pubsub_subscription->retired);
+    furi_pubsub_reclaim(pubsub);
     furi_check(osMutexRelease(pubsub->mutex) == osOK);
-    furi_check(result);
 }
 
 void furi_pubsub_publish(FuriPubSub* pubsub, void* message) {
-    furi_check(osMutexAcquire(pubsub->mutex, osWaitForever) == osOK);
+    // take publisher slot, nested publish from callback takes another one. Search starts
+    // from thread address, so publishers on different threads rarely touch the same slot.
+    // Caller without thread id, e.g. before kernel start, is not tracked.
+    osThreadId_t thread = osThreadGetId();
+    size_t slot = ((uintptr_t)thread >> 4) % FURI_PUBSUB_PUBLISHERS_MAX;
+    for(size_t i = 0; thread; i++) {
+        osThreadId_t expected = NULL;
+        if(atomic_compare_exchange_strong(&pubsub->publishers[slot], &expected, thread)) break;
+        slot = (slot + 1) % FURI_PUBSUB_PUBLISHERS_MAX;
+        if(i == FURI_PUBSUB_PUBLISHERS_MAX) {
+            // all slots taken, sleep until one of publishers leaves
+            atomic_fetch_add(&pubsub->slot_waiters, 1);
+            if(!furi_pubsub_slot_free(pubsub)) furi_pubsub_wait(pubsub);
+            atomic_fetch_sub(&pubsub->slot_waiters, 1);
+            i = 0;
+        }
+    }
 
-    // iterate over subscribers
-    FuriPubSubSubscriptionList_it_t it;
-    for(FuriPubSubSubscriptionList_it(it, pubsub->items); !FuriPubSubSubscriptionList_end_p(it);
-        FuriPubSubSubscriptionList_next(it)) {
-        const FuriPubSubSubscription* item = FuriPubSubSubscriptionList_cref(it);
-        item->callback(message, item->callback_context);
+    // enter epoch, retry if it was advanced between load and increment
+    unsigned int epoch;
+    while(true) {
+        epoch = atomic_load(&pubsub->epoch);
+        atomic_fetch_add(&pubsub->readers[epoch & 1], 1);
+        if(atomic_load(&pubsub->epoch) == epoch) break;
+        furi_pubsub_leave(pubsub, epoch);
     }
 
-    furi_check(osMutexRelease(pubsub->mutex) == osOK);
+    // iterate over snapshot, it and its items stay valid until we leave epoch.
+    // Unsubscribe waits for epoch, so calls need no accounting of their own.
+    FuriPubSubSubscriptions* subscriptions = atomic_load(&pubsub->subscriptions);
+    for(size_t i = 0; i < subscriptions->count; i++) {
+        FuriPubSubSubscription* item = subscriptions->items[i];
+        if(atomic_load_explicit(&item->active, memory_order_relaxed)) {
+            item->callback(message, item->callback_context);
+        }
+    }
+
+    furi_pubsub_leave(pubsub, epoch);
+    if(thread) {
+        atomic_store(&pubsub->publishers[slot], NULL);
+        if(atomic_load(&pubsub->slot_waiters) != 0) furi_pubsub_wake(pubsub);
+    }
 }
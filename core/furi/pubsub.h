@@ -29,7 +29,8 @@ void furi_pubsub_free(FuriPubSub* pubsub);
 
 /** Subscribe to FuriPubSub
  * 
- * Threadsafe, Reentrable
+ * Threadsafe, Reentrable. Never waits for publishers, may be called from
+ * callback of the same FuriPubSub.
  * 
  * @param      pubsub            pointer to FuriPubSub instance
  * @param[in]  callback          The callback
@@ -43,7 +44,10 @@ FuriPubSubSubscription*
 /** Unsubscribe from FuriPubSub
  * 
  * No use of `pubsub_subscription` allowed after call of this method
- * Threadsafe, Reentrable.
+ * Threadsafe, Reentrable. Callback is not called anymore once this method
+ * returns, it sleeps until publishes in progress on other threads are done.
+ * May be called from callback of the same FuriPubSub, including its own: then
+ * it doesn't wait and calls already running on other threads may still finish.
  *
  * @param      pubsub               pointer to FuriPubSub instance
  * @param      pubsub_subscription  pointer to FuriPubSubSubscription instance
@@ -52,7 +56,8 @@ void furi_pubsub_unsubscribe(FuriPubSub* pubsub, FuriPubSubSubscription* pubsub_
 
 /** Publish message to FuriPubSub
  *
- * Threadsafe, Reentrable.
+ * Threadsafe, Reentrable. Lock-free: callbacks are called for snapshot of
+ * subscribers taken on entry, slow subscriber never blocks other publishers.
  * 
  * @param      pubsub   pointer to FuriPubSub instance
  * @param      message  message pointer to publish
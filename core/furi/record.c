@@ -3,22 +3,31 @@
 #include "memmgr.h"
 
 #include <cmsis_os2.h>
-#include <m-string.h>
-#include <m-dict.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <string.h>
 
 #define FURI_RECORD_FLAG_READY (0x1)
+/* Holders count of record being destroyed, open does not take it */
+#define FURI_RECORD_HOLDERS_DEAD UINT32_MAX
 
+/* Open addressing table, must be power of two */
+#define FURI_RECORD_TABLE_SIZE 32
+#define FURI_RECORD_NAME_SIZE 24
+
+/* Slots are never released: once name is set it stays, so lookup can walk
+the table without lock. Destroyed record keeps its slot for next create. */
 typedef struct {
+    atomic_uint hash; /**< 0 for empty slot, published after name */
+    char name[FURI_RECORD_NAME_SIZE];
     osEventFlagsId_t flags;
-    void* data;
-    size_t holders_count;
+    void* _Atomic data;
+    atomic_uint holders_count; /**< FURI_RECORD_HOLDERS_DEAD while destroy runs */
 } FuriRecordData;
 
-DICT_DEF2(FuriRecordDataDict, string_t, STRING_OPLIST, FuriRecordData, M_POD_OPLIST)
-
 typedef struct {
     osMutexId_t mutex;
-    FuriRecordDataDict_t records;
+    FuriRecordData records[FURI_RECORD_TABLE_SIZE];
 } FuriRecord;
 
 static FuriRecord* furi_record = NULL;
@@ -27,21 +36,29 @@ void furi_record_init() {
     furi_record = furi_alloc(sizeof(FuriRecord));
     furi_record->mutex = osMutexNew(NULL);
     furi_check(furi_record->mutex);
-    FuriRecordDataDict_init(furi_record->records);
 }
 
-static FuriRecordData* furi_record_data_get_or_create(string_t name_str) {
-    furi_assert(furi_record);
-    FuriRecordData* record_data = FuriRecordDataDict_get(furi_record->records, name_str);
-    if(!record_data) {
-        FuriRecordData new_record;
-        new_record.flags = osEventFlagsNew(NULL);
-        new_record.data = NULL;
-        new_record.holders_count = 0;
-        FuriRecordDataDict_set_at(furi_record->records, name_str, new_record);
-        record_data = FuriRecordDataDict_get(furi_record->records, name_str);
+/* FNV-1a, 0 is reserved for empty slot */
+static uint32_t furi_record_hash(const char* name) {
+    uint32_t hash = 2166136261UL;
+    while(*name) {
+        hash ^= (uint8_t)*name++;
+        hash *= 16777619UL;
     }
-    return record_data;
+    return hash ? hash : 1;
+}
+
+static FuriRecordData* furi_record_data_find(const char* name, uint32_t hash) {
+    for(size_t i = 0; i < FURI_RECORD_TABLE_SIZE; i++) {
+        FuriRecordData* record_data =
+            &furi_record->records[(hash + i) & (FURI_RECORD_TABLE_SIZE - 1)];
+        uint32_t slot_hash = atomic_load(&record_data->hash);
+        if(slot_hash == 0) break;
+        if(slot_hash == hash && strcmp(record_data->name, name) == 0) {
+            return record_data;
+        }
+    }
+    return NULL;
 }
 
 static void furi_record_lock() {
@@ -52,107 +69,137 @@ static void furi_record_unlock() {
     furi_check(osMutexRelease(furi_record->mutex) == osOK);
 }
 
-bool furi_record_exists(const char* name) {
+static FuriRecordData* furi_record_data_get_or_create(const char* name, uint32_t hash) {
     furi_assert(furi_record);
     furi_assert(name);
 
-    bool ret = false;
-
-    string_t name_str;
-    string_init_set_str(name_str, name);
+    // Existing slot, no lock needed
+    FuriRecordData* record_data = furi_record_data_find(name, hash);
+    if(record_data) return record_data;
 
     furi_record_lock();
-    ret = (FuriRecordDataDict_get(furi_record->records, name_str) != NULL);
+    // Could have been added while we were waiting for lock
+    record_data = furi_record_data_find(name, hash);
+    if(!record_data) {
+        furi_check(strlen(name) < FURI_RECORD_NAME_SIZE);
+        for(size_t i = 0; i < FURI_RECORD_TABLE_SIZE; i++) {
+            FuriRecordData* slot =
+                &furi_record->records[(hash + i) & (FURI_RECORD_TABLE_SIZE - 1)];
+            if(atomic_load(&slot->hash) == 0) {
+                record_data = slot;
+                break;
+            }
+        }
+        furi_check(record_data);
+
+        strcpy(record_data->name, name);
+        record_data->flags = osEventFlagsNew(NULL);
+        furi_check(record_data->flags);
+        atomic_init(&record_data->data, NULL);
+        atomic_init(&record_data->holders_count, 0);
+        atomic_store(&record_data->hash, hash);
+    }
     furi_record_unlock();
 
-    string_clear(name_str);
+    return record_data;
+}
+
+bool furi_record_exists(const char* name) {
+    furi_assert(furi_record);
+    furi_assert(name);
 
-    return ret;
+    FuriRecordData* record_data = furi_record_data_find(name, furi_record_hash(name));
+    return record_data && atomic_load(&record_data->data) != NULL;
 }
 
 void furi_record_create(const char* name, void* data) {
     furi_assert(furi_record);
+    furi_assert(data);
 
-    string_t name_str;
-    string_init_set_str(name_str, name);
+    FuriRecordData* record_data = furi_record_data_get_or_create(name, furi_record_hash(name));
 
     furi_record_lock();
 
-    // Get record data and fill it
-    FuriRecordData* record_data = furi_record_data_get_or_create(name_str);
-    furi_assert(record_data->data == NULL);
-    record_data->data = data;
+    // Data goes first, so ready record is never seen without it
+    furi_assert(atomic_load(&record_data->data) == NULL);
+    atomic_store(&record_data->data, data);
     osEventFlagsSet(record_data->flags, FURI_RECORD_FLAG_READY);
 
     furi_record_unlock();
-
-    string_clear(name_str);
 }
 
 bool furi_record_destroy(const char* name) {
     furi_assert(furi_record);
+    furi_assert(name);
 
     bool ret = false;
 
-    string_t name_str;
-    string_init_set_str(name_str, name);
+    FuriRecordData* record_data = furi_record_data_find(name, furi_record_hash(name));
+    furi_assert(record_data);
 
     furi_record_lock();
 
-    FuriRecordData* record_data = FuriRecordDataDict_get(furi_record->records, name_str);
-    furi_assert(record_data);
-    if(record_data->holders_count == 0) {
-        furi_check(osOK == osEventFlagsDelete(record_data->flags));
-        FuriRecordDataDict_erase(furi_record->records, name_str);
+    // Ready flag goes first: open that sees dead marker sleeps until next create,
+    // open that got holder in before marker keeps record alive.
+    uint32_t flags = osEventFlagsClear(record_data->flags, FURI_RECORD_FLAG_READY);
+    unsigned int holders = 0;
+    if(atomic_compare_exchange_strong(
+           &record_data->holders_count, &holders, FURI_RECORD_HOLDERS_DEAD)) {
+        atomic_store(&record_data->data, NULL);
+        atomic_store(&record_data->holders_count, 0);
         ret = true;
+    } else if(flags & FURI_RECORD_FLAG_READY) {
+        osEventFlagsSet(record_data->flags, FURI_RECORD_FLAG_READY);
     }
 
     furi_record_unlock();
 
-    string_clear(name_str);
-
     return ret;
 }
 
 void* furi_record_open(const char* name) {
     furi_assert(furi_record);
 
-    string_t name_str;
-    string_init_set_str(name_str, name);
-
-    furi_record_lock();
-
-    FuriRecordData* record_data = furi_record_data_get_or_create(name_str);
-    record_data->holders_count++;
-
-    furi_record_unlock();
+    FuriRecordData* record_data = furi_record_data_get_or_create(name, furi_record_hash(name));
+
+    // Destroy either sees holder and keeps record, or marks it dead first
+    unsigned int holders = atomic_load(&record_data->holders_count);
+    while(true) {
+        if(holders == FURI_RECORD_HOLDERS_DEAD) {
+            // Ready is cleared before marker is set, so this sleeps until create
+            osEventFlagsWait(
+                record_data->flags,
+                FURI_RECORD_FLAG_READY,
+                osFlagsWaitAny | osFlagsNoClear,
+                osWaitForever);
+            holders = atomic_load(&record_data->holders_count);
+        } else if(atomic_compare_exchange_weak(
+                      &record_data->holders_count, &holders, holders + 1)) {
+            break;
+        }
+    }
 
     // Wait for record to become ready
-    furi_check(
-        osEventFlagsWait(
-            record_data->flags,
-            FURI_RECORD_FLAG_READY,
-            osFlagsWaitAny | osFlagsNoClear,
-            osWaitForever) == FURI_RECORD_FLAG_READY);
-
-    string_clear(name_str);
-
-    return record_data->data;
+    void* data;
+    do {
+        furi_check(
+            osEventFlagsWait(
+                record_data->flags,
+                FURI_RECORD_FLAG_READY,
+                osFlagsWaitAny | osFlagsNoClear,
+                osWaitForever) == FURI_RECORD_FLAG_READY);
+        data = atomic_load(&record_data->data);
+    } while(data == NULL);
+
+    return data;
 }
 
 void furi_record_close(const char* name) {
     furi_assert(furi_record);
+    furi_assert(name);
 
-    string_t name_str;
-    string_init_set_str(name_str, name);
-
-    furi_record_lock();
-
-    FuriRecordData* record_data = FuriRecordDataDict_get(furi_record->records, name_str);
+    FuriRecordData* record_data = furi_record_data_find(name, furi_record_hash(name));
     furi_assert(record_data);
-    record_data->holders_count--;
-
-    furi_record_unlock();
-
-    string_clear(name_str);
+    furi_assert(atomic_load(&record_data->holders_count) > 0);
+    atomic_fetch_sub(&record_data->holders_count, 1);
 }
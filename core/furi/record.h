@@ -1,6 +1,9 @@
 /**
  * @file record.h
  * Furi: record API
+ *
+ * Records live in a fixed hash table keyed by name, lookups do not allocate.
+ * Opening and closing existing record does not take global record lock.
  */
 
 #pragma once
@@ -18,6 +21,8 @@ void furi_record_init();
 /** Check if record exists
  *
  * @param      name  record name
+ *
+ * @return     true if record was created and not destroyed yet
  * @note       Thread safe. Create and destroy must be executed from the same
  *             thread.
  */
@@ -25,8 +30,8 @@ bool furi_record_exists(const char* name);
 
 /** Create record
  *
- * @param      name  record name
- * @param      data  data pointer
+ * @param      name  record name, shorter than 24 characters
+ * @param      data  data pointer, not NULL
  * @note       Thread safe. Create and destroy must be executed from the same
  *             thread.
  */
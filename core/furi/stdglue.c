@@ -123,6 +123,7 @@ bool furi_stdglue_set_thread_stdout_callback(FuriStdglueWriteCallback callback)
     }
 }
 
+#ifndef FURI_HOST
 void __malloc_lock(struct _reent* REENT) {
     vTaskSuspendAll();
 }
@@ -130,3 +131,4 @@ void __malloc_lock(struct _reent* REENT) {
 void __malloc_unlock(struct _reent* REENT) {
     xTaskResumeAll();
 }
+#endif
@@ -0,0 +1,126 @@
+#include "trace.h"
+#include "check.h"
+#include "common_defines.h"
+#include "memmgr.h"
+#include <furi-hal.h>
+
+#include <stdatomic.h>
+
+/* queueQUEUE_TYPE_* values from FreeRTOS queue.h */
+#define FURI_TRACE_QUEUE_TYPE_BASE (0U)
+#define FURI_TRACE_QUEUE_TYPE_MUTEX (1U)
+#define FURI_TRACE_QUEUE_TYPE_RECURSIVE_MUTEX (4U)
+
+typedef struct {
+    FuriTraceEvent* events;
+    size_t mask; /**< Ring size minus one */
+    atomic_uint head; /**< Events recorded since reset */
+    atomic_bool running;
+} FuriTrace;
+
+static FuriTrace furi_trace = {0};
+
+static const char* const furi_trace_type_names[FuriTraceTypeLast] = {
+    [FuriTraceTypeThreadSwitch] = "switch",
+    [FuriTraceTypeIsrEnter] = "isr_enter",
+    [FuriTraceTypeIsrExit] = "isr_exit",
+    [FuriTraceTypeQueuePut] = "queue_put",
+    [FuriTraceTypeQueueGet] = "queue_get",
+    [FuriTraceTypeMutexWait] = "mutex_wait",
+    [FuriTraceTypeSpanBegin] = "begin",
+    [FuriTraceTypeSpanEnd] = "end",
+};
+
+bool furi_trace_start(size_t events_count) {
+    if(events_count > FURI_TRACE_EVENTS_MAX) return false;
+    if(!furi_trace.events) {
+        size_t size = 1;
+        while(size < (events_count ? events_count : FURI_TRACE_EVENTS_DEFAULT)) size <<= 1;
+        furi_trace.events = furi_alloc(size * sizeof(FuriTraceEvent));
+        furi_trace.mask = size - 1;
+    }
+    atomic_store(&furi_trace.running, true);
+    return true;
+}
+
+void furi_trace_stop() {
+    atomic_store(&furi_trace.running, false);
+}
+
+bool furi_trace_is_running() {
+    return atomic_load(&furi_trace.running);
+}
+
+void furi_trace_reset() {
+    atomic_store(&furi_trace.head, 0);
+}
+
+void furi_trace_record(FuriTraceType type, uint16_t id, const void* data) {
+    if(!atomic_load_explicit(&furi_trace.running, memory_order_relaxed)) return;
+
+    // Slot is owned once index is taken, ISR preempting us takes the next one
+    uint32_t index = atomic_fetch_add_explicit(&furi_trace.head, 1, memory_order_relaxed);
+    FuriTraceEvent* event = &furi_trace.events[index & furi_trace.mask];
+    event->timestamp = furi_hal_delay_get_cycles();
+    event->type = type;
+    event->id = id;
+    event->data = data;
+}
+
+size_t furi_trace_get_capacity() {
+    return furi_trace.events ? furi_trace.mask + 1 : 0;
+}
+
+size_t furi_trace_get_count() {
+    if(!furi_trace.events) return 0;
+    return MIN((size_t)atomic_load(&furi_trace.head), furi_trace.mask + 1);
+}
+
+size_t furi_trace_get_events(FuriTraceEvent* events, size_t first, size_t count) {
+    furi_assert(events);
+    if(!furi_trace.events) return 0;
+
+    uint32_t head = atomic_load(&furi_trace.head);
+    size_t available = MIN((size_t)head, furi_trace.mask + 1);
+    if(first >= available) return 0;
+    count = MIN(count, available - first);
+    uint32_t oldest = head - available + first;
+    for(size_t i = 0; i < count; i++) {
+        events[i] = furi_trace.events[(oldest + i) & furi_trace.mask];
+    }
+
+    return count;
+}
+
+const char* furi_trace_get_type_name(FuriTraceType type) {
+    furi_assert(type < FuriTraceTypeLast);
+    return furi_trace_type_names[type];
+}
+
+uint32_t furi_trace_get_cycles_per_us() {
+    return furi_hal_delay_get_cycles_per_us();
+}
+
+void furi_trace_on_thread_switch(void* task) {
+    furi_trace_record(FuriTraceTypeThreadSwitch, 0, task);
+}
+
+void furi_trace_on_queue_send(void* queue, uint8_t queue_type) {
+    // Semaphores and mutex releases go through the same path, skip them
+    if(queue_type == FURI_TRACE_QUEUE_TYPE_BASE) {
+        furi_trace_record(FuriTraceTypeQueuePut, 0, queue);
+    }
+}
+
+void furi_trace_on_queue_receive(void* queue, uint8_t queue_type) {
+    if(queue_type == FURI_TRACE_QUEUE_TYPE_BASE) {
+        furi_trace_record(FuriTraceTypeQueueGet, 0, queue);
+    }
+}
+
+void furi_trace_on_queue_block(void* queue, uint8_t queue_type) {
+    if(queue_type == FURI_TRACE_QUEUE_TYPE_MUTEX ||
+       queue_type == FURI_TRACE_QUEUE_TYPE_RECURSIVE_MUTEX) {
+        furi_trace_record(FuriTraceTypeMutexWait, 0, queue);
+    }
+}
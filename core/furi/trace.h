@@ -0,0 +1,140 @@
+/**
+ * @file trace.h
+ * Furi: system trace recorder
+ *
+ * Fixed size events with cycle counter timestamps in RAM ring. Kernel hooks
+ * record thread switches, queue operations and mutex waits, interrupt
+ * handlers and services mark their work with ISR and span events. Recording
+ * is off until furi_trace_start, then every event costs a few stores. Hooks
+ * and markers are compiled in debug builds (FURI_DEBUG) only.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Default ring size in events, allocated on first start */
+#define FURI_TRACE_EVENTS_DEFAULT 512
+/** Largest ring size in events */
+#define FURI_TRACE_EVENTS_MAX 4096
+
+typedef enum {
+    FuriTraceTypeThreadSwitch, /**< data: switched in thread */
+    FuriTraceTypeIsrEnter, /**< data: handler name, id: interrupt number */
+    FuriTraceTypeIsrExit, /**< data: handler name, id: interrupt number */
+    FuriTraceTypeQueuePut, /**< data: queue */
+    FuriTraceTypeQueueGet, /**< data: queue */
+    FuriTraceTypeMutexWait, /**< data: mutex, current thread blocks on it */
+    FuriTraceTypeSpanBegin, /**< data: span name */
+    FuriTraceTypeSpanEnd, /**< data: span name */
+    FuriTraceTypeLast,
+} FuriTraceType;
+
+typedef struct {
+    uint32_t timestamp; /**< cycle counter, wraps around */
+    uint16_t type; /**< FuriTraceType */
+    uint16_t id;
+    const void* data;
+} FuriTraceEvent;
+
+#ifdef FURI_DEBUG
+/** Mark begin of span, name must be a literal */
+#define FURI_TRACE_BEGIN(name) furi_trace_record(FuriTraceTypeSpanBegin, 0, name)
+/** Mark end of span started with FURI_TRACE_BEGIN and the same name */
+#define FURI_TRACE_END(name) furi_trace_record(FuriTraceTypeSpanEnd, 0, name)
+/** Mark interrupt handler entry, name must be a literal */
+#define FURI_TRACE_ISR_ENTER(name, id) furi_trace_record(FuriTraceTypeIsrEnter, id, name)
+/** Mark interrupt handler exit */
+#define FURI_TRACE_ISR_EXIT(name, id) furi_trace_record(FuriTraceTypeIsrExit, id, name)
+#else
+#define FURI_TRACE_BEGIN(name) ((void)0)
+#define FURI_TRACE_END(name) ((void)0)
+#define FURI_TRACE_ISR_ENTER(name, id) ((void)0)
+#define FURI_TRACE_ISR_EXIT(name, id) ((void)0)
+#endif
+
+/** Start recording
+ *
+ * Ring is allocated on first start and reused after, old events are kept.
+ *
+ * @param      events_count  ring size, rounded up to power of two, 0 for default
+ *
+ * @return     false if events_count is above FURI_TRACE_EVENTS_MAX
+ */
+bool furi_trace_start(size_t events_count);
+
+/** Stop recording, events stay in ring */
+void furi_trace_stop();
+
+/** Check if recording
+ *
+ * @return     true if recording
+ */
+bool furi_trace_is_running();
+
+/** Drop recorded events */
+void furi_trace_reset();
+
+/** Record event, does nothing if not recording
+ *
+ * ISR safe
+ *
+ * @param      type  event type
+ * @param      id    event specific id
+ * @param      data  event specific pointer
+ */
+void furi_trace_record(FuriTraceType type, uint16_t id, const void* data);
+
+/** Get ring size
+ *
+ * @return     ring size in events, 0 if never started
+ */
+size_t furi_trace_get_capacity();
+
+/** Get number of events in ring
+ *
+ * @return     recorded events, up to ring size
+ */
+size_t furi_trace_get_count();
+
+/** Copy recorded events, oldest first
+ *
+ * Stop recording before reading in chunks, otherwise ring moves between them.
+ *
+ * @param      events  destination
+ * @param      first   index of first event to copy, 0 is the oldest one
+ * @param      count   destination size in events
+ *
+ * @return     events copied
+ */
+size_t furi_trace_get_events(FuriTraceEvent* events, size_t first, size_t count);
+
+/** Get event type name
+ *
+ * @param      type  event type
+ *
+ * @return     name
+ */
+const char* furi_trace_get_type_name(FuriTraceType type);
+
+/** Timestamp rate
+ *
+ * @return     cycles per microsecond
+ */
+uint32_t furi_trace_get_cycles_per_us();
+
+/* Kernel hooks, called from FreeRTOS trace macros */
+void furi_trace_on_thread_switch(void* task);
+void furi_trace_on_queue_send(void* queue, uint8_t queue_type);
+void furi_trace_on_queue_receive(void* queue, uint8_t queue_type);
+void furi_trace_on_queue_block(void* queue, uint8_t queue_type);
+
+#ifdef __cplusplus
+}
+#endif
@@ -51,6 +51,12 @@
 #if defined(__ICCARM__) || defined(__CC_ARM) || defined(__GNUC__)
   #include <stdint.h>
   extern uint32_t SystemCoreClock;
+  extern void memmgr_heap_on_task_delete(void* task);
+  extern void furi_trace_on_thread_switch(void* task);
+  extern void furi_trace_on_queue_send(void* queue, uint8_t queue_type);
+  extern void furi_trace_on_queue_receive(void* queue, uint8_t queue_type);
+  extern void furi_trace_on_queue_block(void* queue, uint8_t queue_type);
+  extern uint32_t furi_hal_delay_get_cycles(void);
 #endif
 #ifndef CMSIS_device_header
 #define CMSIS_device_header "stm32wbxx.h"
@@ -71,7 +77,12 @@
 /* Heap size determined automatically by linker */
 // #define configTOTAL_HEAP_SIZE                    ((size_t)0)
 #define configMAX_TASK_NAME_LEN                  ( 16 )
+/* Run time counters feed profiler service only */
+#ifdef SRV_PROFILER
+#define configGENERATE_RUN_TIME_STATS            1
+#else
 #define configGENERATE_RUN_TIME_STATS            0
+#endif
 #define configUSE_TRACE_FACILITY                 1
 #define configUSE_16_BIT_TICKS                   0
 #define configUSE_MUTEXES                        1
@@ -178,6 +189,22 @@ standard names. */
 /* USER CODE BEGIN Defines */
 /* Section where parameter definitions can be added (for instance, to override default ones in FreeRTOS.h) */
 #define configOVERRIDE_DEFAULT_TICK_CONFIGURATION 1  /* required only for Keil but does not hurt otherwise */
+/* Release per thread heap counters slot */
+#define traceTASK_DELETE( pxTCB ) memmgr_heap_on_task_delete( pxTCB )
+#ifdef SRV_PROFILER
+/* Run time counters in DWT cycles, counter is started by furi_hal_delay_init */
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
+#define portGET_RUN_TIME_COUNTER_VALUE() furi_hal_delay_get_cycles()
+#endif
+#ifdef FURI_DEBUG
+/* Furi trace recorder, debug builds only, ucQueueType needs configUSE_TRACE_FACILITY */
+#define traceTASK_SWITCHED_IN() furi_trace_on_thread_switch( pxCurrentTCB )
+#define traceQUEUE_SEND( pxQueue ) furi_trace_on_queue_send( pxQueue, ( pxQueue )->ucQueueType )
+#define traceQUEUE_SEND_FROM_ISR( pxQueue ) furi_trace_on_queue_send( pxQueue, ( pxQueue )->ucQueueType )
+#define traceQUEUE_RECEIVE( pxQueue ) furi_trace_on_queue_receive( pxQueue, ( pxQueue )->ucQueueType )
+#define traceQUEUE_RECEIVE_FROM_ISR( pxQueue ) furi_trace_on_queue_receive( pxQueue, ( pxQueue )->ucQueueType )
+#define traceBLOCKING_ON_QUEUE_RECEIVE( pxQueue ) furi_trace_on_queue_block( pxQueue, ( pxQueue )->ucQueueType )
+#endif
 /* USER CODE END Defines */
 
 #endif /* FREERTOS_CONFIG_H */
@@ -34,3 +34,11 @@ void delay(float milliseconds) {
 uint32_t millis(void){
     return HAL_GetTick();
 }
+
+uint32_t furi_hal_delay_get_cycles(void) {
+    return DWT->CYCCNT;
+}
+
+uint32_t furi_hal_delay_get_cycles_per_us(void) {
+    return clk_per_microsecond;
+}
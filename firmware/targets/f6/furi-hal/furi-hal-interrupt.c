@@ -62,6 +62,16 @@ void furi_hal_interrupt_set_dma_channel_isr(DMA_TypeDef* dma, uint32_t channel,
 
 extern void api_interrupt_call(InterruptType type, void* hw);
 
+static void furi_hal_interrupt_call_dma(size_t dma, size_t channel) {
+    if (furi_hal_dma_channel_isr[dma][channel]) {
+        api_interrupt_enter();
+        FURI_TRACE_ISR_ENTER("DMA", dma * FURI_HAL_INTERRUPT_DMA_CHANNELS_COUNT + channel);
+        furi_hal_dma_channel_isr[dma][channel]();
+        FURI_TRACE_ISR_EXIT("DMA", dma * FURI_HAL_INTERRUPT_DMA_CHANNELS_COUNT + channel);
+        api_interrupt_exit();
+    }
+}
+
 /* ST HAL symbols */
 
 /* Comparator trigger event */
@@ -76,86 +86,94 @@ void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef* htim) {
 
 /* Timer 2 */
 void TIM2_IRQHandler(void) {
+    api_interrupt_enter();
+    FURI_TRACE_ISR_ENTER("TIM2", TIM2_IRQn);
     if (furi_hal_tim_tim2_isr) {
         furi_hal_tim_tim2_isr();
     } else {
         HAL_TIM_IRQHandler(&htim2);
     }
+    FURI_TRACE_ISR_EXIT("TIM2", TIM2_IRQn);
+    api_interrupt_exit();
 }
 
 /* Timer 1 Update */
 void TIM1_UP_TIM16_IRQHandler(void) {
+    api_interrupt_enter();
+    FURI_TRACE_ISR_ENTER("TIM1", TIM1_UP_TIM16_IRQn);
     if (furi_hal_tim_tim1_isr) {
         furi_hal_tim_tim1_isr();
     } else {
         HAL_TIM_IRQHandler(&htim1);
     }
+    FURI_TRACE_ISR_EXIT("TIM1", TIM1_UP_TIM16_IRQn);
+    api_interrupt_exit();
 }
 
 /* DMA 1 */
 void DMA1_Channel1_IRQHandler(void) {
-    if (furi_hal_dma_channel_isr[0][0]) furi_hal_dma_channel_isr[0][0]();
+    furi_hal_interrupt_call_dma(0, 0);
 }
 
 void DMA1_Channel2_IRQHandler(void) {
-    if (furi_hal_dma_channel_isr[0][1]) furi_hal_dma_channel_isr[0][1]();
+    furi_hal_interrupt_call_dma(0, 1);
 }
 
 void DMA1_Channel3_IRQHandler(void) {
-    if (furi_hal_dma_channel_isr[0][2]) furi_hal_dma_channel_isr[0][2]();
+    furi_hal_interrupt_call_dma(0, 2);
 }
 
 void DMA1_Channel4_IRQHandler(void) {
-    if (furi_hal_dma_channel_isr[0][3]) furi_hal_dma_channel_isr[0][3]();
+    furi_hal_interrupt_call_dma(0, 3);
 }
 
 void DMA1_Channel5_IRQHandler(void) {
-    if (furi_hal_dma_channel_isr[0][4]) furi_hal_dma_channel_isr[0][4]();
+    furi_hal_interrupt_call_dma(0, 4);
 }
 
 void DMA1_Channel6_IRQHandler(void) {
-    if (furi_hal_dma_channel_isr[0][5]) furi_hal_dma_channel_isr[0][5]();
+    furi_hal_interrupt_call_dma(0, 5);
 }
 
 void DMA1_Channel7_IRQHandler(void) {
-    if (furi_hal_dma_channel_isr[0][6]) furi_hal_dma_channel_isr[0][6]();
+    furi_hal_interrupt_call_dma(0, 6);
 }
 
 void DMA1_Channel8_IRQHandler(void) {
-    if (furi_hal_dma_channel_isr[0][7]) furi_hal_dma_channel_isr[0][7]();
+    furi_hal_interrupt_call_dma(0, 7);
 }
 
 /* DMA 2 */
 void DMA2_Channel1_IRQHandler(void) {
-    if (furi_hal_dma_channel_isr[1][0]) furi_hal_dma_channel_isr[1][0]();
+    furi_hal_interrupt_call_dma(1, 0);
 }
 
 void DMA2_Channel2_IRQHandler(void) {
-    if (furi_hal_dma_channel_isr[1][1]) furi_hal_dma_channel_isr[1][1]();
+    furi_hal_interrupt_call_dma(1, 1);
 }
 
 void DMA2_Channel3_IRQHandler(void) {
-    if (furi_hal_dma_channel_isr[1][2]) furi_hal_dma_channel_isr[1][2]();
+    furi_hal_interrupt_call_dma(1, 2);
 }
 
 void DMA2_Channel4_IRQHandler(void) {
-    if (furi_hal_dma_channel_isr[1][3]) furi_hal_dma_channel_isr[1][3]();
+    furi_hal_interrupt_call_dma(1, 3);
 }
 
 void DMA2_Channel5_IRQHandler(void) {
-    if (furi_hal_dma_channel_isr[1][4]) furi_hal_dma_channel_isr[1][4]();
+    furi_hal_interrupt_call_dma(1, 4);
 }
 
 void DMA2_Channel6_IRQHandler(void) {
-    if (furi_hal_dma_channel_isr[1][5]) furi_hal_dma_channel_isr[1][5]();
+    furi_hal_interrupt_call_dma(1, 5);
 }
 
 void DMA2_Channel7_IRQHandler(void) {
-    if (furi_hal_dma_channel_isr[1][6]) furi_hal_dma_channel_isr[1][6]();
+    furi_hal_interrupt_call_dma(1, 6);
 }
 
 void DMA2_Channel8_IRQHandler(void) {
-    if (furi_hal_dma_channel_isr[1][7]) furi_hal_dma_channel_isr[1][7]();
+    furi_hal_interrupt_call_dma(1, 7);
 }
 
 void TAMP_STAMP_LSECSS_IRQHandler(void) {
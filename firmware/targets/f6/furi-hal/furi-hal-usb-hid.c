@@ -3,6 +3,7 @@
 #include "furi-hal-usb.h"
 #include "furi-hal-usb-hid.h"
 #include <furi.h>
+#include <string.h>
 
 #include "usb.h"
 #include "usb_hid.h"
@@ -13,7 +14,10 @@
 #define HID_RIN_EP      0x81
 #define HID_RIN_SZ      0x10
 
-#define HID_KB_MAX_KEYS 6
+/* Reports waiting for endpoint, writers block only when it is full */
+#define HID_QUEUE_LEN   16
+/* One ring entry stays unused to tell full ring from empty one */
+#define HID_QUEUE_RING  (HID_QUEUE_LEN + 1)
 
 struct HidIadDescriptor {
     struct usb_iad_descriptor           hid_iad;
@@ -184,16 +188,29 @@ static struct HidReport {
     struct HidReportMouse mouse;
 } __attribute__((packed)) hid_report;
 
+struct HidQueueItem {
+    uint8_t size;
+    union {
+        struct HidReportKB keyboard;
+        struct HidReportMouse mouse;
+    } report;
+};
+
 static void hid_init(usbd_device* dev, UsbInterface* intf);
 static void hid_deinit(usbd_device *dev);
 static void hid_on_wakeup(usbd_device *dev);
 static void hid_on_suspend(usbd_device *dev);
 
 static bool hid_send_report(uint8_t report_id);
+static bool hid_queue_report(const void* report, uint8_t size);
 static usbd_respond hid_ep_config (usbd_device *dev, uint8_t cfg);
 static usbd_respond hid_control (usbd_device *dev, usbd_ctlreq *req, usbd_rqc_callback *callback);
 static usbd_device* usb_dev;
-static osSemaphoreId_t hid_semaphore = NULL;
+static osSemaphoreId_t hid_queue_free = NULL;
+static struct HidQueueItem hid_queue[HID_QUEUE_RING];
+static volatile uint8_t hid_queue_head = 0;
+static volatile uint8_t hid_queue_tail = 0;
+static volatile bool hid_ep_busy = false;
 static bool hid_connected = false;
 static HidStateCallback callback;
 static void* cb_ctx;
@@ -239,6 +256,12 @@ bool furi_hal_hid_kb_release(uint16_t button) {
     return hid_send_report(ReportIdKeyboard);
 }
 
+bool furi_hal_hid_kb_set(uint8_t mods, const uint8_t* keys) {
+    hid_report.keyboard.mods = mods;
+    memcpy(hid_report.keyboard.btn, keys, HID_KB_MAX_KEYS);
+    return hid_send_report(ReportIdKeyboard);
+}
+
 bool furi_hal_hid_kb_release_all() {
     for (uint8_t key_nb = 0; key_nb < HID_KB_MAX_KEYS; key_nb++) {
         hid_report.keyboard.btn[key_nb] = 0;
@@ -288,9 +311,21 @@ UsbInterface usb_hid = {
     .cfg_descr = (void*)&hid_cfg_desc,
 };
 
+bool furi_hal_hid_flush() {
+    if (hid_queue_free == NULL)
+        return false;
+
+    /* All slots are free once last report is written to endpoint */
+    for (uint8_t slot = 0; slot < HID_QUEUE_LEN; slot++)
+        furi_check(osSemaphoreAcquire(hid_queue_free, osWaitForever) == osOK);
+    for (uint8_t slot = 0; slot < HID_QUEUE_LEN; slot++)
+        osSemaphoreRelease(hid_queue_free);
+    return hid_connected;
+}
+
 static void hid_init(usbd_device* dev, UsbInterface* intf) {
-    if (hid_semaphore == NULL)
-        hid_semaphore = osSemaphoreNew(1, 1, NULL);
+    if (hid_queue_free == NULL)
+        hid_queue_free = osSemaphoreNew(HID_QUEUE_LEN, HID_QUEUE_LEN, NULL);
     usb_dev = dev;
     hid_report.keyboard.report_id = ReportIdKeyboard;
     hid_report.mouse.report_id = ReportIdMouse;
@@ -314,10 +349,21 @@ static void hid_on_wakeup(usbd_device *dev) {
     }
 }
 
+/* Drop queued reports and wake writers waiting for free slots */
+static void hid_queue_reset() {
+    FURI_CRITICAL_ENTER();
+    uint8_t queued = (hid_queue_head + HID_QUEUE_RING - hid_queue_tail) % HID_QUEUE_RING;
+    hid_queue_tail = hid_queue_head;
+    hid_ep_busy = false;
+    FURI_CRITICAL_EXIT();
+    for (uint8_t slot = 0; slot < queued; slot++)
+        osSemaphoreRelease(hid_queue_free);
+}
+
 static void hid_on_suspend(usbd_device *dev) {
     if (hid_connected == true) {
         hid_connected = false;
-        osSemaphoreRelease(hid_semaphore);
+        hid_queue_reset();
         if (callback != NULL)
             callback(false, cb_ctx);
     }
@@ -325,22 +371,56 @@ static void hid_on_suspend(usbd_device *dev) {
 
 static bool hid_send_report(uint8_t report_id)
 {
-    if ((hid_semaphore == NULL) || (hid_connected == false))
+    if (report_id == ReportIdKeyboard)
+        return hid_queue_report(&hid_report.keyboard, sizeof(hid_report.keyboard));
+    else
+        return hid_queue_report(&hid_report.mouse, sizeof(hid_report.mouse));
+}
+
+/* Called with interrupts disabled or from endpoint interrupt, queue must not be empty */
+static void hid_queue_write_next() {
+    struct HidQueueItem* item = &hid_queue[hid_queue_tail];
+    usbd_ep_write(usb_dev, HID_RIN_EP, &item->report, item->size);
+    hid_queue_tail = (hid_queue_tail + 1) % HID_QUEUE_RING;
+}
+
+static bool hid_queue_report(const void* report, uint8_t size)
+{
+    if ((hid_queue_free == NULL) || (hid_connected == false))
         return false;
 
-    furi_check(osSemaphoreAcquire(hid_semaphore, osWaitForever) == osOK);
-    if (hid_connected == true) {
-        if (report_id == ReportIdKeyboard)
-            usbd_ep_write(usb_dev, HID_RIN_EP, &hid_report.keyboard, sizeof(hid_report.keyboard));
-        else
-            usbd_ep_write(usb_dev, HID_RIN_EP, &hid_report.mouse, sizeof(hid_report.mouse));
-        return true;
+    furi_check(osSemaphoreAcquire(hid_queue_free, osWaitForever) == osOK);
+    if (hid_connected == false) {
+        osSemaphoreRelease(hid_queue_free);
+        return false;
+    }
+
+    bool written = false;
+    FURI_CRITICAL_ENTER();
+    struct HidQueueItem* item = &hid_queue[hid_queue_head];
+    memcpy(&item->report, report, size);
+    item->size = size;
+    hid_queue_head = (hid_queue_head + 1) % HID_QUEUE_RING;
+    if (hid_ep_busy == false) {
+        /* Endpoint is idle, nothing would pick report up from interrupt */
+        hid_ep_busy = true;
+        hid_queue_write_next();
+        written = true;
     }
-    return false;
+    FURI_CRITICAL_EXIT();
+
+    if (written)
+        osSemaphoreRelease(hid_queue_free);
+    return true;
 }
 
 static void hid_ep_callback(usbd_device *dev, uint8_t event, uint8_t ep) {
-    osSemaphoreRelease(hid_semaphore);
+    if (hid_queue_tail != hid_queue_head) {
+        hid_queue_write_next();
+        osSemaphoreRelease(hid_queue_free);
+    } else {
+        hid_ep_busy = false;
+    }
 }
 
 /* Configure endpoints */
@@ -350,11 +430,13 @@ static usbd_respond hid_ep_config (usbd_device *dev, uint8_t cfg) {
         /* deconfiguring device */
         usbd_ep_deconfig(dev, HID_RIN_EP);
         usbd_reg_endpoint(dev, HID_RIN_EP, 0);
+        hid_queue_reset();
         return usbd_ack;
     case 1:
         /* configuring device */
         usbd_ep_config(dev, HID_RIN_EP, USB_EPTYPE_INTERRUPT, HID_RIN_SZ);
         usbd_reg_endpoint(dev, HID_RIN_EP, hid_ep_callback);
+        hid_ep_busy = true;
         usbd_ep_write(dev, HID_RIN_EP, 0, 0);
         return usbd_ack;
     default:
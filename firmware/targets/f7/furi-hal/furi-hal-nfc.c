@@ -136,15 +136,29 @@ bool furi_hal_nfc_get_first_frame(uint8_t** rx_buff, uint16_t** rx_len) {
 }
 
 ReturnCode furi_hal_nfc_data_exchange(uint8_t* tx_buff, uint16_t tx_len, uint8_t** rx_buff, uint16_t** rx_len, bool deactivate) {
+    ReturnCode ret = furi_hal_nfc_data_exchange_start(tx_buff, tx_len, rx_buff, rx_len);
+    if(ret != ERR_NONE) {
+        return ret;
+    }
+    return furi_hal_nfc_data_exchange_wait(deactivate);
+}
+
+ReturnCode furi_hal_nfc_data_exchange_start(uint8_t* tx_buff, uint16_t tx_len, uint8_t** rx_buff, uint16_t** rx_len) {
     furi_assert(rx_buff);
     furi_assert(rx_len);
 
-    ReturnCode ret;
-    rfalNfcState state = RFAL_NFC_STATE_ACTIVATED;
-    ret = rfalNfcDataExchangeStart(tx_buff, tx_len, rx_buff, rx_len, 0);
+    ReturnCode ret = rfalNfcDataExchangeStart(tx_buff, tx_len, rx_buff, rx_len, 0);
     if(ret != ERR_NONE) {
         return ret;
     }
+    // Hand frame over to transceiver, it is sent while caller is busy
+    rfalNfcWorker();
+    return ERR_NONE;
+}
+
+ReturnCode furi_hal_nfc_data_exchange_wait(bool deactivate) {
+    ReturnCode ret;
+    rfalNfcState state = RFAL_NFC_STATE_ACTIVATED;
     uint32_t start = DWT->CYCCNT;
     while(state != RFAL_NFC_STATE_DATAEXCHANGE_DONE) {
         rfalNfcWorker();
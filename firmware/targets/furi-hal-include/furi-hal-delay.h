@@ -36,6 +36,20 @@ void delay_us(float microseconds);
  */
 uint32_t millis(void);
 
+/** Get CPU cycle counter
+ *
+ * DWT cycle counter, runs at core clock and wraps around. ISR safe.
+ *
+ * @return     Current cycle count
+ */
+uint32_t furi_hal_delay_get_cycles(void);
+
+/** Get CPU cycle counter rate
+ *
+ * @return     Cycles per microsecond
+ */
+uint32_t furi_hal_delay_get_cycles_per_us(void);
+
 #ifdef __cplusplus
 }
 #endif
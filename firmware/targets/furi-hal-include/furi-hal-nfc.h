@@ -87,6 +87,25 @@ bool furi_hal_nfc_get_first_frame(uint8_t** rx_buff, uint16_t** rx_len);
  */
 ReturnCode furi_hal_nfc_data_exchange(uint8_t* tx_buff, uint16_t tx_len, uint8_t** rx_buff, uint16_t** rx_len, bool deactivate);
 
+/** Start NFC data exchange, response is collected with furi_hal_nfc_data_exchange_wait
+ *
+ * @param      tx_buff     transmit buffer, must be kept until wait returns
+ * @param      tx_len      transmit buffer length
+ * @param      rx_buff     receive buffer, valid after wait
+ * @param      rx_len      receive buffer length, valid after wait
+ *
+ * @return     ST ReturnCode
+ */
+ReturnCode furi_hal_nfc_data_exchange_start(uint8_t* tx_buff, uint16_t tx_len, uint8_t** rx_buff, uint16_t** rx_len);
+
+/** Wait for NFC data exchange started with furi_hal_nfc_data_exchange_start
+ *
+ * @param      deactivate  deactivate flag
+ *
+ * @return     ST ReturnCode
+ */
+ReturnCode furi_hal_nfc_data_exchange_wait(bool deactivate);
+
 /** NFC deactivate and start sleep
  */
 void furi_hal_nfc_deactivate();
@@ -250,6 +250,9 @@ static const uint16_t hid_asciimap[] = {
     KEY_NONE, // DEL
 };
 
+/** Max keys pressed at once, except modifiers */
+#define HID_KB_MAX_KEYS 6
+
 typedef void (*HidStateCallback)(bool state, void* context);
 
 /** ASCII to keycode conversion macro */
@@ -292,6 +295,26 @@ bool furi_hal_hid_kb_release(uint16_t button);
  */
 bool furi_hal_hid_kb_release_all();
 
+/** Replace all pressed keys and modifiers, send HID report
+ *
+ * Keys missing from previous report are pressed, keys missing from this one
+ * are released. Host handles releases first, then presses in array order.
+ *
+ * @param      mods  modifiers bitmask, upper byte of key code
+ * @param      keys  HID_KB_MAX_KEYS key codes, 0 for unused
+ */
+bool furi_hal_hid_kb_set(uint8_t mods, const uint8_t* keys);
+
+/** Wait until all queued HID reports are sent
+ *
+ * Reports are queued and sent once per poll interval, press and release
+ * functions return before report reaches host. Call it before timing
+ * anything against host.
+ *
+ * @return      true if still connected
+ */
+bool furi_hal_hid_flush();
+
 /** Set mouse movement and send HID report
  *
  * @param      dx  x coordinate delta
@@ -0,0 +1,222 @@
+/**
+ * BadUSB compiler benchmark: bundled scripts compile and parse throughput
+ *
+ * Every script from assets/resources/badusb must compile, so unknown keywords
+ * and broken combos in examples show up here. Then each script is compiled in
+ * a loop from memory, fed in small chunks like worker reads it from SD card,
+ * and compile speed is reported along with source and bytecode sizes.
+ *
+ * Text of STRING commands is then typed through BadUsbTyper into simulated
+ * HID sink, reports per character give typing speed at endpoint poll rate,
+ * against press and release report per character as it was before.
+ */
+
+#include <bad_usb/bad_usb_bytecode.h>
+#include <bad_usb/bad_usb_typer.h>
+
+#include <dirent.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_SCRIPTS_DIR "assets/resources/badusb"
+#define BENCH_CHUNK_SIZE 256
+#define BENCH_DURATION_MS 200
+/* Keyboard endpoint bInterval, one report per poll */
+#define BENCH_HID_POLL_MS 10
+
+typedef struct {
+    uint32_t code_size;
+    uint32_t code_hash;
+    uint8_t* code; /**< Kept only if not NULL on compile */
+} BenchOutput;
+
+typedef struct {
+    uint32_t chars;
+    uint32_t reports;
+} BenchTyping;
+
+void furi_crash(const char* message) {
+    fprintf(stderr, "%s", message);
+    abort();
+}
+
+void* furi_alloc(size_t size) {
+    void* pointer = calloc(1, size);
+    if(!pointer) furi_crash("furi_alloc failed\r\n");
+    return pointer;
+}
+
+static bool bench_output_callback(const uint8_t* data, size_t size, void* context) {
+    BenchOutput* output = context;
+    output->code_size += size;
+    output->code_hash = bad_usb_bytecode_hash(output->code_hash, data, size);
+    if(output->code) {
+        output->code = realloc(output->code, output->code_size);
+        memcpy(&output->code[output->code_size - size], data, size);
+    }
+    return true;
+}
+
+static bool bench_typer_callback(const BadUsbTyperReport* report, void* context) {
+    (void)report;
+    BenchTyping* typing = context;
+    typing->reports++;
+    return true;
+}
+
+/* Types every STRING op of code, REPEAT jumps are not followed */
+static void bench_type(const uint8_t* code, uint32_t size, BenchTyping* typing) {
+    memset(typing, 0, sizeof(BenchTyping));
+    BadUsbTyper* typer = bad_usb_typer_alloc(bench_typer_callback, typing);
+
+    uint32_t pos = 0;
+    while(pos < size) {
+        uint8_t op = code[pos++];
+        if(op == BadUsbOpLine || op == BadUsbOpKey) {
+            pos += sizeof(uint16_t);
+        } else if(op == BadUsbOpDelay) {
+            pos += sizeof(uint32_t);
+        } else if(op == BadUsbOpRepeat) {
+            pos += 2 * sizeof(uint32_t);
+        } else if(op == BadUsbOpString) {
+            uint16_t len;
+            memcpy(&len, &code[pos], sizeof(len));
+            pos += sizeof(len);
+            for(uint16_t i = 0; i < len; i++) {
+                if((HID_ASCII_TO_KEY(code[pos + i]) & 0xFF) != KEY_NONE) typing->chars++;
+            }
+            bad_usb_typer_type(typer, (const char*)&code[pos], len);
+            bad_usb_typer_release(typer);
+            pos += len;
+        }
+    }
+
+    bad_usb_typer_free(typer);
+}
+
+static uint64_t bench_time_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static uint8_t* bench_load(const char* path, size_t* size) {
+    FILE* file = fopen(path, "rb");
+    if(!file) return NULL;
+    fseek(file, 0, SEEK_END);
+    *size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    uint8_t* data = malloc(*size ? *size : 1);
+    if(fread(data, 1, *size, file) != *size) {
+        free(data);
+        data = NULL;
+    }
+    fclose(file);
+    return data;
+}
+
+static bool bench_compile(
+    const uint8_t* data,
+    size_t size,
+    BadUsbBytecodeHeader* header,
+    BenchOutput* output,
+    uint16_t* error_line) {
+    uint8_t* code = output->code;
+    memset(output, 0, sizeof(BenchOutput));
+    output->code = code;
+    BadUsbCompiler* compiler = bad_usb_compiler_alloc(bench_output_callback, output);
+
+    bool result = true;
+    for(size_t pos = 0; pos < size && result; pos += BENCH_CHUNK_SIZE) {
+        size_t chunk = size - pos < BENCH_CHUNK_SIZE ? size - pos : BENCH_CHUNK_SIZE;
+        result = bad_usb_compiler_feed(compiler, &data[pos], chunk);
+    }
+    if(result) result = bad_usb_compiler_finish(compiler, header);
+
+    *error_line = bad_usb_compiler_get_error_line(compiler);
+    bad_usb_compiler_free(compiler);
+    return result;
+}
+
+static bool bench_script(const char* path) {
+    size_t size;
+    uint8_t* data = bench_load(path, &size);
+    if(!data) {
+        printf("%-40s cannot read\r\n", path);
+        return false;
+    }
+
+    BadUsbBytecodeHeader header;
+    BenchOutput output = {.code = malloc(1)};
+    uint16_t error_line;
+    if(!bench_compile(data, size, &header, &output, &error_line)) {
+        printf("%-40s error at line %u\r\n", path, error_line);
+        free(output.code);
+        free(data);
+        return false;
+    }
+
+    uint32_t rounds = 0;
+    uint64_t start = bench_time_ns();
+    uint64_t elapsed;
+    do {
+        BadUsbBytecodeHeader round_header;
+        BenchOutput round_output = {0};
+        bench_compile(data, size, &round_header, &round_output, &error_line);
+        rounds++;
+        elapsed = bench_time_ns() - start;
+    } while(elapsed < BENCH_DURATION_MS * 1000000ULL);
+
+    double seconds = elapsed / 1e9;
+    printf(
+        "%-40s %5u lines %7zu B -> %7u B code %10.0f lines/s %8.1f MB/s\r\n",
+        path,
+        header.line_nb,
+        size,
+        output.code_size,
+        header.line_nb * (double)rounds / seconds,
+        size * (double)rounds / seconds / 1e6);
+
+    BenchTyping typing;
+    bench_type(output.code, output.code_size, &typing);
+    if(typing.chars) {
+        printf(
+            "%-40s %5u chars %5u reports (was %5u) %6.1f chars/s (was %5.1f)\r\n",
+            "",
+            typing.chars,
+            typing.reports,
+            typing.chars * 2,
+            typing.chars * 1000.0 / (typing.reports * BENCH_HID_POLL_MS),
+            1000.0 / (2 * BENCH_HID_POLL_MS));
+    }
+
+    free(output.code);
+    free(data);
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    const char* dir_path = argc > 1 ? argv[1] : BENCH_SCRIPTS_DIR;
+    DIR* dir = opendir(dir_path);
+    if(!dir) {
+        printf("Cannot open %s, run from repository root or pass scripts dir\r\n", dir_path);
+        return 1;
+    }
+
+    uint32_t failed = 0;
+    struct dirent* entry;
+    while((entry = readdir(dir))) {
+        size_t len = strlen(entry->d_name);
+        if(len < 4 || strcmp(&entry->d_name[len - 4], ".txt") != 0) continue;
+        char path[512];
+        snprintf(path, sizeof(path), "%s/%s", dir_path, entry->d_name);
+        if(!bench_script(path)) failed++;
+    }
+    closedir(dir);
+
+    return failed ? 1 : 0;
+}
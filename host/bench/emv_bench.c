@@ -0,0 +1,680 @@
+/**
+ * EMV decoder benchmark and fuzzer on recorded APDU responses
+ *
+ * Each recorded response is decoded in a loop by its terminal side decoder
+ * and by unchecked byte scanning decoder it replaced, kept here as baseline.
+ * READ RECORD decoder indexes BER-TLV objects once, SELECT and GPO ones scan
+ * with bounds checks. Decode time and indexed object count are reported per
+ * response.
+ *
+ * With -f responses are mutated: bytes flipped, lengths rewritten, tails cut
+ * and slices repeated, then every decoder is run on result. Index must stay
+ * inside response with templates nesting their objects, decoded fields must
+ * stay inside EmvApplication. Build with SANITIZE=address,undefined to catch
+ * reads past response.
+ *
+ * Responses file has one response per line: decoder name (ppse, app, gpo,
+ * record) and hex bytes with status word, # starts comment.
+ *
+ * Then simulated cards answer whole read: EmvReader with records planned from
+ * AFL against sequential reading with byte scanning decoders as worker did it.
+ * Exchange time is modeled from bytes on air at 106 kbit/s and typical card
+ * processing time per command.
+ */
+
+#include <nfc_protocols/emv_decoder.h>
+#include <nfc_protocols/emv_reader.h>
+#include <nfc_protocols/emv_tlv.h>
+#include <toolbox/hex.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_DURATION_MS 200
+#define BENCH_RESPONSES_MAX 64
+#define BENCH_LINE_MAX 1024
+/* Room for fuzzer to grow response, short APDU response limit */
+#define BENCH_RESPONSE_SIZE 258
+#define BENCH_CARD_RECORDS_MAX 8
+/* 8 data bits and parity at 106 kbit/s */
+#define BENCH_AIR_BYTE_US 85
+/* PCB and CRC of I-block, each direction */
+#define BENCH_FRAME_OVERHEAD_BYTES 3
+#define BENCH_FRAME_DELAY_US 90
+#define BENCH_CARD_SELECT_US 2000
+#define BENCH_CARD_GPO_US 15000
+#define BENCH_CARD_RECORD_US 3000
+
+typedef enum {
+    BenchDecoderPpse,
+    BenchDecoderApp,
+    BenchDecoderGpo,
+    BenchDecoderRecord,
+    BenchDecoderNum,
+} BenchDecoder;
+
+typedef bool (*BenchDecode)(uint8_t* buff, uint16_t len, EmvApplication* app);
+
+typedef struct {
+    char name[32];
+    BenchDecoder decoder;
+    uint16_t len;
+    uint8_t data[BENCH_RESPONSE_SIZE];
+} BenchResponse;
+
+typedef struct {
+    const char* name;
+    BenchDecoder decoder;
+    const char* hex;
+} BenchRecorded;
+
+static const char* bench_decoder_names[BenchDecoderNum] = {"ppse", "app", "gpo", "record"};
+
+/* Mastercard recorded responses, Visa ones come from card emulation */
+static const BenchRecorded bench_recorded[] = {
+    {"mc ppse",
+     BenchDecoderPpse,
+     "6F46840E325041592E5359532E4444463031A534BF0C3161154F07A00000000430605007"
+     "4D41455354524F87010261184F07A0000000041010500A4D415354455243415244870101"
+     "9000"},
+    {"mc select app",
+     BenchDecoderApp,
+     "6F338407A0000000041010A528500A4D4153544552434152448701015F2D04656E7275BF"
+     "0C0F9F4D020B0A9F6E07074300003030009000"},
+    {"mc gpo", BenchDecoderGpo, "771A82021980941408010100100102001801020020010200180303009000"},
+    {"mc record 1/1",
+     BenchDecoderRecord,
+     "7081B29F420209785F25032101015F24032601315A0854133300890200135F3401009F07"
+     "02FF008E0E000000000000000042031E031F039F0D05B4508400009F0E0500000000009F"
+     "0F05B4708480005F280206439F4A01828C219F02069F03069F1A0295055F2A029A039C01"
+     "9F37049F35019F45029F4C089F34038D0C910A8A0295059F37049F4C085F200F43415244"
+     "484F4C4445522F5445535457135413330089020013D26012010000000000000F9F080200"
+     "029000"},
+    {"mc record 3/3",
+     BenchDecoderRecord,
+     "70819C908180A54DCA182530BB1D6D132CDED6237B2ED91E3F721FCB1971174494D6493C"
+     "9D5C3460BE31201E69FEDAA0EEE8B9997F5C7C2999FDAFE593253CD654AF4DFAD71427A0"
+     "AEB3FEE9232F8AF2211F9EE491C5B10BECB5563BFC1E6F93427ECBC8FE2955E5CD8E46DC"
+     "8ED4B7C2764D2A5A4D767706F85D8690024AD6BDA3401BE9C8CB9F3201039210CCC935F6"
+     "CD1F61226AE15338AE1A34008F01059000"},
+};
+
+typedef struct {
+    uint8_t sfi;
+    uint8_t record;
+    const char* hex;
+} BenchCardRecord;
+
+/* NULL PPSE, application or GPO response is taken from card emulation */
+typedef struct {
+    const char* name;
+    const char* ppse;
+    const char* app;
+    const char* gpo;
+    BenchCardRecord records[BENCH_CARD_RECORDS_MAX];
+} BenchCard;
+
+typedef struct {
+    uint32_t exchanges;
+    uint32_t time_us;
+    bool pan;
+    bool exp;
+} BenchReadResult;
+
+static const BenchCard bench_cards[] = {
+    {"visa qvsdc", NULL, NULL, NULL, {{0}}},
+    {"mastercard mchip",
+     "6F46840E325041592E5359532E4444463031A534BF0C3161154F07A00000000430605007"
+     "4D41455354524F87010261184F07A0000000041010500A4D415354455243415244870101"
+     "9000",
+     "6F338407A0000000041010A528500A4D4153544552434152448701015F2D04656E7275BF"
+     "0C0F9F4D020B0A9F6E07074300003030009000",
+     "771A82021980941408010100100102001801020020010200180303009000",
+     {{1,
+       1,
+       "706D9F6C0200019F6206000000000E009F630600000000F1FE5629423534313333333030"
+       "38393032303031335E544553542F43415244484F4C4445525E323630313230319F640103"
+       "57135413330089020013D26012010000000000000F5F200F43415244484F4C4445522F54"
+       "4553549000"},
+      {2,
+       1,
+       "7081B29F420209785F25032101015F24032601315A0854133300890200135F3401009F07"
+       "02FF008E0E000000000000000042031E031F039F0D05B4508400009F0E0500000000009F"
+       "0F05B4708480005F280206439F4A01828C219F02069F03069F1A0295055F2A029A039C01"
+       "9F37049F35019F45029F4C089F34038D0C910A8A0295059F37049F4C085F200F43415244"
+       "484F4C4445522F5445535457135413330089020013D26012010000000000000F9F080200"
+       "029000"},
+      {2,
+       2,
+       "70819C908180A54DCA182530BB1D6D132CDED6237B2ED91E3F721FCB1971174494D6493C"
+       "9D5C3460BE31201E69FEDAA0EEE8B9997F5C7C2999FDAFE593253CD654AF4DFAD71427A0"
+       "AEB3FEE9232F8AF2211F9EE491C5B10BECB5563BFC1E6F93427ECBC8FE2955E5CD8E46DC"
+       "8ED4B7C2764D2A5A4D767706F85D8690024AD6BDA3401BE9C8CB9F3201039210CCC935F6"
+       "CD1F61226AE15338AE1A34008F01059000"},
+      {3,
+       1,
+       "70779F4701039F4670E7EEE7615EF35F30E49B482E15CAE75007201E12617B0FEDA7E164"
+       "7796FF022BEA8ED02A82A175930F2337CD3794C52208006D6B1AF0C0CBD625658AAC2C9F"
+       "AA07D13C447E33051EEEF95A60E56143D6C43BCAD76C008A9B0A6B5FC933154A6DE28404"
+       "A897C525262E6A7C07BCBEE8419000"},
+      {3, 2, "700A9F49039F37049F4A01829000"},
+      {4,
+       1,
+       "70739F4670F745C55D4E9F747F615164C6F728D718353713827AC883D7FB9659234074F5"
+       "258F6C68082389D2E47F1E175A90BC432FB946E6A9471109F3B79F110A26F6229FA34525"
+       "26E7BC1642AEB42BF227D50FFF07C3C20624292E3B83D5A9C6EAE1EC2A0F9E2CF60B7539"
+       "FEF88205BC9A4967569000"},
+      {0}}},
+    {"maestro gpo format 1",
+     "6F2C840E325041592E5359532E4444463031A51ABF0C1761154F07A00000000430605007"
+     "4D41455354524F8701019000",
+     "6F178407A0000000043060A50C50074D41455354524F8701019000",
+     "800A198008010200100101009000",
+     {{1, 1, "70155A0A6799998900000060019F5F280208265F3401019000"},
+      {1, 2, "70165F24032712315F25032312019F0702FF009F420208269000"},
+      {2,
+       1,
+       "70658F01059060AFE2FF7BA7CF8065DC666DC470A26B4544FEB314208D5639E6F18C6DD3"
+       "C3FCA1E7A426108E158FB59E0945CFE8610C887948183BE437BC276566F3835B05F1125B"
+       "738BB151C9722CD2C642E6E86403C0AFEDA768323F6D7CC72C9EA48608B22A9000"},
+      {0}}},
+};
+
+static BenchResponse bench_responses[BENCH_RESPONSES_MAX];
+static uint32_t bench_responses_count;
+
+/* Byte scanning decoders as they were before bounds checks and BER-TLV index */
+
+static uint16_t legacy_parse_TLV(uint8_t* dest, uint8_t* src, uint16_t* idx) {
+    uint8_t len = src[*idx + 1];
+    memcpy(dest, &src[*idx + 2], len);
+    *idx = *idx + len + 1;
+    return len;
+}
+
+static bool legacy_search_tag_u16_r(uint16_t tag, uint8_t* buff, uint16_t* idx) {
+    if((buff[*idx] << 8 | buff[*idx + 1]) == tag) {
+        *idx = *idx + 3;
+        return true;
+    }
+    return false;
+}
+
+static bool legacy_decode_ppse_response(uint8_t* buff, uint16_t len, EmvApplication* app) {
+    uint16_t i = 0;
+    bool app_aid_found = false;
+
+    while(i < len) {
+        if(buff[i] == EMV_TAG_APP_TEMPLATE) {
+            uint8_t app_len = buff[++i];
+            for(uint16_t j = i; j < i + app_len; j++) {
+                if(buff[j] == EMV_TAG_AID) {
+                    app_aid_found = true;
+                    app->aid_len = buff[j + 1];
+                    legacy_parse_TLV(app->aid, buff, &j);
+                } else if(buff[j] == EMV_TAG_PRIORITY) {
+                    legacy_parse_TLV(&app->priority, buff, &j);
+                }
+            }
+            i += app_len;
+        }
+        i++;
+    }
+    return app_aid_found;
+}
+
+static bool legacy_decode_select_app_response(uint8_t* buff, uint16_t len, EmvApplication* app) {
+    uint16_t i = 0;
+    bool found_name = false;
+
+    while(i < len) {
+        if(buff[i] == EMV_TAG_CARD_NAME) {
+            uint8_t name_len = buff[i + 1];
+            legacy_parse_TLV((uint8_t*)app->name, buff, &i);
+            app->name[name_len] = '\0';
+            found_name = true;
+        } else if(((buff[i] << 8) | buff[i + 1]) == EMV_TAG_PDOL) {
+            i++;
+            app->pdol.size = legacy_parse_TLV(app->pdol.data, buff, &i);
+        }
+        i++;
+    }
+    return found_name;
+}
+
+static bool legacy_decode_get_proc_opt(uint8_t* buff, uint16_t len, EmvApplication* app) {
+    for(uint16_t i = 0; i < len; i++) {
+        if(buff[i] == EMV_TAG_CARD_NUM) {
+            app->card_number_len = 8;
+            memcpy(app->card_number, &buff[i + 2], app->card_number_len);
+            return true;
+        } else if(buff[i] == EMV_TAG_AFL) {
+            app->afl.size = legacy_parse_TLV(app->afl.data, buff, &i);
+        }
+    }
+    return false;
+}
+
+static bool legacy_decode_read_sfi_record(uint8_t* buff, uint16_t len, EmvApplication* app) {
+    bool pan_parsed = false;
+    for(uint16_t i = 0; i < len; i++) {
+        if(buff[i] == EMV_TAG_PAN) {
+            if(buff[i + 1] == 8 || buff[i + 1] == 10) {
+                app->card_number_len = buff[i + 1];
+                memcpy(app->card_number, &buff[i + 2], app->card_number_len);
+                pan_parsed = true;
+            }
+        } else if(legacy_search_tag_u16_r(EMV_TAG_EXP_DATE, buff, &i)) {
+            app->exp_year = buff[i++];
+            app->exp_month = buff[i++];
+        } else if(legacy_search_tag_u16_r(EMV_TAG_CURRENCY_CODE, buff, &i)) {
+            app->currency_code = (buff[i] << 8) | buff[i + 1];
+            i += 2;
+        } else if(legacy_search_tag_u16_r(EMV_TAG_COUNTRY_CODE, buff, &i)) {
+            app->country_code = (buff[i] << 8) | buff[i + 1];
+            i += 2;
+        }
+    }
+    return pan_parsed;
+}
+
+static const BenchDecode bench_decoders[BenchDecoderNum] = {
+    emv_decode_ppse_response,
+    emv_decode_select_app_response,
+    emv_decode_get_proc_opt,
+    emv_decode_read_sfi_record,
+};
+
+static const BenchDecode bench_legacy_decoders[BenchDecoderNum] = {
+    legacy_decode_ppse_response,
+    legacy_decode_select_app_response,
+    legacy_decode_get_proc_opt,
+    legacy_decode_read_sfi_record,
+};
+
+void furi_crash(const char* message) {
+    fprintf(stderr, "%s", message);
+    abort();
+}
+
+static uint64_t bench_time_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static bool bench_parse_hex(const char* hex, uint8_t* data, uint16_t* len) {
+    *len = 0;
+    for(; hex[0] && hex[1] && *len < BENCH_RESPONSE_SIZE; hex += 2) {
+        if(!hex_chars_to_uint8(hex[0], hex[1], &data[(*len)++])) return false;
+    }
+    return true;
+}
+
+static bool bench_add(const char* name, BenchDecoder decoder, const char* hex) {
+    if(bench_responses_count == BENCH_RESPONSES_MAX) return false;
+    BenchResponse* response = &bench_responses[bench_responses_count];
+    memset(response, 0, sizeof(BenchResponse));
+    snprintf(response->name, sizeof(response->name), "%s", name);
+    response->decoder = decoder;
+    if(!bench_parse_hex(hex, response->data, &response->len)) return false;
+    bench_responses_count++;
+    return true;
+}
+
+static void bench_add_raw(const char* name, BenchDecoder decoder, uint16_t (*answer)(uint8_t*)) {
+    BenchResponse* response = &bench_responses[bench_responses_count++];
+    memset(response, 0, sizeof(BenchResponse));
+    snprintf(response->name, sizeof(response->name), "%s", name);
+    response->decoder = decoder;
+    response->len = answer(response->data);
+}
+
+static bool bench_load(const char* path) {
+    FILE* file = fopen(path, "r");
+    if(!file) return false;
+
+    char line[BENCH_LINE_MAX];
+    uint32_t line_num = 0;
+    bool result = true;
+    while(result && fgets(line, sizeof(line), file)) {
+        line_num++;
+        char* comment = strchr(line, '#');
+        if(comment) *comment = '\0';
+        char decoder_name[16];
+        char hex[BENCH_LINE_MAX];
+        if(sscanf(line, "%15s %1023s", decoder_name, hex) != 2) continue;
+
+        BenchDecoder decoder = 0;
+        while(decoder < BenchDecoderNum && strcmp(decoder_name, bench_decoder_names[decoder])) {
+            decoder++;
+        }
+        char name[32];
+        snprintf(name, sizeof(name), "%s:%u", path, line_num);
+        result = decoder < BenchDecoderNum && bench_add(name, decoder, hex);
+        if(!result) printf("%s: bad response\r\n", name);
+    }
+    fclose(file);
+    return result;
+}
+
+static double bench_decode_ns(BenchDecode decode, const BenchResponse* response) {
+    uint8_t buff[BENCH_RESPONSE_SIZE];
+    EmvApplication app;
+    uint32_t rounds = 0;
+    uint64_t start = bench_time_ns();
+    uint64_t elapsed;
+    do {
+        for(uint32_t i = 0; i < 1000; i++) {
+            // Legacy decoders write into response, fresh copy every round
+            memcpy(buff, response->data, response->len);
+            memset(&app, 0, sizeof(app));
+            decode(buff, response->len, &app);
+        }
+        rounds += 1000;
+        elapsed = bench_time_ns() - start;
+    } while(elapsed < BENCH_DURATION_MS * 1000000ULL);
+    return (double)elapsed / rounds;
+}
+
+static void bench_run() {
+    printf(
+        "%-24s %-6s %5s %5s %6s %12s %12s\r\n",
+        "response",
+        "dec",
+        "bytes",
+        "objs",
+        "found",
+        "decode ns",
+        "legacy ns");
+    for(uint32_t i = 0; i < bench_responses_count; i++) {
+        BenchResponse* response = &bench_responses[i];
+        EmvTlvIndex index;
+        bool well_formed = emv_tlv_index(&index, response->data, response->len);
+        uint8_t buff[BENCH_RESPONSE_SIZE];
+        memcpy(buff, response->data, response->len);
+        EmvApplication app = {};
+        bool found = bench_decoders[response->decoder](buff, response->len, &app);
+
+        printf(
+            "%-24s %-6s %5u %4u%c %6s %12.1f %12.1f\r\n",
+            response->name,
+            bench_decoder_names[response->decoder],
+            response->len,
+            index.count,
+            well_formed ? ' ' : '!',
+            found ? "yes" : "no",
+            bench_decode_ns(bench_decoders[response->decoder], response),
+            bench_decode_ns(bench_legacy_decoders[response->decoder], response));
+    }
+}
+
+static bool bench_check_index(const EmvTlvIndex* index, uint16_t len) {
+    for(uint8_t i = 0; i < index->count; i++) {
+        const EmvTlvNode* node = &index->nodes[i];
+        if(node->offset + node->len > len) return false;
+        if(node->parent != EMV_TLV_NONE) {
+            if(node->parent >= i) return false;
+            const EmvTlvNode* parent = &index->nodes[node->parent];
+            if(node->offset < parent->offset) return false;
+            if(node->offset + node->len > parent->offset + parent->len) return false;
+        }
+        if(node->next != EMV_TLV_NONE) {
+            if(node->next <= i || node->next >= index->count) return false;
+            if(index->nodes[node->next].tag != node->tag) return false;
+        }
+        // Every object is reachable from its tag chain
+        const EmvTlvNode* found = emv_tlv_find(index, node->tag);
+        while(found && found != node) {
+            found = emv_tlv_next(index, found);
+        }
+        if(!found) return false;
+    }
+    return true;
+}
+
+static bool bench_check_app(const EmvApplication* app) {
+    return app->aid_len <= sizeof(app->aid) &&
+           app->card_number_len <= sizeof(app->card_number) &&
+           memchr(app->name, '\0', sizeof(app->name)) != NULL;
+}
+
+static uint16_t bench_mutate(uint8_t* buff, uint16_t len) {
+    uint32_t mutations = 1 + rand() % 4;
+    while(mutations--) {
+        uint16_t pos = len ? rand() % len : 0;
+        switch(rand() % 5) {
+        case 0:
+            if(len) buff[pos] ^= 1 << (rand() % 8);
+            break;
+        case 1:
+            // Lengths are most likely to go past buffer end
+            if(len) buff[pos] = (rand() % 2) ? 0x81 + rand() % 3 : rand();
+            break;
+        case 2:
+            len = pos;
+            break;
+        case 3: {
+            uint16_t slice = rand() % 16;
+            if(pos + slice > len) slice = len - pos;
+            if(len + slice > BENCH_RESPONSE_SIZE) slice = BENCH_RESPONSE_SIZE - len;
+            memmove(&buff[pos + slice], &buff[pos], len - pos);
+            len += slice;
+        } break;
+        default:
+            if(len) buff[pos] = 0x00;
+            break;
+        }
+    }
+    return len;
+}
+
+static bool bench_fuzz(uint32_t iterations, uint32_t seed) {
+    srand(seed);
+    for(uint32_t i = 0; i < iterations; i++) {
+        const BenchResponse* response = &bench_responses[rand() % bench_responses_count];
+        uint8_t mutated[BENCH_RESPONSE_SIZE];
+        memcpy(mutated, response->data, response->len);
+        uint16_t len = bench_mutate(mutated, response->len);
+
+        // Exact size copy, sanitizer catches any read past response
+        uint8_t* buff = malloc(len ? len : 1);
+        memcpy(buff, mutated, len);
+        EmvTlvIndex index;
+        emv_tlv_index(&index, buff, len);
+        bool result = bench_check_index(&index, len);
+        for(BenchDecoder decoder = 0; result && decoder < BenchDecoderNum; decoder++) {
+            EmvApplication app = {};
+            bench_decoders[decoder](buff, len, &app);
+            result = bench_check_app(&app);
+        }
+        free(buff);
+
+        if(!result) {
+            printf("Iteration %u, %s mutated to %u bytes failed:\r\n", i, response->name, len);
+            for(uint16_t j = 0; j < len; j++) {
+                printf("%02X", mutated[j]);
+            }
+            printf("\r\n");
+            return false;
+        }
+    }
+    printf("%u mutated responses decoded, seed %u\r\n", iterations, seed);
+    return true;
+}
+
+/* Card side of one exchange, time on air and in card is added to result */
+static uint16_t bench_card_exchange(
+    const BenchCard* card,
+    const uint8_t* cmd,
+    uint16_t cmd_len,
+    uint8_t* resp,
+    BenchReadResult* result) {
+    static const uint8_t ppse_name[] = "2PAY.SYS.DDF01";
+    const uint8_t ins = cmd[1];
+    uint16_t len = 0;
+    uint32_t card_us = BENCH_CARD_SELECT_US;
+    // Byte scanning decoders read past response, previous one must not show up there
+    memset(resp, 0, BENCH_RESPONSE_SIZE);
+
+    if(ins == 0xA4 && cmd[4] == sizeof(ppse_name) - 1 &&
+       !memcmp(&cmd[5], ppse_name, sizeof(ppse_name) - 1)) {
+        if(card->ppse) {
+            bench_parse_hex(card->ppse, resp, &len);
+        } else {
+            len = emv_select_ppse_ans(resp);
+        }
+    } else if(ins == 0xA4) {
+        if(card->app) {
+            bench_parse_hex(card->app, resp, &len);
+        } else {
+            len = emv_select_app_ans(resp);
+        }
+    } else if(ins == 0xA8) {
+        card_us = BENCH_CARD_GPO_US;
+        if(card->gpo) {
+            bench_parse_hex(card->gpo, resp, &len);
+        } else {
+            len = emv_get_proc_opt_ans(resp);
+        }
+    } else if(ins == 0xB2) {
+        card_us = BENCH_CARD_RECORD_US;
+        for(const BenchCardRecord* record = card->records; record->hex; record++) {
+            if(record->record == cmd[2] && record->sfi == cmd[3] >> 3) {
+                bench_parse_hex(record->hex, resp, &len);
+            }
+        }
+    }
+    if(!len) {
+        // Record not found
+        resp[len++] = 0x6A;
+        resp[len++] = 0x83;
+    }
+
+    result->exchanges++;
+    result->time_us += (cmd_len + len + 2 * BENCH_FRAME_OVERHEAD_BYTES) * BENCH_AIR_BYTE_US;
+    result->time_us += 2 * BENCH_FRAME_DELAY_US + card_us;
+    return len;
+}
+
+static void bench_read_result(BenchReadResult* result, const EmvApplication* app, bool read) {
+    result->pan = read && app->card_number_len;
+    result->exp = read && app->exp_month;
+}
+
+/* Worker loop of EmvReader, exchange is synchronous in simulation */
+static void bench_read_planned(const BenchCard* card, BenchReadResult* result) {
+    uint8_t tx_buff[2][MAX_APDU_LEN];
+    uint8_t tx_idx = 0;
+    uint8_t rx_buff[BENCH_RESPONSE_SIZE];
+    EmvReader reader;
+    memset(result, 0, sizeof(BenchReadResult));
+    emv_reader_init(&reader);
+
+    uint16_t tx_len = emv_reader_prepare(&reader, tx_buff[tx_idx]);
+    while(tx_len) {
+        uint16_t rx_len = bench_card_exchange(card, tx_buff[tx_idx], tx_len, rx_buff, result);
+        tx_idx ^= 1;
+        tx_len = emv_reader_prepare(&reader, tx_buff[tx_idx]);
+        if(!emv_reader_process(&reader, rx_buff, rx_len)) break;
+        if(!tx_len) tx_len = emv_reader_prepare(&reader, tx_buff[tx_idx]);
+    }
+    bench_read_result(result, &reader.app, reader.state == EmvReaderStateDone);
+}
+
+/* Worker read sequence before EmvReader */
+static void bench_read_sequential(const BenchCard* card, BenchReadResult* result) {
+    uint8_t tx_buff[MAX_APDU_LEN];
+    uint8_t rx_buff[BENCH_RESPONSE_SIZE];
+    uint16_t tx_len;
+    uint16_t rx_len;
+    EmvApplication app = {};
+    memset(result, 0, sizeof(BenchReadResult));
+
+    tx_len = emv_prepare_select_ppse(tx_buff);
+    rx_len = bench_card_exchange(card, tx_buff, tx_len, rx_buff, result);
+    if(!legacy_decode_ppse_response(rx_buff, rx_len, &app)) return;
+    tx_len = emv_prepare_select_app(tx_buff, &app);
+    rx_len = bench_card_exchange(card, tx_buff, tx_len, rx_buff, result);
+    if(!legacy_decode_select_app_response(rx_buff, rx_len, &app) && !app.pdol.size) return;
+    tx_len = emv_prepare_get_proc_opt(tx_buff, &app);
+    rx_len = bench_card_exchange(card, tx_buff, tx_len, rx_buff, result);
+    if(legacy_decode_get_proc_opt(rx_buff, rx_len, &app)) {
+        bench_read_result(result, &app, true);
+        return;
+    }
+
+    bool pan_found = false;
+    for(uint8_t i = 0; (i < app.afl.size) && !pan_found; i += 4) {
+        uint8_t sfi = app.afl.data[i] >> 3;
+        uint8_t record_start = app.afl.data[i + 1];
+        uint8_t record_end = app.afl.data[i + 2];
+        for(uint8_t record = record_start; record <= record_end; ++record) {
+            tx_len = emv_prepare_read_sfi_record(tx_buff, sfi, record);
+            rx_len = bench_card_exchange(card, tx_buff, tx_len, rx_buff, result);
+            if(legacy_decode_read_sfi_record(rx_buff, rx_len, &app)) {
+                pan_found = true;
+                break;
+            }
+        }
+    }
+    bench_read_result(result, &app, pan_found);
+}
+
+static void bench_cards_run() {
+    printf(
+        "\r\n%-24s %-10s %5s %8s %4s %4s\r\n", "card", "reader", "exch", "ms", "pan", "exp");
+    for(size_t i = 0; i < sizeof(bench_cards) / sizeof(BenchCard); i++) {
+        BenchReadResult results[2];
+        bench_read_sequential(&bench_cards[i], &results[0]);
+        bench_read_planned(&bench_cards[i], &results[1]);
+        for(uint8_t j = 0; j < 2; j++) {
+            printf(
+                "%-24s %-10s %5u %8.1f %4s %4s\r\n",
+                j ? "" : bench_cards[i].name,
+                j ? "planned" : "sequential",
+                results[j].exchanges,
+                results[j].time_us / 1000.0,
+                results[j].pan ? "yes" : "no",
+                results[j].exp ? "yes" : "no");
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    uint32_t fuzz_iterations = 0;
+    uint32_t seed = 1;
+    const char* path = NULL;
+    for(int i = 1; i < argc; i++) {
+        if(!strcmp(argv[i], "-f") && i + 1 < argc) {
+            fuzz_iterations = strtoul(argv[++i], NULL, 0);
+        } else if(!strcmp(argv[i], "-s") && i + 1 < argc) {
+            seed = strtoul(argv[++i], NULL, 0);
+        } else {
+            path = argv[i];
+        }
+    }
+
+    bench_add_raw("visa ppse", BenchDecoderPpse, emv_select_ppse_ans);
+    bench_add_raw("visa select app", BenchDecoderApp, emv_select_app_ans);
+    bench_add_raw("visa gpo", BenchDecoderGpo, emv_get_proc_opt_ans);
+    for(size_t i = 0; i < sizeof(bench_recorded) / sizeof(BenchRecorded); i++) {
+        const BenchRecorded* recorded = &bench_recorded[i];
+        bench_add(recorded->name, recorded->decoder, recorded->hex);
+    }
+    if(path && !bench_load(path)) {
+        printf("Cannot load responses from %s\r\n", path);
+        return 1;
+    }
+
+    if(fuzz_iterations) {
+        return bench_fuzz(fuzz_iterations, seed) ? 0 : 1;
+    }
+    bench_run();
+    bench_cards_run();
+    return 0;
+}
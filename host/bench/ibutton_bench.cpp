@@ -0,0 +1,369 @@
+/**
+ * iButton reader bench: time to detect per key type
+ *
+ * Cyfral and Metakom keys are played like KeyEmulator plays them: period
+ * tables are built the same way and run through a model of PulseSequencer
+ * timer, comparator sees pin toggles at timer update events. Dallas key is
+ * modeled by 1-Wire timings only: reset with presence wait, search and ROM
+ * read for verification.
+ *
+ * Alternating reader gives capture and 1-Wire about 300ms each (switch after
+ * more than 200ms at 100ms read ticks), decoders run in comparator ISR.
+ * Time-sliced reader decodes edges buffered since previous tick, then pauses
+ * capture for 1-Wire probe. Key is attached at random time, time to detect is
+ * counted to the end of read tick that reports it.
+ */
+
+#include <ibutton/helpers/cyfral-decoder.h>
+#include <ibutton/helpers/metakom-decoder.h>
+
+#include <algorithm>
+#include <getopt.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#define BENCH_CLOCKS_IN_US 64
+#define BENCH_TICK_MS 100
+#define BENCH_SWITCH_MS 200
+#define BENCH_ARRIVAL_MS 1000
+#define BENCH_TIMEOUT_MS 3000
+#define BENCH_RING_SIZE 1024
+
+/* 1-Wire: reset with presence wait and one time slot, see one_wire_timings.h */
+#define BENCH_OW_RESET_US (480 + 70 + 410)
+#define BENCH_OW_SLOT_US 70
+/* Search: command and 64 x (bit, complement, direction), verify: command and 64 bits */
+#define BENCH_OW_READ_US \
+    (BENCH_OW_RESET_US + (8 + 64 * 3) * BENCH_OW_SLOT_US + BENCH_OW_RESET_US + \
+     (8 + 64) * BENCH_OW_SLOT_US)
+
+/* KeyEmulator pulse table length and full period in timer clicks */
+#define BENCH_PULSE_DATA_SIZE 72
+#define BENCH_PERIOD_FULL 8000
+
+uint32_t SystemCoreClock = 64000000;
+
+typedef enum {
+    BenchKeyDallas,
+    BenchKeyCyfral,
+    BenchKeyMetakom,
+    BenchKeyCount,
+} BenchKey;
+
+static const char* bench_key_names[BenchKeyCount] = {"Dallas", "Cyfral", "Metakom"};
+
+typedef struct {
+    bool level;
+    uint64_t time;
+} BenchEdge;
+
+extern "C" void furi_crash(const char* message) {
+    fprintf(stderr, "%s", message);
+    abort();
+}
+
+static uint32_t bench_random(uint32_t max) {
+    return max ? (uint32_t)(rand() % (max + 1)) : 0;
+}
+
+/* Same tables KeyEmulator builds */
+static uint16_t bench_cyfral_periods(const uint8_t* key_data, uint32_t* periods) {
+    const uint32_t one[2] = {
+        uint32_t(BENCH_PERIOD_FULL * 0.33f), uint32_t(BENCH_PERIOD_FULL * 0.66f)};
+    const uint32_t zero[2] = {
+        uint32_t(BENCH_PERIOD_FULL * 0.66f), uint32_t(BENCH_PERIOD_FULL * 0.33f)};
+    // nibbles for 0b00, 0b01, 0b10, 0b11, start nibble
+    const uint8_t nibbles[5] = {0b0111, 0b1011, 0b1101, 0b1110, 0b0001};
+    uint16_t index = 0;
+
+    auto add_nibble = [&](uint8_t nibble) {
+        for(int8_t i = 3; i >= 0; i--) {
+            const uint32_t* period = ((nibble >> i) & 1) ? one : zero;
+            periods[index++] = period[0];
+            periods[index++] = period[1];
+        }
+    };
+
+    add_nibble(nibbles[4]);
+    for(int8_t i = 1; i >= 0; i--) {
+        for(int8_t j = 3; j >= 0; j--) add_nibble(nibbles[(key_data[i] >> (j * 2)) & 0b11]);
+    }
+
+    return index;
+}
+
+static uint16_t bench_metakom_periods(const uint8_t* key_data, uint32_t* periods) {
+    const uint32_t zero[2] = {
+        uint32_t(BENCH_PERIOD_FULL * 0.33f), uint32_t(BENCH_PERIOD_FULL * 0.66f)};
+    const uint32_t one[2] = {
+        uint32_t(BENCH_PERIOD_FULL * 0.66f), uint32_t(BENCH_PERIOD_FULL * 0.33f)};
+    uint16_t index = 0;
+
+    auto add_bit = [&](bool bit) {
+        const uint32_t* period = bit ? one : zero;
+        periods[index++] = period[0];
+        periods[index++] = period[1];
+    };
+
+    // start pulse and start triplet
+    periods[index++] = BENCH_PERIOD_FULL;
+    add_bit(false);
+    add_bit(true);
+    add_bit(false);
+
+    for(int8_t i = 3; i >= 0; i--) {
+        for(int8_t j = 7; j >= 0; j--) add_bit((key_data[i] >> j) & 1);
+    }
+
+    return index;
+}
+
+/* Pin toggles of PulseSequencer: timer update every ARR + 1 clocks, ARR is set in update */
+static void bench_sequencer_edges(
+    const uint32_t* periods,
+    uint16_t count,
+    uint64_t start,
+    uint64_t end,
+    std::vector<BenchEdge>& edges) {
+    const bool pin_start_state = false;
+    uint16_t index = 1;
+    uint32_t arr = periods[index];
+    bool level = pin_start_state;
+    bool pin_state = !pin_start_state;
+    uint64_t time = start;
+
+    while(true) {
+        time += arr + 1;
+        if(time >= end) break;
+
+        arr = periods[index];
+        if(index == 0) {
+            pin_state = pin_start_state;
+        } else {
+            pin_state = !pin_state;
+        }
+        if(pin_state != level) {
+            edges.push_back({pin_state, time});
+            level = pin_state;
+        }
+
+        index++;
+        if(index == count) index = 0;
+    }
+}
+
+class BenchDecoders {
+public:
+    CyfralDecoder cyfral;
+    MetakomDecoder metakom;
+
+    /* Edges of capture window as ISR sees them, past limit they are dropped */
+    void feed(
+        const std::vector<BenchEdge>& edges,
+        size_t* cursor,
+        uint64_t from,
+        uint64_t to,
+        uint32_t limit) {
+        uint64_t last = from;
+        uint32_t fed = 0;
+        while(*cursor < edges.size() && edges[*cursor].time < to) {
+            const BenchEdge& edge = edges[(*cursor)++];
+            if(edge.time < from || fed == limit) continue;
+            // comparator sees the line through RFID analog part, level is inverted
+            cyfral.process_front(!edge.level, edge.time - last);
+            metakom.process_front(!edge.level, edge.time - last);
+            last = edge.time;
+            fed++;
+        }
+    }
+
+    /* Decoder ready, in KeyReader order, wrong is set if key data doesn't match */
+    bool read(BenchKey key, const uint8_t* key_data, bool* wrong) {
+        uint8_t data[8] = {0};
+        bool result = false;
+        if(cyfral.read(data, 2)) {
+            result = true;
+            *wrong = key != BenchKeyCyfral || memcmp(data, key_data, 2) != 0;
+        } else if(metakom.read(data, 4)) {
+            result = true;
+            *wrong = key != BenchKeyMetakom || memcmp(data, key_data, 4) != 0;
+        }
+        return result;
+    }
+
+    void reset() {
+        cyfral.reset_state();
+        metakom.reset_state();
+    }
+};
+
+static uint64_t bench_ms_to_clocks(uint64_t ms) {
+    return ms * 1000 * BENCH_CLOCKS_IN_US;
+}
+
+/* Reader runs from 0, returns ms from arrival to first reported key or 0 on timeout */
+static uint32_t bench_reader_run(
+    BenchKey key,
+    const uint8_t* key_data,
+    const std::vector<BenchEdge>& edges,
+    uint32_t arrival_ms,
+    bool sliced,
+    bool* wrong) {
+    BenchDecoders* decoders = new BenchDecoders();
+    size_t cursor = 0;
+    uint64_t window_start = 0;
+    bool capture = true;
+    int64_t switch_ms = -BENCH_TIMEOUT_MS;
+    uint32_t result = 0;
+    *wrong = false;
+
+    for(uint32_t tick = BENCH_TICK_MS; tick <= arrival_ms + BENCH_TIMEOUT_MS && !result;
+        tick += BENCH_TICK_MS) {
+        uint64_t now = bench_ms_to_clocks(tick);
+        bool dallas_present = key == BenchKeyDallas && tick >= arrival_ms;
+        uint32_t dallas_ms = tick + (BENCH_OW_READ_US + 999) / 1000 - arrival_ms;
+
+        if(sliced) {
+            decoders->feed(edges, &cursor, window_start, now, BENCH_RING_SIZE);
+            if(decoders->read(key, key_data, wrong)) {
+                result = tick - arrival_ms;
+            } else if(dallas_present) {
+                result = dallas_ms;
+            } else {
+                decoders->reset();
+                window_start = now + BENCH_OW_RESET_US * BENCH_CLOCKS_IN_US;
+            }
+        } else {
+            if(capture) {
+                decoders->feed(edges, &cursor, window_start, now, UINT32_MAX);
+                if(decoders->read(key, key_data, wrong)) result = tick - arrival_ms;
+            } else if(dallas_present) {
+                result = dallas_ms;
+            }
+
+            if((int64_t)tick - switch_ms > BENCH_SWITCH_MS) {
+                switch_ms = tick;
+                capture = !capture;
+                window_start = now;
+            }
+        }
+    }
+
+    delete decoders;
+    return result;
+}
+
+static void bench_key_data(BenchKey key, uint8_t* key_data) {
+    for(uint8_t i = 0; i < 8; i++) key_data[i] = bench_random(0xFF);
+    if(key == BenchKeyMetakom) {
+        // every byte has even parity
+        for(uint8_t i = 0; i < 4; i++) {
+            key_data[i] &= 0xFE;
+            key_data[i] |= __builtin_parity(key_data[i]);
+        }
+    }
+}
+
+static void bench_usage(const char* name) {
+    printf("Usage: %s [-t trials]\r\n", name);
+}
+
+int main(int argc, char* argv[]) {
+    uint32_t trials = 1000;
+
+    int option;
+    while((option = getopt(argc, argv, "t:h")) != -1) {
+        switch(option) {
+        case 't':
+            trials = strtoul(optarg, NULL, 0);
+            break;
+        default:
+            bench_usage(argv[0]);
+            return 1;
+        }
+    }
+    if(trials == 0) {
+        bench_usage(argv[0]);
+        return 1;
+    }
+
+    srand(1);
+
+    printf(
+        "Time to detect, %lu trials, key attached in first %ums, ms\r\n",
+        (unsigned long)trials,
+        BENCH_ARRIVAL_MS);
+    printf("%-10s %24s %24s\r\n", "", "mode alternation", "time slices");
+    printf("%-10s", "");
+    for(uint8_t i = 0; i < 2; i++) printf("%8s%8s%8s", "median", "p99", "wrong");
+    printf("\r\n");
+
+    for(uint8_t key = 0; key < BenchKeyCount; key++) {
+        std::vector<uint32_t> times[2];
+        uint32_t missed[2] = {0, 0};
+        uint32_t wrong[2] = {0, 0};
+
+        for(uint32_t trial = 0; trial < trials; trial++) {
+            uint8_t key_data[8];
+            bench_key_data((BenchKey)key, key_data);
+            uint32_t arrival_ms = bench_random(BENCH_ARRIVAL_MS - 1);
+
+            // Comparator keys start to send on power up
+            std::vector<BenchEdge> edges;
+            uint32_t periods[BENCH_PULSE_DATA_SIZE];
+            uint16_t count = 0;
+            if(key == BenchKeyCyfral) count = bench_cyfral_periods(key_data, periods);
+            if(key == BenchKeyMetakom) count = bench_metakom_periods(key_data, periods);
+            if(count) {
+                bench_sequencer_edges(
+                    periods,
+                    count,
+                    bench_ms_to_clocks(arrival_ms),
+                    bench_ms_to_clocks(arrival_ms + BENCH_TIMEOUT_MS + BENCH_TICK_MS),
+                    edges);
+            }
+
+            for(uint8_t sliced = 0; sliced < 2; sliced++) {
+                bool wrong_key;
+                uint32_t time = bench_reader_run(
+                    (BenchKey)key, key_data, edges, arrival_ms, sliced, &wrong_key);
+                if(!time) {
+                    missed[sliced]++;
+                } else if(wrong_key) {
+                    wrong[sliced]++;
+                } else {
+                    times[sliced].push_back(time);
+                }
+            }
+        }
+
+        printf("%-10s", bench_key_names[key]);
+        for(uint8_t sliced = 0; sliced < 2; sliced++) {
+            std::vector<uint32_t>& t = times[sliced];
+            std::sort(t.begin(), t.end());
+            if(t.empty()) {
+                printf("%8s%8s", "-", "-");
+            } else {
+                printf(
+                    "%8lu%8lu",
+                    (unsigned long)t[t.size() / 2],
+                    (unsigned long)t[t.size() * 99 / 100]);
+            }
+            printf("%8lu", (unsigned long)wrong[sliced]);
+        }
+        printf("\r\n");
+        if(missed[0] || missed[1]) {
+            printf(
+                "%-10s not detected in %ums: %lu and %lu\r\n",
+                "",
+                BENCH_TIMEOUT_MS,
+                (unsigned long)missed[0],
+                (unsigned long)missed[1]);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,22 @@
+/**
+ * @file ibutton_bench_config.h
+ * Host: target definitions needed to build iButton comparator decoders
+ *
+ * Forced into decoders with -include for benchmarks only. SystemCoreClock
+ * is defined by the benchmark, DWT cycles run at this frequency.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern uint32_t SystemCoreClock;
+
+#ifdef __cplusplus
+}
+#endif
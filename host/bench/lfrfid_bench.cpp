@@ -0,0 +1,749 @@
+/**
+ * LF RFID decoder bench: encoder loopback and captured trace replay
+ *
+ * Encoders output goes through the same PulseJoiner the timer emulator uses,
+ * timer pulses become comparator edges as reader sees them: polarity is the
+ * level after edge, period is DWT cycles since previous edge. Indala is PSK,
+ * reader demodulates it into phase changes, so its edges follow the encoder
+ * polarity instead of carrier pulses.
+ *
+ * Edges get uniform jitter and random glitches, then go through all decoders.
+ * Decode rate of the matching decoder is reported for several jitter values,
+ * any read of wrong data or by other decoder counts as false read. Decoder
+ * speed is measured on clean signal.
+ *
+ * Cross-protocol matrix feeds every tag, scaled as in each carrier config, to
+ * decoders RfidReader runs in that config and counts reads per decoder.
+ *
+ * Time to first read compares reader mode switching: fixed 2 seconds in each
+ * carrier config against RfidModeScheduler. Tag is presented at random time,
+ * its clock is derived from reader carrier, so in the other mode its timings
+ * are scaled and decoders can't follow them. Reads are polled every 100ms and
+ * validated like RfidReader does.
+ *
+ * Captured traces are text files with "<polarity> <period>" per line, period
+ * in DWT cycles, '#' starts a comment. Use -w to write synthesized ones.
+ */
+
+#include <lfrfid/helpers/decoder-emmarin.h>
+#include <lfrfid/helpers/decoder-hid26.h>
+#include <lfrfid/helpers/decoder-indala.h>
+#include <lfrfid/helpers/encoder-emmarin.h>
+#include <lfrfid/helpers/encoder-hid-h10301.h>
+#include <lfrfid/helpers/encoder-indala-40134.h>
+#include <lfrfid/helpers/pulse-joiner.h>
+#include <lfrfid/helpers/rfid-mode-scheduler.h>
+
+#include <algorithm>
+#include <getopt.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <vector>
+
+#define BENCH_CLOCKS_IN_US 64
+/* Emulation timer click is one 125kHz carrier period */
+#define BENCH_CLICK_US 8
+#define BENCH_DATA_SIZE 5
+#define BENCH_READ_BATCH 64
+
+/* Reader simulation, RfidReader timings in ms */
+#define BENCH_DECODER_INTERVAL_MS 5
+#define BENCH_READ_INTERVAL_MS 100
+#define BENCH_FIXED_SWITCH_MS 2000
+#define BENCH_ARRIVAL_MS 4000
+#define BENCH_TIMEOUT_MS 8000
+
+static const uint32_t bench_jitter_us[] = {0, 2, 5, 10, 20, 40, 60};
+#define BENCH_JITTER_COUNT (sizeof(bench_jitter_us) / sizeof(bench_jitter_us[0]))
+
+typedef enum {
+    BenchProtocolEM4100,
+    BenchProtocolH10301,
+    BenchProtocolI40134,
+    BenchProtocolCount,
+} BenchProtocol;
+
+typedef struct {
+    const char* name;
+    uint8_t data_size;
+    uint32_t frame_us;
+    bool psk;
+} BenchProtocolInfo;
+
+static const BenchProtocolInfo bench_protocols[BenchProtocolCount] = {
+    {"EM4100", 5, 64 * 64 * BENCH_CLICK_US, false},
+    {"H10301", 3, 96 * 50 * BENCH_CLICK_US, false},
+    {"I40134", 3, 64 * 16 * 2 * BENCH_CLICK_US, true},
+};
+
+typedef struct {
+    bool polarity;
+    uint32_t period;
+} BenchEdge;
+
+typedef struct {
+    uint32_t jitter_us;
+    uint32_t glitches_per_s;
+    uint32_t glitch_us;
+} BenchChannel;
+
+extern "C" void furi_crash(const char* message) {
+    fprintf(stderr, "%s", message);
+    abort();
+}
+
+static uint64_t bench_time_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static uint32_t bench_random(uint32_t max) {
+    return max ? (uint32_t)(rand() % (max + 1)) : 0;
+}
+
+static EncoderGeneric* bench_encoder_alloc(BenchProtocol protocol) {
+    switch(protocol) {
+    case BenchProtocolEM4100:
+        return new EncoderEM();
+    case BenchProtocolH10301:
+        return new EncoderHID_H10301();
+    default:
+        return new EncoderIndala_40134();
+    }
+}
+
+/* Level segments in microseconds, same levels are merged */
+static void bench_segment_add(std::vector<BenchEdge>& segments, bool level, uint32_t time_us) {
+    if(time_us == 0) return;
+    if(!segments.empty() && segments.back().polarity == level) {
+        segments.back().period += time_us;
+    } else {
+        segments.push_back({level, time_us});
+    }
+}
+
+static void bench_signal_segments(
+    BenchProtocol protocol,
+    const uint8_t* data,
+    uint32_t frames,
+    std::vector<BenchEdge>& segments) {
+    const BenchProtocolInfo* info = &bench_protocols[protocol];
+    EncoderGeneric* encoder = bench_encoder_alloc(protocol);
+    encoder->init(data, info->data_size);
+    PulseJoiner joiner;
+
+    // Reading starts anywhere in the frame
+    uint32_t skip_us = bench_random(info->frame_us);
+    uint32_t total_us = skip_us + frames * info->frame_us;
+    uint32_t time_us = 0;
+
+    while(time_us < total_us) {
+        bool polarity;
+        uint16_t period, pulse;
+        encoder->get_next(&polarity, &period, &pulse);
+
+        if(info->psk) {
+            uint32_t period_us = period * BENCH_CLICK_US;
+            if(time_us >= skip_us) bench_segment_add(segments, polarity, period_us);
+            time_us += period_us;
+        } else if(joiner.push_pulse(polarity, period, pulse)) {
+            // PWM1: high for pulse, low for the rest of period
+            joiner.pop_pulse(&period, &pulse);
+            uint32_t period_us = period * BENCH_CLICK_US;
+            if(time_us >= skip_us) {
+                bench_segment_add(segments, true, pulse * BENCH_CLICK_US);
+                bench_segment_add(segments, false, (period - pulse) * BENCH_CLICK_US);
+            }
+            time_us += period_us;
+        }
+    }
+
+    delete encoder;
+}
+
+/* Segments to edges with jitter on edge timestamps and glitches inside segments */
+static void bench_signal_edges(
+    const std::vector<BenchEdge>& segments,
+    const BenchChannel* channel,
+    std::vector<BenchEdge>& edges) {
+    // Comparator was idle for a while before the first edge
+    int64_t time = 1000 * BENCH_CLOCKS_IN_US;
+    int64_t last_edge = 0;
+    int64_t jitter = channel->jitter_us * BENCH_CLOCKS_IN_US;
+
+    auto add_edge = [&](bool polarity, int64_t at) {
+        at += (int64_t)bench_random(2 * jitter) - jitter;
+        if(at <= last_edge) at = last_edge + 1;
+        edges.push_back({polarity, (uint32_t)(at - last_edge)});
+        last_edge = at;
+    };
+
+    for(size_t i = 0; i < segments.size(); i++) {
+        bool level = segments[i].polarity;
+        int64_t length = (int64_t)segments[i].period * BENCH_CLOCKS_IN_US;
+        add_edge(level, time);
+
+        // Glitch rate is per time, not per edge: protocols differ in edge rate a lot
+        if((double)rand() / RAND_MAX * 1e6 < segments[i].period * channel->glitches_per_s) {
+            int64_t glitch = (1 + bench_random(channel->glitch_us - 1)) * BENCH_CLOCKS_IN_US;
+            if(glitch < length) {
+                int64_t at = time + bench_random(length - glitch);
+                add_edge(!level, at);
+                add_edge(level, at + glitch);
+            }
+        }
+        time += length;
+    }
+}
+
+typedef enum {
+    BenchModeNormal,
+    BenchModeIndala,
+    BenchModeCount,
+} BenchMode;
+
+static const char* const bench_mode_names[BenchModeCount] = {"Normal", "Indala"};
+
+/* Decoders RfidReader::decode runs in each carrier config */
+static const uint32_t bench_mode_decoders[BenchModeCount] = {
+    (1 << BenchProtocolEM4100) | (1 << BenchProtocolH10301),
+    (1 << BenchProtocolEM4100) | (1 << BenchProtocolH10301) | (1 << BenchProtocolI40134),
+};
+
+/* Tag clock comes from reader carrier: 125kHz tags run at half speed in Indala mode,
+ * Indala tag at double in Normal one */
+static double bench_mode_scale(BenchMode mode, const BenchProtocolInfo* info) {
+    if(mode == BenchModeIndala && !info->psk) return 2.0;
+    if(mode == BenchModeNormal && info->psk) return 0.5;
+    return 1.0;
+}
+
+class BenchDecoders {
+public:
+    DecoderEMMarin em;
+    DecoderHID26 hid;
+    DecoderIndala indala;
+
+    void process(const BenchEdge& edge) {
+        em.process_front(edge.polarity, edge.period);
+        hid.process_front(edge.polarity, edge.period);
+        indala.process_front(edge.polarity, edge.period);
+    }
+
+    /* Decoders RfidReader runs in given carrier config, mask of BenchProtocol */
+    void process(const BenchEdge& edge, uint32_t active) {
+        if(active & (1 << BenchProtocolEM4100)) em.process_front(edge.polarity, edge.period);
+        if(active & (1 << BenchProtocolH10301)) hid.process_front(edge.polarity, edge.period);
+        if(active & (1 << BenchProtocolI40134)) {
+            indala.process_front(edge.polarity, edge.period);
+        }
+    }
+
+    uint32_t get_sync_count() {
+        return em.get_sync_count() + hid.get_sync_count() + indala.get_sync_count();
+    }
+
+    /* Bitmask of decoders that have data, data of the last of them */
+    uint32_t read(uint8_t* data) {
+        uint32_t result = 0;
+        if(em.read(data, BENCH_DATA_SIZE)) result |= 1 << BenchProtocolEM4100;
+        if(hid.read(data, BENCH_DATA_SIZE)) result |= 1 << BenchProtocolH10301;
+        if(indala.read(data, BENCH_DATA_SIZE)) result |= 1 << BenchProtocolI40134;
+        return result;
+    }
+};
+
+typedef struct {
+    uint32_t decoded;
+    uint32_t false_reads;
+} BenchResult;
+
+static void bench_loopback(
+    BenchProtocol protocol,
+    const BenchChannel* channel,
+    uint32_t trials,
+    uint32_t frames,
+    BenchResult* result) {
+    const BenchProtocolInfo* info = &bench_protocols[protocol];
+    memset(result, 0, sizeof(BenchResult));
+
+    for(uint32_t trial = 0; trial < trials; trial++) {
+        uint8_t data[BENCH_DATA_SIZE] = {0};
+        for(uint8_t i = 0; i < info->data_size; i++) data[i] = bench_random(0xFF);
+
+        std::vector<BenchEdge> segments, edges;
+        bench_signal_segments(protocol, data, frames, segments);
+        bench_signal_edges(segments, channel, edges);
+
+        BenchDecoders* decoders = new BenchDecoders();
+        bool decoded = false;
+        for(size_t i = 0; i < edges.size(); i++) {
+            decoders->process(edges[i]);
+            if(((i + 1) % BENCH_READ_BATCH) && (i + 1 != edges.size())) continue;
+
+            uint8_t read_data[BENCH_DATA_SIZE] = {0};
+            uint32_t readers = decoders->read(read_data);
+            if(readers == (1UL << protocol) &&
+               memcmp(read_data, data, info->data_size) == 0) {
+                decoded = true;
+            } else if(readers) {
+                result->false_reads++;
+            }
+        }
+        if(decoded) result->decoded++;
+        delete decoders;
+    }
+}
+
+/* Tag of every protocol in both carrier configs through decoders reader runs there,
+ * over all jitter values. Matching decoder gives decode rate, any read of wrong data
+ * or by other decoder counts as false read of that decoder. */
+static void bench_cross_reads(const BenchChannel* channel, uint32_t trials, uint32_t frames) {
+    printf(
+        "\r\nCross-protocol reads, %lu trials of %lu frames per jitter value, false reads by "
+        "decoder\r\n",
+        (unsigned long)trials,
+        (unsigned long)frames);
+    printf("%-8s%-10s%10s", "mode", "tag", "decoded");
+    for(uint8_t decoder = 0; decoder < BenchProtocolCount; decoder++) {
+        printf("%10s", bench_protocols[decoder].name);
+    }
+    printf("\r\n");
+
+    for(uint8_t mode = 0; mode < BenchModeCount; mode++) {
+        for(uint8_t protocol = 0; protocol < BenchProtocolCount; protocol++) {
+            const BenchProtocolInfo* info = &bench_protocols[protocol];
+            double scale = bench_mode_scale((BenchMode)mode, info);
+            uint32_t decoded = 0;
+            uint32_t false_reads[BenchProtocolCount] = {0};
+
+            for(size_t j = 0; j < BENCH_JITTER_COUNT; j++) {
+                BenchChannel sweep = *channel;
+                sweep.jitter_us = bench_jitter_us[j];
+                for(uint32_t trial = 0; trial < trials; trial++) {
+                    uint8_t data[BENCH_DATA_SIZE] = {0};
+                    for(uint8_t i = 0; i < info->data_size; i++) data[i] = bench_random(0xFF);
+
+                    std::vector<BenchEdge> segments, edges;
+                    bench_signal_segments((BenchProtocol)protocol, data, frames, segments);
+                    for(size_t i = 0; i < segments.size(); i++) {
+                        segments[i].period = segments[i].period * scale;
+                    }
+                    bench_signal_edges(segments, &sweep, edges);
+
+                    BenchDecoders* decoders = new BenchDecoders();
+                    bool trial_decoded = false;
+                    for(size_t i = 0; i < edges.size(); i++) {
+                        decoders->process(edges[i], bench_mode_decoders[mode]);
+                        if(((i + 1) % BENCH_READ_BATCH) && (i + 1 != edges.size())) continue;
+
+                        uint8_t read_data[BENCH_DATA_SIZE] = {0};
+                        uint32_t readers = decoders->read(read_data);
+                        for(uint8_t decoder = 0; decoder < BenchProtocolCount; decoder++) {
+                            if(!(readers & (1UL << decoder))) continue;
+                            // Data is of the last decoder that read, one decoder at a time
+                            // is the only case it can be checked
+                            if(decoder == protocol && readers == (1UL << decoder) &&
+                               memcmp(read_data, data, info->data_size) == 0) {
+                                trial_decoded = true;
+                            } else {
+                                false_reads[decoder]++;
+                            }
+                        }
+                    }
+                    if(trial_decoded) decoded++;
+                    delete decoders;
+                }
+            }
+
+            printf(
+                "%-8s%-10s%9.1f%%",
+                bench_mode_names[mode],
+                info->name,
+                decoded * 100.0 / (trials * BENCH_JITTER_COUNT));
+            for(uint8_t decoder = 0; decoder < BenchProtocolCount; decoder++) {
+                if(bench_mode_decoders[mode] & (1 << decoder)) {
+                    printf("%10lu", (unsigned long)false_reads[decoder]);
+                } else {
+                    printf("%10s", "-");
+                }
+            }
+            printf("\r\n");
+        }
+    }
+}
+
+static double bench_throughput(const std::vector<BenchEdge>& edges) {
+    BenchDecoders* decoders = new BenchDecoders();
+    uint8_t data[BENCH_DATA_SIZE];
+    uint64_t processed = 0;
+    uint64_t start = bench_time_ns();
+    uint64_t elapsed;
+    do {
+        for(size_t i = 0; i < edges.size(); i++) {
+            decoders->process(edges[i]);
+            if((i + 1) % BENCH_READ_BATCH == 0) decoders->read(data);
+        }
+        processed += edges.size();
+        elapsed = bench_time_ns() - start;
+    } while(elapsed < 200000000ULL);
+    delete decoders;
+    return processed * 1e9 / elapsed;
+}
+
+/* Tag in reader field: native segments are played at speed of reader carrier */
+class BenchTag {
+public:
+    BenchTag(const std::vector<BenchEdge>& _segments, uint32_t arrival_ms, uint32_t jitter_us)
+        : segments(_segments) {
+        time = (double)arrival_ms * 1000 * BENCH_CLOCKS_IN_US;
+        left = segments.empty() ? 0 : (double)segments[0].period * BENCH_CLOCKS_IN_US;
+        jitter = jitter_us * BENCH_CLOCKS_IN_US;
+    }
+
+    /* Edges up to given time, scale is tag period multiplier in current mode */
+    void run(double until, double scale, std::vector<BenchEdge>& edges) {
+        while(index < segments.size() && time < until) {
+            double end = time + left * scale;
+            if(end > until) {
+                left -= (until - time) / scale;
+                time = until;
+                break;
+            }
+
+            time = end;
+            index++;
+            if(index == segments.size()) break;
+            left = (double)segments[index].period * BENCH_CLOCKS_IN_US;
+
+            double at = time + (int64_t)bench_random(2 * jitter) - jitter;
+            if(at <= last_edge) at = last_edge + 1;
+            edges.push_back({segments[index].polarity, (uint32_t)(at - last_edge)});
+            last_edge = at;
+        }
+    }
+
+private:
+    const std::vector<BenchEdge>& segments;
+    size_t index = 0;
+    double time;
+    double left;
+    double last_edge = 0;
+    int64_t jitter;
+};
+
+/* Reader from start to validated read, ms from tag arrival or 0 on timeout */
+static uint32_t bench_reader_run(
+    BenchProtocol protocol,
+    const uint8_t* data,
+    const std::vector<BenchEdge>& segments,
+    const BenchChannel* channel,
+    uint32_t arrival_ms,
+    bool adaptive) {
+    const BenchProtocolInfo* info = &bench_protocols[protocol];
+    BenchTag tag(segments, arrival_ms, channel->jitter_us);
+    BenchDecoders* decoders = new BenchDecoders();
+    RfidModeScheduler scheduler;
+    scheduler.reset(0, 1000);
+
+    BenchMode mode = BenchModeNormal;
+    uint32_t switch_ms = 0;
+    uint32_t scheduler_syncs = 0;
+    uint32_t scheduler_edges = 0;
+    int32_t last_readed_type = -1;
+    uint8_t last_readed_data[BENCH_DATA_SIZE] = {0};
+    uint8_t last_readed_count = 0;
+    uint32_t result = 0;
+    std::vector<BenchEdge> edges;
+
+    for(uint32_t now = 1; now <= arrival_ms + BENCH_TIMEOUT_MS && !result; now++) {
+        double scale = bench_mode_scale(mode, info);
+
+        edges.clear();
+        tag.run((double)now * 1000 * BENCH_CLOCKS_IN_US, scale, edges);
+        for(size_t i = 0; i < edges.size(); i++) {
+            decoders->process(edges[i], bench_mode_decoders[mode]);
+        }
+        scheduler_edges += edges.size();
+
+        if(adaptive && now % BENCH_DECODER_INTERVAL_MS == 0) {
+            uint32_t syncs = decoders->get_sync_count();
+            if(scheduler.update(now, scheduler_edges, syncs - scheduler_syncs)) {
+                mode = mode == BenchModeNormal ? BenchModeIndala : BenchModeNormal;
+                last_readed_count = 0;
+            }
+            scheduler_syncs = syncs;
+            scheduler_edges = 0;
+        }
+
+        if(now % BENCH_READ_INTERVAL_MS) continue;
+
+        uint8_t read_data[BENCH_DATA_SIZE] = {0};
+        uint32_t readers = decoders->read(read_data);
+        if(readers) {
+            int32_t type = 31 - __builtin_clz(readers);
+            if(adaptive) {
+                scheduler.hold(now);
+            } else {
+                switch_ms = now;
+            }
+
+            if(last_readed_type == type &&
+               memcmp(last_readed_data, read_data, BENCH_DATA_SIZE) == 0) {
+                last_readed_count++;
+                if(last_readed_count > 2 && type == protocol &&
+                   memcmp(read_data, data, info->data_size) == 0) {
+                    result = now - arrival_ms;
+                }
+            } else {
+                last_readed_type = type;
+                memcpy(last_readed_data, read_data, BENCH_DATA_SIZE);
+                last_readed_count = 0;
+            }
+        }
+
+        if(!adaptive && now - switch_ms > BENCH_FIXED_SWITCH_MS) {
+            mode = mode == BenchModeNormal ? BenchModeIndala : BenchModeNormal;
+            switch_ms = now;
+            last_readed_count = 0;
+        }
+    }
+
+    delete decoders;
+    return result;
+}
+
+static void bench_time_to_read(const BenchChannel* channel, uint32_t trials) {
+    printf(
+        "\r\nTime to first read, %lu trials, tag arrives in first %ums, ms\r\n",
+        (unsigned long)trials,
+        BENCH_ARRIVAL_MS);
+    printf("%-10s %24s %24s\r\n", "", "fixed 2s switch", "adaptive");
+    printf("%-10s", "");
+    for(uint8_t i = 0; i < 2; i++) printf("%8s%8s%8s", "median", "p99", "missed");
+    printf("\r\n");
+
+    for(uint8_t protocol = 0; protocol < BenchProtocolCount; protocol++) {
+        const BenchProtocolInfo* info = &bench_protocols[protocol];
+        std::vector<uint32_t> times[2];
+        uint32_t missed[2] = {0, 0};
+
+        for(uint32_t trial = 0; trial < trials; trial++) {
+            uint8_t data[BENCH_DATA_SIZE] = {0};
+            for(uint8_t i = 0; i < info->data_size; i++) data[i] = bench_random(0xFF);
+            uint32_t arrival_ms = bench_random(BENCH_ARRIVAL_MS - 1);
+
+            // Enough frames to play tag at half speed until timeout
+            std::vector<BenchEdge> segments;
+            uint32_t frames = BENCH_TIMEOUT_MS * 1000 / info->frame_us + 1;
+            bench_signal_segments((BenchProtocol)protocol, data, frames, segments);
+
+            for(uint8_t adaptive = 0; adaptive < 2; adaptive++) {
+                uint32_t time = bench_reader_run(
+                    (BenchProtocol)protocol, data, segments, channel, arrival_ms, adaptive);
+                if(time) {
+                    times[adaptive].push_back(time);
+                } else {
+                    missed[adaptive]++;
+                }
+            }
+        }
+
+        printf("%-10s", info->name);
+        for(uint8_t adaptive = 0; adaptive < 2; adaptive++) {
+            std::vector<uint32_t>& t = times[adaptive];
+            std::sort(t.begin(), t.end());
+            if(t.empty()) {
+                printf("%8s%8s", "-", "-");
+            } else {
+                printf(
+                    "%8lu%8lu",
+                    (unsigned long)t[t.size() / 2],
+                    (unsigned long)t[t.size() * 99 / 100]);
+            }
+            printf("%8lu", (unsigned long)missed[adaptive]);
+        }
+        printf("\r\n");
+    }
+}
+
+static bool bench_trace_load(const char* path, std::vector<BenchEdge>& edges) {
+    FILE* file = fopen(path, "r");
+    if(!file) return false;
+    char line[128];
+    while(fgets(line, sizeof(line), file)) {
+        char* comment = strchr(line, '#');
+        if(comment) *comment = '\0';
+        unsigned polarity;
+        unsigned long period;
+        if(sscanf(line, "%u %lu", &polarity, &period) == 2) {
+            edges.push_back({polarity != 0, (uint32_t)period});
+        }
+    }
+    fclose(file);
+    return true;
+}
+
+static bool bench_trace_write(const char* prefix, BenchProtocol protocol) {
+    const BenchProtocolInfo* info = &bench_protocols[protocol];
+    uint8_t data[BENCH_DATA_SIZE] = {0x12, 0x34, 0x56, 0x78, 0x9A};
+    std::vector<BenchEdge> segments, edges;
+    BenchChannel channel = {0, 0, 1};
+    bench_signal_segments(protocol, data, 4, segments);
+    bench_signal_edges(segments, &channel, edges);
+
+    char path[256];
+    snprintf(path, sizeof(path), "%s_%s.trace", prefix, info->name);
+    FILE* file = fopen(path, "w");
+    if(!file) return false;
+    fprintf(file, "# %s", info->name);
+    for(uint8_t i = 0; i < info->data_size; i++) fprintf(file, " %02X", data[i]);
+    fprintf(file, "\n");
+    for(size_t i = 0; i < edges.size(); i++) {
+        fprintf(file, "%u %lu\n", edges[i].polarity, (unsigned long)edges[i].period);
+    }
+    fclose(file);
+    printf("Written %s, %zu edges\r\n", path, edges.size());
+    return true;
+}
+
+static bool bench_trace_replay(const char* path) {
+    std::vector<BenchEdge> edges;
+    if(!bench_trace_load(path, edges)) {
+        printf("Cannot read %s\r\n", path);
+        return false;
+    }
+
+    BenchDecoders* decoders = new BenchDecoders();
+    uint32_t reads = 0;
+    for(size_t i = 0; i < edges.size(); i++) {
+        decoders->process(edges[i]);
+        if(((i + 1) % BENCH_READ_BATCH) && (i + 1 != edges.size())) continue;
+
+        uint8_t data[BENCH_DATA_SIZE] = {0};
+        uint32_t readers = decoders->read(data);
+        for(uint8_t protocol = 0; protocol < BenchProtocolCount; protocol++) {
+            if(!(readers & (1UL << protocol))) continue;
+            const BenchProtocolInfo* info = &bench_protocols[protocol];
+            printf("%s: edge %6zu %s", path, i + 1, info->name);
+            for(uint8_t j = 0; j < info->data_size; j++) printf(" %02X", data[j]);
+            printf("\r\n");
+            reads++;
+        }
+    }
+    delete decoders;
+
+    printf(
+        "%s: %zu edges, %lu reads, %.0f edges/s\r\n",
+        path,
+        edges.size(),
+        (unsigned long)reads,
+        edges.empty() ? 0.0 : bench_throughput(edges));
+    return true;
+}
+
+static void bench_usage(const char* name) {
+    printf("Usage: %s [-t trials] [-f frames] [-n glitches_per_s] [-g glitch_us]\r\n", name);
+    printf("       %s -w prefix\r\n", name);
+    printf("       %s trace_file...\r\n", name);
+}
+
+int main(int argc, char* argv[]) {
+    uint32_t trials = 200;
+    uint32_t frames = 4;
+    BenchChannel channel = {0, 0, 20};
+    const char* write_prefix = NULL;
+
+    int option;
+    while((option = getopt(argc, argv, "t:f:n:g:w:h")) != -1) {
+        switch(option) {
+        case 't':
+            trials = strtoul(optarg, NULL, 0);
+            break;
+        case 'f':
+            frames = strtoul(optarg, NULL, 0);
+            break;
+        case 'n':
+            channel.glitches_per_s = strtoul(optarg, NULL, 0);
+            break;
+        case 'g':
+            channel.glitch_us = strtoul(optarg, NULL, 0);
+            break;
+        case 'w':
+            write_prefix = optarg;
+            break;
+        default:
+            bench_usage(argv[0]);
+            return 1;
+        }
+    }
+    if(trials == 0 || frames == 0 || channel.glitch_us == 0) {
+        bench_usage(argv[0]);
+        return 1;
+    }
+
+    srand(1);
+
+    if(write_prefix) {
+        for(uint8_t protocol = 0; protocol < BenchProtocolCount; protocol++) {
+            if(!bench_trace_write(write_prefix, (BenchProtocol)protocol)) return 1;
+        }
+        return 0;
+    }
+
+    if(optind < argc) {
+        bool result = true;
+        for(int i = optind; i < argc; i++) result &= bench_trace_replay(argv[i]);
+        return result ? 0 : 1;
+    }
+
+    printf(
+        "Decode rate, %lu trials of %lu frames, %lu glitches/s up to %luus\r\n",
+        (unsigned long)trials,
+        (unsigned long)frames,
+        (unsigned long)channel.glitches_per_s,
+        (unsigned long)channel.glitch_us);
+    printf("%-10s", "jitter us");
+    for(size_t j = 0; j < BENCH_JITTER_COUNT; j++) {
+        printf("%8lu", (unsigned long)bench_jitter_us[j]);
+    }
+    printf("%14s\r\n", "false reads");
+
+    for(uint8_t protocol = 0; protocol < BenchProtocolCount; protocol++) {
+        printf("%-10s", bench_protocols[protocol].name);
+        uint32_t false_reads = 0;
+        for(size_t j = 0; j < BENCH_JITTER_COUNT; j++) {
+            BenchChannel sweep = channel;
+            sweep.jitter_us = bench_jitter_us[j];
+            BenchResult result;
+            bench_loopback((BenchProtocol)protocol, &sweep, trials, frames, &result);
+            printf("%7.1f%%", result.decoded * 100.0 / trials);
+            false_reads += result.false_reads;
+        }
+        printf("%14lu\r\n", (unsigned long)false_reads);
+    }
+
+    printf("\r\nAll decoders on clean signal\r\n");
+    for(uint8_t protocol = 0; protocol < BenchProtocolCount; protocol++) {
+        uint8_t data[BENCH_DATA_SIZE] = {0x12, 0x34, 0x56, 0x78, 0x9A};
+        std::vector<BenchEdge> segments, edges;
+        BenchChannel clean = {0, 0, 1};
+        bench_signal_segments((BenchProtocol)protocol, data, 16, segments);
+        bench_signal_edges(segments, &clean, edges);
+        printf(
+            "%-10s %10.0f edges/s %8.1f edges/s on air\r\n",
+            bench_protocols[protocol].name,
+            bench_throughput(edges),
+            edges.size() * 1e6 / (16.0 * bench_protocols[protocol].frame_us));
+    }
+
+    bench_cross_reads(&channel, trials, frames);
+
+    bench_time_to_read(&channel, trials);
+
+    return 0;
+}
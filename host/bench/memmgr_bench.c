@@ -0,0 +1,207 @@
+/**
+ * Memmgr slab benchmark: replays allocation trace recorded by host build
+ *
+ * Trace is produced with FURI_HOST_ALLOC_TRACE=<file> and contains lines
+ * "a <pointer> <size>" and "f <pointer>". Every allocation is replayed through
+ * memmgr slab with libc fallback (same as firmware heap does) and through
+ * libc only, reporting per class occupancy, fallbacks and time per call.
+ */
+
+#include <furi/memmgr_slab.h>
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+typedef struct {
+    uint32_t slot; /**< Live allocation index */
+    uint32_t size; /**< 0 for free */
+} BenchOp;
+
+typedef struct {
+    BenchOp* ops;
+    size_t ops_count;
+    size_t slots_count;
+} BenchTrace;
+
+typedef struct {
+    uintptr_t key;
+    uint32_t slot;
+    bool used;
+} BenchTraceEntry;
+
+static uint64_t arena[MEMMGR_SLAB_ARENA_SIZE / sizeof(uint64_t)];
+
+void furi_crash(const char* message) {
+    fprintf(stderr, "%s", message);
+    abort();
+}
+
+static uint64_t bench_time_ns() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+/* Pointers in trace are reused by allocator, map every live pointer to a slot */
+static bool bench_trace_load(BenchTrace* trace, const char* path) {
+    FILE* file = fopen(path, "r");
+    if(!file) return false;
+
+    size_t table_size = 1 << 16;
+    BenchTraceEntry* table = calloc(table_size, sizeof(BenchTraceEntry));
+    uint32_t* free_slots = NULL;
+    size_t free_slots_count = 0;
+    size_t ops_capacity = 1024;
+    trace->ops = malloc(ops_capacity * sizeof(BenchOp));
+    trace->ops_count = 0;
+    trace->slots_count = 0;
+
+    char op;
+    void* pointer;
+    size_t size;
+    char line[64];
+    while(fgets(line, sizeof(line), file)) {
+        int fields = sscanf(line, "%c %p %zu", &op, &pointer, &size);
+        if(fields < 2 || pointer == NULL) continue;
+
+        size_t index = ((uintptr_t)pointer >> 3) & (table_size - 1);
+        if(op == 'a' && fields == 3) {
+            while(table[index].used && table[index].key != (uintptr_t)pointer) {
+                index = (index + 1) & (table_size - 1);
+            }
+            if(table[index].used) continue;
+            uint32_t slot = free_slots_count ? free_slots[--free_slots_count] :
+                                               trace->slots_count++;
+            table[index] = (BenchTraceEntry){(uintptr_t)pointer, slot, true};
+            if(trace->ops_count == ops_capacity) {
+                ops_capacity *= 2;
+                trace->ops = realloc(trace->ops, ops_capacity * sizeof(BenchOp));
+            }
+            trace->ops[trace->ops_count++] = (BenchOp){slot, size};
+        } else if(op == 'f') {
+            while(table[index].used && table[index].key != (uintptr_t)pointer) {
+                index = (index + 1) & (table_size - 1);
+            }
+            if(!table[index].used) continue;
+            uint32_t slot = table[index].slot;
+            // Backward shift deletion keeps probe chains intact
+            size_t hole = index;
+            size_t next = (hole + 1) & (table_size - 1);
+            while(table[next].used) {
+                size_t home = (table[next].key >> 3) & (table_size - 1);
+                if(((next - home) & (table_size - 1)) >= ((next - hole) & (table_size - 1))) {
+                    table[hole] = table[next];
+                    hole = next;
+                }
+                next = (next + 1) & (table_size - 1);
+            }
+            table[hole].used = false;
+            free_slots = realloc(free_slots, (free_slots_count + 1) * sizeof(uint32_t));
+            free_slots[free_slots_count++] = slot;
+            if(trace->ops_count == ops_capacity) {
+                ops_capacity *= 2;
+                trace->ops = realloc(trace->ops, ops_capacity * sizeof(BenchOp));
+            }
+            trace->ops[trace->ops_count++] = (BenchOp){slot, 0};
+        }
+    }
+
+    free(free_slots);
+    free(table);
+    fclose(file);
+    return true;
+}
+
+static uint64_t bench_replay(const BenchTrace* trace, void** slots, bool use_slab) {
+    memset(slots, 0, trace->slots_count * sizeof(void*));
+    uint64_t start = bench_time_ns();
+    for(size_t i = 0; i < trace->ops_count; i++) {
+        const BenchOp* op = &trace->ops[i];
+        if(op->size) {
+            void* pointer = use_slab ? memmgr_slab_alloc(op->size) : NULL;
+            slots[op->slot] = pointer ? pointer : malloc(op->size);
+        } else {
+            if(use_slab && memmgr_slab_owns(slots[op->slot])) {
+                memmgr_slab_free(slots[op->slot]);
+            } else {
+                free(slots[op->slot]);
+            }
+            slots[op->slot] = NULL;
+        }
+    }
+    uint64_t time = bench_time_ns() - start;
+
+    // Allocations still alive at the end of trace are not part of measurement
+    for(size_t i = 0; i < trace->slots_count; i++) {
+        if(use_slab && memmgr_slab_owns(slots[i])) continue;
+        free(slots[i]);
+    }
+    return time;
+}
+
+int main(int argc, char* argv[]) {
+    if(argc < 2) {
+        printf("Usage: %s <trace> [arena_size] [rounds]\r\n", argv[0]);
+        return 1;
+    }
+    size_t arena_size = (argc > 2) ? strtoul(argv[2], NULL, 0) : MEMMGR_SLAB_ARENA_SIZE;
+    int rounds = (argc > 3) ? atoi(argv[3]) : 10;
+    if(arena_size > MEMMGR_SLAB_ARENA_SIZE) {
+        printf("Arena is limited to %d bytes in this build\r\n", MEMMGR_SLAB_ARENA_SIZE);
+        return 1;
+    }
+
+    BenchTrace trace;
+    if(!bench_trace_load(&trace, argv[1])) {
+        printf("Failed to open %s\r\n", argv[1]);
+        return 1;
+    }
+    printf(
+        "Trace: %zu calls, %zu live slots max, arena %zu bytes\r\n",
+        trace.ops_count,
+        trace.slots_count,
+        arena_size);
+
+    void** slots = calloc(trace.slots_count ? trace.slots_count : 1, sizeof(void*));
+    uint64_t time_slab = 0;
+    uint64_t time_libc = 0;
+    MemmgrSlabClassStats stats[MEMMGR_SLAB_CLASS_COUNT];
+    for(int round = 0; round < rounds; round++) {
+        memmgr_slab_init(arena, arena_size);
+        time_slab += bench_replay(&trace, slots, true);
+        for(uint8_t class_id = 0; class_id < MEMMGR_SLAB_CLASS_COUNT; class_id++) {
+            memmgr_slab_get_class_stats(class_id, &stats[class_id]);
+        }
+        time_libc += bench_replay(&trace, slots, false);
+    }
+
+    printf(
+        "\r\n%-6s %-10s %-10s %-10s %s\r\n",
+        "Class",
+        "Allocs",
+        "Fallbacks",
+        "Hit, %",
+        "Peak pages");
+    for(uint8_t class_id = 0; class_id < MEMMGR_SLAB_CLASS_COUNT; class_id++) {
+        uint32_t requests = stats[class_id].allocs + stats[class_id].fallbacks;
+        printf(
+            "%-6zu %-10" PRIu32 " %-10" PRIu32 " %-10.1f %zu\r\n",
+            stats[class_id].object_size,
+            stats[class_id].allocs,
+            stats[class_id].fallbacks,
+            requests ? 100.0 * stats[class_id].allocs / requests : 0.0,
+            stats[class_id].pages_max);
+    }
+
+    double calls = (double)trace.ops_count * rounds;
+    printf("\r\nslab+libc: %.1f ns/call\r\n", calls ? time_slab / calls : 0.0);
+    printf("libc:      %.1f ns/call\r\n", calls ? time_libc / calls : 0.0);
+
+    free(slots);
+    free(trace.ops);
+    return 0;
+}
@@ -0,0 +1,23 @@
+/**
+ * @file memmgr_heap_bench_config.h
+ * Host: FreeRTOS port definitions needed to build target memmgr_heap.c
+ *
+ * Forced into memmgr_heap.c with -include for benchmarks only. Heap region
+ * symbols come from the benchmark: __heap_start__ is a static array and
+ * __heap_end__ is defined by linker relative to it.
+ */
+
+#pragma once
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+#define configSUPPORT_DYNAMIC_ALLOCATION 1
+#define configUSE_MALLOC_FAILED_HOOK 0
+#define configASSERT(x) assert(x)
+
+#define portBYTE_ALIGNMENT 8
+#define portBYTE_ALIGNMENT_MASK (0x0007)
+
+#define mtCOVERAGE_TEST_MARKER()
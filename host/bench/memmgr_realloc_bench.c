@@ -0,0 +1,159 @@
+/**
+ * Memmgr realloc benchmark: string and array building on target heap
+ *
+ * Target memmgr_heap.c (slab and heap_4) is linked against host OS and driven
+ * by growth patterns of m-string and m-array: single char appends, line
+ * concatenation and element pushes, interleaved with short lived allocations
+ * of other sizes. Every workload runs with memmgr_heap_realloc and with
+ * always-moving realloc (alloc, copy, free), which is what memmgr did before.
+ */
+
+#include <furi/check.h>
+#include <furi/memmgr_heap.h>
+#include <FreeRTOS.h>
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_HEAP_SIZE (256 * 1024)
+#define BENCH_NOISE_COUNT 16
+#define BENCH_ROUNDS 200
+
+/* Heap region for memmgr_heap.c, __heap_end__ is set by linker */
+uint8_t __heap_start__[BENCH_HEAP_SIZE] __attribute__((aligned(8)));
+
+typedef void* (*BenchRealloc)(void* ptr, size_t old_size, size_t size);
+
+typedef struct {
+    const char* name;
+    size_t target_size; /**< Bytes to build */
+    size_t chunk_size; /**< Bytes appended per step */
+    size_t noise_period; /**< Steps between noise allocations, 0 for none */
+} BenchWorkload;
+
+static const BenchWorkload bench_workloads[] = {
+    {"string push_back", 2048, 1, 0},
+    {"string push_back + noise", 2048, 1, 64},
+    {"string cat lines", 4096, 40, 0},
+    {"string cat lines + noise", 4096, 40, 2},
+    {"array push 24B", 24 * 256, 24, 0},
+    {"array push 24B + noise", 24 * 256, 24, 4},
+};
+
+static uint32_t bench_random_state = 1;
+
+void furi_crash(const char* message) {
+    fprintf(stderr, "%s", message);
+    abort();
+}
+
+static uint32_t bench_random() {
+    bench_random_state = bench_random_state * 1103515245 + 12345;
+    return bench_random_state >> 16;
+}
+
+static uint64_t bench_time_ns() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+static void* bench_realloc_in_place(void* ptr, size_t old_size, size_t size) {
+    (void)old_size;
+    return memmgr_heap_realloc(ptr, size);
+}
+
+static void* bench_realloc_move(void* ptr, size_t old_size, size_t size) {
+    void* new_ptr = pvPortMalloc(size);
+    if(new_ptr && ptr) {
+        memcpy(new_ptr, ptr, old_size < size ? old_size : size);
+        vPortFree(ptr);
+    }
+    return new_ptr;
+}
+
+/* Capacity grows by half plus a minimum step, like m-string and m-array */
+static uint64_t bench_run(const BenchWorkload* workload, BenchRealloc bench_realloc) {
+    void* noise[BENCH_NOISE_COUNT] = {0};
+    size_t noise_index = 0;
+    uint8_t chunk[64];
+    memset(chunk, 'x', sizeof(chunk));
+
+    bench_random_state = 1;
+    uint64_t start = bench_time_ns();
+    for(size_t round = 0; round < BENCH_ROUNDS; round++) {
+        uint8_t* buffer = NULL;
+        size_t capacity = 0;
+        size_t size = 0;
+        size_t step = 0;
+        while(size < workload->target_size) {
+            if(size + workload->chunk_size > capacity) {
+                size_t new_capacity = capacity + capacity / 2 + 16;
+                if(new_capacity < size + workload->chunk_size) {
+                    new_capacity = size + workload->chunk_size;
+                }
+                buffer = bench_realloc(buffer, capacity, new_capacity);
+                furi_check(buffer);
+                capacity = new_capacity;
+            }
+            memcpy(&buffer[size], chunk, workload->chunk_size);
+            size += workload->chunk_size;
+
+            if(workload->noise_period && (++step % workload->noise_period) == 0) {
+                vPortFree(noise[noise_index]);
+                noise[noise_index] = pvPortMalloc(8 + bench_random() % 600);
+                noise_index = (noise_index + 1) % BENCH_NOISE_COUNT;
+            }
+        }
+        vPortFree(buffer);
+    }
+    uint64_t time = bench_time_ns() - start;
+
+    for(size_t i = 0; i < BENCH_NOISE_COUNT; i++) {
+        vPortFree(noise[i]);
+    }
+    return time;
+}
+
+int main() {
+    // First allocation initializes heap
+    vPortFree(pvPortMalloc(1));
+    size_t free_before = xPortGetFreeHeapSize();
+
+    printf(
+        "%-26s %-12s %-12s %-10s %s\r\n",
+        "Workload",
+        "In place, us",
+        "Moving, us",
+        "Speedup",
+        "Kept/moved");
+    for(size_t i = 0; i < sizeof(bench_workloads) / sizeof(bench_workloads[0]); i++) {
+        const BenchWorkload* workload = &bench_workloads[i];
+
+        MemmgrHeapStats before, after;
+        memmgr_heap_get_stats(&before);
+        uint64_t time_in_place = bench_run(workload, bench_realloc_in_place);
+        memmgr_heap_get_stats(&after);
+        uint64_t time_move = bench_run(workload, bench_realloc_move);
+
+        printf(
+            "%-26s %-12.1f %-12.1f %-10.2f %" PRIu32 "/%" PRIu32 "\r\n",
+            workload->name,
+            time_in_place / 1000.0,
+            time_move / 1000.0,
+            time_in_place ? (double)time_move / time_in_place : 0.0,
+            after.realloc_in_place - before.realloc_in_place,
+            after.realloc_moved - before.realloc_moved);
+    }
+
+    size_t free_after = xPortGetFreeHeapSize();
+    if(free_after != free_before) {
+        printf("Leaked: %zu\r\n", free_before - free_after);
+        return 1;
+    }
+    return 0;
+}
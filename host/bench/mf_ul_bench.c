@@ -0,0 +1,430 @@
+/**
+ * Mifare Ultralight emulation benchmark: reader command traces replay
+ *
+ * Reader sessions are replayed against emulated dumps of Ultralight EV1,
+ * NTAG216 size and largest dump size. Each command response is checked
+ * against reference model of the tag, then every command is timed in a loop
+ * for response table lookup and for if/else decoding with copy it replaced,
+ * kept here as baseline. Worst command is what must fit in frame delay time,
+ * WRITE is shown apart as the only command that updates response table.
+ *
+ * Trace file has one reader command per line in hex, # starts comment.
+ */
+
+#include <nfc_protocols/mifare_ultralight.h>
+#include <toolbox/hex.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_TRACE_MAX 512
+#define BENCH_CMD_MAX 8
+#define BENCH_TX_MAX 1024
+#define BENCH_ROUNDS 256
+#define BENCH_BATCHES 32
+
+typedef struct {
+    uint8_t len;
+    uint8_t data[BENCH_CMD_MAX];
+} BenchCommand;
+
+typedef struct {
+    char name[64];
+    uint16_t len;
+    BenchCommand commands[BENCH_TRACE_MAX];
+} BenchTrace;
+
+typedef struct {
+    const char* name;
+    uint8_t storage_size;
+    uint16_t pages;
+} BenchDump;
+
+typedef struct {
+    double mean_ns;
+    double worst_ns;
+    uint8_t worst_cmd;
+    double write_ns; /**< worst WRITE, 0 if trace has none */
+} BenchTiming;
+
+static const BenchDump bench_dumps[] = {
+    {"ultralight ev1 48", 0x0B, 20},
+    {"ultralight ev1 128", 0x0E, 41},
+    {"ntag216 size", 0x13, 231},
+    {"max dump", 0x0E, MF_UL_MAX_DUMP_SIZE / MF_UL_PAGE_SIZE},
+};
+
+void furi_crash(const char* message) {
+    fprintf(stderr, "%s", message);
+    abort();
+}
+
+/* if/else decoding with copy into tx buffer, as it was before response table */
+static uint16_t legacy_prepare_emulation_response(
+    uint8_t* buff_rx,
+    uint16_t len_rx,
+    uint8_t* buff_tx,
+    MifareUlDevice* mf_ul_emulate) {
+    (void)len_rx;
+    uint8_t cmd = buff_rx[0];
+    uint16_t page_num = mf_ul_emulate->data.data_size / 4;
+    uint16_t tx_len = 0;
+
+    if(cmd == MF_UL_GET_VERSION_CMD) {
+        if(mf_ul_emulate->type != MfUltralightTypeUnknown) {
+            tx_len = sizeof(mf_ul_emulate->data.version);
+            memcpy(buff_tx, &mf_ul_emulate->data.version, tx_len);
+        }
+    } else if(cmd == MF_UL_READ_CMD) {
+        uint8_t start_page = buff_rx[1];
+        if(start_page < page_num) {
+            tx_len = 16;
+            if(start_page + 4 > page_num) {
+                // Handle roll-over mechanism
+                uint8_t end_pages_num = page_num - start_page;
+                memcpy(buff_tx, &mf_ul_emulate->data.data[start_page * 4], end_pages_num * 4);
+                memcpy(
+                    &buff_tx[end_pages_num * 4],
+                    mf_ul_emulate->data.data,
+                    (4 - end_pages_num) * 4);
+            } else {
+                memcpy(buff_tx, &mf_ul_emulate->data.data[start_page * 4], tx_len);
+            }
+        }
+    } else if(cmd == MF_UL_FAST_READ_CMD) {
+        if(mf_ul_emulate->support_fast_read) {
+            uint8_t start_page = buff_rx[1];
+            uint8_t end_page = buff_rx[2];
+            if((start_page < page_num) && (end_page < page_num) && (start_page < end_page)) {
+                tx_len = (end_page - start_page) * 4;
+                memcpy(buff_tx, &mf_ul_emulate->data.data[start_page * 4], tx_len);
+            }
+        }
+    } else if(cmd == MF_UL_WRITE) {
+        uint8_t write_page = buff_rx[1];
+        if((write_page > 1) && (write_page < page_num - 2)) {
+            memcpy(&mf_ul_emulate->data.data[write_page * 4], &buff_rx[2], 4);
+            mf_ul_emulate->data_changed = true;
+            buff_tx[0] = 0x0A;
+            tx_len = 1;
+        }
+    } else if(cmd == MF_UL_READ_CNT) {
+        uint8_t cnt_num = buff_rx[1];
+        if(cnt_num < 3) {
+            buff_tx[0] = mf_ul_emulate->data.counter[cnt_num] >> 16;
+            buff_tx[1] = mf_ul_emulate->data.counter[cnt_num] >> 8;
+            buff_tx[2] = mf_ul_emulate->data.counter[cnt_num];
+            tx_len = 3;
+        }
+    } else if(cmd == MF_UL_INC_CNT) {
+        uint8_t cnt_num = buff_rx[1];
+        uint32_t inc = (buff_rx[2] | (buff_rx[3] << 8) | (buff_rx[4] << 16));
+        if((cnt_num < 3) && (mf_ul_emulate->data.counter[cnt_num] + inc < 0x00FFFFFF)) {
+            mf_ul_emulate->data.counter[cnt_num] += inc;
+            mf_ul_emulate->data_changed = true;
+            buff_tx[0] = 0x0A;
+            tx_len = 1;
+        }
+    } else if(cmd == MF_UL_READ_SIG) {
+        if(buff_rx[1] == 0x00) {
+            tx_len = sizeof(mf_ul_emulate->data.signature);
+            memcpy(buff_tx, mf_ul_emulate->data.signature, tx_len);
+        }
+    } else if(cmd == MF_UL_CHECK_TEARING) {
+        uint8_t cnt_num = buff_rx[1];
+        if(cnt_num < 3) {
+            buff_tx[0] = mf_ul_emulate->data.tearing[cnt_num];
+            tx_len = 1;
+        }
+    }
+    return tx_len;
+}
+
+/* Tag as datasheet describes it, state is updated by WRITE and INC_CNT */
+static uint16_t bench_reference_response(const uint8_t* cmd, uint8_t* tx, MifareUlData* data) {
+    uint16_t page_num = data->data_size / MF_UL_PAGE_SIZE;
+    bool ev1 = data->version.storage_size == 0x0B || data->version.storage_size == 0x0E;
+    uint16_t len = 0;
+
+    if(cmd[0] == MF_UL_GET_VERSION_CMD && ev1) {
+        len = sizeof(data->version);
+        memcpy(tx, &data->version, len);
+    } else if(cmd[0] == MF_UL_READ_CMD && cmd[1] < page_num) {
+        for(uint8_t i = 0; i < MF_UL_READ_PAGES; i++) {
+            uint16_t page = (cmd[1] + i) % page_num;
+            memcpy(&tx[len], &data->data[page * MF_UL_PAGE_SIZE], MF_UL_PAGE_SIZE);
+            len += MF_UL_PAGE_SIZE;
+        }
+    } else if(cmd[0] == MF_UL_FAST_READ_CMD && ev1 && cmd[1] <= cmd[2] && cmd[2] < page_num) {
+        len = (cmd[2] - cmd[1] + 1) * MF_UL_PAGE_SIZE;
+        memcpy(tx, &data->data[cmd[1] * MF_UL_PAGE_SIZE], len);
+    } else if(cmd[0] == MF_UL_WRITE && cmd[1] > 1 && cmd[1] < page_num - 2) {
+        memcpy(&data->data[cmd[1] * MF_UL_PAGE_SIZE], &cmd[2], MF_UL_PAGE_SIZE);
+        tx[len++] = MF_UL_ACK;
+    } else if(cmd[0] == MF_UL_READ_CNT && cmd[1] < MF_UL_COUNTERS_NUM) {
+        for(uint8_t i = 0; i < 3; i++) {
+            tx[len++] = data->counter[cmd[1]] >> (8 * i);
+        }
+    } else if(cmd[0] == MF_UL_INC_CNT && cmd[1] < MF_UL_COUNTERS_NUM) {
+        uint32_t inc = cmd[2] | (cmd[3] << 8) | (cmd[4] << 16);
+        if(data->counter[cmd[1]] + inc < 0x00FFFFFF) {
+            data->counter[cmd[1]] += inc;
+            tx[len++] = MF_UL_ACK;
+        }
+    } else if(cmd[0] == MF_UL_READ_SIG && cmd[1] == 0) {
+        len = sizeof(data->signature);
+        memcpy(tx, data->signature, len);
+    } else if(cmd[0] == MF_UL_CHECK_TEARING && cmd[1] < MF_UL_COUNTERS_NUM) {
+        tx[len++] = data->tearing[cmd[1]];
+    }
+    return len;
+}
+
+static uint64_t bench_time_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void bench_dump_fill(MifareUlData* data, const BenchDump* dump) {
+    memset(data, 0, sizeof(MifareUlData));
+    data->version.header = 0x00;
+    data->version.vendor_id = 0x04;
+    data->version.prod_type = 0x03;
+    data->version.storage_size = dump->storage_size;
+    data->version.protocol_type = 0x03;
+    for(uint8_t i = 0; i < sizeof(data->signature); i++) {
+        data->signature[i] = i * 7 + 1;
+    }
+    data->counter[2] = 0x000123;
+    data->tearing[0] = data->tearing[1] = data->tearing[2] = MF_UL_TEARING_FLAG_DEFAULT;
+    data->data_size = dump->pages * MF_UL_PAGE_SIZE;
+    for(uint16_t i = 0; i < data->data_size; i++) {
+        data->data[i] = i * 13 + (i >> 8);
+    }
+}
+
+static void bench_trace_add(BenchTrace* trace, uint8_t len, const uint8_t* data) {
+    if(trace->len == BENCH_TRACE_MAX) return;
+    BenchCommand* command = &trace->commands[trace->len++];
+    command->len = len;
+    memcpy(command->data, data, len);
+}
+
+#define BENCH_CMD(trace, ...)                                              \
+    do {                                                                   \
+        const uint8_t cmd[] = {__VA_ARGS__};                               \
+        bench_trace_add(trace, sizeof(cmd), cmd);                          \
+    } while(0)
+
+/* Flipper reading EV1: version, signature, counters, then whole memory */
+static void bench_trace_flipper(BenchTrace* trace, uint16_t pages) {
+    snprintf(trace->name, sizeof(trace->name), "flipper read");
+    BENCH_CMD(trace, MF_UL_GET_VERSION_CMD);
+    BENCH_CMD(trace, MF_UL_READ_SIG, 0x00);
+    for(uint8_t i = 0; i < MF_UL_COUNTERS_NUM; i++) {
+        BENCH_CMD(trace, MF_UL_READ_CNT, i);
+        BENCH_CMD(trace, MF_UL_CHECK_TEARING, i);
+    }
+    BENCH_CMD(trace, MF_UL_FAST_READ_CMD, 0x00, pages - 1);
+}
+
+/* Plain READ of every window, last ones roll over to page 0 */
+static void bench_trace_read_all(BenchTrace* trace, uint16_t pages) {
+    snprintf(trace->name, sizeof(trace->name), "read all");
+    for(uint16_t page = 0; page < pages; page++) {
+        BENCH_CMD(trace, MF_UL_READ_CMD, page);
+    }
+}
+
+/* Ticket validator: read, count, stamp, read back across roll-over */
+static void bench_trace_validator(BenchTrace* trace, uint16_t pages) {
+    snprintf(trace->name, sizeof(trace->name), "validator");
+    BENCH_CMD(trace, MF_UL_GET_VERSION_CMD);
+    BENCH_CMD(trace, MF_UL_READ_CMD, 0x00);
+    BENCH_CMD(trace, MF_UL_READ_CMD, 0x04);
+    BENCH_CMD(trace, MF_UL_READ_CNT, 0x02);
+    BENCH_CMD(trace, MF_UL_INC_CNT, 0x02, 0x01, 0x00, 0x00, 0x00);
+    BENCH_CMD(trace, MF_UL_READ_CNT, 0x02);
+    BENCH_CMD(trace, MF_UL_WRITE, 0x02, 0x11, 0x22, 0x33, 0x44);
+    BENCH_CMD(trace, MF_UL_WRITE, pages - 3, 0xDE, 0xAD, 0xBE, 0xEF);
+    BENCH_CMD(trace, MF_UL_READ_CMD, pages - 3);
+    BENCH_CMD(trace, MF_UL_READ_CMD, pages - 1);
+    BENCH_CMD(trace, MF_UL_FAST_READ_CMD, 0x04, 0x07);
+    BENCH_CMD(trace, MF_UL_CHECK_TEARING, 0x02);
+}
+
+static bool bench_trace_load(BenchTrace* trace, const char* path) {
+    FILE* file = fopen(path, "r");
+    if(!file) return false;
+    memset(trace, 0, sizeof(BenchTrace));
+    snprintf(trace->name, sizeof(trace->name), "%s", path);
+
+    char line[256];
+    bool result = true;
+    while(result && fgets(line, sizeof(line), file)) {
+        char* comment = strchr(line, '#');
+        if(comment) *comment = '\0';
+        char hex[2 * BENCH_CMD_MAX + 1];
+        if(sscanf(line, "%16s", hex) != 1) continue;
+        uint8_t cmd[BENCH_CMD_MAX];
+        uint8_t len = 0;
+        for(const char* c = hex; c[0] && c[1] && result; c += 2) {
+            result = hex_chars_to_uint8(c[0], c[1], &cmd[len++]);
+        }
+        if(result) bench_trace_add(trace, len, cmd);
+    }
+    fclose(file);
+    return result;
+}
+
+/* Command buffer is reader FIFO sized, emulation may look past command end */
+static uint16_t bench_table_response(
+    const BenchCommand* command,
+    uint8_t** tx,
+    MifareUlDevice* device) {
+    uint8_t rx[BENCH_CMD_MAX] = {0};
+    memcpy(rx, command->data, command->len);
+    return mf_ul_prepare_emulation_response(rx, command->len, tx, device);
+}
+
+static bool bench_verify(const BenchTrace* trace, const MifareUlData* data) {
+    static MifareUlDevice device;
+    static MifareUlData reference;
+    mf_ul_prepare_emulation(&device, (MifareUlData*)data);
+    reference = *data;
+
+    for(uint16_t i = 0; i < trace->len; i++) {
+        uint8_t expected[BENCH_TX_MAX + 64];
+        uint8_t* tx;
+        uint8_t cmd[BENCH_CMD_MAX] = {0};
+        memcpy(cmd, trace->commands[i].data, trace->commands[i].len);
+        uint16_t expected_len = bench_reference_response(cmd, expected, &reference);
+        uint16_t tx_len = bench_table_response(&trace->commands[i], &tx, &device);
+        if(tx_len != expected_len || memcmp(tx, expected, tx_len)) {
+            printf(
+                "%s: command %u (%02X %02X) response %u bytes, expected %u\r\n",
+                trace->name,
+                i,
+                cmd[0],
+                cmd[1],
+                tx_len,
+                expected_len);
+            return false;
+        }
+    }
+    return true;
+}
+
+static void bench_time(
+    const BenchTrace* trace,
+    const MifareUlData* data,
+    bool table,
+    BenchTiming* timing) {
+    static MifareUlDevice device;
+    static uint8_t tx_buff[BENCH_TX_MAX + 64];
+    mf_ul_prepare_emulation(&device, (MifareUlData*)data);
+    memset(timing, 0, sizeof(BenchTiming));
+
+    double total_ns = 0;
+    for(uint16_t i = 0; i < trace->len; i++) {
+        const BenchCommand* command = &trace->commands[i];
+        uint8_t rx[BENCH_CMD_MAX] = {0};
+        memcpy(rx, command->data, command->len);
+        volatile uint16_t sink = 0;
+
+        // Best batch mean, scheduler and timer noise stay out of it
+        double command_ns = 1e12;
+        for(uint32_t batch = 0; batch < BENCH_BATCHES; batch++) {
+            uint64_t start = bench_time_ns();
+            for(uint32_t round = 0; round < BENCH_ROUNDS; round++) {
+                if(table) {
+                    // Response is sent from table, touch it like transceiver would
+                    uint8_t* tx;
+                    uint16_t tx_len =
+                        mf_ul_prepare_emulation_response(rx, command->len, &tx, &device);
+                    if(tx_len) sink += tx[0];
+                } else {
+                    sink += legacy_prepare_emulation_response(
+                        rx, command->len, tx_buff, &device);
+                }
+            }
+            double batch_ns = (double)(bench_time_ns() - start) / BENCH_ROUNDS;
+            if(batch_ns < command_ns) command_ns = batch_ns;
+        }
+
+        total_ns += command_ns;
+        if(rx[0] == MF_UL_WRITE && command_ns > timing->write_ns) {
+            timing->write_ns = command_ns;
+        }
+        if(command_ns > timing->worst_ns) {
+            timing->worst_ns = command_ns;
+            timing->worst_cmd = rx[0];
+        }
+    }
+    timing->mean_ns = trace->len ? total_ns / trace->len : 0;
+}
+
+static bool bench_run(const BenchTrace* trace, const BenchDump* dump, const MifareUlData* data) {
+    if(!bench_verify(trace, data)) return false;
+
+    BenchTiming table;
+    BenchTiming legacy;
+    bench_time(trace, data, true, &table);
+    bench_time(trace, data, false, &legacy);
+    printf(
+        "%-20s %-14s %5u %9.1f %9.1f (%02X) %9.1f %9.1f %9.1f (%02X) %9.1f\r\n",
+        dump->name,
+        trace->name,
+        trace->len,
+        table.mean_ns,
+        table.worst_ns,
+        table.worst_cmd,
+        table.write_ns,
+        legacy.mean_ns,
+        legacy.worst_ns,
+        legacy.worst_cmd,
+        legacy.write_ns);
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    static BenchTrace trace;
+    static MifareUlData data;
+    bool result = true;
+
+    printf(
+        "%-20s %-14s %5s %9s %14s %9s %9s %14s %9s\r\n",
+        "dump",
+        "trace",
+        "cmds",
+        "table ns",
+        "worst ns",
+        "write ns",
+        "copy ns",
+        "worst ns",
+        "write ns");
+    for(size_t i = 0; i < sizeof(bench_dumps) / sizeof(BenchDump) && result; i++) {
+        const BenchDump* dump = &bench_dumps[i];
+        bench_dump_fill(&data, dump);
+        void (*traces[])(BenchTrace*, uint16_t) = {
+            bench_trace_flipper, bench_trace_read_all, bench_trace_validator};
+        for(size_t j = 0; j < sizeof(traces) / sizeof(traces[0]) && result; j++) {
+            memset(&trace, 0, sizeof(BenchTrace));
+            traces[j](&trace, dump->pages);
+            result = bench_run(&trace, dump, &data);
+        }
+        for(int j = 1; j < argc && result; j++) {
+            if(!bench_trace_load(&trace, argv[j])) {
+                printf("Cannot load trace %s\r\n", argv[j]);
+                return 1;
+            }
+            result = bench_run(&trace, dump, &data);
+        }
+    }
+    return result ? 0 : 1;
+}
@@ -0,0 +1,543 @@
+/**
+ * NFC dump loading benchmark: text key file against binary sidecar dump
+ *
+ * Mifare Ultralight dumps of 64 to 1024 pages are saved the way nfc_device
+ * does: text key file with one "Page N" key per page and binary dump next to
+ * it. Pages are loaded back with flipper_file key lookup, kept here as
+ * baseline over stdio, and from binary dump. Dump loader reads text file in
+ * 512 byte chunks to check its CRC. Storage calls are counted as well as
+ * time, on device every call is a message to storage thread.
+ *
+ * Both loaders must give the same data, damaged dump and dump of text file
+ * edited in place or resized must be rejected.
+ */
+
+#include <nfc_protocols/mifare_ultralight_dump.h>
+#include <toolbox/hex.h>
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_KEY_MAX 64
+#define BENCH_VALUE_MAX 16
+#define BENCH_ROUNDS 32
+/* NFC_DEVICE_SOURCE_CRC_CHUNK */
+#define BENCH_SOURCE_CRC_CHUNK 512
+
+typedef struct {
+    FILE* fp;
+    uint64_t size;
+    uint32_t reads;
+    uint32_t seeks;
+} BenchFile;
+
+typedef struct {
+    double us;
+    uint32_t calls;
+} BenchResult;
+
+static const uint16_t bench_pages[] = {64, 128, 256, 512, 1024};
+
+static const char bench_eoln = '\n';
+static const char bench_eolr = '\r';
+static const char bench_delimiter = ':';
+static const char bench_comment = '#';
+
+static double bench_now_us() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+/* storage_file_* calls over stdio */
+static bool bench_file_open(BenchFile* file, const char* path) {
+    memset(file, 0, sizeof(BenchFile));
+    file->fp = fopen(path, "rb");
+    if(!file->fp) return false;
+    fseek(file->fp, 0, SEEK_END);
+    file->size = ftell(file->fp);
+    fseek(file->fp, 0, SEEK_SET);
+    return true;
+}
+
+static void bench_file_close(BenchFile* file) {
+    if(file->fp) fclose(file->fp);
+    file->fp = NULL;
+}
+
+static uint16_t bench_file_read(BenchFile* file, void* buff, uint16_t bytes_to_read) {
+    file->reads++;
+    return fread(buff, 1, bytes_to_read, file->fp);
+}
+
+static bool bench_file_seek(BenchFile* file, uint32_t offset) {
+    file->seeks++;
+    return fseek(file->fp, offset, SEEK_SET) == 0;
+}
+
+static bool bench_file_eof(BenchFile* file) {
+    return (uint64_t)ftell(file->fp) >= file->size;
+}
+
+static bool bench_helper_seek(BenchFile* file, int32_t offset) {
+    return bench_file_seek(file, ftell(file->fp) + offset);
+}
+
+/* flipper_file_read_valid_key, m-string replaced with fixed buffer */
+static bool legacy_read_valid_key(BenchFile* file, char* key) {
+    uint8_t key_len = 0;
+    bool found = false;
+    bool error = false;
+    const uint8_t buffer_size = 32;
+    uint8_t buffer[buffer_size];
+    bool accumulate = true;
+    bool new_line = true;
+
+    key[0] = 0;
+    while(true) {
+        uint16_t bytes_were_read = bench_file_read(file, buffer, buffer_size);
+        if(bytes_were_read == 0) break;
+
+        for(uint16_t i = 0; i < bytes_were_read; i++) {
+            if(buffer[i] == bench_eoln) {
+                key_len = 0;
+                accumulate = true;
+                new_line = true;
+            } else if(buffer[i] == bench_eolr) {
+            } else if(buffer[i] == bench_comment && new_line) {
+                accumulate = false;
+                new_line = false;
+            } else if(buffer[i] == bench_delimiter) {
+                if(new_line) {
+                    key_len = 0;
+                    accumulate = false;
+                    new_line = false;
+                } else if(accumulate) {
+                    if(!bench_helper_seek(file, i - bytes_were_read)) {
+                        error = true;
+                        break;
+                    }
+                    found = true;
+                    break;
+                }
+            } else {
+                new_line = false;
+                if(accumulate && key_len < BENCH_KEY_MAX - 1) {
+                    key[key_len++] = buffer[i];
+                }
+            }
+        }
+        key[key_len] = 0;
+
+        if(found || error) break;
+    }
+
+    return found;
+}
+
+/* flipper_file_seek_to_key */
+static bool legacy_seek_to_key(BenchFile* file, const char* key) {
+    bool found = false;
+    char readed_key[BENCH_KEY_MAX];
+
+    while(!bench_file_eof(file)) {
+        if(legacy_read_valid_key(file, readed_key)) {
+            if(strcmp(readed_key, key) == 0) {
+                if(!bench_helper_seek(file, 2)) break;
+                found = true;
+                break;
+            }
+        }
+    }
+
+    return found;
+}
+
+/* file_helper_read_value */
+static bool legacy_read_value(BenchFile* file, char* value, bool* last) {
+    uint8_t value_len = 0;
+    const uint8_t buffer_size = 32;
+    uint8_t buffer[buffer_size];
+    bool result = false;
+    bool error = false;
+
+    while(true) {
+        uint16_t bytes_were_read = bench_file_read(file, buffer, buffer_size);
+
+        if(bytes_were_read == 0) {
+            if(bench_file_eof(file) && value_len > 0) {
+                result = true;
+                *last = true;
+                break;
+            }
+        }
+
+        for(uint16_t i = 0; i < bytes_were_read; i++) {
+            if(buffer[i] == bench_eoln) {
+                if(value_len > 0) {
+                    if(!bench_helper_seek(file, i - bytes_were_read)) {
+                        error = true;
+                        break;
+                    }
+                    result = true;
+                    *last = true;
+                    break;
+                } else {
+                    error = true;
+                }
+            } else if(buffer[i] == ' ') {
+                if(value_len > 0) {
+                    if(!bench_helper_seek(file, i - bytes_were_read)) {
+                        error = true;
+                        break;
+                    }
+                    result = true;
+                    *last = false;
+                    break;
+                }
+            } else if(buffer[i] == bench_eolr) {
+            } else if(value_len < BENCH_VALUE_MAX - 1) {
+                value[value_len++] = buffer[i];
+            }
+        }
+
+        if(error || result) break;
+    }
+    value[value_len] = 0;
+
+    return result;
+}
+
+/* flipper_file_read_internal for hex and uint32 values */
+static bool legacy_read_values(
+    BenchFile* file,
+    const char* key,
+    void* _data,
+    uint16_t data_size,
+    bool hex) {
+    bool result = false;
+    char value[BENCH_VALUE_MAX];
+
+    if(legacy_seek_to_key(file, key)) {
+        result = true;
+        for(uint16_t i = 0; i < data_size; i++) {
+            bool last = false;
+            result = legacy_read_value(file, value, &last);
+            if(!result) break;
+            int scan_values = 0;
+            if(hex) {
+                scan_values = hex_chars_to_uint8(value[0], value[1], &((uint8_t*)_data)[i]);
+            } else {
+                scan_values = sscanf(value, "%" SCNu32, &((uint32_t*)_data)[i]);
+            }
+            if(scan_values != 1 || (last && (i + 1) != data_size)) {
+                result = false;
+                break;
+            }
+        }
+    }
+
+    return result;
+}
+
+/* nfc_device_load_mifare_ul_data */
+static bool legacy_load_mifare_ul_data(BenchFile* file, MifareUlData* data) {
+    char key[BENCH_KEY_MAX];
+
+    if(!legacy_read_values(file, "Signature", data->signature, sizeof(data->signature), true))
+        return false;
+    if(!legacy_read_values(
+           file, "Mifare version", (uint8_t*)&data->version, sizeof(data->version), true))
+        return false;
+    for(uint8_t i = 0; i < 3; i++) {
+        snprintf(key, sizeof(key), "Counter %d", i);
+        if(!legacy_read_values(file, key, &data->counter[i], 1, false)) return false;
+        snprintf(key, sizeof(key), "Tearing %d", i);
+        if(!legacy_read_values(file, key, &data->tearing[i], 1, true)) return false;
+    }
+    uint32_t pages = 0;
+    if(!legacy_read_values(file, "Pages total", &pages, 1, false)) return false;
+    if(pages > MF_UL_MAX_DUMP_SIZE / 4) return false;
+    data->data_size = pages * 4;
+    for(uint16_t i = 0; i < pages; i++) {
+        snprintf(key, sizeof(key), "Page %d", i);
+        if(!legacy_read_values(file, key, &data->data[i * 4], 4, true)) return false;
+    }
+    return true;
+}
+
+/* nfc_device_get_source_crc */
+static bool bench_source_crc(BenchFile* source, uint32_t* crc) {
+    if(source->size == 0 || source->size > MF_UL_DUMP_SOURCE_SIZE_MAX) return false;
+
+    uint8_t chunk[BENCH_SOURCE_CRC_CHUNK];
+    uint32_t left = source->size;
+    uint32_t source_crc = 0;
+    uint32_t position = ftell(source->fp);
+    if(bench_file_seek(source, 0)) {
+        while(left) {
+            uint16_t chunk_size = left < sizeof(chunk) ? left : sizeof(chunk);
+            if(bench_file_read(source, chunk, chunk_size) != chunk_size) break;
+            source_crc = mf_ul_dump_source_crc(source_crc, chunk, chunk_size);
+            left -= chunk_size;
+        }
+    }
+    if(!left) *crc = source_crc;
+
+    return bench_file_seek(source, position) && !left;
+}
+
+/* nfc_device_load_mifare_ul_dump */
+static bool bench_load_mifare_ul_dump(BenchFile* file, BenchFile* source, MifareUlData* data) {
+    MfUltralightDumpHeader header;
+    if(bench_file_read(file, &header, sizeof(header)) != sizeof(header)) return false;
+    if(header.source_size != source->size) return false;
+    uint32_t source_crc;
+    if(!bench_source_crc(source, &source_crc)) return false;
+    if(header.source_crc != source_crc) return false;
+    if(!mf_ul_dump_parse_header(&header, data)) return false;
+    if(bench_file_read(file, data->data, data->data_size) != data->data_size) return false;
+    return mf_ul_dump_check(&header, data);
+}
+
+static void bench_write_hex(FILE* fp, const char* key, const uint8_t* data, uint16_t len) {
+    fprintf(fp, "%s: ", key);
+    for(uint16_t i = 0; i < len; i++) {
+        fprintf(fp, i ? " %02X" : "%02X", data[i]);
+    }
+    fputc('\n', fp);
+}
+
+/* Same keys and order as nfc_device_save_file */
+static uint64_t bench_save_text(const char* path, MifareUlData* data) {
+    FILE* fp = fopen(path, "wb");
+    if(!fp) return 0;
+    const uint8_t uid[7] = {0x04, 0x85, 0x92, 0x8A, 0xA0, 0x61, 0x81};
+    const uint8_t atqa[2] = {0x00, 0x44};
+    const uint8_t sak = 0x00;
+    char key[BENCH_KEY_MAX];
+
+    fprintf(fp, "Filetype: Flipper NFC device\nVersion: 2\n");
+    fprintf(fp, "# Nfc device type can be UID, Mifare Ultralight, Bank card\n");
+    fprintf(fp, "Device type: Mifare Ultralight\n");
+    fprintf(fp, "# UID, ATQA and SAK are common for all formats\n");
+    bench_write_hex(fp, "UID", uid, sizeof(uid));
+    bench_write_hex(fp, "ATQA", atqa, sizeof(atqa));
+    bench_write_hex(fp, "SAK", &sak, 1);
+    fprintf(fp, "# Mifare Ultralight specific data\n");
+    bench_write_hex(fp, "Signature", data->signature, sizeof(data->signature));
+    bench_write_hex(fp, "Mifare version", (uint8_t*)&data->version, sizeof(data->version));
+    for(uint8_t i = 0; i < 3; i++) {
+        fprintf(fp, "Counter %d: %" PRIu32 "\n", i, data->counter[i]);
+        snprintf(key, sizeof(key), "Tearing %d", i);
+        bench_write_hex(fp, key, &data->tearing[i], 1);
+    }
+    fprintf(fp, "Pages total: %d\n", data->data_size / 4);
+    for(uint16_t i = 0; i < data->data_size; i += 4) {
+        snprintf(key, sizeof(key), "Page %d", i / 4);
+        bench_write_hex(fp, key, &data->data[i], 4);
+    }
+    uint64_t size = ftell(fp);
+    fclose(fp);
+    return size;
+}
+
+/* nfc_device_save_mifare_ul_dump, called after text file is written */
+static bool bench_save_dump(const char* path, const char* source_path, MifareUlData* data) {
+    BenchFile source;
+    if(!bench_file_open(&source, source_path)) return false;
+    uint32_t source_crc;
+    bool read = bench_source_crc(&source, &source_crc);
+    bench_file_close(&source);
+    if(!read) return false;
+
+    MfUltralightDumpHeader header;
+    mf_ul_dump_prepare_header(&header, data, source.size, source_crc);
+    FILE* fp = fopen(path, "wb");
+    if(!fp) return false;
+    bool saved = fwrite(&header, sizeof(header), 1, fp) == 1 &&
+                 fwrite(data->data, data->data_size, 1, fp) == 1;
+    fclose(fp);
+    return saved;
+}
+
+static void bench_fill_data(MifareUlData* data, uint16_t pages) {
+    memset(data, 0, sizeof(MifareUlData));
+    data->version.header = 0x00;
+    data->version.vendor_id = 0x04;
+    data->version.prod_type = 0x04;
+    data->version.prod_subtype = 0x02;
+    data->version.prod_ver_major = 0x01;
+    data->version.storage_size = 0x13;
+    data->version.protocol_type = 0x03;
+    for(uint8_t i = 0; i < sizeof(data->signature); i++) {
+        data->signature[i] = rand();
+    }
+    for(uint8_t i = 0; i < 3; i++) {
+        data->counter[i] = rand() & 0xFFFFFF;
+        data->tearing[i] = MF_UL_TEARING_FLAG_DEFAULT;
+    }
+    data->data_size = pages * 4;
+    for(uint16_t i = 0; i < data->data_size; i++) {
+        data->data[i] = rand();
+    }
+}
+
+static bool bench_data_equal(MifareUlData* a, MifareUlData* b) {
+    return !memcmp(&a->version, &b->version, sizeof(a->version)) &&
+           !memcmp(a->signature, b->signature, sizeof(a->signature)) &&
+           !memcmp(a->counter, b->counter, sizeof(a->counter)) &&
+           !memcmp(a->tearing, b->tearing, sizeof(a->tearing)) && a->data_size == b->data_size &&
+           !memcmp(a->data, b->data, a->data_size);
+}
+
+/* Best of rounds, both loaders start after common keys like nfc_device_load_data */
+static bool bench_load(
+    const char* text_path,
+    const char* dump_path,
+    MifareUlData* data,
+    BenchResult* result) {
+    result->us = 0;
+    for(uint16_t round = 0; round < BENCH_ROUNDS; round++) {
+        BenchFile text;
+        BenchFile file;
+        if(!bench_file_open(&text, text_path)) return false;
+        if(dump_path && !bench_file_open(&file, dump_path)) {
+            bench_file_close(&text);
+            return false;
+        }
+        char value[BENCH_VALUE_MAX];
+        bool last = false;
+        bool loaded = legacy_seek_to_key(&text, "SAK") && legacy_read_value(&text, value, &last);
+        text.reads = 0;
+        text.seeks = 0;
+        double start = bench_now_us();
+        if(dump_path) {
+            loaded = loaded && bench_load_mifare_ul_dump(&file, &text, data);
+        } else {
+            loaded = loaded && legacy_load_mifare_ul_data(&text, data);
+        }
+        double us = bench_now_us() - start;
+        result->calls = text.reads + text.seeks;
+        bench_file_close(&text);
+        if(dump_path) {
+            result->calls += file.reads + file.seeks;
+            bench_file_close(&file);
+        }
+        if(!loaded) return false;
+        if(round == 0 || us < result->us) result->us = us;
+    }
+    return true;
+}
+
+static bool bench_corrupt(const char* path, long offset) {
+    FILE* fp = fopen(path, "r+b");
+    if(!fp) return false;
+    fseek(fp, offset, SEEK_SET);
+    int c = fgetc(fp);
+    fseek(fp, offset, SEEK_SET);
+    fputc(c ^ 0x01, fp);
+    fclose(fp);
+    return true;
+}
+
+static bool bench_append(const char* path) {
+    FILE* fp = fopen(path, "ab");
+    if(!fp) return false;
+    fputc('\n', fp);
+    fclose(fp);
+    return true;
+}
+
+static bool
+    bench_check_rejected(const char* text_path, const char* dump_path, MifareUlData* data) {
+    BenchFile text;
+    BenchFile file;
+    if(!bench_file_open(&text, text_path)) return false;
+    if(!bench_file_open(&file, dump_path)) {
+        bench_file_close(&text);
+        return false;
+    }
+    bool loaded = bench_load_mifare_ul_dump(&file, &text, data);
+    bench_file_close(&file);
+    bench_file_close(&text);
+    return !loaded;
+}
+
+int main(int argc, char** argv) {
+    const char* dir = argc > 1 ? argv[1] : "/tmp";
+    char text_path[256];
+    char dump_path[256];
+    static MifareUlData saved;
+    static MifareUlData loaded;
+    bool ok = true;
+
+    srand(1);
+    printf("pages  text bytes  text us  calls   dump us  calls  speedup\n");
+    for(size_t i = 0; i < sizeof(bench_pages) / sizeof(bench_pages[0]); i++) {
+        uint16_t pages = bench_pages[i];
+        if(pages > MF_UL_MAX_DUMP_SIZE / 4) break;
+        snprintf(text_path, sizeof(text_path), "%s/nfc_dump_bench_%d.nfc", dir, pages);
+        snprintf(dump_path, sizeof(dump_path), "%s/nfc_dump_bench_%d.nfb", dir, pages);
+
+        bench_fill_data(&saved, pages);
+        uint64_t source_size = bench_save_text(text_path, &saved);
+        if(!source_size || !bench_save_dump(dump_path, text_path, &saved)) {
+            fprintf(stderr, "can't write dumps to %s\n", dir);
+            return 1;
+        }
+
+        BenchResult text;
+        BenchResult dump;
+        if(!bench_load(text_path, NULL, &loaded, &text) ||
+           !bench_data_equal(&saved, &loaded)) {
+            printf("%5d  text loader failed\n", pages);
+            ok = false;
+            continue;
+        }
+        if(!bench_load(text_path, dump_path, &loaded, &dump) ||
+           !bench_data_equal(&saved, &loaded)) {
+            printf("%5d  dump loader failed\n", pages);
+            ok = false;
+            continue;
+        }
+        printf(
+            "%5d  %10" PRIu64 "  %7.1f  %5" PRIu32 "  %8.1f  %5" PRIu32 "  %6.0fx\n",
+            pages,
+            source_size,
+            text.us,
+            text.calls,
+            dump.us,
+            dump.calls,
+            text.us / dump.us);
+
+        // Edited text file and damaged page must fall back to text loader.
+        // Page value in the middle of text file is changed keeping its size.
+        bench_corrupt(text_path, source_size / 2);
+        if(!bench_check_rejected(text_path, dump_path, &loaded)) {
+            printf("%5d  dump of text file edited in place accepted\n", pages);
+            ok = false;
+        }
+        bench_corrupt(text_path, source_size / 2);
+        bench_append(text_path);
+        if(!bench_check_rejected(text_path, dump_path, &loaded)) {
+            printf("%5d  dump of resized text file accepted\n", pages);
+            ok = false;
+        }
+        bench_save_dump(dump_path, text_path, &saved);
+        bench_corrupt(dump_path, sizeof(MfUltralightDumpHeader) + saved.data_size / 2);
+        if(!bench_check_rejected(text_path, dump_path, &loaded)) {
+            printf("%5d  damaged dump accepted\n", pages);
+            ok = false;
+        }
+        remove(text_path);
+        remove(dump_path);
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,250 @@
+/**
+ * Pubsub contention benchmark: publish throughput under subscribe churn
+ *
+ * Several publisher threads call furi_pubsub_publish in a loop while one more
+ * thread keeps subscribing and unsubscribing. Same load runs against a mutex
+ * protected subscriber list, which is how furi_pubsub worked before, so both
+ * numbers come from the same machine and the same run.
+ */
+
+#include <furi/pubsub.h>
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define BENCH_PUBLISHERS 4
+#define BENCH_SUBSCRIBERS_MAX 16
+#define BENCH_DURATION_MS 300
+/* Work done by every callback, keeps callbacks from being free */
+#define BENCH_CALLBACK_SPIN 64
+
+typedef struct {
+    void* (*alloc)(void);
+    void (*free)(void* pubsub);
+    void* (*subscribe)(void* pubsub, FuriPubSubCallback callback, void* context);
+    void (*unsubscribe)(void* pubsub, void* subscription);
+    void (*publish)(void* pubsub, void* message);
+} BenchPubSubApi;
+
+typedef struct {
+    const BenchPubSubApi* api;
+    void* pubsub;
+    atomic_bool running;
+    atomic_ulong publishes;
+    atomic_ulong churns;
+} BenchContext;
+
+/* Baseline: subscriber list and callbacks under one mutex */
+typedef struct BenchMutexItem {
+    FuriPubSubCallback callback;
+    void* context;
+    struct BenchMutexItem* next;
+} BenchMutexItem;
+
+typedef struct {
+    pthread_mutex_t mutex;
+    BenchMutexItem* items;
+} BenchMutexPubSub;
+
+void furi_crash(const char* message) {
+    fprintf(stderr, "%s", message);
+    abort();
+}
+
+void* furi_alloc(size_t size) {
+    void* pointer = calloc(1, size);
+    if(!pointer) furi_crash("furi_alloc failed\r\n");
+    return pointer;
+}
+
+static uint64_t bench_time_ms() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000ULL + now.tv_nsec / 1000000ULL;
+}
+
+static void* bench_mutex_alloc(void) {
+    BenchMutexPubSub* pubsub = furi_alloc(sizeof(BenchMutexPubSub));
+    pthread_mutex_init(&pubsub->mutex, NULL);
+    return pubsub;
+}
+
+static void bench_mutex_free(void* context) {
+    BenchMutexPubSub* pubsub = context;
+    pthread_mutex_destroy(&pubsub->mutex);
+    free(pubsub);
+}
+
+static void* bench_mutex_subscribe(void* context, FuriPubSubCallback callback, void* cb_context) {
+    BenchMutexPubSub* pubsub = context;
+    BenchMutexItem* item = furi_alloc(sizeof(BenchMutexItem));
+    item->callback = callback;
+    item->context = cb_context;
+    pthread_mutex_lock(&pubsub->mutex);
+    item->next = pubsub->items;
+    pubsub->items = item;
+    pthread_mutex_unlock(&pubsub->mutex);
+    return item;
+}
+
+static void bench_mutex_unsubscribe(void* context, void* subscription) {
+    BenchMutexPubSub* pubsub = context;
+    pthread_mutex_lock(&pubsub->mutex);
+    for(BenchMutexItem** item = &pubsub->items; *item; item = &(*item)->next) {
+        if(*item == subscription) {
+            *item = (*item)->next;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&pubsub->mutex);
+    free(subscription);
+}
+
+static void bench_mutex_publish(void* context, void* message) {
+    BenchMutexPubSub* pubsub = context;
+    pthread_mutex_lock(&pubsub->mutex);
+    for(BenchMutexItem* item = pubsub->items; item; item = item->next) {
+        item->callback(message, item->context);
+    }
+    pthread_mutex_unlock(&pubsub->mutex);
+}
+
+static const BenchPubSubApi bench_mutex_api = {
+    .alloc = bench_mutex_alloc,
+    .free = bench_mutex_free,
+    .subscribe = bench_mutex_subscribe,
+    .unsubscribe = bench_mutex_unsubscribe,
+    .publish = bench_mutex_publish,
+};
+
+static void* bench_furi_alloc(void) {
+    return furi_pubsub_alloc();
+}
+
+static void bench_furi_free(void* pubsub) {
+    furi_pubsub_free(pubsub);
+}
+
+static void* bench_furi_subscribe(void* pubsub, FuriPubSubCallback callback, void* cb_context) {
+    return furi_pubsub_subscribe(pubsub, callback, cb_context);
+}
+
+static void bench_furi_unsubscribe(void* pubsub, void* subscription) {
+    furi_pubsub_unsubscribe(pubsub, subscription);
+}
+
+static void bench_furi_publish(void* pubsub, void* message) {
+    furi_pubsub_publish(pubsub, message);
+}
+
+static const BenchPubSubApi bench_furi_api = {
+    .alloc = bench_furi_alloc,
+    .free = bench_furi_free,
+    .subscribe = bench_furi_subscribe,
+    .unsubscribe = bench_furi_unsubscribe,
+    .publish = bench_furi_publish,
+};
+
+static void bench_callback(const void* message, void* context) {
+    volatile uint32_t value = *(const uint32_t*)message;
+    for(size_t i = 0; i < BENCH_CALLBACK_SPIN; i++) {
+        value = value * 31 + i;
+    }
+    atomic_fetch_add((atomic_ulong*)context, 1);
+}
+
+static void* bench_publisher(void* context) {
+    BenchContext* bench = context;
+    uint32_t message = 0;
+    unsigned long publishes = 0;
+    while(atomic_load(&bench->running)) {
+        message++;
+        bench->api->publish(bench->pubsub, &message);
+        publishes++;
+    }
+    atomic_fetch_add(&bench->publishes, publishes);
+    return NULL;
+}
+
+static void* bench_churn(void* context) {
+    BenchContext* bench = context;
+    atomic_ulong calls = 0;
+    unsigned long churns = 0;
+    while(atomic_load(&bench->running)) {
+        void* subscription = bench->api->subscribe(bench->pubsub, bench_callback, &calls);
+        bench->api->unsubscribe(bench->pubsub, subscription);
+        churns++;
+    }
+    atomic_fetch_add(&bench->churns, churns);
+    return NULL;
+}
+
+/* Returns publishes per millisecond, churns are reported through pointer */
+static double bench_run(const BenchPubSubApi* api, size_t subscribers, double* churn_rate) {
+    BenchContext bench = {.api = api, .pubsub = api->alloc()};
+    atomic_init(&bench.running, true);
+    atomic_init(&bench.publishes, 0);
+    atomic_init(&bench.churns, 0);
+
+    atomic_ulong calls = 0;
+    void* subscriptions[BENCH_SUBSCRIBERS_MAX];
+    for(size_t i = 0; i < subscribers; i++) {
+        subscriptions[i] = api->subscribe(bench.pubsub, bench_callback, &calls);
+    }
+
+    pthread_t publishers[BENCH_PUBLISHERS];
+    pthread_t churn;
+    uint64_t start = bench_time_ms();
+    for(size_t i = 0; i < BENCH_PUBLISHERS; i++) {
+        pthread_create(&publishers[i], NULL, bench_publisher, &bench);
+    }
+    pthread_create(&churn, NULL, bench_churn, &bench);
+
+    usleep(BENCH_DURATION_MS * 1000);
+    atomic_store(&bench.running, false);
+    for(size_t i = 0; i < BENCH_PUBLISHERS; i++) {
+        pthread_join(publishers[i], NULL);
+    }
+    pthread_join(churn, NULL);
+    uint64_t time = bench_time_ms() - start;
+
+    for(size_t i = 0; i < subscribers; i++) {
+        api->unsubscribe(bench.pubsub, subscriptions[i]);
+    }
+    api->free(bench.pubsub);
+
+    *churn_rate = (double)atomic_load(&bench.churns) / time;
+    return (double)atomic_load(&bench.publishes) / time;
+}
+
+int main() {
+    printf(
+        "%-12s %-14s %-14s %-10s %-14s %s\r\n",
+        "Subscribers",
+        "RCU, pub/ms",
+        "Mutex, pub/ms",
+        "Speedup",
+        "RCU, churn/ms",
+        "Mutex, churn/ms");
+    for(size_t subscribers = 1; subscribers <= BENCH_SUBSCRIBERS_MAX; subscribers *= 2) {
+        double churn_furi, churn_mutex;
+        double publish_furi = bench_run(&bench_furi_api, subscribers, &churn_furi);
+        double publish_mutex = bench_run(&bench_mutex_api, subscribers, &churn_mutex);
+        printf(
+            "%-12zu %-14.1f %-14.1f %-10.2f %-14.2f %.2f\r\n",
+            subscribers,
+            publish_furi,
+            publish_mutex,
+            publish_mutex > 0 ? publish_furi / publish_mutex : 0.0,
+            churn_furi,
+            churn_mutex);
+    }
+    return 0;
+}
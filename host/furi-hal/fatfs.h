@@ -0,0 +1,8 @@
+#pragma once
+
+/* Host has no FatFs, only filesystem type ids used by storage SD API */
+
+#define FS_FAT12 1
+#define FS_FAT16 2
+#define FS_FAT32 3
+#define FS_EXFAT 4
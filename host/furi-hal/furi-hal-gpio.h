@@ -0,0 +1,18 @@
+#pragma once
+#include "main.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Host has no GPIO, pins only exist so shared headers keep compiling */
+typedef struct {
+    void* port;
+    uint16_t pin;
+} GpioPin;
+
+#ifdef __cplusplus
+}
+#endif
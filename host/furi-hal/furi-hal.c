@@ -0,0 +1,141 @@
+#include <furi-hal.h>
+#include <furi.h>
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+static __thread uint32_t furi_hal_primask = 0;
+static atomic_bool furi_hal_console_alive = true;
+static atomic_uint furi_hal_power_insomnia = 0;
+
+void furi_hal_init() {
+    furi_hal_delay_init();
+    furi_hal_console_init();
+}
+
+/******************* CMSIS core *******************/
+
+void __disable_irq(void) {
+    furi_hal_primask = 1;
+}
+
+void __enable_irq(void) {
+    furi_hal_primask = 0;
+}
+
+uint32_t __get_PRIMASK(void) {
+    return furi_hal_primask;
+}
+
+void __set_PRIMASK(uint32_t primask) {
+    furi_hal_primask = primask;
+}
+
+uint32_t __get_IPSR(void) {
+    return 0;
+}
+
+uint32_t HAL_GetTick(void) {
+    return osKernelGetTickCount();
+}
+
+bool task_is_isr_context(void) {
+    return false;
+}
+
+/******************* Delay *******************/
+
+void furi_hal_delay_init(void) {
+}
+
+void delay(float milliseconds) {
+    delay_us(milliseconds * 1000.0f);
+}
+
+void delay_us(float microseconds) {
+    struct timespec time = {
+        .tv_sec = (time_t)(microseconds / 1000000.0f),
+        .tv_nsec = (long)((uint64_t)(microseconds * 1000.0f) % 1000000000ULL),
+    };
+    while(nanosleep(&time, &time) != 0) {
+    }
+}
+
+uint32_t millis(void) {
+    return HAL_GetTick();
+}
+
+/* Nanoseconds pose as cycles of 1GHz core */
+uint32_t furi_hal_delay_get_cycles(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint32_t)((uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec);
+}
+
+uint32_t furi_hal_delay_get_cycles_per_us(void) {
+    return 1000;
+}
+
+/******************* Console *******************/
+
+void furi_hal_console_init() {
+    furi_hal_console_alive = true;
+}
+
+void furi_hal_console_enable() {
+    furi_hal_console_alive = true;
+}
+
+void furi_hal_console_disable() {
+    furi_hal_console_alive = false;
+}
+
+void furi_hal_console_tx(const uint8_t* buffer, size_t buffer_size) {
+    if(!furi_hal_console_alive) return;
+
+    // Raw write: stdout is routed back here by stdglue
+    while(buffer_size > 0) {
+        ssize_t written = write(STDOUT_FILENO, buffer, buffer_size);
+        if(written <= 0) break;
+        buffer += written;
+        buffer_size -= written;
+    }
+}
+
+void furi_hal_console_tx_with_new_line(const uint8_t* buffer, size_t buffer_size) {
+    furi_hal_console_tx(buffer, buffer_size);
+    furi_hal_console_tx((const uint8_t*)"\r\n", 2);
+}
+
+void furi_hal_console_printf(const char format[], ...) {
+    string_t string;
+    va_list args;
+    va_start(args, format);
+    string_init_vprintf(string, format, args);
+    va_end(args);
+    furi_hal_console_tx((const uint8_t*)string_get_cstr(string), string_size(string));
+    string_clear(string);
+}
+
+void furi_hal_console_puts(const char* data) {
+    furi_hal_console_tx((const uint8_t*)data, strlen(data));
+}
+
+/******************* Power *******************/
+
+uint16_t furi_hal_power_insomnia_level() {
+    return atomic_load(&furi_hal_power_insomnia);
+}
+
+void furi_hal_power_insomnia_enter() {
+    atomic_fetch_add(&furi_hal_power_insomnia, 1);
+}
+
+void furi_hal_power_insomnia_exit() {
+    furi_check(atomic_load(&furi_hal_power_insomnia) > 0);
+    atomic_fetch_sub(&furi_hal_power_insomnia, 1);
+}
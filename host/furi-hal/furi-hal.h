@@ -0,0 +1,23 @@
+/**
+ * @file furi-hal.h
+ * Furi HAL API, host subset
+ */
+
+#pragma once
+
+#include "furi-hal-console.h"
+#include "furi-hal-gpio.h"
+#include "furi-hal-delay.h"
+#include "furi-hal-task.h"
+#include "furi-hal-power.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Init furi-hal */
+void furi_hal_init();
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,27 @@
+#pragma once
+
+/* Host replacement for CubeMX main.h: CMSIS core intrinsics and HAL tick */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define __NOP() ((void)0)
+#define __DMB() __sync_synchronize()
+#define __DSB() __sync_synchronize()
+#define __ISB() __sync_synchronize()
+
+/* There are no interrupts on host, masking is tracked but has no effect */
+void __disable_irq(void);
+void __enable_irq(void);
+uint32_t __get_PRIMASK(void);
+void __set_PRIMASK(uint32_t primask);
+uint32_t __get_IPSR(void);
+
+uint32_t HAL_GetTick(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,42 @@
+/**
+ * @file FreeRTOS.h
+ * Host: FreeRTOS definitions used by sources that talk to the kernel directly
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef uint32_t TickType_t;
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+
+#define pdFALSE ((BaseType_t)0)
+#define pdTRUE ((BaseType_t)1)
+#define pdFAIL (pdFALSE)
+#define pdPASS (pdTRUE)
+
+#define portMAX_DELAY ((TickType_t)0xFFFFFFFFUL)
+
+#define configTICK_RATE_HZ ((TickType_t)1000)
+#define portTICK_PERIOD_MS ((TickType_t)1000 / configTICK_RATE_HZ)
+#define pdMS_TO_TICKS(xTimeInMs) \
+    ((TickType_t)(((TickType_t)(xTimeInMs) * (TickType_t)configTICK_RATE_HZ) / (TickType_t)1000))
+
+/* There are no interrupts on host, yielding from ISR is a no-op */
+#define portYIELD_FROM_ISR(x) ((void)(x))
+#define portEND_SWITCHING_ISR(x) ((void)(x))
+
+void* pvPortMalloc(size_t xSize);
+void vPortFree(void* pv);
+size_t xPortGetFreeHeapSize(void);
+size_t xPortGetMinimumEverFreeHeapSize(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,1120 @@
+#include "cmsis_os2.h"
+#include "os_host_i.h"
+
+#include <errno.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define OS_HOST_TICK_FREQ 1000U
+#define OS_HOST_SYS_TIMER_FREQ 1000000U
+#define OS_HOST_THREAD_NAME_MAX 16U
+
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    uint32_t value;
+} OsHostFlags;
+
+typedef struct OsHostThread OsHostThread;
+
+struct OsHostThread {
+    pthread_t pthread;
+    char* name;
+    osThreadFunc_t func;
+    void* argument;
+    uint32_t stack_size;
+    osPriority_t priority;
+    volatile osThreadState_t state;
+    OsHostFlags flags;
+    uint32_t number; /**< uxTaskNumber counterpart */
+    OsHostThread* next;
+};
+
+typedef struct OsHostTimer OsHostTimer;
+
+struct OsHostTimer {
+    const char* name;
+    osTimerFunc_t func;
+    void* argument;
+    osTimerType_t type;
+    uint32_t period;
+    struct timespec deadline;
+    bool running;
+    OsHostTimer* next;
+};
+
+typedef struct {
+    pthread_mutex_t mutex;
+    OsHostThread* owner;
+} OsHostMutex;
+
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    uint32_t count;
+    uint32_t max_count;
+} OsHostSemaphore;
+
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+    uint8_t* buffer;
+    uint32_t msg_size;
+    uint32_t capacity;
+    uint32_t head;
+    uint32_t count;
+} OsHostMessageQueue;
+
+static pthread_once_t os_host_once = PTHREAD_ONCE_INIT;
+static struct timespec os_host_boot;
+static volatile osKernelState_t os_host_kernel_state = osKernelInactive;
+
+static pthread_mutex_t os_host_scheduler_mutex;
+static __thread uint32_t os_host_scheduler_depth = 0;
+
+static pthread_mutex_t os_host_threads_mutex = PTHREAD_MUTEX_INITIALIZER;
+static OsHostThread* os_host_threads = NULL;
+static uint32_t os_host_threads_count = 0;
+static __thread OsHostThread* os_host_thread_current = NULL;
+
+static pthread_once_t os_host_timer_once = PTHREAD_ONCE_INIT;
+static pthread_mutex_t os_host_timer_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t os_host_timer_cond;
+static OsHostTimer* os_host_timers = NULL;
+
+/******************* Helpers *******************/
+
+static void os_host_init(void) {
+    clock_gettime(CLOCK_MONOTONIC, &os_host_boot);
+
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&os_host_scheduler_mutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+}
+
+static inline void os_host_ensure_init(void) {
+    pthread_once(&os_host_once, os_host_init);
+}
+
+static inline bool os_host_timespec_before(const struct timespec* a, const struct timespec* b) {
+    return (a->tv_sec < b->tv_sec) || (a->tv_sec == b->tv_sec && a->tv_nsec < b->tv_nsec);
+}
+
+static void os_host_timespec_add_ticks(struct timespec* time, uint32_t ticks) {
+    time->tv_sec += ticks / OS_HOST_TICK_FREQ;
+    time->tv_nsec += (long)(ticks % OS_HOST_TICK_FREQ) * (1000000000L / OS_HOST_TICK_FREQ);
+    if(time->tv_nsec >= 1000000000L) {
+        time->tv_sec += 1;
+        time->tv_nsec -= 1000000000L;
+    }
+}
+
+static uint64_t os_host_uptime_us(void) {
+    os_host_ensure_init();
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    int64_t sec = now.tv_sec - os_host_boot.tv_sec;
+    int64_t nsec = now.tv_nsec - os_host_boot.tv_nsec;
+    return (uint64_t)(sec * 1000000LL + nsec / 1000LL);
+}
+
+void os_host_cond_init(pthread_cond_t* cond) {
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(cond, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+void os_host_deadline(struct timespec* deadline, uint32_t ticks) {
+    clock_gettime(CLOCK_MONOTONIC, deadline);
+    os_host_timespec_add_ticks(deadline, ticks);
+}
+
+static void os_host_cond_cleanup(void* context) {
+    pthread_mutex_unlock((pthread_mutex_t*)context);
+}
+
+bool os_host_cond_wait(pthread_cond_t* cond, pthread_mutex_t* mutex, struct timespec* deadline) {
+    int ret = 0;
+    // Keep mutex consistent if thread is terminated while waiting
+    pthread_cleanup_push(os_host_cond_cleanup, mutex);
+    if(deadline) {
+        ret = pthread_cond_timedwait(cond, mutex, deadline);
+    } else {
+        ret = pthread_cond_wait(cond, mutex);
+    }
+    pthread_cleanup_pop(0);
+    return ret != ETIMEDOUT;
+}
+
+void os_host_scheduler_lock(void) {
+    os_host_ensure_init();
+    pthread_mutex_lock(&os_host_scheduler_mutex);
+    os_host_scheduler_depth++;
+}
+
+void os_host_scheduler_unlock(void) {
+    if(os_host_scheduler_depth > 0) {
+        os_host_scheduler_depth--;
+        pthread_mutex_unlock(&os_host_scheduler_mutex);
+    }
+}
+
+uint32_t os_host_scheduler_lock_depth(void) {
+    return os_host_scheduler_depth;
+}
+
+static void os_host_flags_init(OsHostFlags* flags) {
+    pthread_mutex_init(&flags->mutex, NULL);
+    os_host_cond_init(&flags->cond);
+    flags->value = 0;
+}
+
+static void os_host_flags_deinit(OsHostFlags* flags) {
+    pthread_cond_destroy(&flags->cond);
+    pthread_mutex_destroy(&flags->mutex);
+}
+
+static uint32_t os_host_flags_set(OsHostFlags* flags, uint32_t value) {
+    pthread_mutex_lock(&flags->mutex);
+    flags->value |= value;
+    uint32_t result = flags->value;
+    pthread_cond_broadcast(&flags->cond);
+    pthread_mutex_unlock(&flags->mutex);
+    return result;
+}
+
+static uint32_t os_host_flags_clear(OsHostFlags* flags, uint32_t value) {
+    pthread_mutex_lock(&flags->mutex);
+    uint32_t result = flags->value;
+    flags->value &= ~value;
+    pthread_mutex_unlock(&flags->mutex);
+    return result;
+}
+
+static uint32_t os_host_flags_get(OsHostFlags* flags) {
+    pthread_mutex_lock(&flags->mutex);
+    uint32_t result = flags->value;
+    pthread_mutex_unlock(&flags->mutex);
+    return result;
+}
+
+static uint32_t
+    os_host_flags_wait(OsHostFlags* flags, uint32_t value, uint32_t options, uint32_t timeout) {
+    struct timespec deadline;
+    struct timespec* deadline_ptr = NULL;
+    if(timeout != osWaitForever) {
+        os_host_deadline(&deadline, timeout);
+        deadline_ptr = &deadline;
+    }
+
+    uint32_t result;
+    pthread_mutex_lock(&flags->mutex);
+    while(true) {
+        uint32_t match = flags->value & value;
+        bool done = (options & osFlagsWaitAll) ? (match == value) : (match != 0);
+        if(done) {
+            result = flags->value;
+            if(!(options & osFlagsNoClear)) {
+                flags->value &= ~value;
+            }
+            break;
+        }
+        if(timeout == 0) {
+            result = osFlagsErrorResource;
+            break;
+        }
+        if(!os_host_cond_wait(&flags->cond, &flags->mutex, deadline_ptr)) {
+            result = osFlagsErrorTimeout;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&flags->mutex);
+
+    return result;
+}
+
+/******************* Kernel *******************/
+
+osStatus_t osKernelInitialize(void) {
+    os_host_ensure_init();
+    if(os_host_kernel_state != osKernelInactive) {
+        return osError;
+    }
+    os_host_kernel_state = osKernelReady;
+    return osOK;
+}
+
+osKernelState_t osKernelGetState(void) {
+    if(os_host_kernel_state == osKernelRunning && os_host_scheduler_depth > 0) {
+        return osKernelLocked;
+    }
+    return os_host_kernel_state;
+}
+
+osStatus_t osKernelStart(void) {
+    if(os_host_kernel_state != osKernelReady) {
+        return osError;
+    }
+    os_host_kernel_state = osKernelRunning;
+
+    // Same as on target: the caller never gets control back
+    while(true) {
+        pause();
+    }
+
+    return osOK;
+}
+
+int32_t osKernelLock(void) {
+    int32_t lock = (os_host_scheduler_depth > 0) ? 1 : 0;
+    os_host_scheduler_lock();
+    return lock;
+}
+
+int32_t osKernelUnlock(void) {
+    int32_t lock = (os_host_scheduler_depth > 0) ? 1 : 0;
+    os_host_scheduler_unlock();
+    return lock;
+}
+
+int32_t osKernelRestoreLock(int32_t lock) {
+    if(lock) {
+        if(os_host_scheduler_depth == 0) os_host_scheduler_lock();
+    } else {
+        while(os_host_scheduler_depth > 0) os_host_scheduler_unlock();
+    }
+    return lock;
+}
+
+uint32_t osKernelGetTickCount(void) {
+    return (uint32_t)(os_host_uptime_us() / (OS_HOST_SYS_TIMER_FREQ / OS_HOST_TICK_FREQ));
+}
+
+uint32_t osKernelGetTickFreq(void) {
+    return OS_HOST_TICK_FREQ;
+}
+
+uint32_t osKernelGetSysTimerCount(void) {
+    return (uint32_t)os_host_uptime_us();
+}
+
+uint32_t osKernelGetSysTimerFreq(void) {
+    return OS_HOST_SYS_TIMER_FREQ;
+}
+
+/******************* Threads *******************/
+
+static void os_host_thread_cleanup(void* context) {
+    OsHostThread* thread = context;
+
+    pthread_mutex_lock(&os_host_threads_mutex);
+    for(OsHostThread** item = &os_host_threads; *item; item = &(*item)->next) {
+        if(*item == thread) {
+            *item = thread->next;
+            os_host_threads_count--;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&os_host_threads_mutex);
+
+    os_host_thread_current = NULL;
+    os_host_flags_deinit(&thread->flags);
+    free(thread->name);
+    free(thread);
+}
+
+static void* os_host_thread_entry(void* context) {
+    OsHostThread* thread = context;
+    os_host_thread_current = thread;
+
+    if(thread->name) {
+        char name[OS_HOST_THREAD_NAME_MAX];
+        strncpy(name, thread->name, sizeof(name) - 1);
+        name[sizeof(name) - 1] = '\0';
+        pthread_setname_np(pthread_self(), name);
+    }
+
+    pthread_cleanup_push(os_host_thread_cleanup, thread);
+    thread->state = osThreadRunning;
+    thread->func(thread->argument);
+    pthread_cleanup_pop(1);
+
+    return NULL;
+}
+
+osThreadId_t osThreadNew(osThreadFunc_t func, void* argument, const osThreadAttr_t* attr) {
+    if(func == NULL) {
+        return NULL;
+    }
+    os_host_ensure_init();
+
+    OsHostThread* thread = calloc(1, sizeof(OsHostThread));
+    if(thread == NULL) {
+        return NULL;
+    }
+
+    thread->func = func;
+    thread->argument = argument;
+    thread->priority = osPriorityNormal;
+    thread->state = osThreadReady;
+    os_host_flags_init(&thread->flags);
+    if(attr) {
+        if(attr->name) thread->name = strdup(attr->name);
+        if(attr->priority != osPriorityNone) thread->priority = attr->priority;
+        thread->stack_size = attr->stack_size;
+    }
+
+    // Target stack sizes are far too small for host libc, keep the default one
+    pthread_attr_t pthread_attr;
+    pthread_attr_init(&pthread_attr);
+    pthread_attr_setdetachstate(&pthread_attr, PTHREAD_CREATE_DETACHED);
+
+    pthread_mutex_lock(&os_host_threads_mutex);
+    thread->next = os_host_threads;
+    os_host_threads = thread;
+    os_host_threads_count++;
+    int ret = pthread_create(&thread->pthread, &pthread_attr, os_host_thread_entry, thread);
+    if(ret != 0) {
+        os_host_threads = thread->next;
+        os_host_threads_count--;
+    }
+    pthread_mutex_unlock(&os_host_threads_mutex);
+    pthread_attr_destroy(&pthread_attr);
+
+    if(ret != 0) {
+        os_host_flags_deinit(&thread->flags);
+        free(thread->name);
+        free(thread);
+        return NULL;
+    }
+
+    return thread;
+}
+
+const char* osThreadGetName(osThreadId_t thread_id) {
+    OsHostThread* thread = thread_id;
+    return thread ? thread->name : NULL;
+}
+
+uint32_t os_host_thread_get_number(void* thread_id) {
+    return ((OsHostThread*)thread_id)->number;
+}
+
+void os_host_thread_set_number(void* thread_id, uint32_t number) {
+    ((OsHostThread*)thread_id)->number = number;
+}
+
+osThreadId_t osThreadGetId(void) {
+    return os_host_thread_current;
+}
+
+osThreadState_t osThreadGetState(osThreadId_t thread_id) {
+    OsHostThread* thread = thread_id;
+    if(thread == NULL) {
+        return osThreadError;
+    }
+    return (thread == os_host_thread_current) ? osThreadRunning : thread->state;
+}
+
+uint32_t osThreadGetStackSize(osThreadId_t thread_id) {
+    OsHostThread* thread = thread_id;
+    return thread ? thread->stack_size : 0;
+}
+
+uint32_t osThreadGetStackSpace(osThreadId_t thread_id) {
+    // Host stacks are not measured, report requested size as untouched
+    return osThreadGetStackSize(thread_id);
+}
+
+osPriority_t osThreadGetPriority(osThreadId_t thread_id) {
+    OsHostThread* thread = thread_id;
+    return thread ? thread->priority : osPriorityError;
+}
+
+osStatus_t osThreadSetPriority(osThreadId_t thread_id, osPriority_t priority) {
+    OsHostThread* thread = thread_id;
+    if(thread == NULL || priority < osPriorityIdle || priority > osPriorityISR) {
+        return osErrorParameter;
+    }
+    thread->priority = priority;
+    return osOK;
+}
+
+osStatus_t osThreadYield(void) {
+    sched_yield();
+    return osOK;
+}
+
+void osThreadExit(void) {
+    pthread_exit(NULL);
+}
+
+osStatus_t osThreadTerminate(osThreadId_t thread_id) {
+    OsHostThread* thread = thread_id;
+    if(thread == NULL) {
+        return osErrorParameter;
+    }
+    if(thread == os_host_thread_current) {
+        osThreadExit();
+    }
+
+    // Thread may be exiting on its own, its cleanup handler unlinks it under the same lock
+    osStatus_t status = osErrorParameter;
+    pthread_mutex_lock(&os_host_threads_mutex);
+    for(OsHostThread* item = os_host_threads; item; item = item->next) {
+        if(item == thread) {
+            status = (pthread_cancel(thread->pthread) == 0) ? osOK : osErrorResource;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&os_host_threads_mutex);
+
+    return status;
+}
+
+uint32_t osThreadGetCount(void) {
+    pthread_mutex_lock(&os_host_threads_mutex);
+    uint32_t count = os_host_threads_count;
+    pthread_mutex_unlock(&os_host_threads_mutex);
+    return count;
+}
+
+uint32_t osThreadEnumerate(osThreadId_t* thread_array, uint32_t array_items) {
+    if(thread_array == NULL || array_items == 0) {
+        return 0;
+    }
+
+    uint32_t count = 0;
+    pthread_mutex_lock(&os_host_threads_mutex);
+    for(OsHostThread* thread = os_host_threads; thread && count < array_items;
+        thread = thread->next) {
+        thread_array[count++] = thread;
+    }
+    pthread_mutex_unlock(&os_host_threads_mutex);
+
+    return count;
+}
+
+/******************* Thread flags *******************/
+
+uint32_t osThreadFlagsSet(osThreadId_t thread_id, uint32_t flags) {
+    OsHostThread* thread = thread_id;
+    if(thread == NULL || (flags & osFlagsError)) {
+        return osFlagsErrorParameter;
+    }
+    return os_host_flags_set(&thread->flags, flags);
+}
+
+uint32_t osThreadFlagsClear(uint32_t flags) {
+    OsHostThread* thread = os_host_thread_current;
+    if(thread == NULL) {
+        return osFlagsErrorUnknown;
+    }
+    if(flags & osFlagsError) {
+        return osFlagsErrorParameter;
+    }
+    return os_host_flags_clear(&thread->flags, flags);
+}
+
+uint32_t osThreadFlagsGet(void) {
+    OsHostThread* thread = os_host_thread_current;
+    return thread ? os_host_flags_get(&thread->flags) : 0;
+}
+
+uint32_t osThreadFlagsWait(uint32_t flags, uint32_t options, uint32_t timeout) {
+    OsHostThread* thread = os_host_thread_current;
+    if(thread == NULL) {
+        return osFlagsErrorUnknown;
+    }
+    if(flags & osFlagsError) {
+        return osFlagsErrorParameter;
+    }
+    return os_host_flags_wait(&thread->flags, flags, options, timeout);
+}
+
+/******************* Delay *******************/
+
+osStatus_t osDelay(uint32_t ticks) {
+    if(ticks == 0) {
+        return osErrorParameter;
+    }
+    struct timespec deadline;
+    os_host_deadline(&deadline, ticks);
+    while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL) == EINTR) {
+    }
+    return osOK;
+}
+
+osStatus_t osDelayUntil(uint32_t ticks) {
+    uint32_t delay = ticks - osKernelGetTickCount();
+    if(delay == 0 || delay > 0x7FFFFFFFU) {
+        return osErrorParameter;
+    }
+    return osDelay(delay);
+}
+
+/******************* Timers *******************/
+
+static void os_host_timer_insert(OsHostTimer* timer) {
+    OsHostTimer** item = &os_host_timers;
+    while(*item && !os_host_timespec_before(&timer->deadline, &(*item)->deadline)) {
+        item = &(*item)->next;
+    }
+    timer->next = *item;
+    *item = timer;
+}
+
+static void os_host_timer_remove(OsHostTimer* timer) {
+    for(OsHostTimer** item = &os_host_timers; *item; item = &(*item)->next) {
+        if(*item == timer) {
+            *item = timer->next;
+            timer->next = NULL;
+            break;
+        }
+    }
+}
+
+static void os_host_timer_service(void* context) {
+    (void)context;
+    pthread_mutex_lock(&os_host_timer_mutex);
+    while(true) {
+        OsHostTimer* timer = os_host_timers;
+        if(timer == NULL) {
+            os_host_cond_wait(&os_host_timer_cond, &os_host_timer_mutex, NULL);
+            continue;
+        }
+
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        if(os_host_timespec_before(&now, &timer->deadline)) {
+            struct timespec deadline = timer->deadline;
+            os_host_cond_wait(&os_host_timer_cond, &os_host_timer_mutex, &deadline);
+            continue;
+        }
+
+        os_host_timer_remove(timer);
+        if(timer->type == osTimerPeriodic) {
+            os_host_timespec_add_ticks(&timer->deadline, timer->period);
+            os_host_timer_insert(timer);
+        } else {
+            timer->running = false;
+        }
+
+        // Callback runs unlocked, so it can restart or stop timers
+        osTimerFunc_t func = timer->func;
+        void* argument = timer->argument;
+        pthread_mutex_unlock(&os_host_timer_mutex);
+        func(argument);
+        pthread_mutex_lock(&os_host_timer_mutex);
+    }
+}
+
+static void os_host_timer_service_start(void) {
+    os_host_cond_init(&os_host_timer_cond);
+    const osThreadAttr_t attr = {.name = "TimerService", .stack_size = 1024};
+    osThreadNew(os_host_timer_service, NULL, &attr);
+}
+
+osTimerId_t osTimerNew(
+    osTimerFunc_t func,
+    osTimerType_t type,
+    void* argument,
+    const osTimerAttr_t* attr) {
+    if(func == NULL || (type != osTimerOnce && type != osTimerPeriodic)) {
+        return NULL;
+    }
+    pthread_once(&os_host_timer_once, os_host_timer_service_start);
+
+    OsHostTimer* timer = calloc(1, sizeof(OsHostTimer));
+    if(timer) {
+        timer->name = attr ? attr->name : NULL;
+        timer->func = func;
+        timer->argument = argument;
+        timer->type = type;
+    }
+    return timer;
+}
+
+const char* osTimerGetName(osTimerId_t timer_id) {
+    OsHostTimer* timer = timer_id;
+    return timer ? timer->name : NULL;
+}
+
+osStatus_t osTimerStart(osTimerId_t timer_id, uint32_t ticks) {
+    OsHostTimer* timer = timer_id;
+    if(timer == NULL || ticks == 0) {
+        return osErrorParameter;
+    }
+
+    pthread_mutex_lock(&os_host_timer_mutex);
+    if(timer->running) {
+        os_host_timer_remove(timer);
+    }
+    timer->period = ticks;
+    timer->running = true;
+    os_host_deadline(&timer->deadline, ticks);
+    os_host_timer_insert(timer);
+    pthread_cond_signal(&os_host_timer_cond);
+    pthread_mutex_unlock(&os_host_timer_mutex);
+
+    return osOK;
+}
+
+osStatus_t osTimerStop(osTimerId_t timer_id) {
+    OsHostTimer* timer = timer_id;
+    if(timer == NULL) {
+        return osErrorParameter;
+    }
+
+    osStatus_t status = osOK;
+    pthread_mutex_lock(&os_host_timer_mutex);
+    if(timer->running) {
+        os_host_timer_remove(timer);
+        timer->running = false;
+    } else {
+        status = osErrorResource;
+    }
+    pthread_mutex_unlock(&os_host_timer_mutex);
+
+    return status;
+}
+
+uint32_t osTimerIsRunning(osTimerId_t timer_id) {
+    OsHostTimer* timer = timer_id;
+    if(timer == NULL) {
+        return 0;
+    }
+
+    pthread_mutex_lock(&os_host_timer_mutex);
+    uint32_t running = timer->running ? 1U : 0U;
+    pthread_mutex_unlock(&os_host_timer_mutex);
+
+    return running;
+}
+
+osStatus_t osTimerDelete(osTimerId_t timer_id) {
+    OsHostTimer* timer = timer_id;
+    if(timer == NULL) {
+        return osErrorParameter;
+    }
+
+    pthread_mutex_lock(&os_host_timer_mutex);
+    if(timer->running) {
+        os_host_timer_remove(timer);
+    }
+    pthread_mutex_unlock(&os_host_timer_mutex);
+    free(timer);
+
+    return osOK;
+}
+
+/******************* Event flags *******************/
+
+osEventFlagsId_t osEventFlagsNew(const osEventFlagsAttr_t* attr) {
+    (void)attr;
+    OsHostFlags* flags = malloc(sizeof(OsHostFlags));
+    if(flags) {
+        os_host_flags_init(flags);
+    }
+    return flags;
+}
+
+uint32_t osEventFlagsSet(osEventFlagsId_t ef_id, uint32_t flags) {
+    if(ef_id == NULL || (flags & osFlagsError)) {
+        return osFlagsErrorParameter;
+    }
+    return os_host_flags_set(ef_id, flags);
+}
+
+uint32_t osEventFlagsClear(osEventFlagsId_t ef_id, uint32_t flags) {
+    if(ef_id == NULL || (flags & osFlagsError)) {
+        return osFlagsErrorParameter;
+    }
+    return os_host_flags_clear(ef_id, flags);
+}
+
+uint32_t osEventFlagsGet(osEventFlagsId_t ef_id) {
+    return ef_id ? os_host_flags_get(ef_id) : 0;
+}
+
+uint32_t osEventFlagsWait(
+    osEventFlagsId_t ef_id,
+    uint32_t flags,
+    uint32_t options,
+    uint32_t timeout) {
+    if(ef_id == NULL || (flags & osFlagsError)) {
+        return osFlagsErrorParameter;
+    }
+    return os_host_flags_wait(ef_id, flags, options, timeout);
+}
+
+osStatus_t osEventFlagsDelete(osEventFlagsId_t ef_id) {
+    if(ef_id == NULL) {
+        return osErrorParameter;
+    }
+    os_host_flags_deinit(ef_id);
+    free(ef_id);
+    return osOK;
+}
+
+/******************* Mutex *******************/
+
+osMutexId_t osMutexNew(const osMutexAttr_t* attr) {
+    OsHostMutex* mutex = malloc(sizeof(OsHostMutex));
+    if(mutex == NULL) {
+        return NULL;
+    }
+
+    pthread_mutexattr_t mutex_attr;
+    pthread_mutexattr_init(&mutex_attr);
+    if(attr && (attr->attr_bits & osMutexRecursive)) {
+        pthread_mutexattr_settype(&mutex_attr, PTHREAD_MUTEX_RECURSIVE);
+    } else {
+        pthread_mutexattr_settype(&mutex_attr, PTHREAD_MUTEX_ERRORCHECK);
+    }
+    if(attr && (attr->attr_bits & osMutexPrioInherit)) {
+        pthread_mutexattr_setprotocol(&mutex_attr, PTHREAD_PRIO_INHERIT);
+    }
+    pthread_mutex_init(&mutex->mutex, &mutex_attr);
+    pthread_mutexattr_destroy(&mutex_attr);
+    mutex->owner = NULL;
+
+    return mutex;
+}
+
+osStatus_t osMutexAcquire(osMutexId_t mutex_id, uint32_t timeout) {
+    OsHostMutex* mutex = mutex_id;
+    if(mutex == NULL) {
+        return osErrorParameter;
+    }
+
+    int ret;
+    if(timeout == osWaitForever) {
+        ret = pthread_mutex_lock(&mutex->mutex);
+    } else if(timeout == 0) {
+        ret = pthread_mutex_trylock(&mutex->mutex);
+    } else {
+        struct timespec deadline;
+        os_host_deadline(&deadline, timeout);
+        ret = pthread_mutex_clocklock(&mutex->mutex, CLOCK_MONOTONIC, &deadline);
+    }
+
+    if(ret == 0) {
+        mutex->owner = os_host_thread_current;
+        return osOK;
+    } else if(ret == ETIMEDOUT) {
+        return osErrorTimeout;
+    } else {
+        return osErrorResource;
+    }
+}
+
+osStatus_t osMutexRelease(osMutexId_t mutex_id) {
+    OsHostMutex* mutex = mutex_id;
+    if(mutex == NULL) {
+        return osErrorParameter;
+    }
+
+    OsHostThread* owner = mutex->owner;
+    mutex->owner = NULL;
+    if(pthread_mutex_unlock(&mutex->mutex) != 0) {
+        mutex->owner = owner;
+        return osErrorResource;
+    }
+    return osOK;
+}
+
+osThreadId_t osMutexGetOwner(osMutexId_t mutex_id) {
+    OsHostMutex* mutex = mutex_id;
+    return mutex ? mutex->owner : NULL;
+}
+
+osStatus_t osMutexDelete(osMutexId_t mutex_id) {
+    OsHostMutex* mutex = mutex_id;
+    if(mutex == NULL) {
+        return osErrorParameter;
+    }
+    pthread_mutex_destroy(&mutex->mutex);
+    free(mutex);
+    return osOK;
+}
+
+/******************* Semaphore *******************/
+
+osSemaphoreId_t
+    osSemaphoreNew(uint32_t max_count, uint32_t initial_count, const osSemaphoreAttr_t* attr) {
+    (void)attr;
+    if(max_count == 0 || initial_count > max_count) {
+        return NULL;
+    }
+
+    OsHostSemaphore* semaphore = malloc(sizeof(OsHostSemaphore));
+    if(semaphore) {
+        pthread_mutex_init(&semaphore->mutex, NULL);
+        os_host_cond_init(&semaphore->cond);
+        semaphore->count = initial_count;
+        semaphore->max_count = max_count;
+    }
+    return semaphore;
+}
+
+osStatus_t osSemaphoreAcquire(osSemaphoreId_t semaphore_id, uint32_t timeout) {
+    OsHostSemaphore* semaphore = semaphore_id;
+    if(semaphore == NULL) {
+        return osErrorParameter;
+    }
+
+    struct timespec deadline;
+    struct timespec* deadline_ptr = NULL;
+    if(timeout != osWaitForever) {
+        os_host_deadline(&deadline, timeout);
+        deadline_ptr = &deadline;
+    }
+
+    osStatus_t status = osOK;
+    pthread_mutex_lock(&semaphore->mutex);
+    while(semaphore->count == 0) {
+        if(timeout == 0) {
+            status = osErrorResource;
+            break;
+        }
+        if(!os_host_cond_wait(&semaphore->cond, &semaphore->mutex, deadline_ptr)) {
+            status = osErrorTimeout;
+            break;
+        }
+    }
+    if(status == osOK) {
+        semaphore->count--;
+    }
+    pthread_mutex_unlock(&semaphore->mutex);
+
+    return status;
+}
+
+osStatus_t osSemaphoreRelease(osSemaphoreId_t semaphore_id) {
+    OsHostSemaphore* semaphore = semaphore_id;
+    if(semaphore == NULL) {
+        return osErrorParameter;
+    }
+
+    osStatus_t status = osOK;
+    pthread_mutex_lock(&semaphore->mutex);
+    if(semaphore->count < semaphore->max_count) {
+        semaphore->count++;
+        pthread_cond_signal(&semaphore->cond);
+    } else {
+        status = osErrorResource;
+    }
+    pthread_mutex_unlock(&semaphore->mutex);
+
+    return status;
+}
+
+uint32_t osSemaphoreGetCount(osSemaphoreId_t semaphore_id) {
+    OsHostSemaphore* semaphore = semaphore_id;
+    if(semaphore == NULL) {
+        return 0;
+    }
+
+    pthread_mutex_lock(&semaphore->mutex);
+    uint32_t count = semaphore->count;
+    pthread_mutex_unlock(&semaphore->mutex);
+
+    return count;
+}
+
+osStatus_t osSemaphoreDelete(osSemaphoreId_t semaphore_id) {
+    OsHostSemaphore* semaphore = semaphore_id;
+    if(semaphore == NULL) {
+        return osErrorParameter;
+    }
+    pthread_cond_destroy(&semaphore->cond);
+    pthread_mutex_destroy(&semaphore->mutex);
+    free(semaphore);
+    return osOK;
+}
+
+/******************* Message queue *******************/
+
+osMessageQueueId_t
+    osMessageQueueNew(uint32_t msg_count, uint32_t msg_size, const osMessageQueueAttr_t* attr) {
+    (void)attr;
+    if(msg_count == 0 || msg_size == 0) {
+        return NULL;
+    }
+
+    OsHostMessageQueue* queue = malloc(sizeof(OsHostMessageQueue));
+    if(queue == NULL) {
+        return NULL;
+    }
+    queue->buffer = malloc((size_t)msg_count * msg_size);
+    if(queue->buffer == NULL) {
+        free(queue);
+        return NULL;
+    }
+
+    pthread_mutex_init(&queue->mutex, NULL);
+    os_host_cond_init(&queue->not_empty);
+    os_host_cond_init(&queue->not_full);
+    queue->msg_size = msg_size;
+    queue->capacity = msg_count;
+    queue->head = 0;
+    queue->count = 0;
+
+    return queue;
+}
+
+osStatus_t osMessageQueuePut(
+    osMessageQueueId_t mq_id,
+    const void* msg_ptr,
+    uint8_t msg_prio,
+    uint32_t timeout) {
+    (void)msg_prio;
+    OsHostMessageQueue* queue = mq_id;
+    if(queue == NULL || msg_ptr == NULL) {
+        return osErrorParameter;
+    }
+
+    struct timespec deadline;
+    struct timespec* deadline_ptr = NULL;
+    if(timeout != osWaitForever) {
+        os_host_deadline(&deadline, timeout);
+        deadline_ptr = &deadline;
+    }
+
+    osStatus_t status = osOK;
+    pthread_mutex_lock(&queue->mutex);
+    while(queue->count == queue->capacity) {
+        if(timeout == 0) {
+            status = osErrorResource;
+            break;
+        }
+        if(!os_host_cond_wait(&queue->not_full, &queue->mutex, deadline_ptr)) {
+            status = osErrorTimeout;
+            break;
+        }
+    }
+    if(status == osOK) {
+        uint32_t tail = (queue->head + queue->count) % queue->capacity;
+        memcpy(&queue->buffer[tail * queue->msg_size], msg_ptr, queue->msg_size);
+        queue->count++;
+        pthread_cond_signal(&queue->not_empty);
+    }
+    pthread_mutex_unlock(&queue->mutex);
+
+    return status;
+}
+
+osStatus_t osMessageQueueGet(
+    osMessageQueueId_t mq_id,
+    void* msg_ptr,
+    uint8_t* msg_prio,
+    uint32_t timeout) {
+    OsHostMessageQueue* queue = mq_id;
+    if(queue == NULL || msg_ptr == NULL) {
+        return osErrorParameter;
+    }
+
+    struct timespec deadline;
+    struct timespec* deadline_ptr = NULL;
+    if(timeout != osWaitForever) {
+        os_host_deadline(&deadline, timeout);
+        deadline_ptr = &deadline;
+    }
+
+    osStatus_t status = osOK;
+    pthread_mutex_lock(&queue->mutex);
+    while(queue->count == 0) {
+        if(timeout == 0) {
+            status = osErrorResource;
+            break;
+        }
+        if(!os_host_cond_wait(&queue->not_empty, &queue->mutex, deadline_ptr)) {
+            status = osErrorTimeout;
+            break;
+        }
+    }
+    if(status == osOK) {
+        memcpy(msg_ptr, &queue->buffer[queue->head * queue->msg_size], queue->msg_size);
+        queue->head = (queue->head + 1) % queue->capacity;
+        queue->count--;
+        if(msg_prio) *msg_prio = 0;
+        pthread_cond_signal(&queue->not_full);
+    }
+    pthread_mutex_unlock(&queue->mutex);
+
+    return status;
+}
+
+uint32_t osMessageQueueGetCapacity(osMessageQueueId_t mq_id) {
+    OsHostMessageQueue* queue = mq_id;
+    return queue ? queue->capacity : 0;
+}
+
+uint32_t osMessageQueueGetMsgSize(osMessageQueueId_t mq_id) {
+    OsHostMessageQueue* queue = mq_id;
+    return queue ? queue->msg_size : 0;
+}
+
+uint32_t osMessageQueueGetCount(osMessageQueueId_t mq_id) {
+    OsHostMessageQueue* queue = mq_id;
+    if(queue == NULL) {
+        return 0;
+    }
+
+    pthread_mutex_lock(&queue->mutex);
+    uint32_t count = queue->count;
+    pthread_mutex_unlock(&queue->mutex);
+
+    return count;
+}
+
+uint32_t osMessageQueueGetSpace(osMessageQueueId_t mq_id) {
+    OsHostMessageQueue* queue = mq_id;
+    if(queue == NULL) {
+        return 0;
+    }
+
+    pthread_mutex_lock(&queue->mutex);
+    uint32_t space = queue->capacity - queue->count;
+    pthread_mutex_unlock(&queue->mutex);
+
+    return space;
+}
+
+osStatus_t osMessageQueueReset(osMessageQueueId_t mq_id) {
+    OsHostMessageQueue* queue = mq_id;
+    if(queue == NULL) {
+        return osErrorParameter;
+    }
+
+    pthread_mutex_lock(&queue->mutex);
+    queue->head = 0;
+    queue->count = 0;
+    pthread_cond_broadcast(&queue->not_full);
+    pthread_mutex_unlock(&queue->mutex);
+
+    return osOK;
+}
+
+osStatus_t osMessageQueueDelete(osMessageQueueId_t mq_id) {
+    OsHostMessageQueue* queue = mq_id;
+    if(queue == NULL) {
+        return osErrorParameter;
+    }
+
+    pthread_cond_destroy(&queue->not_full);
+    pthread_cond_destroy(&queue->not_empty);
+    pthread_mutex_destroy(&queue->mutex);
+    free(queue->buffer);
+    free(queue);
+
+    return osOK;
+}
@@ -0,0 +1,263 @@
+/**
+ * @file cmsis_os2.h
+ * Host: CMSIS-RTOS2 API subset implemented on top of POSIX threads
+ *
+ * Declares only the part of CMSIS-RTOS2 used by core/furi and the components
+ * built for host. Types and constants mirror the ARM header so sources compile
+ * unchanged. One kernel tick is one millisecond, same as firmware.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Kernel information */
+typedef enum {
+    osKernelInactive = 0,
+    osKernelReady = 1,
+    osKernelRunning = 2,
+    osKernelLocked = 3,
+    osKernelSuspended = 4,
+    osKernelError = -1,
+    osKernelReserved = 0x7FFFFFFF
+} osKernelState_t;
+
+/** Thread state */
+typedef enum {
+    osThreadInactive = 0,
+    osThreadReady = 1,
+    osThreadRunning = 2,
+    osThreadBlocked = 3,
+    osThreadTerminated = 4,
+    osThreadError = -1,
+    osThreadReserved = 0x7FFFFFFF
+} osThreadState_t;
+
+/** Priority values, host threads ignore them */
+typedef enum {
+    osPriorityNone = 0,
+    osPriorityIdle = 1,
+    osPriorityLow = 8,
+    osPriorityBelowNormal = 16,
+    osPriorityNormal = 24,
+    osPriorityAboveNormal = 32,
+    osPriorityHigh = 40,
+    osPriorityRealtime = 48,
+    osPriorityISR = 56,
+    osPriorityError = -1,
+    osPriorityReserved = 0x7FFFFFFF
+} osPriority_t;
+
+typedef void (*osThreadFunc_t)(void* argument);
+typedef void (*osTimerFunc_t)(void* argument);
+
+/** Timer type */
+typedef enum {
+    osTimerOnce = 0,
+    osTimerPeriodic = 1
+} osTimerType_t;
+
+#define osWaitForever 0xFFFFFFFFU
+
+#define osFlagsWaitAny 0x00000000U
+#define osFlagsWaitAll 0x00000001U
+#define osFlagsNoClear 0x00000002U
+
+#define osFlagsError 0x80000000U
+#define osFlagsErrorUnknown 0xFFFFFFFFU
+#define osFlagsErrorTimeout 0xFFFFFFFEU
+#define osFlagsErrorResource 0xFFFFFFFDU
+#define osFlagsErrorParameter 0xFFFFFFFCU
+#define osFlagsErrorISR 0xFFFFFFFAU
+
+#define osThreadDetached 0x00000000U
+#define osThreadJoinable 0x00000001U
+
+#define osMutexRecursive 0x00000001U
+#define osMutexPrioInherit 0x00000002U
+#define osMutexRobust 0x00000008U
+
+/** Status code values returned by CMSIS-RTOS functions */
+typedef enum {
+    osOK = 0,
+    osError = -1,
+    osErrorTimeout = -2,
+    osErrorResource = -3,
+    osErrorParameter = -4,
+    osErrorNoMemory = -5,
+    osErrorISR = -6,
+    osStatusReserved = 0x7FFFFFFF
+} osStatus_t;
+
+typedef void* osThreadId_t;
+typedef void* osTimerId_t;
+typedef void* osEventFlagsId_t;
+typedef void* osMutexId_t;
+typedef void* osSemaphoreId_t;
+typedef void* osMessageQueueId_t;
+
+typedef uint32_t TZ_ModuleId_t;
+
+typedef struct {
+    const char* name;
+    uint32_t attr_bits;
+    void* cb_mem;
+    uint32_t cb_size;
+    void* stack_mem;
+    uint32_t stack_size;
+    osPriority_t priority;
+    TZ_ModuleId_t tz_module;
+    uint32_t reserved;
+} osThreadAttr_t;
+
+typedef struct {
+    const char* name;
+    uint32_t attr_bits;
+    void* cb_mem;
+    uint32_t cb_size;
+} osTimerAttr_t;
+
+typedef struct {
+    const char* name;
+    uint32_t attr_bits;
+    void* cb_mem;
+    uint32_t cb_size;
+} osEventFlagsAttr_t;
+
+typedef struct {
+    const char* name;
+    uint32_t attr_bits;
+    void* cb_mem;
+    uint32_t cb_size;
+} osMutexAttr_t;
+
+typedef struct {
+    const char* name;
+    uint32_t attr_bits;
+    void* cb_mem;
+    uint32_t cb_size;
+} osSemaphoreAttr_t;
+
+typedef struct {
+    const char* name;
+    uint32_t attr_bits;
+    void* cb_mem;
+    uint32_t cb_size;
+    void* mq_mem;
+    uint32_t mq_size;
+} osMessageQueueAttr_t;
+
+//  ==== Kernel Management Functions ====
+
+osStatus_t osKernelInitialize(void);
+osKernelState_t osKernelGetState(void);
+/** Marks kernel as running and parks the calling thread forever */
+osStatus_t osKernelStart(void);
+int32_t osKernelLock(void);
+int32_t osKernelUnlock(void);
+int32_t osKernelRestoreLock(int32_t lock);
+uint32_t osKernelGetTickCount(void);
+uint32_t osKernelGetTickFreq(void);
+uint32_t osKernelGetSysTimerCount(void);
+uint32_t osKernelGetSysTimerFreq(void);
+
+//  ==== Thread Management Functions ====
+
+osThreadId_t osThreadNew(osThreadFunc_t func, void* argument, const osThreadAttr_t* attr);
+const char* osThreadGetName(osThreadId_t thread_id);
+osThreadId_t osThreadGetId(void);
+osThreadState_t osThreadGetState(osThreadId_t thread_id);
+uint32_t osThreadGetStackSize(osThreadId_t thread_id);
+uint32_t osThreadGetStackSpace(osThreadId_t thread_id);
+osPriority_t osThreadGetPriority(osThreadId_t thread_id);
+osStatus_t osThreadSetPriority(osThreadId_t thread_id, osPriority_t priority);
+osStatus_t osThreadYield(void);
+__attribute__((__noreturn__)) void osThreadExit(void);
+osStatus_t osThreadTerminate(osThreadId_t thread_id);
+uint32_t osThreadGetCount(void);
+uint32_t osThreadEnumerate(osThreadId_t* thread_array, uint32_t array_items);
+
+//  ==== Thread Flags Functions ====
+
+uint32_t osThreadFlagsSet(osThreadId_t thread_id, uint32_t flags);
+uint32_t osThreadFlagsClear(uint32_t flags);
+uint32_t osThreadFlagsGet(void);
+uint32_t osThreadFlagsWait(uint32_t flags, uint32_t options, uint32_t timeout);
+
+//  ==== Generic Wait Functions ====
+
+osStatus_t osDelay(uint32_t ticks);
+osStatus_t osDelayUntil(uint32_t ticks);
+
+//  ==== Timer Management Functions ====
+
+osTimerId_t osTimerNew(
+    osTimerFunc_t func,
+    osTimerType_t type,
+    void* argument,
+    const osTimerAttr_t* attr);
+const char* osTimerGetName(osTimerId_t timer_id);
+osStatus_t osTimerStart(osTimerId_t timer_id, uint32_t ticks);
+osStatus_t osTimerStop(osTimerId_t timer_id);
+uint32_t osTimerIsRunning(osTimerId_t timer_id);
+osStatus_t osTimerDelete(osTimerId_t timer_id);
+
+//  ==== Event Flags Management Functions ====
+
+osEventFlagsId_t osEventFlagsNew(const osEventFlagsAttr_t* attr);
+uint32_t osEventFlagsSet(osEventFlagsId_t ef_id, uint32_t flags);
+uint32_t osEventFlagsClear(osEventFlagsId_t ef_id, uint32_t flags);
+uint32_t osEventFlagsGet(osEventFlagsId_t ef_id);
+uint32_t osEventFlagsWait(
+    osEventFlagsId_t ef_id,
+    uint32_t flags,
+    uint32_t options,
+    uint32_t timeout);
+osStatus_t osEventFlagsDelete(osEventFlagsId_t ef_id);
+
+//  ==== Mutex Management Functions ====
+
+osMutexId_t osMutexNew(const osMutexAttr_t* attr);
+osStatus_t osMutexAcquire(osMutexId_t mutex_id, uint32_t timeout);
+osStatus_t osMutexRelease(osMutexId_t mutex_id);
+osThreadId_t osMutexGetOwner(osMutexId_t mutex_id);
+osStatus_t osMutexDelete(osMutexId_t mutex_id);
+
+//  ==== Semaphore Management Functions ====
+
+osSemaphoreId_t
+    osSemaphoreNew(uint32_t max_count, uint32_t initial_count, const osSemaphoreAttr_t* attr);
+osStatus_t osSemaphoreAcquire(osSemaphoreId_t semaphore_id, uint32_t timeout);
+osStatus_t osSemaphoreRelease(osSemaphoreId_t semaphore_id);
+uint32_t osSemaphoreGetCount(osSemaphoreId_t semaphore_id);
+osStatus_t osSemaphoreDelete(osSemaphoreId_t semaphore_id);
+
+//  ==== Message Queue Management Functions ====
+
+osMessageQueueId_t
+    osMessageQueueNew(uint32_t msg_count, uint32_t msg_size, const osMessageQueueAttr_t* attr);
+osStatus_t osMessageQueuePut(
+    osMessageQueueId_t mq_id,
+    const void* msg_ptr,
+    uint8_t msg_prio,
+    uint32_t timeout);
+osStatus_t osMessageQueueGet(
+    osMessageQueueId_t mq_id,
+    void* msg_ptr,
+    uint8_t* msg_prio,
+    uint32_t timeout);
+uint32_t osMessageQueueGetCapacity(osMessageQueueId_t mq_id);
+uint32_t osMessageQueueGetMsgSize(osMessageQueueId_t mq_id);
+uint32_t osMessageQueueGetCount(osMessageQueueId_t mq_id);
+uint32_t osMessageQueueGetSpace(osMessageQueueId_t mq_id);
+osStatus_t osMessageQueueReset(osMessageQueueId_t mq_id);
+osStatus_t osMessageQueueDelete(osMessageQueueId_t mq_id);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,264 @@
+#include "FreeRTOS.h"
+#include "task.h"
+#include "stream_buffer.h"
+#include "cmsis_os2.h"
+#include "os_host_i.h"
+
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct StreamBufferDef_t {
+    pthread_mutex_t mutex;
+    pthread_cond_t data;
+    pthread_cond_t space;
+    uint8_t* buffer;
+    size_t size;
+    size_t head;
+    size_t count;
+    size_t trigger_level;
+};
+
+/******************* Task *******************/
+
+TickType_t xTaskGetTickCount(void) {
+    return osKernelGetTickCount();
+}
+
+TickType_t xTaskGetTickCountFromISR(void) {
+    return osKernelGetTickCount();
+}
+
+void vTaskSuspendAll(void) {
+    os_host_scheduler_lock();
+}
+
+BaseType_t xTaskResumeAll(void) {
+    os_host_scheduler_unlock();
+    return pdFALSE;
+}
+
+void vTaskDelay(const TickType_t xTicksToDelay) {
+    if(xTicksToDelay > 0) {
+        osDelay(xTicksToDelay);
+    }
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+    return osThreadGetId();
+}
+
+BaseType_t xTaskGetSchedulerState(void) {
+    switch(osKernelGetState()) {
+    case osKernelRunning:
+        return taskSCHEDULER_RUNNING;
+    case osKernelLocked:
+        return taskSCHEDULER_SUSPENDED;
+    default:
+        return taskSCHEDULER_NOT_STARTED;
+    }
+}
+
+UBaseType_t uxTaskGetTaskNumber(TaskHandle_t xTask) {
+    return xTask ? os_host_thread_get_number(xTask) : 0;
+}
+
+void vTaskSetTaskNumber(TaskHandle_t xTask, const UBaseType_t uxHandle) {
+    if(xTask) {
+        os_host_thread_set_number(xTask, uxHandle);
+    }
+}
+
+void taskYieldHost(void) {
+    sched_yield();
+}
+
+/******************* Stream buffer *******************/
+
+static size_t
+    stream_buffer_copy_in(StreamBufferHandle_t stream, const uint8_t* data, size_t size) {
+    size_t space = stream->size - stream->count;
+    if(size > space) size = space;
+
+    size_t tail = (stream->head + stream->count) % stream->size;
+    size_t chunk = stream->size - tail;
+    if(chunk > size) chunk = size;
+    memcpy(&stream->buffer[tail], data, chunk);
+    memcpy(stream->buffer, &data[chunk], size - chunk);
+    stream->count += size;
+
+    return size;
+}
+
+static size_t stream_buffer_copy_out(StreamBufferHandle_t stream, uint8_t* data, size_t size) {
+    if(size > stream->count) size = stream->count;
+
+    size_t chunk = stream->size - stream->head;
+    if(chunk > size) chunk = size;
+    memcpy(data, &stream->buffer[stream->head], chunk);
+    memcpy(&data[chunk], stream->buffer, size - chunk);
+    stream->head = (stream->head + size) % stream->size;
+    stream->count -= size;
+
+    return size;
+}
+
+StreamBufferHandle_t xStreamBufferCreate(size_t xBufferSizeBytes, size_t xTriggerLevelBytes) {
+    if(xBufferSizeBytes == 0 || xTriggerLevelBytes > xBufferSizeBytes) {
+        return NULL;
+    }
+
+    StreamBufferHandle_t stream = malloc(sizeof(struct StreamBufferDef_t));
+    if(stream == NULL) {
+        return NULL;
+    }
+    stream->buffer = malloc(xBufferSizeBytes);
+    if(stream->buffer == NULL) {
+        free(stream);
+        return NULL;
+    }
+
+    pthread_mutex_init(&stream->mutex, NULL);
+    os_host_cond_init(&stream->data);
+    os_host_cond_init(&stream->space);
+    stream->size = xBufferSizeBytes;
+    stream->head = 0;
+    stream->count = 0;
+    stream->trigger_level = xTriggerLevelBytes ? xTriggerLevelBytes : 1;
+
+    return stream;
+}
+
+void vStreamBufferDelete(StreamBufferHandle_t xStreamBuffer) {
+    pthread_cond_destroy(&xStreamBuffer->space);
+    pthread_cond_destroy(&xStreamBuffer->data);
+    pthread_mutex_destroy(&xStreamBuffer->mutex);
+    free(xStreamBuffer->buffer);
+    free(xStreamBuffer);
+}
+
+size_t xStreamBufferSend(
+    StreamBufferHandle_t xStreamBuffer,
+    const void* pvTxData,
+    size_t xDataLengthBytes,
+    TickType_t xTicksToWait) {
+    struct timespec deadline;
+    struct timespec* deadline_ptr = NULL;
+    if(xTicksToWait != portMAX_DELAY) {
+        os_host_deadline(&deadline, xTicksToWait);
+        deadline_ptr = &deadline;
+    }
+
+    const uint8_t* data = pvTxData;
+    size_t sent = 0;
+    pthread_mutex_lock(&xStreamBuffer->mutex);
+    while(true) {
+        sent += stream_buffer_copy_in(xStreamBuffer, &data[sent], xDataLengthBytes - sent);
+        if(xStreamBuffer->count >= xStreamBuffer->trigger_level) {
+            pthread_cond_broadcast(&xStreamBuffer->data);
+        }
+        if(sent == xDataLengthBytes || xTicksToWait == 0) {
+            break;
+        }
+        if(!os_host_cond_wait(&xStreamBuffer->space, &xStreamBuffer->mutex, deadline_ptr)) {
+            sent += stream_buffer_copy_in(xStreamBuffer, &data[sent], xDataLengthBytes - sent);
+            break;
+        }
+    }
+    pthread_mutex_unlock(&xStreamBuffer->mutex);
+
+    return sent;
+}
+
+size_t xStreamBufferSendFromISR(
+    StreamBufferHandle_t xStreamBuffer,
+    const void* pvTxData,
+    size_t xDataLengthBytes,
+    BaseType_t* const pxHigherPriorityTaskWoken) {
+    if(pxHigherPriorityTaskWoken) *pxHigherPriorityTaskWoken = pdFALSE;
+    return xStreamBufferSend(xStreamBuffer, pvTxData, xDataLengthBytes, 0);
+}
+
+size_t xStreamBufferReceive(
+    StreamBufferHandle_t xStreamBuffer,
+    void* pvRxData,
+    size_t xBufferLengthBytes,
+    TickType_t xTicksToWait) {
+    struct timespec deadline;
+    struct timespec* deadline_ptr = NULL;
+    if(xTicksToWait != portMAX_DELAY) {
+        os_host_deadline(&deadline, xTicksToWait);
+        deadline_ptr = &deadline;
+    }
+
+    size_t received = 0;
+    pthread_mutex_lock(&xStreamBuffer->mutex);
+    // Same as target: wake up on trigger level, then take whatever is there
+    while(xTicksToWait != 0 && xStreamBuffer->count < xStreamBuffer->trigger_level) {
+        if(!os_host_cond_wait(&xStreamBuffer->data, &xStreamBuffer->mutex, deadline_ptr)) {
+            break;
+        }
+    }
+    received = stream_buffer_copy_out(xStreamBuffer, pvRxData, xBufferLengthBytes);
+    if(received) {
+        pthread_cond_broadcast(&xStreamBuffer->space);
+    }
+    pthread_mutex_unlock(&xStreamBuffer->mutex);
+
+    return received;
+}
+
+size_t xStreamBufferReceiveFromISR(
+    StreamBufferHandle_t xStreamBuffer,
+    void* pvRxData,
+    size_t xBufferLengthBytes,
+    BaseType_t* const pxHigherPriorityTaskWoken) {
+    if(pxHigherPriorityTaskWoken) *pxHigherPriorityTaskWoken = pdFALSE;
+    return xStreamBufferReceive(xStreamBuffer, pvRxData, xBufferLengthBytes, 0);
+}
+
+BaseType_t xStreamBufferReset(StreamBufferHandle_t xStreamBuffer) {
+    pthread_mutex_lock(&xStreamBuffer->mutex);
+    xStreamBuffer->head = 0;
+    xStreamBuffer->count = 0;
+    pthread_cond_broadcast(&xStreamBuffer->space);
+    pthread_mutex_unlock(&xStreamBuffer->mutex);
+    return pdPASS;
+}
+
+BaseType_t xStreamBufferIsEmpty(StreamBufferHandle_t xStreamBuffer) {
+    return (xStreamBufferBytesAvailable(xStreamBuffer) == 0) ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xStreamBufferIsFull(StreamBufferHandle_t xStreamBuffer) {
+    return (xStreamBufferSpacesAvailable(xStreamBuffer) == 0) ? pdTRUE : pdFALSE;
+}
+
+size_t xStreamBufferSpacesAvailable(StreamBufferHandle_t xStreamBuffer) {
+    pthread_mutex_lock(&xStreamBuffer->mutex);
+    size_t space = xStreamBuffer->size - xStreamBuffer->count;
+    pthread_mutex_unlock(&xStreamBuffer->mutex);
+    return space;
+}
+
+size_t xStreamBufferBytesAvailable(StreamBufferHandle_t xStreamBuffer) {
+    pthread_mutex_lock(&xStreamBuffer->mutex);
+    size_t count = xStreamBuffer->count;
+    pthread_mutex_unlock(&xStreamBuffer->mutex);
+    return count;
+}
+
+BaseType_t xStreamBufferSetTriggerLevel(StreamBufferHandle_t xStreamBuffer, size_t xTriggerLevel) {
+    if(xTriggerLevel > xStreamBuffer->size) {
+        return pdFALSE;
+    }
+
+    pthread_mutex_lock(&xStreamBuffer->mutex);
+    xStreamBuffer->trigger_level = xTriggerLevel ? xTriggerLevel : 1;
+    if(xStreamBuffer->count >= xStreamBuffer->trigger_level) {
+        pthread_cond_broadcast(&xStreamBuffer->data);
+    }
+    pthread_mutex_unlock(&xStreamBuffer->mutex);
+
+    return pdTRUE;
+}
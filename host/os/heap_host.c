@@ -0,0 +1,192 @@
+#include "FreeRTOS.h"
+
+#include <furi/memmgr_heap.h>
+
+#include <fcntl.h>
+#include <malloc.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* Nominal heap capacity, only used to report free heap in target terms */
+#ifndef FURI_HOST_HEAP_SIZE
+#define FURI_HOST_HEAP_SIZE (64U * 1024U * 1024U)
+#endif
+
+#ifdef FURI_HOST_SYSTEM_HEAP
+/* Sanitizers own malloc, memmgr does not override it and only pvPortMalloc is accounted */
+#define heap_host_malloc malloc
+#define heap_host_realloc realloc
+#define heap_host_free free
+#else
+/* memmgr.c overrides malloc, so libc allocator is reached through its internal names */
+extern void* __libc_malloc(size_t size);
+extern void* __libc_realloc(void* ptr, size_t size);
+extern void __libc_free(void* ptr);
+#define heap_host_malloc __libc_malloc
+#define heap_host_realloc __libc_realloc
+#define heap_host_free __libc_free
+#endif
+
+static atomic_size_t heap_host_used = 0;
+static atomic_size_t heap_host_used_max = 0;
+static atomic_uint heap_host_realloc_in_place = 0;
+static atomic_uint heap_host_realloc_moved = 0;
+
+/* Allocation trace for host/bench, enabled with FURI_HOST_ALLOC_TRACE=<file> */
+static pthread_once_t heap_host_trace_once = PTHREAD_ONCE_INIT;
+static int heap_host_trace_fd = -1;
+static __thread bool heap_host_trace_busy = false;
+
+static void heap_host_trace_init(void) {
+    const char* path = getenv("FURI_HOST_ALLOC_TRACE");
+    if(path) {
+        heap_host_trace_fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
+    }
+}
+
+/* One line per call: "a <pointer> <size>" or "f <pointer>", formatted on stack */
+static void heap_host_trace(char op, void* ptr, size_t size) {
+    if(heap_host_trace_busy) return;
+    heap_host_trace_busy = true;
+    pthread_once(&heap_host_trace_once, heap_host_trace_init);
+    if(heap_host_trace_fd >= 0) {
+        char line[48];
+        int length = (op == 'a') ? snprintf(line, sizeof(line), "a %p %zu\n", ptr, size) :
+                                   snprintf(line, sizeof(line), "f %p\n", ptr);
+        if(write(heap_host_trace_fd, line, length) < 0) {
+            close(heap_host_trace_fd);
+            heap_host_trace_fd = -1;
+        }
+    }
+    heap_host_trace_busy = false;
+}
+
+static void heap_host_account(size_t size) {
+    size_t used = atomic_fetch_add(&heap_host_used, size) + size;
+    size_t used_max = atomic_load(&heap_host_used_max);
+    while(used > used_max && !atomic_compare_exchange_weak(&heap_host_used_max, &used_max, used)) {
+    }
+}
+
+void* pvPortMalloc(size_t xSize) {
+    void* ptr = heap_host_malloc(xSize);
+    heap_host_trace('a', ptr, xSize);
+    if(ptr) {
+        heap_host_account(malloc_usable_size(ptr));
+    }
+    return ptr;
+}
+
+void* memmgr_heap_alloc(size_t size, void* caller) {
+    (void)caller;
+    return pvPortMalloc(size);
+}
+
+void vPortFree(void* pv) {
+    if(pv) {
+        heap_host_trace('f', pv, 0);
+        atomic_fetch_sub(&heap_host_used, malloc_usable_size(pv));
+        heap_host_free(pv);
+    }
+}
+
+void* memmgr_heap_realloc(void* ptr, size_t size) {
+    if(ptr == NULL) {
+        return pvPortMalloc(size);
+    }
+    if(size == 0) {
+        vPortFree(ptr);
+        return NULL;
+    }
+
+    size_t old_size = malloc_usable_size(ptr);
+    // Old pointer is only compared and traced once realloc is done
+    uintptr_t old_address = (uintptr_t)ptr;
+    void* new_ptr = heap_host_realloc(ptr, size);
+    if(new_ptr) {
+        atomic_fetch_sub(&heap_host_used, old_size);
+        heap_host_account(malloc_usable_size(new_ptr));
+        if((uintptr_t)new_ptr == old_address) {
+            atomic_fetch_add(&heap_host_realloc_in_place, 1);
+        } else {
+            atomic_fetch_add(&heap_host_realloc_moved, 1);
+        }
+        heap_host_trace('f', (void*)old_address, 0);
+        heap_host_trace('a', new_ptr, size);
+    }
+    return new_ptr;
+}
+
+size_t xPortGetFreeHeapSize(void) {
+    size_t used = atomic_load(&heap_host_used);
+    return (used < FURI_HOST_HEAP_SIZE) ? FURI_HOST_HEAP_SIZE - used : 0;
+}
+
+size_t xPortGetMinimumEverFreeHeapSize(void) {
+    size_t used_max = atomic_load(&heap_host_used_max);
+    return (used_max < FURI_HOST_HEAP_SIZE) ? FURI_HOST_HEAP_SIZE - used_max : 0;
+}
+
+/* Per-thread tracing, counters, samples and slab rely on heap_4 internals, host reports them as empty */
+
+void memmgr_heap_enable_thread_trace(osThreadId_t thread_id) {
+    (void)thread_id;
+}
+
+void memmgr_heap_disable_thread_trace(osThreadId_t thread_id) {
+    (void)thread_id;
+}
+
+size_t memmgr_heap_get_thread_memory(osThreadId_t thread_id) {
+    (void)thread_id;
+    return MEMMGR_HEAP_UNKNOWN;
+}
+
+size_t memmgr_heap_get_threads_stats(MemmgrHeapThreadStats* stats, size_t count) {
+    (void)stats;
+    (void)count;
+    return 0;
+}
+
+void memmgr_heap_on_task_delete(void* task) {
+    (void)task;
+}
+
+void memmgr_heap_set_sample_rate(uint32_t rate) {
+    (void)rate;
+}
+
+uint32_t memmgr_heap_get_sample_rate() {
+    return 0;
+}
+
+size_t memmgr_heap_get_samples(MemmgrHeapSample* samples, size_t count) {
+    (void)samples;
+    (void)count;
+    return 0;
+}
+
+void memmgr_heap_get_stats(MemmgrHeapStats* stats) {
+    memset(stats, 0, sizeof(MemmgrHeapStats));
+    stats->heap_free_bytes = xPortGetFreeHeapSize();
+    stats->realloc_in_place = atomic_load(&heap_host_realloc_in_place);
+    stats->realloc_moved = atomic_load(&heap_host_realloc_moved);
+}
+
+void memmgr_heap_get_slab_stats(uint8_t class_id, MemmgrSlabClassStats* stats) {
+    memset(stats, 0, sizeof(MemmgrSlabClassStats));
+    stats->object_size = MEMMGR_SLAB_MIN_SIZE << class_id;
+}
+
+size_t memmgr_heap_get_max_free_block() {
+    return xPortGetFreeHeapSize();
+}
+
+void memmgr_heap_printf_free_blocks() {
+    printf("Host heap: %zu bytes in use\r\n", atomic_load(&heap_host_used));
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Initialize condition variable bound to CLOCK_MONOTONIC
+ *
+ * @param cond condition variable to initialize
+ */
+void os_host_cond_init(pthread_cond_t* cond);
+
+/** Convert timeout in ticks to absolute CLOCK_MONOTONIC deadline
+ *
+ * @param deadline deadline to fill
+ * @param ticks timeout in ticks (milliseconds)
+ */
+void os_host_deadline(struct timespec* deadline, uint32_t ticks);
+
+/** Wait on condition with optional timeout in ticks
+ *
+ * @param cond condition variable
+ * @param mutex locked mutex protecting predicate
+ * @param deadline absolute deadline or NULL to wait forever
+ * @return false on timeout
+ */
+bool os_host_cond_wait(pthread_cond_t* cond, pthread_mutex_t* mutex, struct timespec* deadline);
+
+/** Global scheduler lock, shared by osKernelLock and vTaskSuspendAll */
+void os_host_scheduler_lock(void);
+
+/** Release global scheduler lock */
+void os_host_scheduler_unlock(void);
+
+/** Get scheduler lock nesting of calling thread */
+uint32_t os_host_scheduler_lock_depth(void);
+
+/** Get thread number, FreeRTOS uxTaskNumber counterpart
+ *
+ * @param thread_id thread id
+ * @return number set with os_host_thread_set_number, 0 by default
+ */
+uint32_t os_host_thread_get_number(void* thread_id);
+
+/** Set thread number
+ *
+ * @param thread_id thread id
+ * @param number number to keep
+ */
+void os_host_thread_set_number(void* thread_id, uint32_t number);
+
+#ifdef __cplusplus
+}
+#endif
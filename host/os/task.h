@@ -0,0 +1,42 @@
+/**
+ * @file task.h
+ * Host: FreeRTOS task API subset
+ *
+ * Suspending the scheduler takes a global recursive lock shared with
+ * osKernelLock. Other threads keep running until they try to take it too.
+ */
+
+#pragma once
+
+#include "FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef void* TaskHandle_t;
+
+#define taskENTER_CRITICAL() vTaskSuspendAll()
+#define taskEXIT_CRITICAL() xTaskResumeAll()
+#define taskENTER_CRITICAL_FROM_ISR() (vTaskSuspendAll(), 0)
+#define taskEXIT_CRITICAL_FROM_ISR(x) ((void)(x), xTaskResumeAll())
+#define taskYIELD() taskYieldHost()
+
+#define taskSCHEDULER_SUSPENDED ((BaseType_t)0)
+#define taskSCHEDULER_NOT_STARTED ((BaseType_t)1)
+#define taskSCHEDULER_RUNNING ((BaseType_t)2)
+
+TickType_t xTaskGetTickCount(void);
+TickType_t xTaskGetTickCountFromISR(void);
+void vTaskSuspendAll(void);
+BaseType_t xTaskResumeAll(void);
+void vTaskDelay(const TickType_t xTicksToDelay);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+BaseType_t xTaskGetSchedulerState(void);
+UBaseType_t uxTaskGetTaskNumber(TaskHandle_t xTask);
+void vTaskSetTaskNumber(TaskHandle_t xTask, const UBaseType_t uxHandle);
+void taskYieldHost(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,44 @@
+/**
+ * @file timers.h
+ * Host: FreeRTOS software timer API subset
+ *
+ * On target osTimerId_t is a TimerHandle_t, so sources mix both APIs. Host
+ * timers are osTimer ones, FreeRTOS calls are mapped on top of them.
+ */
+
+#pragma once
+
+#include "FreeRTOS.h"
+#include "cmsis_os2.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef void* TimerHandle_t;
+
+static inline BaseType_t xTimerStop(TimerHandle_t xTimer, TickType_t xTicksToWait) {
+    (void)xTicksToWait;
+    return (osTimerStop(xTimer) == osOK) ? pdPASS : pdFAIL;
+}
+
+static inline BaseType_t xTimerChangePeriod(
+    TimerHandle_t xTimer,
+    TickType_t xNewPeriod,
+    TickType_t xTicksToWait) {
+    (void)xTicksToWait;
+    return (osTimerStart(xTimer, xNewPeriod) == osOK) ? pdPASS : pdFAIL;
+}
+
+static inline BaseType_t xTimerIsTimerActive(TimerHandle_t xTimer) {
+    return osTimerIsRunning(xTimer) ? pdTRUE : pdFALSE;
+}
+
+static inline BaseType_t xTimerDelete(TimerHandle_t xTimer, TickType_t xTicksToWait) {
+    (void)xTicksToWait;
+    return (osTimerDelete(xTimer) == osOK) ? pdPASS : pdFAIL;
+}
+
+#ifdef __cplusplus
+}
+#endif
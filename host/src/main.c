@@ -0,0 +1,82 @@
+#include <furi.h>
+#include <furi-hal.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "minunit_vars.h"
+
+#define TAG "Host"
+
+int32_t storage_srv(void* p);
+
+int run_minunit();
+int run_minunit_test_irda_decoder_encoder();
+int run_minunit_test_flipper_file();
+int run_minunit_test_bad_usb();
+
+void minunit_print_progress(void) {
+}
+
+void minunit_print_fail(const char* str) {
+    printf("%s\n", str);
+}
+
+static FuriThread* host_service_start(const char* name, FuriThreadCallback callback) {
+    FuriThread* thread = furi_thread_alloc();
+    furi_thread_set_name(thread, name);
+    furi_thread_set_stack_size(thread, 4096);
+    furi_thread_set_callback(thread, callback);
+    furi_check(furi_thread_start(thread));
+    return thread;
+}
+
+static int32_t host_unit_tests(void* context) {
+    uint32_t test_result = 0;
+
+    // Wait for services the same way applications do
+    furi_record_open("storage");
+    furi_record_close("storage");
+
+    uint32_t heap_before = memmgr_get_free_heap() + memmgr_get_free_slab();
+    uint32_t tick = osKernelGetTickCount();
+
+    test_result |= run_minunit();
+    test_result |= run_minunit_test_irda_decoder_encoder();
+    test_result |= run_minunit_test_flipper_file();
+    test_result |= run_minunit_test_bad_usb();
+
+    tick = osKernelGetTickCount() - tick;
+    FURI_LOG_I(TAG, "Consumed: %0.2fs", (float)tick / osKernelGetTickFreq());
+
+    if(test_result == 0) {
+        delay(200); /* wait for tested services and apps to deallocate */
+        uint32_t heap_after = memmgr_get_free_heap() + memmgr_get_free_slab();
+        if(heap_after != heap_before) {
+            FURI_LOG_E(TAG, "Leaked: %ld", (int32_t)(heap_before - heap_after));
+        } else {
+            FURI_LOG_I(TAG, "No leaks");
+        }
+        FURI_LOG_I(TAG, "PASSED");
+    } else {
+        FURI_LOG_E(TAG, "FAILED");
+    }
+
+    furi_log_flush(1000);
+    fflush(stdout);
+    exit(test_result == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    osKernelInitialize();
+
+    furi_hal_init();
+    furi_init();
+
+    host_service_start("StorageSrv", storage_srv);
+    host_service_start("UnitTests", host_unit_tests);
+
+    osKernelStart();
+
+    return EXIT_FAILURE;
+}
@@ -165,6 +165,7 @@ static int32_t irda_worker_rx_thread(void* thread_context) {
     while(1) {
         events = osEventFlagsWait(instance->events, IRDA_WORKER_ALL_RX_EVENTS, 0, osWaitForever);
         furi_check(events & IRDA_WORKER_ALL_RX_EVENTS); /* at least one caught */
+        FURI_TRACE_BEGIN("irda_worker_rx");
 
         if (events & IRDA_WORKER_RX_RECEIVED) {
             if (!instance->rx.overrun && instance->blink_enable && ((xTaskGetTickCount() - last_blink_time) > 80)) {
@@ -199,6 +200,7 @@ static int32_t irda_worker_rx_thread(void* thread_context) {
             }
             instance->signal.timings_cnt = 0;
         }
+        FURI_TRACE_END("irda_worker_rx");
         if (events & IRDA_WORKER_EXIT)
             break;
     }
@@ -492,7 +494,9 @@ static int32_t irda_worker_tx_thread(void* thread_context) {
             }
 
             if (events & IRDA_WORKER_TX_FILL_BUFFER) {
+                FURI_TRACE_BEGIN("irda_worker_tx");
                 irda_worker_tx_fill_buffer(instance);
+                FURI_TRACE_END("irda_worker_tx");
 
                 if (instance->tx.need_reinitialization) {
                     instance->state = IrdaWorkerStateWaitTxEnd;
@@ -1,4 +1,8 @@
 #include "emv_decoder.h"
+#include "emv_tlv.h"
+
+/* First tag byte with these bits set is followed by second one */
+#define EMV_TAG_MULTI_BYTE 0x1F
 
 const PDOLValue pdol_term_info = {0x9F59, {0xC8, 0x80, 0x00}}; // Terminal transaction information
 const PDOLValue pdol_term_type = {0x9F5A, {0x00}}; // Terminal transaction type
@@ -56,19 +60,74 @@ static const uint8_t pdol_ans[] = {
                           0x52, 0x96, 0xC9, 0x85, 0x9F, 0x27, 0x01, 0x00, 0x9F, 0x36, 0x02, 0x06,
                           0x0C, 0x9F, 0x6C, 0x02, 0x10, 0x00, 0x90, 0x00};
 
-static uint16_t emv_parse_TLV(uint8_t* dest, uint8_t* src, uint16_t* idx) {
-    uint8_t len = src[*idx + 1];
-    memcpy(dest, &src[*idx + 2], len);
-    *idx = *idx + len + 1;
-    return len;
+static void emv_copy_value(
+    uint8_t* dest,
+    uint8_t* dest_len,
+    uint8_t dest_size,
+    const uint8_t* value,
+    uint16_t value_len) {
+    uint8_t len = value_len < dest_size ? value_len : dest_size;
+    memcpy(dest, value, len);
+    *dest_len = len;
+}
+
+static uint16_t emv_get_u16(const uint8_t* value) {
+    return (value[0] << 8) | value[1];
 }
 
-static bool emv_decode_search_tag_u16_r(uint16_t tag, uint8_t* buff, uint16_t* idx) {
-    if((buff[*idx] << 8 | buff[*idx + 1]) == tag) {
-        *idx = *idx + 3;
-        return true;
+/* Value of object with tag at pos, NULL if it runs past end. Short APDU response
+ * has one byte lengths, 0x81 form included. */
+static const uint8_t* emv_scan_value(
+    const uint8_t* buff,
+    uint16_t end,
+    uint16_t pos,
+    uint8_t tag_len,
+    uint16_t* value_len) {
+    uint16_t i = pos + tag_len;
+    if(i >= end) return NULL;
+    uint16_t len = buff[i++];
+    if(len == 0x81) {
+        if(i == end) return NULL;
+        len = buff[i++];
     }
-    return false;
+    if(len > end - i) return NULL;
+    *value_len = len;
+    return &buff[i];
+}
+
+static uint8_t emv_get_nibble(const uint8_t* value, uint16_t nibble) {
+    return (nibble & 1) ? value[nibble / 2] & 0x0F : value[nibble / 2] >> 4;
+}
+
+/* Track 2 equivalent data: PAN digits, separator, YYMM expiration date, then service code */
+static bool emv_decode_track2(const uint8_t* value, uint16_t len, EmvApplication* app) {
+    uint16_t nibbles = len * 2;
+    uint16_t separator = nibbles;
+    for(uint16_t i = 0; i < len; i++) {
+        if((value[i] >> 4) == EMV_TRACK2_SEPARATOR) {
+            separator = i * 2;
+            break;
+        } else if((value[i] & 0x0F) == EMV_TRACK2_SEPARATOR) {
+            separator = i * 2 + 1;
+            break;
+        }
+    }
+    uint16_t pan_len = (separator + 1) / 2;
+    if(!separator || separator == nibbles || pan_len > sizeof(app->card_number)) return false;
+
+    memcpy(app->card_number, value, pan_len);
+    if(separator & 1) {
+        // Odd digit count, pad like PAN data object
+        app->card_number[pan_len - 1] |= 0x0F;
+    }
+    app->card_number_len = pan_len;
+    if(separator + 4 < nibbles) {
+        app->exp_year = emv_get_nibble(value, separator + 1) << 4 |
+                        emv_get_nibble(value, separator + 2);
+        app->exp_month = emv_get_nibble(value, separator + 3) << 4 |
+                         emv_get_nibble(value, separator + 4);
+    }
+    return true;
 }
 
 uint16_t emv_prepare_select_ppse(uint8_t* dest) {
@@ -84,25 +143,53 @@ uint16_t emv_prepare_select_ppse(uint8_t* dest) {
     return sizeof(emv_select_ppse);
 }
 
+/* Short SELECT and GPO responses are scanned once, it is cheaper than building index.
+ * Only READ RECORD templates, long and looked up for several tags, are indexed. */
 bool emv_decode_ppse_response(uint8_t* buff, uint16_t len, EmvApplication* app) {
     uint16_t i = 0;
     bool app_aid_found = false;
+    uint8_t best_rank = 0;
 
     while(i < len) {
-        if(buff[i] == EMV_TAG_APP_TEMPLATE) {
-            uint8_t app_len = buff[++i];
-            for(uint16_t j = i; j < i + app_len; j++) {
-                if(buff[j] == EMV_TAG_AID) {
-                    app_aid_found = true;
-                    app->aid_len = buff[j + 1];
-                    emv_parse_TLV(app->aid, buff, &j);
-                } else if(buff[j] == EMV_TAG_PRIORITY) {
-                    emv_parse_TLV(&app->priority, buff, &j);
-                }
+        const uint8_t* tmpl;
+        uint16_t tmpl_len;
+        if(buff[i] != EMV_TAG_APP_TEMPLATE ||
+           !(tmpl = emv_scan_value(buff, len, i, 1, &tmpl_len))) {
+            i++;
+            continue;
+        }
+        uint16_t tmpl_end = tmpl - buff + tmpl_len;
+        const uint8_t* aid = NULL;
+        uint16_t aid_len = 0;
+        uint8_t priority = 0;
+        uint16_t j = tmpl - buff;
+        while(j < tmpl_end) {
+            const uint8_t* value;
+            uint16_t value_len;
+            if(buff[j] == EMV_TAG_AID && !aid &&
+               (value = emv_scan_value(buff, tmpl_end, j, 1, &value_len))) {
+                aid = value;
+                aid_len = value_len;
+                j = value - buff + value_len;
+            } else if(
+                buff[j] == EMV_TAG_PRIORITY &&
+                (value = emv_scan_value(buff, tmpl_end, j, 1, &value_len))) {
+                if(value_len == 1) priority = value[0];
+                j = value - buff + value_len;
+            } else {
+                j++;
             }
-            i += app_len;
         }
-        i++;
+        i = tmpl_end;
+
+        if(!aid || !aid_len || aid_len > sizeof(app->aid)) continue;
+        // Lowest priority number is selected, 0 means no priority assigned
+        uint8_t rank = (priority & 0x0F) ? (priority & 0x0F) : 0x10;
+        if(app_aid_found && rank >= best_rank) continue;
+        emv_copy_value(app->aid, &app->aid_len, sizeof(app->aid), aid, aid_len);
+        app->priority = priority;
+        best_rank = rank;
+        app_aid_found = true;
     }
     return app_aid_found;
 }
@@ -126,20 +213,30 @@ uint16_t emv_prepare_select_app(uint8_t* dest, EmvApplication* app) {
 }
 
 bool emv_decode_select_app_response(uint8_t* buff, uint16_t len, EmvApplication* app) {
-    uint16_t i = 0;
     bool found_name = false;
+    bool found_pdol = false;
+    uint16_t i = 0;
 
-    while(i < len) {
-        if(buff[i] == EMV_TAG_CARD_NAME) {
-            uint8_t name_len = buff[i + 1];
-            emv_parse_TLV((uint8_t*)app->name, buff, &i);
+    while(i < len && !(found_name && found_pdol)) {
+        const uint8_t* value;
+        uint16_t value_len;
+        if(buff[i] == EMV_TAG_CARD_NAME && !found_name &&
+           (value = emv_scan_value(buff, len, i, 1, &value_len))) {
+            uint8_t name_len;
+            emv_copy_value(
+                (uint8_t*)app->name, &name_len, sizeof(app->name) - 1, value, value_len);
             app->name[name_len] = '\0';
             found_name = true;
-        } else if(((buff[i] << 8) | buff[i + 1]) == EMV_TAG_PDOL) {
+            i = value - buff + value_len;
+        } else if(
+            i + 1 < len && ((buff[i] << 8) | buff[i + 1]) == EMV_TAG_PDOL && !found_pdol &&
+            (value = emv_scan_value(buff, len, i, 2, &value_len))) {
+            emv_copy_value(app->pdol.data, &app->pdol.size, MAX_APDU_LEN, value, value_len);
+            found_pdol = true;
+            i = value - buff + value_len;
+        } else {
             i++;
-            app->pdol.size = emv_parse_TLV(app->pdol.data, buff, &i);
         }
-        i++;
     }
     return found_name;
 }
@@ -196,16 +293,50 @@ uint16_t emv_prepare_get_proc_opt(uint8_t* dest, EmvApplication* app) {
 }
 
 bool emv_decode_get_proc_opt(uint8_t* buff, uint16_t len, EmvApplication* app) {
-    for(uint16_t i = 0; i < len; i++) {
-        if(buff[i] == EMV_TAG_CARD_NUM) {
-            app->card_number_len = 8;
-            memcpy(app->card_number, &buff[i + 2], app->card_number_len);
-            return true;
-        } else if(buff[i] == EMV_TAG_AFL) {
-            app->afl.size = emv_parse_TLV(app->afl.data, buff, &i);
+    const uint8_t* value;
+    uint16_t value_len;
+    if(!len) return false;
+
+    if(buff[0] == EMV_TAG_RESP_FORMAT1) {
+        // Application interchange profile followed by AFL
+        value = emv_scan_value(buff, len, 0, 1, &value_len);
+        if(value && value_len > EMV_AIP_SIZE) {
+            emv_copy_value(
+                app->afl.data,
+                &app->afl.size,
+                MAX_APDU_LEN,
+                value + EMV_AIP_SIZE,
+                value_len - EMV_AIP_SIZE);
         }
+        return false;
     }
-    return false;
+
+    // Format 2 template holds primitive objects only, walk them instead of bytes
+    const uint8_t* tmpl;
+    uint16_t tmpl_len;
+    if(buff[0] != EMV_TAG_RESP_FORMAT2 || !(tmpl = emv_scan_value(buff, len, 0, 1, &tmpl_len))) {
+        return false;
+    }
+    uint16_t end = tmpl - buff + tmpl_len;
+    uint16_t i = tmpl - buff;
+    bool found_afl = false;
+    bool found_card_num = false;
+    bool card_num_decoded = false;
+    while(i < end && !(found_afl && found_card_num)) {
+        uint8_t tag = buff[i];
+        uint8_t tag_len = (tag & EMV_TAG_MULTI_BYTE) == EMV_TAG_MULTI_BYTE ? 2 : 1;
+        value = emv_scan_value(buff, end, i, tag_len, &value_len);
+        if(!value) break;
+        if(tag == EMV_TAG_AFL && !found_afl) {
+            emv_copy_value(app->afl.data, &app->afl.size, MAX_APDU_LEN, value, value_len);
+            found_afl = true;
+        } else if(tag == EMV_TAG_CARD_NUM && !found_card_num) {
+            card_num_decoded = emv_decode_track2(value, value_len, app);
+            found_card_num = true;
+        }
+        i = value - buff + value_len;
+    }
+    return card_num_decoded;
 }
 
 uint16_t emv_prepare_read_sfi_record(uint8_t* dest, uint8_t sfi, uint8_t record_num) {
@@ -223,24 +354,35 @@ uint16_t emv_prepare_read_sfi_record(uint8_t* dest, uint8_t sfi, uint8_t record_
 }
 
 bool emv_decode_read_sfi_record(uint8_t* buff, uint16_t len, EmvApplication* app) {
+    EmvTlvIndex index;
+    emv_tlv_index(&index, buff, len);
     bool pan_parsed = false;
-    for(uint16_t i = 0; i < len; i++) {
-        if(buff[i] == EMV_TAG_PAN) {
-            if(buff[i + 1] == 8 || buff[i + 1] == 10) {
-                app->card_number_len = buff[i + 1];
-                memcpy(app->card_number, &buff[i + 2], app->card_number_len);
-                pan_parsed = true;
-            }
-        } else if(emv_decode_search_tag_u16_r(EMV_TAG_EXP_DATE, buff, &i)) {
-            app->exp_year = buff[i++];
-            app->exp_month = buff[i++];
-        } else if(emv_decode_search_tag_u16_r(EMV_TAG_CURRENCY_CODE, buff, &i)) {
-            app->currency_code = (buff[i] << 8) | buff[i + 1];
-            i += 2;
-        } else if(emv_decode_search_tag_u16_r(EMV_TAG_COUNTRY_CODE, buff, &i)) {
-            app->country_code = (buff[i] << 8) | buff[i + 1];
-            i += 2;
-        }
+
+    const EmvTlvNode* pan = emv_tlv_find(&index, EMV_TAG_PAN);
+    const EmvTlvNode* card_num = emv_tlv_find(&index, EMV_TAG_CARD_NUM);
+    if(pan && (pan->len == 8 || pan->len == 10)) {
+        emv_copy_value(
+            app->card_number,
+            &app->card_number_len,
+            sizeof(app->card_number),
+            emv_tlv_value(&index, pan),
+            pan->len);
+        pan_parsed = true;
+    } else if(card_num) {
+        pan_parsed = emv_decode_track2(emv_tlv_value(&index, card_num), card_num->len, app);
+    }
+    const EmvTlvNode* exp_date = emv_tlv_find(&index, EMV_TAG_EXP_DATE);
+    if(exp_date && exp_date->len >= 2) {
+        app->exp_year = emv_tlv_value(&index, exp_date)[0];
+        app->exp_month = emv_tlv_value(&index, exp_date)[1];
+    }
+    const EmvTlvNode* currency = emv_tlv_find(&index, EMV_TAG_CURRENCY_CODE);
+    if(currency && currency->len == 2) {
+        app->currency_code = emv_get_u16(emv_tlv_value(&index, currency));
+    }
+    const EmvTlvNode* country = emv_tlv_find(&index, EMV_TAG_COUNTRY_CODE);
+    if(country && country->len == 2) {
+        app->country_code = emv_get_u16(emv_tlv_value(&index, country));
     }
     return pan_parsed;
 }
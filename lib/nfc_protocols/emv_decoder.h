@@ -16,11 +16,16 @@
 #define EMV_TAG_CARD_NUM 0x57
 #define EMV_TAG_PAN 0x5A
 #define EMV_TAG_AFL 0x94
+#define EMV_TAG_RESP_FORMAT1 0x80
+#define EMV_TAG_RESP_FORMAT2 0x77
 #define EMV_TAG_EXP_DATE 0x5F24
 #define EMV_TAG_COUNTRY_CODE 0x5F28
 #define EMV_TAG_CURRENCY_CODE 0x9F42
 #define EMV_TAG_CARDHOLDER_NAME 0x5F20
 
+#define EMV_TRACK2_SEPARATOR 0x0D
+#define EMV_AIP_SIZE 2
+
 typedef struct {
     uint16_t tag;
     uint8_t data[];
@@ -0,0 +1,93 @@
+#include "emv_reader.h"
+
+#define EMV_AFL_ENTRY_SIZE 4
+#define EMV_SFI_MAX 30
+
+static bool emv_reader_is_complete(EmvReader* reader) {
+    return reader->app.card_number_len && reader->app.exp_month;
+}
+
+static void emv_reader_plan_records(EmvReader* reader) {
+    APDU* afl = &reader->app.afl;
+    reader->records_num = 0;
+    for(uint16_t i = 0; i + EMV_AFL_ENTRY_SIZE <= afl->size; i += EMV_AFL_ENTRY_SIZE) {
+        uint8_t sfi = afl->data[i] >> 3;
+        uint8_t record_start = afl->data[i + 1];
+        uint8_t record_end = afl->data[i + 2];
+        if(sfi == 0 || sfi > EMV_SFI_MAX || record_start == 0) continue;
+        for(uint16_t record = record_start; record <= record_end; record++) {
+            if(reader->records_num == EMV_READER_RECORDS_MAX) return;
+            reader->records[reader->records_num].sfi = sfi;
+            reader->records[reader->records_num].record = record;
+            reader->records_num++;
+        }
+    }
+}
+
+static void emv_reader_finish(EmvReader* reader) {
+    reader->state = reader->app.card_number_len ? EmvReaderStateDone : EmvReaderStateFail;
+}
+
+void emv_reader_init(EmvReader* reader) {
+    memset(reader, 0, sizeof(EmvReader));
+    reader->state = EmvReaderStateSelectPpse;
+}
+
+uint16_t emv_reader_prepare(EmvReader* reader, uint8_t* dest) {
+    if(reader->state == EmvReaderStateReadRecords) {
+        if(reader->records_sent == reader->records_num) return 0;
+        EmvRecord* record = &reader->records[reader->records_sent++];
+        return emv_prepare_read_sfi_record(dest, record->sfi, record->record);
+    }
+    if(reader->pending) return 0;
+
+    uint16_t len = 0;
+    if(reader->state == EmvReaderStateSelectPpse) {
+        len = emv_prepare_select_ppse(dest);
+    } else if(reader->state == EmvReaderStateSelectApp) {
+        len = emv_prepare_select_app(dest, &reader->app);
+    } else if(reader->state == EmvReaderStateGetProcOpt) {
+        len = emv_prepare_get_proc_opt(dest, &reader->app);
+    }
+    reader->pending = len > 0;
+    return len;
+}
+
+bool emv_reader_process(EmvReader* reader, uint8_t* buff, uint16_t len) {
+    reader->pending = false;
+    switch(reader->state) {
+    case EmvReaderStateSelectPpse:
+        if(emv_decode_ppse_response(buff, len, &reader->app)) {
+            reader->state = EmvReaderStateSelectApp;
+        } else {
+            reader->state = EmvReaderStateFail;
+        }
+        break;
+    case EmvReaderStateSelectApp:
+        if(emv_decode_select_app_response(buff, len, &reader->app) || reader->app.pdol.size) {
+            reader->state = EmvReaderStateGetProcOpt;
+        } else {
+            reader->state = EmvReaderStateFail;
+        }
+        break;
+    case EmvReaderStateGetProcOpt:
+        emv_decode_get_proc_opt(buff, len, &reader->app);
+        emv_reader_plan_records(reader);
+        if(emv_reader_is_complete(reader) || !reader->records_num) {
+            emv_reader_finish(reader);
+        } else {
+            reader->state = EmvReaderStateReadRecords;
+        }
+        break;
+    case EmvReaderStateReadRecords:
+        emv_decode_read_sfi_record(buff, len, &reader->app);
+        reader->records_read++;
+        if(emv_reader_is_complete(reader) || reader->records_read == reader->records_num) {
+            emv_reader_finish(reader);
+        }
+        break;
+    default:
+        break;
+    }
+    return reader->state != EmvReaderStateDone && reader->state != EmvReaderStateFail;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "emv_decoder.h"
+
+/** Records read at most, AFL entries past it are dropped */
+#define EMV_READER_RECORDS_MAX 32
+
+typedef enum {
+    EmvReaderStateSelectPpse,
+    EmvReaderStateSelectApp,
+    EmvReaderStateGetProcOpt,
+    EmvReaderStateReadRecords,
+    EmvReaderStateDone,
+    EmvReaderStateFail,
+} EmvReaderState;
+
+typedef struct {
+    uint8_t sfi;
+    uint8_t record;
+} EmvRecord;
+
+/**
+ * Terminal side of EMV read: SELECT PPSE, SELECT application, GET PROCESSING
+ * OPTIONS, then READ RECORD for files from AFL until card number and
+ * expiration date are found.
+ *
+ * Commands and responses are exchanged by caller. Record commands are known
+ * once AFL is parsed, so next one can be prepared while previous response is
+ * still in flight.
+ */
+typedef struct {
+    EmvReaderState state;
+    EmvApplication app;
+    EmvRecord records[EMV_READER_RECORDS_MAX];
+    uint8_t records_num;
+    uint8_t records_sent;
+    uint8_t records_read;
+    bool pending;
+} EmvReader;
+
+void emv_reader_init(EmvReader* reader);
+
+/**
+ * Prepare next command
+ * @param reader reader
+ * @param dest command buffer, MAX_APDU_LEN bytes
+ * @return command length, 0 if reading is over or command depends on response not processed yet
+ */
+uint16_t emv_reader_prepare(EmvReader* reader, uint8_t* dest);
+
+/**
+ * Process response to oldest prepared command
+ * @param reader reader
+ * @param buff response with status word
+ * @param len response length
+ * @return true if reading goes on, false once state is done or fail
+ */
+bool emv_reader_process(EmvReader* reader, uint8_t* buff, uint16_t len);
@@ -0,0 +1,118 @@
+#include "emv_tlv.h"
+
+#define EMV_TLV_TAG_CONSTRUCTED (0x20)
+#define EMV_TLV_TAG_MULTI_BYTE (0x1F)
+#define EMV_TLV_TAG_MORE (0x80)
+#define EMV_TLV_LEN_LONG (0x80)
+
+static uint8_t emv_tlv_hash(uint16_t tag) {
+    return (((uint32_t)tag * 0x9E37) & 0xFFFF) >> 10 & (EMV_TLV_HASH_SIZE - 1);
+}
+
+static void emv_tlv_link(EmvTlvIndex* index, uint8_t node_idx) {
+    uint16_t tag = index->nodes[node_idx].tag;
+    uint8_t slot = emv_tlv_hash(tag);
+    while(index->hash[slot] != EMV_TLV_NONE) {
+        uint8_t idx = index->hash[slot];
+        if(index->nodes[idx].tag == tag) {
+            // Same tag seen before, append to keep buffer order
+            while(index->nodes[idx].next != EMV_TLV_NONE) {
+                idx = index->nodes[idx].next;
+            }
+            index->nodes[idx].next = node_idx;
+            return;
+        }
+        slot = (slot + 1) & (EMV_TLV_HASH_SIZE - 1);
+    }
+    index->hash[slot] = node_idx;
+}
+
+bool emv_tlv_index(EmvTlvIndex* index, const uint8_t* buff, uint16_t len) {
+    uint16_t end[EMV_TLV_MAX_DEPTH];
+    uint8_t parent[EMV_TLV_MAX_DEPTH];
+    uint8_t depth = 0;
+    uint16_t i = 0;
+
+    index->buff = buff;
+    index->count = 0;
+    memset(index->hash, EMV_TLV_NONE, sizeof(index->hash));
+    end[0] = len;
+    parent[0] = EMV_TLV_NONE;
+
+    while(true) {
+        // Leave finished templates
+        while(depth > 0 && i == end[depth]) {
+            depth--;
+        }
+        if(i == end[depth]) break;
+        // Padding between data objects
+        if(buff[i] == 0x00) {
+            i++;
+            continue;
+        }
+
+        uint16_t tag = buff[i++];
+        bool constructed = tag & EMV_TLV_TAG_CONSTRUCTED;
+        if((tag & EMV_TLV_TAG_MULTI_BYTE) == EMV_TLV_TAG_MULTI_BYTE) {
+            // EMV doesn't use tags longer than 2 bytes
+            if(i == end[depth] || (buff[i] & EMV_TLV_TAG_MORE)) return false;
+            tag = (tag << 8) | buff[i++];
+        }
+
+        if(i == end[depth]) return false;
+        uint16_t value_len = buff[i++];
+        if(value_len & EMV_TLV_LEN_LONG) {
+            uint8_t len_bytes = value_len & ~EMV_TLV_LEN_LONG;
+            if(len_bytes == 0 || len_bytes > 2 || end[depth] - i < len_bytes) return false;
+            value_len = 0;
+            while(len_bytes--) {
+                value_len = (value_len << 8) | buff[i++];
+            }
+        }
+        if(value_len > end[depth] - i) return false;
+        if(index->count == EMV_TLV_MAX_NODES) return false;
+
+        uint8_t node_idx = index->count++;
+        EmvTlvNode* node = &index->nodes[node_idx];
+        node->tag = tag;
+        node->offset = i;
+        node->len = value_len;
+        node->parent = parent[depth];
+        node->next = EMV_TLV_NONE;
+        emv_tlv_link(index, node_idx);
+
+        if(constructed && value_len && depth + 1 < EMV_TLV_MAX_DEPTH) {
+            // Step into template, its objects follow
+            depth++;
+            end[depth] = i + value_len;
+            parent[depth] = node_idx;
+        } else {
+            i += value_len;
+        }
+    }
+    return true;
+}
+
+const EmvTlvNode* emv_tlv_find(const EmvTlvIndex* index, uint16_t tag) {
+    uint8_t slot = emv_tlv_hash(tag);
+    while(index->hash[slot] != EMV_TLV_NONE) {
+        const EmvTlvNode* node = &index->nodes[index->hash[slot]];
+        if(node->tag == tag) return node;
+        slot = (slot + 1) & (EMV_TLV_HASH_SIZE - 1);
+    }
+    return NULL;
+}
+
+const EmvTlvNode* emv_tlv_next(const EmvTlvIndex* index, const EmvTlvNode* node) {
+    return node->next == EMV_TLV_NONE ? NULL : &index->nodes[node->next];
+}
+
+const EmvTlvNode*
+    emv_tlv_find_child(const EmvTlvIndex* index, const EmvTlvNode* parent, uint16_t tag) {
+    uint8_t parent_idx = parent - index->nodes;
+    const EmvTlvNode* node = emv_tlv_find(index, tag);
+    while(node && node->parent != parent_idx) {
+        node = emv_tlv_next(index, node);
+    }
+    return node;
+}
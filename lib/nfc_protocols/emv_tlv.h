@@ -0,0 +1,57 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+/** Most data objects in one response, short APDU with 2 byte TLVs fits */
+#define EMV_TLV_MAX_NODES 48
+/** Nesting limit, deeper templates are indexed as primitive objects */
+#define EMV_TLV_MAX_DEPTH 6
+/** Tag lookup table, power of 2 and larger than node count */
+#define EMV_TLV_HASH_SIZE 64
+
+#define EMV_TLV_NONE 0xFF
+
+/** Data object, value stays in response buffer */
+typedef struct {
+    uint16_t tag;
+    uint16_t offset;
+    uint16_t len;
+    uint8_t parent;
+    uint8_t next;
+} EmvTlvNode;
+
+/**
+ * Index of BER-TLV data objects in response buffer.
+ * Built in one pass, nodes are in buffer order and same tags are chained.
+ */
+typedef struct {
+    const uint8_t* buff;
+    uint8_t count;
+    uint8_t hash[EMV_TLV_HASH_SIZE];
+    EmvTlvNode nodes[EMV_TLV_MAX_NODES];
+} EmvTlvIndex;
+
+/**
+ * Index response buffer
+ * @param index index to fill, buffer must outlive it
+ * @param buff response, trailing status word is indexed as empty object
+ * @param len response length
+ * @return true if whole buffer is well formed, on error objects before it are kept
+ */
+bool emv_tlv_index(EmvTlvIndex* index, const uint8_t* buff, uint16_t len);
+
+/** First object with tag at any depth, NULL if not found */
+const EmvTlvNode* emv_tlv_find(const EmvTlvIndex* index, uint16_t tag);
+
+/** Next object with same tag, NULL if it was last */
+const EmvTlvNode* emv_tlv_next(const EmvTlvIndex* index, const EmvTlvNode* node);
+
+/** First object with tag directly in template, NULL if not found */
+const EmvTlvNode*
+    emv_tlv_find_child(const EmvTlvIndex* index, const EmvTlvNode* parent, uint16_t tag);
+
+static inline const uint8_t* emv_tlv_value(const EmvTlvIndex* index, const EmvTlvNode* node) {
+    return index->buff + node->offset;
+}
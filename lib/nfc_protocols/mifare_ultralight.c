@@ -138,93 +138,145 @@ uint16_t mf_ul_prepare_write(uint8_t* dest, uint16_t page_addr, uint32_t data) {
     return 6;
 }
 
+static void mf_ul_emulation_set_counter(MifareUlDevice* mf_ul_emulate, uint8_t cnt_num) {
+    uint32_t counter = mf_ul_emulate->data.counter[cnt_num];
+    // LSB first, like reader parses it
+    mf_ul_emulate->emulation.counter[cnt_num][0] = counter;
+    mf_ul_emulate->emulation.counter[cnt_num][1] = counter >> 8;
+    mf_ul_emulate->emulation.counter[cnt_num][2] = counter >> 16;
+}
+
+static void mf_ul_emulation_set_rollover(MifareUlDevice* mf_ul_emulate, uint16_t page) {
+    MfUltralightEmulation* emulation = &mf_ul_emulate->emulation;
+    uint8_t* data = &mf_ul_emulate->data.data[page * MF_UL_PAGE_SIZE];
+    // Page is in both parts when there are only few pages between them
+    if(page >= emulation->rollover_page) {
+        uint16_t index = page - emulation->rollover_page;
+        memcpy(&emulation->rollover[index * MF_UL_PAGE_SIZE], data, MF_UL_PAGE_SIZE);
+    }
+    if(page < MF_UL_READ_PAGES - 1) {
+        uint16_t index = emulation->page_num - emulation->rollover_page + page;
+        memcpy(&emulation->rollover[index * MF_UL_PAGE_SIZE], data, MF_UL_PAGE_SIZE);
+    }
+}
+
 void mf_ul_prepare_emulation(MifareUlDevice* mf_ul_emulate, MifareUlData* data) {
     mf_ul_emulate->data = *data;
     mf_ul_emulate->data_changed = false;
-    if(data->version.storage_size == 0) {
-        mf_ul_emulate->type = MfUltralightTypeUnknown;
-        mf_ul_emulate->support_fast_read = false;
-    } else if(data->version.storage_size == 0x0B) {
+    mf_ul_emulate->type = MfUltralightTypeUnknown;
+    mf_ul_emulate->support_fast_read = false;
+    if(data->version.storage_size == 0x0B) {
         mf_ul_emulate->type = MfUltralightTypeUL11;
         mf_ul_emulate->support_fast_read = true;
     } else if(data->version.storage_size == 0x0E) {
         mf_ul_emulate->type = MfUltralightTypeUL21;
         mf_ul_emulate->support_fast_read = true;
     }
+
+    MfUltralightEmulation* emulation = &mf_ul_emulate->emulation;
+    emulation->page_num = data->data_size / MF_UL_PAGE_SIZE;
+    emulation->rollover_page = emulation->page_num > MF_UL_READ_PAGES - 1 ?
+                                   emulation->page_num - (MF_UL_READ_PAGES - 1) :
+                                   0;
+    // Last pages, then first ones. Dump shorter than READ window repeats in it,
+    // no page of such dump can be written, so it is filled here only.
+    uint16_t rollover_num = 0;
+    if(emulation->page_num) {
+        rollover_num = emulation->page_num - emulation->rollover_page + MF_UL_READ_PAGES - 1;
+    }
+    for(uint16_t index = 0; index < rollover_num; index++) {
+        uint16_t page = (emulation->rollover_page + index) % emulation->page_num;
+        memcpy(
+            &emulation->rollover[index * MF_UL_PAGE_SIZE],
+            &mf_ul_emulate->data.data[page * MF_UL_PAGE_SIZE],
+            MF_UL_PAGE_SIZE);
+    }
+    for(uint8_t i = 0; i < MF_UL_COUNTERS_NUM; i++) {
+        mf_ul_emulation_set_counter(mf_ul_emulate, i);
+    }
+    emulation->ack = MF_UL_ACK;
 }
 
-uint16_t mf_ul_prepare_emulation_response(uint8_t* buff_rx, uint16_t len_rx, uint8_t* buff_tx, MifareUlDevice* mf_ul_emulate) {
-    uint8_t cmd = buff_rx[0];
-    uint16_t page_num = mf_ul_emulate->data.data_size / 4;
+uint16_t mf_ul_prepare_emulation_response(uint8_t* buff_rx, uint16_t len_rx, uint8_t** buff_tx, MifareUlDevice* mf_ul_emulate) {
+    MfUltralightEmulation* emulation = &mf_ul_emulate->emulation;
+    uint16_t page_num = emulation->page_num;
     uint16_t tx_len = 0;
 
-    if(cmd == MF_UL_GET_VERSION_CMD) {
+    switch(buff_rx[0]) {
+    case MF_UL_GET_VERSION_CMD:
         if(mf_ul_emulate->type != MfUltralightTypeUnknown) {
+            *buff_tx = (uint8_t*)&mf_ul_emulate->data.version;
             tx_len = sizeof(mf_ul_emulate->data.version);
-            memcpy(buff_tx, &mf_ul_emulate->data.version, tx_len);
         }
-    } else if(cmd == MF_UL_READ_CMD) {
+        break;
+    case MF_UL_READ_CMD: {
         uint8_t start_page = buff_rx[1];
-        if(start_page < page_num) {
-            tx_len = 16;
-            if(start_page + 4 > page_num) {
-                // Handle roll-over mechanism
-                uint8_t end_pages_num = page_num - start_page;
-                memcpy(buff_tx, &mf_ul_emulate->data.data[start_page * 4], end_pages_num * 4);
-                memcpy(&buff_tx[end_pages_num * 4], mf_ul_emulate->data.data, (4 - end_pages_num) * 4);
-            } else {
-                memcpy(buff_tx, &mf_ul_emulate->data.data[start_page * 4], tx_len);
-            }
+        if(start_page < emulation->rollover_page) {
+            *buff_tx = &mf_ul_emulate->data.data[start_page * MF_UL_PAGE_SIZE];
+            tx_len = MF_UL_READ_PAGES * MF_UL_PAGE_SIZE;
+        } else if(start_page < page_num) {
+            // Window goes past last page and rolls over to page 0
+            uint16_t index = start_page - emulation->rollover_page;
+            *buff_tx = &emulation->rollover[index * MF_UL_PAGE_SIZE];
+            tx_len = MF_UL_READ_PAGES * MF_UL_PAGE_SIZE;
         }
-    } else if(cmd == MF_UL_FAST_READ_CMD) {
-        if(mf_ul_emulate->support_fast_read) {
-            uint8_t start_page = buff_rx[1];
-            uint8_t end_page = buff_rx[2];
-            if((start_page < page_num) &&
-               (end_page < page_num) && (start_page < end_page)) {
-                tx_len = (end_page - start_page) * 4;
-                memcpy(buff_tx, &mf_ul_emulate->data.data[start_page * 4], tx_len);
-               }
+    } break;
+    case MF_UL_FAST_READ_CMD: {
+        uint8_t start_page = buff_rx[1];
+        uint8_t end_page = buff_rx[2];
+        if(mf_ul_emulate->support_fast_read && (start_page <= end_page) &&
+           (end_page < page_num)) {
+            *buff_tx = &mf_ul_emulate->data.data[start_page * MF_UL_PAGE_SIZE];
+            tx_len = (end_page - start_page + 1) * MF_UL_PAGE_SIZE;
         }
-    } else if(cmd == MF_UL_WRITE) {
+    } break;
+    case MF_UL_WRITE: {
         uint8_t write_page = buff_rx[1];
         if((write_page > 1) && (write_page < page_num - 2)) {
-            memcpy(&mf_ul_emulate->data.data[write_page * 4], &buff_rx[2], 4);
+            memcpy(&mf_ul_emulate->data.data[write_page * MF_UL_PAGE_SIZE], &buff_rx[2], 4);
             mf_ul_emulate->data_changed = true;
+            mf_ul_emulation_set_rollover(mf_ul_emulate, write_page);
             // TODO make 4-bit ACK
-            buff_tx[0] = 0x0A;
+            *buff_tx = &emulation->ack;
             tx_len = 1;
         }
-    } else if(cmd == MF_UL_READ_CNT) {
+    } break;
+    case MF_UL_READ_CNT: {
         uint8_t cnt_num = buff_rx[1];
-        if(cnt_num < 3) {
-            buff_tx[0] = mf_ul_emulate->data.counter[cnt_num] >> 16;
-            buff_tx[1] = mf_ul_emulate->data.counter[cnt_num] >> 8;
-            buff_tx[2] = mf_ul_emulate->data.counter[cnt_num];
-            tx_len = 3;
+        if(cnt_num < MF_UL_COUNTERS_NUM) {
+            *buff_tx = emulation->counter[cnt_num];
+            tx_len = sizeof(emulation->counter[cnt_num]);
         }
-    } else if(cmd == MF_UL_INC_CNT) {
+    } break;
+    case MF_UL_INC_CNT: {
         uint8_t cnt_num = buff_rx[1];
         uint32_t inc = (buff_rx[2] | (buff_rx[3] << 8) | (buff_rx[4] << 16));
-        if((cnt_num < 3) && (mf_ul_emulate->data.counter[cnt_num] + inc < 0x00FFFFFF)) {
+        if((cnt_num < MF_UL_COUNTERS_NUM) &&
+           (mf_ul_emulate->data.counter[cnt_num] + inc < 0x00FFFFFF)) {
             mf_ul_emulate->data.counter[cnt_num] += inc;
+            mf_ul_emulation_set_counter(mf_ul_emulate, cnt_num);
             mf_ul_emulate->data_changed = true;
             // TODO make 4-bit ACK
-            buff_tx[0] = 0x0A;
+            *buff_tx = &emulation->ack;
             tx_len = 1;
         }
-    } else if(cmd == MF_UL_READ_SIG) {
+    } break;
+    case MF_UL_READ_SIG:
         // Check 2nd byte = 0x00 - RFU
         if(buff_rx[1] == 0x00) {
+            *buff_tx = mf_ul_emulate->data.signature;
             tx_len = sizeof(mf_ul_emulate->data.signature);
-            memcpy(buff_tx, mf_ul_emulate->data.signature, tx_len);
         }
-    } else if(cmd == MF_UL_CHECK_TEARING) {
+        break;
+    case MF_UL_CHECK_TEARING: {
         uint8_t cnt_num = buff_rx[1];
-        if(cnt_num < 3) {
-            buff_tx[0] = mf_ul_emulate->data.tearing[cnt_num];
+        if(cnt_num < MF_UL_COUNTERS_NUM) {
+            *buff_tx = &mf_ul_emulate->data.tearing[cnt_num];
             tx_len = 1;
         }
+    } break;
+    default:
+        break;
     }
     return tx_len;
 }
@@ -4,7 +4,9 @@
 #include <stdbool.h>
 #include <string.h>
 
+#ifndef MF_UL_MAX_DUMP_SIZE
 #define MF_UL_MAX_DUMP_SIZE 1024
+#endif
 
 #define MF_UL_TEARING_FLAG_DEFAULT (0xBD)
 
@@ -20,6 +22,11 @@
 #define MF_UL_CHECK_TEARING (0x3E)
 #define MF_UL_READ_VCSL (0x4B)
 
+#define MF_UL_ACK (0x0A)
+#define MF_UL_PAGE_SIZE (4)
+#define MF_UL_READ_PAGES (4)
+#define MF_UL_COUNTERS_NUM (3)
+
 
 typedef enum {
     MfUltralightTypeUnknown,
@@ -60,6 +67,18 @@ typedef struct {
     uint8_t data[MF_UL_MAX_DUMP_SIZE];
 } MifareUlData;
 
+/** Emulation responses which are not a plain slice of MifareUlData */
+typedef struct {
+    uint16_t page_num;
+    /** First page which READ window rolls over to page 0 from */
+    uint16_t rollover_page;
+    /** Pages from rollover_page to last one, then first ones: rolled over READ
+     * window is a slice of it, so WRITE updates one copy of page at most */
+    uint8_t rollover[2 * (MF_UL_READ_PAGES - 1) * MF_UL_PAGE_SIZE];
+    uint8_t counter[MF_UL_COUNTERS_NUM][3];
+    uint8_t ack;
+} MfUltralightEmulation;
+
 typedef struct {
     MfUltralightType type;
     uint8_t pages_to_read;
@@ -67,6 +86,7 @@ typedef struct {
     bool support_fast_read;
     bool data_changed;
     MifareUlData data;
+    MfUltralightEmulation emulation;
 } MifareUlDevice;
 
 bool mf_ul_check_card_type(uint8_t ATQA0, uint8_t ATQA1, uint8_t SAK);
@@ -94,5 +114,15 @@ void mf_ul_parse_fast_read_response(uint8_t* buff, uint8_t start_page, uint8_t e
 
 uint16_t mf_ul_prepare_write(uint8_t* dest, uint16_t page_addr, uint32_t data);
 
+/** Copy data and precompute responses to reader commands */
 void mf_ul_prepare_emulation(MifareUlDevice* mf_ul_emulate, MifareUlData* data);
-uint16_t mf_ul_prepare_emulation_response(uint8_t* buff_rx, uint16_t len_rx, uint8_t* buff_tx, MifareUlDevice* mf_ul_emulate);
+
+/**
+ * Look up response to reader command, WRITE and INC_CNT update data and precomputed responses
+ * @param buff_rx command from reader
+ * @param len_rx command length
+ * @param buff_tx response, points into emulation data, valid until next command
+ * @param mf_ul_emulate emulated device
+ * @return response length, 0 if command is not valid
+ */
+uint16_t mf_ul_prepare_emulation_response(uint8_t* buff_rx, uint16_t len_rx, uint8_t** buff_tx, MifareUlDevice* mf_ul_emulate);
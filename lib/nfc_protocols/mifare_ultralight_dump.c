@@ -0,0 +1,69 @@
+
+#include "mifare_ultralight_dump.h"
+
+#include <stddef.h>
+
+#define MF_UL_DUMP_CRC_INIT (0xFFFFFFFFUL)
+#define MF_UL_DUMP_CRC_POLY (0xEDB88320UL)
+
+static uint32_t mf_ul_dump_crc(uint32_t crc, const uint8_t* buff, uint32_t len) {
+    // Nibble table keeps CRC32 fast without 1 KB table in flash
+    static const uint32_t crc_table[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4,
+        0x4DB26158, 0x5005713C, 0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+        0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+    };
+    for(uint32_t i = 0; i < len; i++) {
+        crc ^= buff[i];
+        crc = (crc >> 4) ^ crc_table[crc & 0x0F];
+        crc = (crc >> 4) ^ crc_table[crc & 0x0F];
+    }
+    return crc;
+}
+
+static uint32_t mf_ul_dump_get_crc(MfUltralightDumpHeader* header, MifareUlData* data) {
+    uint32_t crc = mf_ul_dump_crc(
+        MF_UL_DUMP_CRC_INIT, (uint8_t*)header, offsetof(MfUltralightDumpHeader, crc));
+    crc = mf_ul_dump_crc(crc, data->data, data->data_size);
+    return ~crc;
+}
+
+uint32_t mf_ul_dump_source_crc(uint32_t crc, const uint8_t* source, uint32_t size) {
+    // Final inversion is undone for next chunk, so 0 gives MF_UL_DUMP_CRC_INIT
+    return ~mf_ul_dump_crc(~crc, source, size);
+}
+
+void mf_ul_dump_prepare_header(
+    MfUltralightDumpHeader* header,
+    MifareUlData* data,
+    uint32_t source_size,
+    uint32_t source_crc) {
+    memset(header, 0, sizeof(MfUltralightDumpHeader));
+    header->magic = MF_UL_DUMP_MAGIC;
+    header->format_version = MF_UL_DUMP_FORMAT_VERSION;
+    header->pages = data->data_size / 4;
+    header->source_size = source_size;
+    header->source_crc = source_crc;
+    header->version = data->version;
+    memcpy(header->signature, data->signature, sizeof(header->signature));
+    memcpy(header->counter, data->counter, sizeof(header->counter));
+    memcpy(header->tearing, data->tearing, sizeof(header->tearing));
+    header->crc = mf_ul_dump_get_crc(header, data);
+}
+
+bool mf_ul_dump_parse_header(MfUltralightDumpHeader* header, MifareUlData* data) {
+    if(header->magic != MF_UL_DUMP_MAGIC) return false;
+    if(header->format_version != MF_UL_DUMP_FORMAT_VERSION) return false;
+    if(header->pages > MF_UL_MAX_DUMP_SIZE / 4) return false;
+
+    data->version = header->version;
+    memcpy(data->signature, header->signature, sizeof(data->signature));
+    memcpy(data->counter, header->counter, sizeof(data->counter));
+    memcpy(data->tearing, header->tearing, sizeof(data->tearing));
+    data->data_size = header->pages * 4;
+    return true;
+}
+
+bool mf_ul_dump_check(MfUltralightDumpHeader* header, MifareUlData* data) {
+    return mf_ul_dump_get_crc(header, data) == header->crc;
+}
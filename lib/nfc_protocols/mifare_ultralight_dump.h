@@ -0,0 +1,67 @@
+#pragma once
+
+#include "mifare_ultralight.h"
+
+/** "NFUL" read as little endian word */
+#define MF_UL_DUMP_MAGIC (0x4C55464EUL)
+#define MF_UL_DUMP_FORMAT_VERSION (2)
+/** Text key file CRC is checked on every dump load, larger one is not dumped */
+#define MF_UL_DUMP_SOURCE_SIZE_MAX (UINT16_MAX)
+
+/**
+ * Binary Mifare Ultralight dump, header is followed by raw page array.
+ * Dump is a copy of text key file, it is valid only while text file
+ * has size and CRC32 it was saved with.
+ */
+typedef struct {
+    uint32_t magic;
+    uint16_t format_version;
+    uint16_t pages;
+    uint32_t source_size;
+    uint32_t source_crc;
+    MfUltralightVersion version;
+    uint8_t signature[32];
+    uint32_t counter[3];
+    uint8_t tearing[3];
+    uint8_t reserved;
+    /** CRC32 of header up to this field and of page array */
+    uint32_t crc;
+} __attribute__((packed)) MfUltralightDumpHeader;
+
+/**
+ * CRC32 of text key file contents, computed chunk by chunk
+ * @param crc 0 for first chunk, result of previous chunk for next ones
+ * @param source text file chunk
+ * @param size chunk size
+ * @return CRC32 of text file up to chunk end
+ */
+uint32_t mf_ul_dump_source_crc(uint32_t crc, const uint8_t* source, uint32_t size);
+
+/**
+ * Fill dump header
+ * @param header header to fill
+ * @param data dump data, page array is written from data->data right after header
+ * @param source_size size of text key file saved with same data
+ * @param source_crc mf_ul_dump_source_crc of that file
+ */
+void mf_ul_dump_prepare_header(
+    MfUltralightDumpHeader* header,
+    MifareUlData* data,
+    uint32_t source_size,
+    uint32_t source_crc);
+
+/**
+ * Check dump header and copy its fields to data
+ * @param header header read from dump
+ * @param data data to fill, data_size is set to page array size to read next
+ * @return true if header is valid and page array fits into data
+ */
+bool mf_ul_dump_parse_header(MfUltralightDumpHeader* header, MifareUlData* data);
+
+/**
+ * Check CRC once page array is read
+ * @param header header read from dump
+ * @param data data filled by mf_ul_dump_parse_header and page array
+ * @return true if dump is not damaged
+ */
+bool mf_ul_dump_check(MfUltralightDumpHeader* header, MifareUlData* data);
@@ -68,12 +68,14 @@ static inline bool subghz_protocol_keeloq_check_decrypt(
  * @param instance SubGhzProtocolKeeloq instance
  * @param fix fix part of the parcel
  * @param hop hop encrypted part of the parcel
+ * @param data keys acquired with subghz_keystore_get_data
  * @return true on successful search
  */
 uint8_t subghz_protocol_keeloq_check_remote_controller_selector(
     SubGhzProtocolKeeloq* instance,
     uint32_t fix,
-    uint32_t hop) {
+    uint32_t hop,
+    SubGhzKeyArray_t* data) {
     // protocol HCS300 uses 10 bits in discriminator, HCS200 uses 8 bits, for backward compatibility, we are looking for the 8-bit pattern
     // HCS300 -> uint16_t end_serial = (uint16_t)(fix & 0x3FF);
     // HCS200 -> uint16_t end_serial = (uint16_t)(fix & 0xFF);
@@ -85,13 +87,13 @@ uint8_t subghz_protocol_keeloq_check_remote_controller_selector(
     uint32_t seed = 0;
 
     for
-        M_EACH(manufacture_code, *subghz_keystore_get_data(instance->keystore), SubGhzKeyArray_t) {
+        M_EACH(manufacture_code, *data, SubGhzKeyArray_t) {
             switch(manufacture_code->type) {
             case KEELOQ_LEARNING_SIMPLE:
                 // Simple Learning
                 decrypt = subghz_protocol_keeloq_common_decrypt(hop, manufacture_code->key);
                 if(subghz_protocol_keeloq_check_decrypt(instance, decrypt, btn, end_serial)) {
-                    instance->manufacture_name = string_get_cstr(manufacture_code->name);
+                    instance->manufacture_name = manufacture_code->name;
                     return 1;
                 }
                 break;
@@ -102,7 +104,7 @@ uint8_t subghz_protocol_keeloq_check_remote_controller_selector(
                     subghz_protocol_keeloq_common_normal_learning(fix, manufacture_code->key);
                 decrypt = subghz_protocol_keeloq_common_decrypt(hop, man_learning);
                 if(subghz_protocol_keeloq_check_decrypt(instance, decrypt, btn, end_serial)) {
-                    instance->manufacture_name = string_get_cstr(manufacture_code->name);
+                    instance->manufacture_name = manufacture_code->name;
                     return 1;
                 }
                 break;
@@ -111,7 +113,7 @@ uint8_t subghz_protocol_keeloq_check_remote_controller_selector(
                     fix, seed, manufacture_code->key);
                 decrypt = subghz_protocol_keeloq_common_decrypt(hop, man_learning);
                 if(subghz_protocol_keeloq_check_decrypt(instance, decrypt, btn, end_serial)) {
-                    instance->manufacture_name = string_get_cstr(manufacture_code->name);
+                    instance->manufacture_name = manufacture_code->name;
                     return 1;
                 }
                 break;
@@ -119,7 +121,7 @@ uint8_t subghz_protocol_keeloq_check_remote_controller_selector(
                 // Simple Learning
                 decrypt = subghz_protocol_keeloq_common_decrypt(hop, manufacture_code->key);
                 if(subghz_protocol_keeloq_check_decrypt(instance, decrypt, btn, end_serial)) {
-                    instance->manufacture_name = string_get_cstr(manufacture_code->name);
+                    instance->manufacture_name = manufacture_code->name;
                     return 1;
                 }
                 // Check for mirrored man
@@ -131,7 +133,7 @@ uint8_t subghz_protocol_keeloq_check_remote_controller_selector(
                 }
                 decrypt = subghz_protocol_keeloq_common_decrypt(hop, man_rev);
                 if(subghz_protocol_keeloq_check_decrypt(instance, decrypt, btn, end_serial)) {
-                    instance->manufacture_name = string_get_cstr(manufacture_code->name);
+                    instance->manufacture_name = manufacture_code->name;
                     return 1;
                 }
                 //###########################
@@ -141,13 +143,13 @@ uint8_t subghz_protocol_keeloq_check_remote_controller_selector(
                     subghz_protocol_keeloq_common_normal_learning(fix, manufacture_code->key);
                 decrypt = subghz_protocol_keeloq_common_decrypt(hop, man_learning);
                 if(subghz_protocol_keeloq_check_decrypt(instance, decrypt, btn, end_serial)) {
-                    instance->manufacture_name = string_get_cstr(manufacture_code->name);
+                    instance->manufacture_name = manufacture_code->name;
                     return 1;
                 }
                 man_learning = subghz_protocol_keeloq_common_normal_learning(fix, man_rev);
                 decrypt = subghz_protocol_keeloq_common_decrypt(hop, man_learning);
                 if(subghz_protocol_keeloq_check_decrypt(instance, decrypt, btn, end_serial)) {
-                    instance->manufacture_name = string_get_cstr(manufacture_code->name);
+                    instance->manufacture_name = manufacture_code->name;
                     return 1;
                 }
 
@@ -156,7 +158,7 @@ uint8_t subghz_protocol_keeloq_check_remote_controller_selector(
                     fix, seed, manufacture_code->key);
                 decrypt = subghz_protocol_keeloq_common_decrypt(hop, man_learning);
                 if(subghz_protocol_keeloq_check_decrypt(instance, decrypt, btn, end_serial)) {
-                    instance->manufacture_name = string_get_cstr(manufacture_code->name);
+                    instance->manufacture_name = manufacture_code->name;
                     return 1;
                 }
 
@@ -165,7 +167,7 @@ uint8_t subghz_protocol_keeloq_check_remote_controller_selector(
                 man_learning = subghz_protocol_keeloq_common_secure_learning(fix, seed, man_rev);
                 decrypt = subghz_protocol_keeloq_common_decrypt(hop, man_learning);
                 if(subghz_protocol_keeloq_check_decrypt(instance, decrypt, btn, end_serial)) {
-                    instance->manufacture_name = string_get_cstr(manufacture_code->name);
+                    instance->manufacture_name = manufacture_code->name;
                     return 1;
                 }
                 break;
@@ -196,7 +198,9 @@ void subghz_protocol_keeloq_check_remote_controller(SubGhzProtocolKeeloq* instan
         instance->manufacture_name = "HCS101";
         instance->common.cnt = key_hop >> 16;
     } else {
-        subghz_protocol_keeloq_check_remote_controller_selector(instance, key_fix, key_hop);
+        SubGhzKeyArray_t* data = subghz_keystore_get_data(instance->keystore);
+        subghz_protocol_keeloq_check_remote_controller_selector(instance, key_fix, key_hop, data);
+        subghz_keystore_release_data(instance->keystore);
     }
     instance->common.serial = key_fix & 0x0FFFFFFF;
     instance->common.btn = key_fix >> 28;
@@ -217,16 +221,21 @@ bool subghz_protocol_keeloq_set_manufacture_name(void* context, const char* manu
     SubGhzProtocolKeeloq* instance = context;
     instance->manufacture_name = manufacture_name;
     int res = 0;
+    bool result = false;
         for
             M_EACH(
                 manufacture_code,
                 *subghz_keystore_get_data(instance->keystore),
                 SubGhzKeyArray_t) {
-                res = strcmp(string_get_cstr(manufacture_code->name), instance->manufacture_name);
-                if(res == 0) return true;
+                res = strcmp(manufacture_code->name, instance->manufacture_name);
+                if(res == 0) {
+                    result = true;
+                    break;
+                }
             }
-        instance->manufacture_name = "Unknown";
-        return false;
+        subghz_keystore_release_data(instance->keystore);
+        if(!result) instance->manufacture_name = "Unknown";
+        return result;
 }
 
 uint64_t subghz_protocol_keeloq_gen_key(void* context) {
@@ -240,7 +249,7 @@ uint64_t subghz_protocol_keeloq_gen_key(void* context) {
 
     for
         M_EACH(manufacture_code, *subghz_keystore_get_data(instance->keystore), SubGhzKeyArray_t) {
-            res = strcmp(string_get_cstr(manufacture_code->name), instance->manufacture_name);
+            res = strcmp(manufacture_code->name, instance->manufacture_name);
             if(res == 0) {
                 switch(manufacture_code->type) {
                 case KEELOQ_LEARNING_SIMPLE:
@@ -260,6 +269,7 @@ uint64_t subghz_protocol_keeloq_gen_key(void* context) {
                 break;
             }
         }
+    subghz_keystore_release_data(instance->keystore);
     uint64_t yek = (uint64_t)fix << 32 | hop;
     return subghz_protocol_common_reverse_key(yek, instance->common.code_last_count_bit);
 }
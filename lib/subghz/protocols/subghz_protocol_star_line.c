@@ -107,26 +107,28 @@ void subghz_protocol_star_line_reset(SubGhzProtocolStarLine* instance) {
  * @param instance SubGhzProtocolStarLine instance
  * @param fix fix part of the parcel
  * @param hop hop encrypted part of the parcel
+ * @param data keys acquired with subghz_keystore_get_data
  * @return true on successful search
  */
 uint8_t subghz_protocol_star_line_check_remote_controller_selector(
     SubGhzProtocolStarLine* instance,
     uint32_t fix,
-    uint32_t hop) {
+    uint32_t hop,
+    SubGhzKeyArray_t* data) {
     uint16_t end_serial = (uint16_t)(fix & 0xFF);
     uint8_t btn = (uint8_t)(fix >> 24);
     uint32_t decrypt = 0;
     uint64_t man_normal_learning;
 
     for
-        M_EACH(manufacture_code, *subghz_keystore_get_data(instance->keystore), SubGhzKeyArray_t) {
+        M_EACH(manufacture_code, *data, SubGhzKeyArray_t) {
             switch(manufacture_code->type) {
             case KEELOQ_LEARNING_SIMPLE:
                 //Simple Learning
                 decrypt = subghz_protocol_keeloq_common_decrypt(hop, manufacture_code->key);
                 if((decrypt >> 24 == btn) &&
                    ((((uint16_t)(decrypt >> 16)) & 0x00FF) == end_serial)) {
-                    instance->manufacture_name = string_get_cstr(manufacture_code->name);
+                    instance->manufacture_name = manufacture_code->name;
                     instance->common.cnt = decrypt & 0x0000FFFF;
                     return 1;
                 }
@@ -139,7 +141,7 @@ uint8_t subghz_protocol_star_line_check_remote_controller_selector(
                 decrypt = subghz_protocol_keeloq_common_decrypt(hop, man_normal_learning);
                 if((decrypt >> 24 == btn) &&
                    ((((uint16_t)(decrypt >> 16)) & 0x00FF) == end_serial)) {
-                    instance->manufacture_name = string_get_cstr(manufacture_code->name);
+                    instance->manufacture_name = manufacture_code->name;
                     instance->common.cnt = decrypt & 0x0000FFFF;
                     return 1;
                 }
@@ -149,7 +151,7 @@ uint8_t subghz_protocol_star_line_check_remote_controller_selector(
                 decrypt = subghz_protocol_keeloq_common_decrypt(hop, manufacture_code->key);
                 if((decrypt >> 24 == btn) &&
                    ((((uint16_t)(decrypt >> 16)) & 0x00FF) == end_serial)) {
-                    instance->manufacture_name = string_get_cstr(manufacture_code->name);
+                    instance->manufacture_name = manufacture_code->name;
                     instance->common.cnt = decrypt & 0x0000FFFF;
                     return 1;
                 }
@@ -163,7 +165,7 @@ uint8_t subghz_protocol_star_line_check_remote_controller_selector(
                 decrypt = subghz_protocol_keeloq_common_decrypt(hop, man_rev);
                 if((decrypt >> 24 == btn) &&
                    ((((uint16_t)(decrypt >> 16)) & 0x00FF) == end_serial)) {
-                    instance->manufacture_name = string_get_cstr(manufacture_code->name);
+                    instance->manufacture_name = manufacture_code->name;
                     instance->common.cnt = decrypt & 0x0000FFFF;
                     return 1;
                 }
@@ -175,7 +177,7 @@ uint8_t subghz_protocol_star_line_check_remote_controller_selector(
                 decrypt = subghz_protocol_keeloq_common_decrypt(hop, man_normal_learning);
                 if((decrypt >> 24 == btn) &&
                    ((((uint16_t)(decrypt >> 16)) & 0x00FF) == end_serial)) {
-                    instance->manufacture_name = string_get_cstr(manufacture_code->name);
+                    instance->manufacture_name = manufacture_code->name;
                     instance->common.cnt = decrypt & 0x0000FFFF;
                     return 1;
                 }
@@ -190,7 +192,7 @@ uint8_t subghz_protocol_star_line_check_remote_controller_selector(
                 decrypt = subghz_protocol_keeloq_common_decrypt(hop, man_normal_learning);
                 if((decrypt >> 24 == btn) &&
                    ((((uint16_t)(decrypt >> 16)) & 0x00FF) == end_serial)) {
-                    instance->manufacture_name = string_get_cstr(manufacture_code->name);
+                    instance->manufacture_name = manufacture_code->name;
                     instance->common.cnt = decrypt & 0x0000FFFF;
                     return 1;
                 }
@@ -214,7 +216,9 @@ void subghz_protocol_star_line_check_remote_controller(SubGhzProtocolStarLine* i
     uint32_t key_fix = key >> 32;
     uint32_t key_hop = key & 0x00000000ffffffff;
 
-    subghz_protocol_star_line_check_remote_controller_selector(instance, key_fix, key_hop);
+    SubGhzKeyArray_t* data = subghz_keystore_get_data(instance->keystore);
+    subghz_protocol_star_line_check_remote_controller_selector(instance, key_fix, key_hop, data);
+    subghz_keystore_release_data(instance->keystore);
 
     instance->common.serial = key_fix & 0x00FFFFFF;
     instance->common.btn = key_fix >> 24;
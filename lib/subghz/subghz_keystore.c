@@ -6,6 +6,8 @@
 #include <storage/storage.h>
 #include <toolbox/hex.h>
 #include <flipper_file/flipper_file.h>
+#include <fnv1a-hash.h>
+#include <stdatomic.h>
 
 #define TAG "SubGhzKeystore"
 
@@ -19,19 +21,128 @@
 #define SUBGHZ_KEYSTORE_FILE_DECRYPTED_LINE_SIZE 512
 #define SUBGHZ_KEYSTORE_FILE_ENCRYPTED_LINE_SIZE (SUBGHZ_KEYSTORE_FILE_DECRYPTED_LINE_SIZE * 2)
 
+#define SUBGHZ_KEYSTORE_BINARY_MAGIC 0x424B4753 // "SGKB"
+#define SUBGHZ_KEYSTORE_BINARY_VERSION 1
+#define SUBGHZ_KEYSTORE_BINARY_KEYS_MAX 4096
+// Names are at most 64 chars, same as text format
+#define SUBGHZ_KEYSTORE_BINARY_POOL_MAX (SUBGHZ_KEYSTORE_BINARY_KEYS_MAX * 65)
+
 typedef enum {
     SubGhzKeystoreEncryptionNone,
     SubGhzKeystoreEncryptionAES256,
 } SubGhzKeystoreEncryption;
 
+typedef struct {
+    uint32_t magic;
+    uint8_t version;
+    uint8_t encryption;
+    uint16_t reserved;
+    uint32_t key_count;
+    uint32_t pool_size;
+    uint32_t payload_size; // key table + name pool, padded to AES block
+    uint32_t checksum; // FNV-1a of plain payload
+    uint8_t iv[16];
+} __attribute__((packed)) SubGhzKeystoreBinaryHeader;
+
+typedef struct {
+    uint64_t key;
+    uint16_t type;
+    uint16_t reserved;
+    uint32_t name_offset;
+} __attribute__((packed)) SubGhzKeystoreBinaryKey;
+
+typedef struct {
+    char* names;
+    size_t size;
+} SubGhzKeystoreNamePool;
+
+ARRAY_DEF(SubGhzKeystoreNamePoolArray, SubGhzKeystoreNamePool, M_POD_OPLIST)
+ARRAY_DEF(SubGhzKeystoreFileArray, string_t, STRING_OPLIST)
+
+/* Published keys, linked into retired list once superseded */
+typedef struct SubGhzKeystoreData {
+    SubGhzKeyArray_t keys;
+    struct SubGhzKeystoreData* next;
+} SubGhzKeystoreData;
+
+typedef struct {
+    osMutexId_t mutex;
+    SubGhzKeystore* keystore;
+    size_t attach_count;
+} SubGhzKeystoreShared;
+
 struct SubGhzKeystore {
-    SubGhzKeyArray_t data;
+    osMutexId_t mutex;
+    SubGhzKeystoreFileArray_t files;
+
+    // Published keys, replaced as a whole when load is complete. Decoders iterate it
+    // without lock, so superseded arrays are retired and freed once no reader is left
+    SubGhzKeystoreData* _Atomic data;
+    SubGhzKeystoreData* _Atomic retired;
+    // Readers between subghz_keystore_get_data and subghz_keystore_release_data
+    atomic_uint readers;
+    // Keys of load in progress, published only on success
+    SubGhzKeyArray_t load_data;
+    // Every load owns one pool block, keys point into them
+    SubGhzKeystoreNamePoolArray_t pools;
+
+    // Text loader staging pool, names are stored as offsets until load is finished
+    char* load_pool;
+    size_t load_pool_size;
+    size_t load_pool_capacity;
 };
 
+static void subghz_keystore_data_free(SubGhzKeystoreData* data) {
+    for
+        M_EACH(manufacture_code, data->keys, SubGhzKeyArray_t) {
+            manufacture_code->key = 0;
+        }
+    SubGhzKeyArray_clear(data->keys);
+    free(data);
+}
+
+static void subghz_keystore_retire(SubGhzKeystore* instance, SubGhzKeystoreData* head) {
+    SubGhzKeystoreData* tail = head;
+    while(tail->next) tail = tail->next;
+    SubGhzKeystoreData* retired = atomic_load(&instance->retired);
+    do {
+        tail->next = retired;
+    } while(!atomic_compare_exchange_weak(&instance->retired, &retired, head));
+}
+
+/** Free retired arrays if no reader is left
+ * Array is retired only after it is replaced, so reader that still sees it has entered
+ * before list was taken. Zero readers after taking the list means all of them are gone,
+ * otherwise list is put back and the last reader to leave tries again. Never waits.
+ */
+static void subghz_keystore_reclaim(SubGhzKeystore* instance) {
+    if(atomic_load(&instance->readers) != 0) return;
+    SubGhzKeystoreData* retired = atomic_exchange(&instance->retired, NULL);
+    if(!retired) return;
+    if(atomic_load(&instance->readers) != 0) {
+        subghz_keystore_retire(instance, retired);
+        return;
+    }
+    while(retired) {
+        SubGhzKeystoreData* next = retired->next;
+        subghz_keystore_data_free(retired);
+        retired = next;
+    }
+}
+
 SubGhzKeystore* subghz_keystore_alloc() {
     SubGhzKeystore* instance = furi_alloc(sizeof(SubGhzKeystore));
 
-    SubGhzKeyArray_init(instance->data);
+    instance->mutex = osMutexNew(NULL);
+    furi_check(instance->mutex);
+    SubGhzKeystoreFileArray_init(instance->files);
+    SubGhzKeystoreData* data = furi_alloc(sizeof(SubGhzKeystoreData));
+    SubGhzKeyArray_init(data->keys);
+    atomic_init(&instance->data, data);
+    atomic_init(&instance->retired, NULL);
+    atomic_init(&instance->readers, 0);
+    SubGhzKeyArray_init(instance->load_data);
+    SubGhzKeystoreNamePoolArray_init(instance->pools);
 
     return instance;
 }
@@ -39,25 +150,162 @@ SubGhzKeystore* subghz_keystore_alloc() {
 void subghz_keystore_free(SubGhzKeystore* instance) {
     furi_assert(instance);
 
+    furi_assert(atomic_load(&instance->readers) == 0);
+    subghz_keystore_data_free(atomic_load(&instance->data));
+    subghz_keystore_reclaim(instance);
+    SubGhzKeyArray_clear(instance->load_data);
+
     for
-        M_EACH(manufacture_code, instance->data, SubGhzKeyArray_t) {
-            string_clear(manufacture_code->name);
-            manufacture_code->key = 0;
+        M_EACH(pool, instance->pools, SubGhzKeystoreNamePoolArray_t) {
+            memset(pool->names, 0, pool->size);
+            free(pool->names);
         }
-    SubGhzKeyArray_clear(instance->data);
+    SubGhzKeystoreNamePoolArray_clear(instance->pools);
+
+    SubGhzKeystoreFileArray_clear(instance->files);
+    osMutexDelete(instance->mutex);
 
     free(instance);
 }
 
+void subghz_keystore_shared_init() {
+    SubGhzKeystoreShared* shared = furi_alloc(sizeof(SubGhzKeystoreShared));
+    shared->mutex = osMutexNew(NULL);
+    furi_check(shared->mutex);
+    furi_record_create(SUBGHZ_KEYSTORE_RECORD, shared);
+}
+
+SubGhzKeystore* subghz_keystore_attach() {
+    SubGhzKeystoreShared* shared = furi_record_open(SUBGHZ_KEYSTORE_RECORD);
+
+    furi_check(osMutexAcquire(shared->mutex, osWaitForever) == osOK);
+    if(shared->attach_count == 0) {
+        furi_assert(!shared->keystore);
+        shared->keystore = subghz_keystore_alloc();
+    }
+    shared->attach_count++;
+    SubGhzKeystore* keystore = shared->keystore;
+    furi_check(osMutexRelease(shared->mutex) == osOK);
+
+    return keystore;
+}
+
+void subghz_keystore_detach(SubGhzKeystore* instance) {
+    SubGhzKeystoreShared* shared = furi_record_open(SUBGHZ_KEYSTORE_RECORD);
+
+    furi_check(osMutexAcquire(shared->mutex, osWaitForever) == osOK);
+    furi_assert(shared->keystore == instance);
+    furi_assert(shared->attach_count > 0);
+    shared->attach_count--;
+    if(shared->attach_count == 0) {
+        subghz_keystore_free(shared->keystore);
+        shared->keystore = NULL;
+    }
+    furi_check(osMutexRelease(shared->mutex) == osOK);
+
+    // Once for this call, once for attach
+    furi_record_close(SUBGHZ_KEYSTORE_RECORD);
+    furi_record_close(SUBGHZ_KEYSTORE_RECORD);
+}
+
+/** Move pool into new buffer of given size, old buffer is zeroed before free
+ * Unlike realloc, no copy of key material is left behind in the heap
+ */
+static char* subghz_keystore_pool_resize(char* pool, size_t size, size_t new_size) {
+    char* new_pool = malloc(new_size);
+    furi_check(new_pool);
+    if(pool) {
+        memcpy(new_pool, pool, MIN(size, new_size));
+        memset(pool, 0, size);
+        free(pool);
+    }
+    return new_pool;
+}
+
 static void subghz_keystore_add_key(
     SubGhzKeystore* instance,
     const char* name,
     uint64_t key,
     uint16_t type) {
-    SubGhzKey* manufacture_code = SubGhzKeyArray_push_raw(instance->data);
-    string_init_set_str(manufacture_code->name, name);
+    size_t len = strlen(name) + 1;
+    if(instance->load_pool_size + len > instance->load_pool_capacity) {
+        size_t capacity = MAX(instance->load_pool_capacity * 2, (size_t)256);
+        capacity = MAX(capacity, instance->load_pool_size + len);
+        instance->load_pool = subghz_keystore_pool_resize(
+            instance->load_pool, instance->load_pool_size, capacity);
+        instance->load_pool_capacity = capacity;
+    }
+    memcpy(instance->load_pool + instance->load_pool_size, name, len);
+
+    SubGhzKey* manufacture_code = SubGhzKeyArray_push_raw(instance->load_data);
+    manufacture_code->name = (const char*)instance->load_pool_size;
     manufacture_code->key = key;
     manufacture_code->type = type;
+
+    instance->load_pool_size += len;
+}
+
+/** Move staging pool into keystore
+ * Turns name offsets of loaded keys into pointers
+ */
+static void subghz_keystore_commit_pool(SubGhzKeystore* instance) {
+    if(instance->load_pool) {
+        char* pool = subghz_keystore_pool_resize(
+            instance->load_pool, instance->load_pool_size, instance->load_pool_size);
+        SubGhzKeystoreNamePool* block = SubGhzKeystoreNamePoolArray_push_raw(instance->pools);
+        block->names = pool;
+        block->size = instance->load_pool_size;
+
+        for
+            M_EACH(manufacture_code, instance->load_data, SubGhzKeyArray_t) {
+                manufacture_code->name = pool + (size_t)manufacture_code->name;
+            }
+    }
+
+    instance->load_pool = NULL;
+    instance->load_pool_size = 0;
+    instance->load_pool_capacity = 0;
+}
+
+/** Drop keys and names of failed load, keystore stays as before the load */
+static void subghz_keystore_discard_load(SubGhzKeystore* instance) {
+    for
+        M_EACH(manufacture_code, instance->load_data, SubGhzKeyArray_t) {
+            manufacture_code->key = 0;
+        }
+    SubGhzKeyArray_reset(instance->load_data);
+
+    if(instance->load_pool) memset(instance->load_pool, 0, instance->load_pool_capacity);
+    free(instance->load_pool);
+    instance->load_pool = NULL;
+    instance->load_pool_size = 0;
+    instance->load_pool_capacity = 0;
+}
+
+/** Publish published + loaded keys as new array
+ * Readers see either the old or the new array, never one that is being filled
+ */
+static void subghz_keystore_publish_load(SubGhzKeystore* instance) {
+    SubGhzKeystoreData* current = atomic_load(&instance->data);
+    SubGhzKeystoreData* next = furi_alloc(sizeof(SubGhzKeystoreData));
+    SubGhzKeyArray_init(next->keys);
+    SubGhzKeyArray_reserve(
+        next->keys,
+        SubGhzKeyArray_size(current->keys) + SubGhzKeyArray_size(instance->load_data));
+    for
+        M_EACH(manufacture_code, current->keys, SubGhzKeyArray_t) {
+            SubGhzKeyArray_push_back(next->keys, *manufacture_code);
+        }
+    for
+        M_EACH(manufacture_code, instance->load_data, SubGhzKeyArray_t) {
+            SubGhzKeyArray_push_back(next->keys, *manufacture_code);
+        }
+    SubGhzKeyArray_reset(instance->load_data);
+
+    atomic_store(&instance->data, next);
+    current->next = NULL;
+    subghz_keystore_retire(instance, current);
+    subghz_keystore_reclaim(instance);
 }
 
 static bool subghz_keystore_process_line(SubGhzKeystore* instance, char* line) {
@@ -176,6 +424,138 @@ static bool subghz_keystore_read_file(SubGhzKeystore* instance, File* file, uint
     return result;
 }
 
+static bool subghz_keystore_file_read(File* file, uint8_t* data, size_t size) {
+    while(size) {
+        uint16_t chunk = MIN(size, (size_t)UINT16_MAX);
+        if(storage_file_read(file, data, chunk) != chunk) return false;
+        data += chunk;
+        size -= chunk;
+    }
+    return true;
+}
+
+static bool subghz_keystore_file_write(File* file, const uint8_t* data, size_t size) {
+    while(size) {
+        uint16_t chunk = MIN(size, (size_t)UINT16_MAX);
+        if(storage_file_write(file, data, chunk) != chunk) return false;
+        data += chunk;
+        size -= chunk;
+    }
+    return true;
+}
+
+static bool subghz_keystore_read_binary(SubGhzKeystore* instance, File* file) {
+    bool result = false;
+    SubGhzKeystoreBinaryHeader header;
+    uint32_t iv[4]; // word aligned for subghz_keystore_mess_with_iv
+    uint8_t* payload = NULL;
+
+    do {
+        if(!subghz_keystore_file_read(file, (uint8_t*)&header, sizeof(header))) {
+            FURI_LOG_E(TAG, "Missing binary header");
+            break;
+        }
+        // Counts are capped first, so table and pool sizes can not wrap
+        uint64_t file_size = storage_file_size(file);
+        uint64_t data_size = (uint64_t)header.key_count * sizeof(SubGhzKeystoreBinaryKey) +
+                             header.pool_size;
+        if(header.version != SUBGHZ_KEYSTORE_BINARY_VERSION ||
+           header.key_count > SUBGHZ_KEYSTORE_BINARY_KEYS_MAX ||
+           header.pool_size > SUBGHZ_KEYSTORE_BINARY_POOL_MAX || header.pool_size == 0 ||
+           header.payload_size % 16 != 0 || header.payload_size < data_size ||
+           header.payload_size - data_size >= 16 ||
+           header.payload_size > file_size - sizeof(header)) {
+            FURI_LOG_E(TAG, "Binary header mismatch");
+            break;
+        }
+
+        // One bulk read, one bulk decrypt
+        payload = malloc(header.payload_size);
+        if(!payload) {
+            FURI_LOG_E(TAG, "Not enough memory for %lu bytes", header.payload_size);
+            break;
+        }
+        if(!subghz_keystore_file_read(file, payload, header.payload_size)) {
+            FURI_LOG_E(TAG, "Truncated binary keystore");
+            break;
+        }
+
+        if(header.encryption == SubGhzKeystoreEncryptionAES256) {
+            memcpy(iv, header.iv, sizeof(iv));
+            subghz_keystore_mess_with_iv((uint8_t*)iv);
+            if(!furi_hal_crypto_store_load_key(
+                   SUBGHZ_KEYSTORE_FILE_ENCRYPTION_KEY_SLOT, (uint8_t*)iv)) {
+                FURI_LOG_E(TAG, "Unable to load encryption key");
+                break;
+            }
+            bool decrypted = furi_hal_crypto_decrypt(payload, payload, header.payload_size);
+            furi_hal_crypto_store_unload_key(SUBGHZ_KEYSTORE_FILE_ENCRYPTION_KEY_SLOT);
+            if(!decrypted) {
+                FURI_LOG_E(TAG, "Decryption failed");
+                break;
+            }
+        } else if(header.encryption != SubGhzKeystoreEncryptionNone) {
+            FURI_LOG_E(TAG, "Unknown encryption");
+            break;
+        }
+
+        if(fnv1a_buffer_hash(payload, header.payload_size, FNV_1A_INIT) != header.checksum) {
+            FURI_LOG_E(TAG, "Checksum mismatch");
+            break;
+        }
+
+        // Only name pool is kept, decrypted table is zeroed together with the payload
+        const SubGhzKeystoreBinaryKey* table = (const SubGhzKeystoreBinaryKey*)payload;
+        char* pool = (char*)payload + header.key_count * sizeof(SubGhzKeystoreBinaryKey);
+        if(pool[header.pool_size - 1] != '\0') {
+            FURI_LOG_E(TAG, "Malformed name pool");
+            break;
+        }
+
+        // Whole table is checked before any key is added, failed load leaves keystore as is
+        size_t malformed = header.key_count;
+        for(size_t i = 0; i < header.key_count; i++) {
+            if(table[i].name_offset >= header.pool_size) {
+                malformed = i;
+                break;
+            }
+        }
+        if(malformed != header.key_count) {
+            FURI_LOG_E(TAG, "Malformed key %u", malformed);
+            break;
+        }
+
+        char* names = malloc(header.pool_size);
+        if(!names) {
+            FURI_LOG_E(TAG, "Not enough memory for %lu bytes", header.pool_size);
+            break;
+        }
+        memcpy(names, pool, header.pool_size);
+
+        SubGhzKeyArray_reserve(
+            instance->load_data, SubGhzKeyArray_size(instance->load_data) + header.key_count);
+        for(size_t i = 0; i < header.key_count; i++) {
+            SubGhzKey* manufacture_code = SubGhzKeyArray_push_raw(instance->load_data);
+            manufacture_code->name = names + table[i].name_offset;
+            manufacture_code->key = table[i].key;
+            manufacture_code->type = table[i].type;
+        }
+
+        SubGhzKeystoreNamePool* block = SubGhzKeystoreNamePoolArray_push_raw(instance->pools);
+        block->names = names;
+        block->size = header.pool_size;
+        result = true;
+    } while(0);
+
+    memset(iv, 0, sizeof(iv));
+    if(payload) {
+        memset(payload, 0, header.payload_size);
+        free(payload);
+    }
+
+    return result;
+}
+
 bool subghz_keystore_load(SubGhzKeystore* instance, const char* file_name) {
     furi_assert(instance);
     bool result = false;
@@ -183,17 +563,32 @@ bool subghz_keystore_load(SubGhzKeystore* instance, const char* file_name) {
     uint32_t version;
     SubGhzKeystoreEncryption encryption;
 
+    Storage* storage = furi_record_open("storage");
+
     string_t filetype;
     string_init(filetype);
 
-    Storage* storage = furi_record_open("storage");
-
     FlipperFile* flipper_file = flipper_file_alloc(storage);
     do {
         if(!flipper_file_open_existing(flipper_file, file_name)) {
             FURI_LOG_E(TAG, "Unable to open file for read: %s", file_name);
             break;
         }
+
+        // Format is detected on the same open file, text reader starts over from offset 0
+        File* file = flipper_file_get_file(flipper_file);
+        uint32_t magic = 0;
+        bool binary = storage_file_read(file, &magic, sizeof(magic)) == sizeof(magic) &&
+                      magic == SUBGHZ_KEYSTORE_BINARY_MAGIC;
+        if(!storage_file_seek(file, 0, true)) {
+            FURI_LOG_E(TAG, "Unable to rewind: %s", file_name);
+            break;
+        }
+        if(binary) {
+            result = subghz_keystore_read_binary(instance, file);
+            break;
+        }
+
         if(!flipper_file_read_header(flipper_file, filetype, &version)) {
             FURI_LOG_E(TAG, "Missing or incorrect header");
             break;
@@ -209,7 +604,6 @@ bool subghz_keystore_load(SubGhzKeystore* instance, const char* file_name) {
             break;
         }
 
-        File* file = flipper_file_get_file(flipper_file);
         if(encryption == SubGhzKeystoreEncryptionNone) {
             result = subghz_keystore_read_file(instance, file, NULL);
         } else if(encryption == SubGhzKeystoreEncryptionAES256) {
@@ -227,6 +621,14 @@ bool subghz_keystore_load(SubGhzKeystore* instance, const char* file_name) {
     flipper_file_close(flipper_file);
     flipper_file_free(flipper_file);
 
+    // Failed load leaves nothing behind, so retry does not duplicate keys
+    if(result) {
+        subghz_keystore_commit_pool(instance);
+        subghz_keystore_publish_load(instance);
+    } else {
+        subghz_keystore_discard_load(instance);
+    }
+
     furi_record_close("storage");
 
     string_clear(filetype);
@@ -234,9 +636,35 @@ bool subghz_keystore_load(SubGhzKeystore* instance, const char* file_name) {
     return result;
 }
 
+bool subghz_keystore_load_once(SubGhzKeystore* instance, const char* file_name) {
+    furi_assert(instance);
+    bool result = false;
+
+    furi_check(osMutexAcquire(instance->mutex, osWaitForever) == osOK);
+    for
+        M_EACH(loaded_file, instance->files, SubGhzKeystoreFileArray_t) {
+            if(string_cmp_str(*loaded_file, file_name) == 0) {
+                result = true;
+                break;
+            }
+        }
+
+    if(!result) {
+        result = subghz_keystore_load(instance, file_name);
+        if(result) {
+            string_t* loaded_file = SubGhzKeystoreFileArray_push_new(instance->files);
+            string_set_str(*loaded_file, file_name);
+        }
+    }
+    furi_check(osMutexRelease(instance->mutex) == osOK);
+
+    return result;
+}
+
 bool subghz_keystore_save(SubGhzKeystore* instance, const char* file_name, uint8_t* iv) {
     furi_assert(instance);
     bool result = false;
+    SubGhzKeyArray_t* data = subghz_keystore_get_data(instance);
 
     Storage* storage = furi_record_open("storage");
     char* decrypted_line = furi_alloc(SUBGHZ_KEYSTORE_FILE_DECRYPTED_LINE_SIZE);
@@ -273,7 +701,7 @@ bool subghz_keystore_save(SubGhzKeystore* instance, const char* file_name, uint8
         File* file = flipper_file_get_file(flipper_file);
         size_t encrypted_line_count = 0;
         for
-            M_EACH(key, instance->data, SubGhzKeyArray_t) {
+            M_EACH(key, *data, SubGhzKeyArray_t) {
                 // Wipe buffer before packing
                 memset(decrypted_line, 0, SUBGHZ_KEYSTORE_FILE_DECRYPTED_LINE_SIZE);
                 memset(encrypted_line, 0, SUBGHZ_KEYSTORE_FILE_ENCRYPTED_LINE_SIZE);
@@ -285,7 +713,7 @@ bool subghz_keystore_save(SubGhzKeystore* instance, const char* file_name, uint8
                     (uint32_t)(key->key >> 32),
                     (uint32_t)key->key,
                     key->type,
-                    string_get_cstr(key->name));
+                    key->name);
                 // Verify length and align
                 furi_assert(len > 0);
                 if(len % 16 != 0) {
@@ -312,7 +740,7 @@ bool subghz_keystore_save(SubGhzKeystore* instance, const char* file_name, uint8
                 encrypted_line_count++;
             }
         furi_hal_crypto_store_unload_key(SUBGHZ_KEYSTORE_FILE_ENCRYPTION_KEY_SLOT);
-        size_t total_keys = SubGhzKeyArray_size(instance->data);
+        size_t total_keys = SubGhzKeyArray_size(*data);
         result = encrypted_line_count == total_keys;
         if (result) {
             FURI_LOG_I(TAG, "Success. Encrypted: %d of %d", encrypted_line_count, total_keys);
@@ -326,13 +754,127 @@ bool subghz_keystore_save(SubGhzKeystore* instance, const char* file_name, uint8
     free(encrypted_line);
     free(decrypted_line);
     furi_record_close("storage");
+    subghz_keystore_release_data(instance);
+
+    return result;
+}
+
+static int subghz_keystore_binary_key_cmp(const void* a, const void* b) {
+    const SubGhzKeystoreBinaryKey* key_a = a;
+    const SubGhzKeystoreBinaryKey* key_b = b;
+    if(key_a->type != key_b->type) return key_a->type < key_b->type ? -1 : 1;
+    // Keep file order within type
+    return key_a->reserved < key_b->reserved ? -1 : (key_a->reserved > key_b->reserved);
+}
+
+bool subghz_keystore_save_binary(SubGhzKeystore* instance, const char* file_name, uint8_t* iv) {
+    furi_assert(instance);
+    furi_assert(iv);
+    bool result = false;
+    SubGhzKeyArray_t* data = subghz_keystore_get_data(instance);
+
+    SubGhzKeystoreBinaryHeader header = {
+        .magic = SUBGHZ_KEYSTORE_BINARY_MAGIC,
+        .version = SUBGHZ_KEYSTORE_BINARY_VERSION,
+        .encryption = SubGhzKeystoreEncryptionAES256,
+        .key_count = SubGhzKeyArray_size(*data),
+    };
+    memcpy(header.iv, iv, sizeof(header.iv));
+
+    for
+        M_EACH(key, *data, SubGhzKeyArray_t) {
+            header.pool_size += strlen(key->name) + 1;
+        }
+    if(header.key_count > SUBGHZ_KEYSTORE_BINARY_KEYS_MAX || header.pool_size == 0 ||
+       header.pool_size > SUBGHZ_KEYSTORE_BINARY_POOL_MAX) {
+        FURI_LOG_E(TAG, "Keystore does not fit binary format: %lu keys", header.key_count);
+        subghz_keystore_release_data(instance);
+        return false;
+    }
+    header.payload_size = header.key_count * sizeof(SubGhzKeystoreBinaryKey) + header.pool_size;
+    if(header.payload_size % 16) header.payload_size += 16 - header.payload_size % 16;
+
+    uint8_t* payload = furi_alloc(header.payload_size);
+    SubGhzKeystoreBinaryKey* table = (SubGhzKeystoreBinaryKey*)payload;
+    char* pool = (char*)payload + header.key_count * sizeof(SubGhzKeystoreBinaryKey);
+
+    size_t index = 0;
+    size_t pool_offset = 0;
+    for
+        M_EACH(key, *data, SubGhzKeyArray_t) {
+            size_t len = strlen(key->name) + 1;
+            memcpy(pool + pool_offset, key->name, len);
+            table[index].key = key->key;
+            table[index].type = key->type;
+            table[index].reserved = index; // sort tiebreaker, cleared below
+            table[index].name_offset = pool_offset;
+            pool_offset += len;
+            index++;
+        }
+    subghz_keystore_release_data(instance);
+    qsort(
+        table,
+        header.key_count,
+        sizeof(SubGhzKeystoreBinaryKey),
+        subghz_keystore_binary_key_cmp);
+    for(size_t i = 0; i < header.key_count; i++) {
+        table[i].reserved = 0;
+    }
+
+    header.checksum = fnv1a_buffer_hash(payload, header.payload_size, FNV_1A_INIT);
+
+    Storage* storage = furi_record_open("storage");
+    File* file = storage_file_alloc(storage);
+    do {
+        uint32_t aligned_iv[4];
+        memcpy(aligned_iv, iv, sizeof(aligned_iv));
+        subghz_keystore_mess_with_iv((uint8_t*)aligned_iv);
+        if(!furi_hal_crypto_store_load_key(
+               SUBGHZ_KEYSTORE_FILE_ENCRYPTION_KEY_SLOT, (uint8_t*)aligned_iv)) {
+            FURI_LOG_E(TAG, "Unable to load encryption key");
+            break;
+        }
+        bool encrypted = furi_hal_crypto_encrypt(payload, payload, header.payload_size);
+        furi_hal_crypto_store_unload_key(SUBGHZ_KEYSTORE_FILE_ENCRYPTION_KEY_SLOT);
+        if(!encrypted) {
+            FURI_LOG_E(TAG, "Encryption failed");
+            break;
+        }
+
+        if(!storage_file_open(file, file_name, FSAM_WRITE, FSOM_CREATE_ALWAYS)) {
+            FURI_LOG_E(TAG, "Unable to open file for write: %s", file_name);
+            break;
+        }
+        if(!subghz_keystore_file_write(file, (uint8_t*)&header, sizeof(header)) ||
+           !subghz_keystore_file_write(file, payload, header.payload_size)) {
+            FURI_LOG_E(TAG, "Unable to write: %s", storage_file_get_error_desc(file));
+            break;
+        }
+        FURI_LOG_I(TAG, "Compiled %lu keys, %lu bytes", header.key_count, header.payload_size);
+        result = true;
+    } while(0);
+    storage_file_close(file);
+    storage_file_free(file);
+    furi_record_close("storage");
+
+    memset(payload, 0, header.payload_size);
+    free(payload);
 
     return result;
 }
 
 SubGhzKeyArray_t* subghz_keystore_get_data(SubGhzKeystore* instance) {
     furi_assert(instance);
-    return &instance->data;
+    // Count reader before loading, so reclaim that sees zero readers can't race with it
+    atomic_fetch_add(&instance->readers, 1);
+    return &atomic_load(&instance->data)->keys;
+}
+
+void subghz_keystore_release_data(SubGhzKeystore* instance) {
+    furi_assert(instance);
+    if(atomic_fetch_sub(&instance->readers, 1) == 1 && atomic_load(&instance->retired)) {
+        subghz_keystore_reclaim(instance);
+    }
 }
 
 bool subghz_keystore_raw_encrypted_save(
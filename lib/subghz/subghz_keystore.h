@@ -5,7 +5,7 @@
 #include <stdint.h>
 
 typedef struct {
-    string_t name;
+    const char* name; /**< Points into keystore name pool, valid until keystore is freed */
     uint64_t key;
     uint16_t type;
 } SubGhzKey;
@@ -14,8 +14,29 @@ ARRAY_DEF(SubGhzKeyArray, SubGhzKey, M_POD_OPLIST)
 
 #define M_OPL_SubGhzKeyArray_t() ARRAY_OPLIST(SubGhzKeyArray, M_POD_OPLIST)
 
+#define SUBGHZ_KEYSTORE_RECORD "subghz_keystore"
+
 typedef struct SubGhzKeystore SubGhzKeystore;
 
+/** Create process-wide keystore record
+ * Keys are not loaded here, first attach allocates keystore
+ */
+void subghz_keystore_shared_init();
+
+/** Attach to process-wide keystore
+ * Keystore is shared between all attached users and must be treated as read-only,
+ * use subghz_keystore_load_once to add key files to it.
+ * 
+ * @return SubGhzKeystore* 
+ */
+SubGhzKeystore* subghz_keystore_attach();
+
+/** Detach from process-wide keystore, last detach frees it
+ * 
+ * @param instance - SubGhzKeystore instance returned by subghz_keystore_attach
+ */
+void subghz_keystore_detach(SubGhzKeystore* instance);
+
 /** Allocate SubGhzKeystore
  * 
  * @return SubGhzKeystore* 
@@ -29,12 +50,22 @@ SubGhzKeystore* subghz_keystore_alloc();
 void subghz_keystore_free(SubGhzKeystore* instance);
 
 /** Loading manufacture key from file
+ * Both text and compiled binary formats are accepted, format is detected by file magic
+ * Keys become visible only if the whole file is loaded, failed load adds nothing
  * 
  * @param instance - SubGhzKeystore instance
  * @param filename - const char* full path to the file
  */
 bool subghz_keystore_load(SubGhzKeystore* instance, const char* filename);
 
+/** Loading manufacture key from file unless it was already loaded into this keystore
+ * 
+ * @param instance - SubGhzKeystore instance
+ * @param filename - const char* full path to the file
+ * @return true if keys from file are present in keystore
+ */
+bool subghz_keystore_load_once(SubGhzKeystore* instance, const char* filename);
+
 /** Save manufacture key to file
  * 
  * @param instance - SubGhzKeystore instance
@@ -42,13 +73,35 @@ bool subghz_keystore_load(SubGhzKeystore* instance, const char* filename);
  */
 bool subghz_keystore_save(SubGhzKeystore* instance, const char* filename, uint8_t* iv);
 
+/** Save manufacture keys to compiled binary file
+ * Key table is sorted by type, names are packed into a single string pool.
+ * Table and pool are encrypted as one block, header carries checksum of plain data.
+ * Up to 4096 keys. Binary files are not shipped in assets, they are compiled on device
+ * with `subghz compile_keeloq` and can replace text keystore under the same name.
+ * 
+ * @param instance - SubGhzKeystore instance
+ * @param filename - const char* full path to the file
+ * @param iv - 16 bytes IV
+ */
+bool subghz_keystore_save_binary(SubGhzKeystore* instance, const char* filename, uint8_t* iv);
+
 /** Get array of keys and names manufacture
+ * Returned array is never modified and stays valid until subghz_keystore_release_data,
+ * so it can be iterated without lock. Loads publish a new array on success,
+ * superseded one is freed once every reader has released it. Calls may nest.
  * 
  * @param instance - SubGhzKeystore instance
  * @return SubGhzKeyArray_t*
  */
 SubGhzKeyArray_t* subghz_keystore_get_data(SubGhzKeystore* instance);
 
+/** Release array returned by subghz_keystore_get_data
+ * Key names stay valid until keystore is freed, only the array itself may go away
+ * 
+ * @param instance - SubGhzKeystore instance
+ */
+void subghz_keystore_release_data(SubGhzKeystore* instance);
+
 /** Save RAW encrypted to file
  * 
  * @param input_file_name - const char* full path to the input file
@@ -83,7 +83,7 @@ static void subghz_parser_parser_rx_callback(SubGhzProtocolCommon* parser, void*
 SubGhzParser* subghz_parser_alloc() {
     SubGhzParser* instance = furi_alloc(sizeof(SubGhzParser));
 
-    instance->keystore = subghz_keystore_alloc();
+    instance->keystore = subghz_keystore_attach();
 
     instance->protocols[SubGhzProtocolTypeCame] =
         (SubGhzProtocolCommon*)subghz_protocol_came_alloc();
@@ -157,7 +157,7 @@ void subghz_parser_free(SubGhzParser* instance) {
     subghz_protocol_hormann_free(
         (SubGhzProtocolHormann*)instance->protocols[SubGhzProtocolTypeHormann]);
 
-    subghz_keystore_free(instance->keystore);
+    subghz_keystore_detach(instance->keystore);
 
     free(instance);
 }
@@ -216,7 +216,7 @@ void subghz_parser_load_came_atomo_file(SubGhzParser* instance, const char* file
 }
 
 void subghz_parser_load_keeloq_file(SubGhzParser* instance, const char* file_name) {
-    if (subghz_keystore_load(instance->keystore, file_name)) {
+    if (subghz_keystore_load_once(instance->keystore, file_name)) {
         FURI_LOG_I(SUBGHZ_PARSER_TAG, "Successfully loaded keeloq keys from %s", file_name);
     } else {
         FURI_LOG_W(SUBGHZ_PARSER_TAG, "Failed to load keeloq keysfrom %s", file_name);
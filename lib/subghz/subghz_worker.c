@@ -1,17 +1,41 @@
 #include "subghz_worker.h"
 
-#include <stream_buffer.h>
 #include <furi.h>
 
 #define TAG "SubGhzWorker"
 
+/* Ring size must be a power of two */
+#define SUBGHZ_WORKER_RING_SIZE 2048
+#define SUBGHZ_WORKER_RING_MASK (SUBGHZ_WORKER_RING_SIZE - 1)
+/* Consumer is woken once this many edges are pending */
+#define SUBGHZ_WORKER_RING_WATERMARK 64
+/* Upper bound for edges staying in the ring below watermark */
+#define SUBGHZ_WORKER_FLUSH_TIMEOUT 10
+
+typedef enum {
+    SubGhzWorkerEvtStop = (1 << 0),
+    SubGhzWorkerEvtRx = (1 << 1),
+} SubGhzWorkerEvtFlags;
+
+#define SUBGHZ_WORKER_ALL_EVENTS (SubGhzWorkerEvtStop | SubGhzWorkerEvtRx)
+
 struct SubGhzWorker {
     FuriThread* thread;
-    StreamBufferHandle_t stream;
+
+    /* Single producer (ISR) / single consumer (worker thread) ring.
+     * Only ISR writes ring_head, only thread writes ring_tail. */
+    LevelDuration ring[SUBGHZ_WORKER_RING_SIZE];
+    volatile uint32_t ring_head;
+    volatile uint32_t ring_tail;
+    volatile uint32_t ring_pending_since;
 
     volatile bool running;
     volatile bool overrun;
 
+    volatile uint32_t overrun_count;
+    uint32_t batch_max;
+    uint32_t latency_max;
+
     LevelDuration filter_level_duration;
     bool filter_running;
     uint16_t filter_duration;
@@ -30,16 +54,96 @@ struct SubGhzWorker {
 void subghz_worker_rx_callback(bool level, uint32_t duration, void* context) {
     SubGhzWorker* instance = context;
 
-    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
-    LevelDuration level_duration = level_duration_make(level, duration);
+    uint32_t head = instance->ring_head;
+    uint32_t tail = instance->ring_tail;
+    uint32_t pending = head - tail;
+    // Overrun marker takes one extra slot
+    uint32_t required = instance->overrun ? 2 : 1;
+
+    if(pending + required > SUBGHZ_WORKER_RING_SIZE) {
+        instance->overrun = true;
+        instance->overrun_count++;
+        return;
+    }
+
+    if(pending == 0) {
+        instance->ring_pending_since = DWT->CYCCNT;
+    }
+
     if(instance->overrun) {
         instance->overrun = false;
-        level_duration = level_duration_reset();
+        instance->ring[head++ & SUBGHZ_WORKER_RING_MASK] = level_duration_reset();
+    }
+    instance->ring[head++ & SUBGHZ_WORKER_RING_MASK] = level_duration_make(level, duration);
+
+    // Publish slot content before index
+    __DMB();
+    instance->ring_head = head;
+
+    pending += required;
+    if(pending >= SUBGHZ_WORKER_RING_WATERMARK &&
+       pending - required < SUBGHZ_WORKER_RING_WATERMARK) {
+        osThreadId_t thread_id = furi_thread_get_thread_id(instance->thread);
+        if(thread_id) osThreadFlagsSet(thread_id, SubGhzWorkerEvtRx);
     }
-    size_t ret = xStreamBufferSendFromISR(
-        instance->stream, &level_duration, sizeof(LevelDuration), &xHigherPriorityTaskWoken);
-    if(sizeof(LevelDuration) != ret) instance->overrun = true;
-    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+static inline void
+    subghz_worker_process_level_duration(SubGhzWorker* instance, LevelDuration level_duration) {
+    if(level_duration_is_reset(level_duration)) {
+        FURI_LOG_E(TAG, "Overrun buffer");
+        if(instance->overrun_callback) instance->overrun_callback(instance->context);
+    } else {
+        bool level = level_duration_get_level(level_duration);
+        uint32_t duration = level_duration_get_duration(level_duration);
+
+        if(instance->filter_running) {
+            if((duration < instance->filter_duration) ||
+               (instance->filter_level_duration.level == level)) {
+                instance->filter_level_duration.duration += duration;
+
+            } else if(instance->filter_level_duration.level != level) {
+                if(instance->pair_callback)
+                    instance->pair_callback(
+                        instance->context,
+                        instance->filter_level_duration.level,
+                        instance->filter_level_duration.duration);
+
+                instance->filter_level_duration.duration = duration;
+                instance->filter_level_duration.level = level;
+            }
+        } else {
+            if(instance->pair_callback)
+                instance->pair_callback(instance->context, level, duration);
+        }
+    }
+}
+
+/** Drain all pending edges from ring
+ * 
+ * @param instance SubGhzWorker instance
+ */
+static void subghz_worker_process_batch(SubGhzWorker* instance) {
+    uint32_t pending_since = instance->ring_pending_since;
+    uint32_t tail = instance->ring_tail;
+    uint32_t head = instance->ring_head;
+    // Read slot content after index
+    __DMB();
+
+    uint32_t batch = head - tail;
+    if(!batch) return;
+
+    uint32_t latency = DWT->CYCCNT - pending_since;
+    if(latency > instance->latency_max) instance->latency_max = latency;
+    if(batch > instance->batch_max) instance->batch_max = batch;
+
+    while(tail != head) {
+        subghz_worker_process_level_duration(
+            instance, instance->ring[tail & SUBGHZ_WORKER_RING_MASK]);
+        tail++;
+    }
+
+    instance->ring_tail = tail;
 }
 
 /** Worker callback thread
@@ -50,39 +154,11 @@ void subghz_worker_rx_callback(bool level, uint32_t duration, void* context) {
 static int32_t subghz_worker_thread_callback(void* context) {
     SubGhzWorker* instance = context;
 
-    LevelDuration level_duration;
     while(instance->running) {
-        int ret =
-            xStreamBufferReceive(instance->stream, &level_duration, sizeof(LevelDuration), 10);
-        if(ret == sizeof(LevelDuration)) {
-            if(level_duration_is_reset(level_duration)) {
-                FURI_LOG_E(TAG, "Overrun buffer");;
-                if(instance->overrun_callback) instance->overrun_callback(instance->context);
-            } else {
-                bool level = level_duration_get_level(level_duration);
-                uint32_t duration = level_duration_get_duration(level_duration);
-
-                if(instance->filter_running) {
-                    if((duration < instance->filter_duration) ||
-                       (instance->filter_level_duration.level == level)) {
-                        instance->filter_level_duration.duration += duration;
-
-                    } else if(instance->filter_level_duration.level != level) {
-                        if(instance->pair_callback)
-                            instance->pair_callback(
-                                instance->context,
-                                instance->filter_level_duration.level,
-                                instance->filter_level_duration.duration);
-
-                        instance->filter_level_duration.duration = duration;
-                        instance->filter_level_duration.level = level;
-                    }
-                } else {
-                    if(instance->pair_callback)
-                        instance->pair_callback(instance->context, level, duration);
-                }
-            }
-        }
+        osThreadFlagsWait(SUBGHZ_WORKER_ALL_EVENTS, osFlagsWaitAny, SUBGHZ_WORKER_FLUSH_TIMEOUT);
+        FURI_TRACE_BEGIN("subghz_worker");
+        subghz_worker_process_batch(instance);
+        FURI_TRACE_END("subghz_worker");
     }
 
     return 0;
@@ -97,8 +173,6 @@ SubGhzWorker* subghz_worker_alloc() {
     furi_thread_set_context(instance->thread, instance);
     furi_thread_set_callback(instance->thread, subghz_worker_thread_callback);
 
-    instance->stream = xStreamBufferCreate(sizeof(LevelDuration) * 2048, sizeof(LevelDuration));
-
     //setting filter
     instance->filter_running = true;
     instance->filter_duration = 20;
@@ -109,7 +183,6 @@ SubGhzWorker* subghz_worker_alloc() {
 void subghz_worker_free(SubGhzWorker* instance) {
     furi_assert(instance);
 
-    vStreamBufferDelete(instance->stream);
     furi_thread_free(instance->thread);
 
     free(instance);
@@ -136,6 +209,7 @@ void subghz_worker_start(SubGhzWorker* instance) {
     furi_assert(instance);
     furi_assert(!instance->running);
 
+    instance->ring_tail = instance->ring_head;
     instance->running = true;
 
     furi_thread_start(instance->thread);
@@ -146,6 +220,7 @@ void subghz_worker_stop(SubGhzWorker* instance) {
     furi_assert(instance->running);
 
     instance->running = false;
+    osThreadFlagsSet(furi_thread_get_thread_id(instance->thread), SubGhzWorkerEvtStop);
 
     furi_thread_join(instance->thread);
 }
@@ -154,3 +229,18 @@ bool subghz_worker_is_running(SubGhzWorker* instance) {
     furi_assert(instance);
     return instance->running;
 }
+
+void subghz_worker_get_stats(SubGhzWorker* instance, SubGhzWorkerStats* stats) {
+    furi_assert(instance);
+    furi_assert(stats);
+    stats->overrun_count = instance->overrun_count;
+    stats->batch_max = instance->batch_max;
+    stats->latency_max_us = instance->latency_max / (SystemCoreClock / 1000000);
+}
+
+void subghz_worker_reset_stats(SubGhzWorker* instance) {
+    furi_assert(instance);
+    instance->overrun_count = 0;
+    instance->batch_max = 0;
+    instance->latency_max = 0;
+}
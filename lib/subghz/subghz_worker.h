@@ -8,6 +8,19 @@ typedef void (*SubGhzWorkerOverrunCallback)(void* context);
 
 typedef void (*SubGhzWorkerPairCallback)(void* context, bool level, uint32_t duration);
 
+typedef struct {
+    uint32_t overrun_count; /**< Edges dropped because ring was full */
+    uint32_t batch_max; /**< Largest number of edges drained in one wakeup */
+    uint32_t latency_max_us; /**< Worst time from first pending edge to drain */
+} SubGhzWorkerStats;
+
+/** Rx callback, ISR context
+ * Stores edge into lock-free ring, wakes worker thread on watermark
+ * 
+ * @param level received signal level
+ * @param duration received signal duration
+ * @param context SubGhzWorker instance
+ */
 void subghz_worker_rx_callback(bool level, uint32_t duration, void* context);
 
 /** Allocate SubGhzWorker
@@ -60,3 +73,16 @@ void subghz_worker_stop(SubGhzWorker* instance);
  * @return bool - true if running
  */
 bool subghz_worker_is_running(SubGhzWorker* instance);
+
+/** Get capture path statistics
+ * 
+ * @param instance SubGhzWorker instance
+ * @param stats SubGhzWorkerStats to fill
+ */
+void subghz_worker_get_stats(SubGhzWorker* instance, SubGhzWorkerStats* stats);
+
+/** Reset capture path statistics
+ * 
+ * @param instance SubGhzWorker instance
+ */
+void subghz_worker_reset_stats(SubGhzWorker* instance);
@@ -0,0 +1,91 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+/**
+ * @brief Lock-free ring of comparator edges, single producer (ISR) and single consumer (thread)
+ *
+ * Edge is packed into one word: DWT period since previous edge and polarity in MSB.
+ *
+ * @tparam size ring capacity, power of two
+ */
+template <uint32_t size> class EdgeRing {
+public:
+    static_assert((size & (size - 1)) == 0, "EdgeRing size must be power of two");
+
+    static const uint32_t capacity = size;
+
+    EdgeRing() {
+        reset();
+    }
+
+    /** Drop stored edges and counters, producer must be stopped */
+    void reset() {
+        head.store(0, std::memory_order_relaxed);
+        tail.store(0, std::memory_order_relaxed);
+        overruns.store(0, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Store edge, producer only
+     * @return fill level after push, 0 if edge was dropped on overrun
+     */
+    inline uint32_t push(bool polarity, uint32_t period) {
+        uint32_t _head = head.load(std::memory_order_relaxed);
+        uint32_t fill = _head - tail.load(std::memory_order_acquire);
+        if(fill == capacity) {
+            overruns.fetch_add(1, std::memory_order_relaxed);
+            return 0;
+        }
+        buffer[_head & (capacity - 1)] = pack(polarity, period);
+        head.store(_head + 1, std::memory_order_release);
+        return fill + 1;
+    }
+
+    /**
+     * @brief Take up to count edges, consumer only
+     * @return number of edges taken
+     */
+    size_t pop(uint32_t* edges, size_t count) {
+        uint32_t _tail = tail.load(std::memory_order_relaxed);
+        uint32_t fill = head.load(std::memory_order_acquire) - _tail;
+        if(count > fill) count = fill;
+        for(size_t i = 0; i < count; i++) {
+            edges[i] = buffer[(_tail + i) & (capacity - 1)];
+        }
+        tail.store(_tail + count, std::memory_order_release);
+        return count;
+    }
+
+    /** Drop edges stored so far, consumer only */
+    void flush() {
+        tail.store(head.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+    /** Edges dropped because consumer was late */
+    uint32_t get_overruns() {
+        return overruns.load(std::memory_order_relaxed);
+    }
+
+    static inline uint32_t pack(bool polarity, uint32_t period) {
+        return (period & period_mask) | (polarity ? polarity_bit : 0);
+    }
+
+    static inline bool get_polarity(uint32_t edge) {
+        return (edge & polarity_bit) != 0;
+    }
+
+    static inline uint32_t get_period(uint32_t edge) {
+        return edge & period_mask;
+    }
+
+private:
+    static const uint32_t polarity_bit = (1UL << 31);
+    static const uint32_t period_mask = polarity_bit - 1;
+
+    uint32_t buffer[capacity];
+    std::atomic<uint32_t> head;
+    std::atomic<uint32_t> tail;
+    std::atomic<uint32_t> overruns;
+};
@@ -0,0 +1,207 @@
+#!/usr/bin/env python3
+
+import argparse
+import logging
+import re
+import struct
+import sys
+
+# Must match core/furi/log.c
+BINARY_MAGIC = b"FLOG"
+BINARY_VERSION = 1
+RECORD_VALID = 1 << 31
+RECORD_SIZE_MASK = 0xFFFF
+RECORD_LEVEL_SHIFT = 16
+
+LEVELS = {2: "E", 3: "W", 4: "I", 5: "D", 6: "T"}
+
+SPEC_RE = re.compile(r"%([-+ #0]*)(\*|[0-9]*)(?:\.(\*|[0-9]*))?([hlzjt]*)(.?)")
+
+
+class Elf:
+    """Minimal ELF reader: resolves C strings by address in loaded sections"""
+
+    def __init__(self, path):
+        with open(path, "rb") as file:
+            self.data = file.read()
+        if self.data[:4] != b"\x7fELF":
+            raise ValueError(f"{path} is not ELF")
+        is64 = self.data[4] == 2
+        endian = "<" if self.data[5] == 1 else ">"
+        if is64:
+            shoff, = struct.unpack_from(endian + "Q", self.data, 0x28)
+            shentsize, shnum = struct.unpack_from(endian + "HH", self.data, 0x3A)
+            section = endian + "IIQQQQ"
+        else:
+            shoff, = struct.unpack_from(endian + "I", self.data, 0x20)
+            shentsize, shnum = struct.unpack_from(endian + "HH", self.data, 0x2E)
+            section = endian + "IIIIII"
+        self.sections = []
+        for index in range(shnum):
+            _, sh_type, flags, addr, offset, size = struct.unpack_from(
+                section, self.data, shoff + index * shentsize
+            )
+            # SHF_ALLOC and not SHT_NOBITS
+            if flags & 0x2 and sh_type != 8 and addr:
+                self.sections.append((addr, offset, size))
+
+    def string(self, address):
+        for addr, offset, size in self.sections:
+            if addr <= address < addr + size:
+                start = offset + address - addr
+                end = self.data.index(b"\0", start)
+                return self.data[start:end].decode("utf-8", "replace")
+        return None
+
+
+class Decoder:
+    def __init__(self, elf):
+        self.elf = elf
+        self.pointer_size = 4
+        self.long_size = 4
+        self.size_size = 4
+
+    def set_abi(self, pointer_size, long_size, size_size):
+        self.pointer_size = pointer_size
+        self.long_size = long_size
+        self.size_size = size_size
+
+    @property
+    def record_header_size(self):
+        # uint32_t header, uint32_t timestamp, const char* format
+        return (8 + self.pointer_size - 1) // self.pointer_size * self.pointer_size + (
+            self.pointer_size
+        )
+
+    def integer(self, length, conversion):
+        signed = conversion in "di"
+        if "z" in length or "t" in length:
+            size = self.size_size
+        elif length.count("l") > 1 or "j" in length:
+            size = 8
+        elif "l" in length:
+            size = self.long_size
+        else:
+            size = 4
+        return size, {4: "i", 8: "q"}[size] if signed else {4: "I", 8: "Q"}[size]
+
+    def format(self, format, args):
+        output = ""
+        position = 0
+        offset = 0
+        for match in SPEC_RE.finditer(format):
+            output += format[position : match.start()]
+            position = match.end()
+            flags, width, precision, length, conversion = match.groups()
+            if conversion == "%":
+                output += "%"
+                continue
+
+            stars = []
+            for field in (width, precision):
+                if field == "*":
+                    if offset + 4 > len(args):
+                        return output + format[match.start() :]
+                    stars.append(struct.unpack_from("<i", args, offset)[0])
+                    offset += 4
+            width = str(stars.pop(0)) if width == "*" else width
+            precision = str(stars.pop(0)) if precision == "*" else precision
+            spec = "%" + flags + width + ("." + precision if precision is not None else "")
+
+            if conversion in "diuxXoc":
+                size, code = self.integer(length, conversion)
+                if offset + size > len(args):
+                    return output + format[match.start() :]
+                value, = struct.unpack_from("<" + code, args, offset)
+                output += (spec + conversion.replace("u", "d")) % value
+            elif conversion == "p":
+                size = self.pointer_size
+                if offset + size > len(args):
+                    return output + format[match.start() :]
+                value, = struct.unpack_from("<" + {4: "I", 8: "Q"}[size], args, offset)
+                output += "0x%x" % value
+            elif conversion in "fFeEgGaA":
+                size = 8
+                if offset + size > len(args):
+                    return output + format[match.start() :]
+                value, = struct.unpack_from("<d", args, offset)
+                output += (spec + conversion.replace("a", "e").replace("A", "E")) % value
+            elif conversion == "s":
+                if offset + 1 > len(args):
+                    return output + format[match.start() :]
+                size = 1 + args[offset]
+                value = args[offset + 1 : offset + size].decode("utf-8", "replace")
+                output += (spec + "s") % value
+            else:
+                return output + format[match.start() :]
+            offset += size
+        return output + format[position:]
+
+    def record(self, record):
+        header, timestamp = struct.unpack_from("<II", record, 0)
+        level = LEVELS.get((header >> RECORD_LEVEL_SHIFT) & 0xFF, "?")
+        pointer_code = {4: "I", 8: "Q"}[self.pointer_size]
+        format_address, = struct.unpack_from("<" + pointer_code, record, 8)
+        args = record[self.record_header_size :]
+        if format_address == 0:
+            dropped, = struct.unpack_from("<I", args, 0)
+            return f"{timestamp} [log] {dropped} records dropped\r\n"
+        format = self.elf.string(format_address) if self.elf else None
+        if format is None:
+            return f"{timestamp} [{level}] <format 0x{format_address:x}> {args.hex()}\r\n"
+        return f"{timestamp} " + self.format(format, args)
+
+
+class Main:
+    def __init__(self):
+        self.parser = argparse.ArgumentParser(
+            description="Decode furi_log binary stream (FuriLogModeBinary)"
+        )
+        self.parser.add_argument("-d", "--debug", action="store_true", help="Debug")
+        self.parser.add_argument("-e", "--elf", help="Firmware ELF to resolve format strings")
+        self.parser.add_argument("dump", help="Binary dump file, - for stdin")
+        self.logger = logging.getLogger()
+
+    def __call__(self):
+        self.args = self.parser.parse_args()
+        logging.basicConfig(
+            level=logging.DEBUG if self.args.debug else logging.INFO,
+            format="%(asctime)s [%(levelname)s] %(message)s",
+        )
+        elf = Elf(self.args.elf) if self.args.elf else None
+        if self.args.dump == "-":
+            data = sys.stdin.buffer.read()
+        else:
+            with open(self.args.dump, "rb") as file:
+                data = file.read()
+        return self.decode(Decoder(elf), data)
+
+    def decode(self, decoder, data):
+        position = data.find(BINARY_MAGIC)
+        if position < 0:
+            self.logger.error("No binary log header found")
+            return 1
+        while position >= 0 and position + 8 <= len(data):
+            version, pointer_size, long_size, size_size = data[position + 4 : position + 8]
+            if version != BINARY_VERSION:
+                self.logger.error(f"Unsupported version {version}")
+                return 1
+            decoder.set_abi(pointer_size, long_size, size_size)
+            position += 8
+            while position + 4 <= len(data):
+                header, = struct.unpack_from("<I", data, position)
+                size = header & RECORD_SIZE_MASK
+                if not header & RECORD_VALID or size < decoder.record_header_size:
+                    break
+                if position + size > len(data):
+                    self.logger.warning("Truncated record at the end of dump")
+                    return 0
+                sys.stdout.write(decoder.record(data[position : position + size]))
+                position += size
+            # Mode switched back and forth or garbage, look for next header
+            position = data.find(BINARY_MAGIC, position)
+        return 0
+
+
+if __name__ == "__main__":
+    sys.exit(Main()())
@@ -0,0 +1,162 @@
+#!/usr/bin/env python3
+
+import argparse
+import json
+import logging
+import sys
+
+# Must match core/furi/trace.h, timestamps are 32 bit cycle counter
+TIMESTAMP_WRAP = 1 << 32
+
+PID = 0
+TID_CPU = 0
+TID_ISR = 1
+
+
+class Converter:
+    """Furi trace dump to Chrome trace event format (chrome://tracing, Perfetto)
+
+    CPU track shows which thread runs, every thread gets own track with its
+    spans, queue and mutex events. Interrupt handlers go to ISR track.
+    """
+
+    def __init__(self):
+        self.events = []
+        self.threads = {}
+        self.cycles_per_us = 1
+        self.last_timestamp = None
+        self.wraps = 0
+        self.current = None
+        self.current_since = None
+        self.current_name = None
+
+    def time(self, timestamp):
+        # Unwrap counter, events are in order and never a whole period apart
+        if self.last_timestamp is not None and timestamp < self.last_timestamp:
+            self.wraps += 1
+        self.last_timestamp = timestamp
+        return (timestamp + self.wraps * TIMESTAMP_WRAP) / self.cycles_per_us
+
+    def thread_tid(self, handle, name):
+        if handle not in self.threads:
+            tid = len(self.threads) + 2
+            self.threads[handle] = tid
+            self.events.append(
+                {
+                    "ph": "M",
+                    "pid": PID,
+                    "tid": tid,
+                    "name": "thread_name",
+                    "args": {"name": name if name != "-" else handle},
+                }
+            )
+        return self.threads[handle]
+
+    def current_tid(self):
+        return self.threads[self.current] if self.current else TID_CPU
+
+    def add(self, time, type, id, data, label):
+        if type == "switch":
+            if self.current is not None:
+                self.events.append(
+                    {
+                        "ph": "X",
+                        "pid": PID,
+                        "tid": TID_CPU,
+                        "name": self.current_name,
+                        "ts": self.current_since,
+                        "dur": time - self.current_since,
+                    }
+                )
+            self.thread_tid(data, label)
+            self.current = data
+            self.current_name = label if label != "-" else data
+            self.current_since = time
+        elif type in ("isr_enter", "isr_exit"):
+            self.events.append(
+                {
+                    "ph": "B" if type == "isr_enter" else "E",
+                    "pid": PID,
+                    "tid": TID_ISR,
+                    "name": f"{label} {id}",
+                    "ts": time,
+                }
+            )
+        elif type in ("begin", "end"):
+            self.events.append(
+                {
+                    "ph": "B" if type == "begin" else "E",
+                    "pid": PID,
+                    "tid": self.current_tid(),
+                    "name": label,
+                    "ts": time,
+                }
+            )
+        else:
+            self.events.append(
+                {
+                    "ph": "i",
+                    "s": "t",
+                    "pid": PID,
+                    "tid": self.current_tid(),
+                    "name": type,
+                    "ts": time,
+                    "args": {"handle": data},
+                }
+            )
+
+    def convert(self, lines):
+        self.events.append(
+            {"ph": "M", "pid": PID, "tid": TID_CPU, "name": "thread_name", "args": {"name": "CPU"}}
+        )
+        self.events.append(
+            {"ph": "M", "pid": PID, "tid": TID_ISR, "name": "thread_name", "args": {"name": "ISR"}}
+        )
+        for line in lines:
+            line = line.strip()
+            if not line:
+                continue
+            if line.startswith("#"):
+                fields = line.split()
+                if "cycles/us" in fields:
+                    self.cycles_per_us = int(fields[fields.index("cycles/us") + 1])
+                continue
+            fields = line.split(" ", 4)
+            if len(fields) < 5:
+                logging.warning(f"Skipping malformed line: {line}")
+                continue
+            timestamp, type, id, data, label = fields
+            self.add(self.time(int(timestamp)), type, int(id), data, label)
+        return {"traceEvents": self.events, "displayTimeUnit": "ns"}
+
+
+class Main:
+    def __init__(self):
+        self.parser = argparse.ArgumentParser(
+            description="Convert `trace dump` output to Chrome trace JSON"
+        )
+        self.parser.add_argument("-d", "--debug", action="store_true", help="Debug")
+        self.parser.add_argument("dump", help="Trace dump file, - for stdin")
+        self.parser.add_argument("output", help="JSON file, - for stdout")
+
+    def __call__(self):
+        self.args = self.parser.parse_args()
+        logging.basicConfig(
+            level=logging.DEBUG if self.args.debug else logging.INFO,
+            format="%(asctime)s [%(levelname)s] %(message)s",
+        )
+        if self.args.dump == "-":
+            trace = Converter().convert(sys.stdin)
+        else:
+            with open(self.args.dump, "r", errors="replace") as file:
+                trace = Converter().convert(file)
+        if self.args.output == "-":
+            json.dump(trace, sys.stdout)
+        else:
+            with open(self.args.output, "w") as file:
+                json.dump(trace, file)
+        return 0
+
+
+if __name__ == "__main__":
+    sys.exit(Main()())